@@ -0,0 +1,26 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/core/libeblearn/src/bbox.cpp" "/root/repo/core/build/libeblearn/CMakeFiles/eblearn.dir/src/bbox.o" "gcc" "/root/repo/core/build/libeblearn/CMakeFiles/eblearn.dir/src/bbox.o.d"
+  "/root/repo/core/libeblearn/src/ebl_convolution.cpp" "/root/repo/core/build/libeblearn/CMakeFiles/eblearn.dir/src/ebl_convolution.o" "gcc" "/root/repo/core/build/libeblearn/CMakeFiles/eblearn.dir/src/ebl_convolution.o.d"
+  "/root/repo/core/libeblearn/src/ebl_logger.cpp" "/root/repo/core/build/libeblearn/CMakeFiles/eblearn.dir/src/ebl_logger.o" "gcc" "/root/repo/core/build/libeblearn/CMakeFiles/eblearn.dir/src/ebl_logger.o.d"
+  "/root/repo/core/libeblearn/src/ebl_module.cpp" "/root/repo/core/build/libeblearn/CMakeFiles/eblearn.dir/src/ebl_module.o" "gcc" "/root/repo/core/build/libeblearn/CMakeFiles/eblearn.dir/src/ebl_module.o.d"
+  "/root/repo/core/libeblearn/src/ebl_parameters.cpp" "/root/repo/core/build/libeblearn/CMakeFiles/eblearn.dir/src/ebl_parameters.o" "gcc" "/root/repo/core/build/libeblearn/CMakeFiles/eblearn.dir/src/ebl_parameters.o.d"
+  "/root/repo/core/libeblearn/src/ebl_utils.cpp" "/root/repo/core/build/libeblearn/CMakeFiles/eblearn.dir/src/ebl_utils.o" "gcc" "/root/repo/core/build/libeblearn/CMakeFiles/eblearn.dir/src/ebl_utils.o.d"
+  "/root/repo/core/libeblearn/src/nms.cpp" "/root/repo/core/build/libeblearn/CMakeFiles/eblearn.dir/src/nms.o" "gcc" "/root/repo/core/build/libeblearn/CMakeFiles/eblearn.dir/src/nms.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/core/build/libidx/CMakeFiles/idx.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,23 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/libeblearn.pdb"
+  "/root/repo/bin/libeblearn.so"
+  "CMakeFiles/eblearn.dir/src/bbox.o"
+  "CMakeFiles/eblearn.dir/src/bbox.o.d"
+  "CMakeFiles/eblearn.dir/src/ebl_convolution.o"
+  "CMakeFiles/eblearn.dir/src/ebl_convolution.o.d"
+  "CMakeFiles/eblearn.dir/src/ebl_logger.o"
+  "CMakeFiles/eblearn.dir/src/ebl_logger.o.d"
+  "CMakeFiles/eblearn.dir/src/ebl_module.o"
+  "CMakeFiles/eblearn.dir/src/ebl_module.o.d"
+  "CMakeFiles/eblearn.dir/src/ebl_parameters.o"
+  "CMakeFiles/eblearn.dir/src/ebl_parameters.o.d"
+  "CMakeFiles/eblearn.dir/src/ebl_utils.o"
+  "CMakeFiles/eblearn.dir/src/ebl_utils.o.d"
+  "CMakeFiles/eblearn.dir/src/nms.o"
+  "CMakeFiles/eblearn.dir/src/nms.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/eblearn.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
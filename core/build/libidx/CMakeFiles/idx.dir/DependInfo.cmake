@@ -0,0 +1,44 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/core/libidx/src/blasops.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/blasops.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/blasops.o.d"
+  "/root/repo/core/libidx/src/color_spaces.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/color_spaces.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/color_spaces.o.d"
+  "/root/repo/core/libidx/src/gemm.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/gemm.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/gemm.o.d"
+  "/root/repo/core/libidx/src/half.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/half.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/half.o.d"
+  "/root/repo/core/libidx/src/idx.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/idx.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/idx.o.d"
+  "/root/repo/core/libidx/src/idxIO.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/idxIO.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/idxIO.o.d"
+  "/root/repo/core/libidx/src/idxops.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/idxops.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/idxops.o.d"
+  "/root/repo/core/libidx/src/idxspec.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/idxspec.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/idxspec.o.d"
+  "/root/repo/core/libidx/src/image.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/image.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/image.o.d"
+  "/root/repo/core/libidx/src/imageIO.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/imageIO.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/imageIO.o.d"
+  "/root/repo/core/libidx/src/ipp.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/ipp.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/ipp.o.d"
+  "/root/repo/core/libidx/src/ippops.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/ippops.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/ippops.o.d"
+  "/root/repo/core/libidx/src/lzcodec.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/lzcodec.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/lzcodec.o.d"
+  "/root/repo/core/libidx/src/matlab.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/matlab.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/matlab.o.d"
+  "/root/repo/core/libidx/src/numerics.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/numerics.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/numerics.o.d"
+  "/root/repo/core/libidx/src/prefetcher.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/prefetcher.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/prefetcher.o.d"
+  "/root/repo/core/libidx/src/random.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/random.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/random.o.d"
+  "/root/repo/core/libidx/src/resampler.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/resampler.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/resampler.o.d"
+  "/root/repo/core/libidx/src/simd.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/simd.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/simd.o.d"
+  "/root/repo/core/libidx/src/smart.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/smart.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/smart.o.d"
+  "/root/repo/core/libidx/src/srg.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/srg.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/srg.o.d"
+  "/root/repo/core/libidx/src/stl.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/stl.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/stl.o.d"
+  "/root/repo/core/libidx/src/string_utils.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/string_utils.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/string_utils.o.d"
+  "/root/repo/core/libidx/src/th.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/th.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/th.o.d"
+  "/root/repo/core/libidx/src/thops.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/thops.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/thops.o.d"
+  "/root/repo/core/libidx/src/utils.cpp" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/utils.o" "gcc" "/root/repo/core/build/libidx/CMakeFiles/idx.dir/src/utils.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,61 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/libidx.pdb"
+  "/root/repo/bin/libidx.so"
+  "CMakeFiles/idx.dir/src/blasops.o"
+  "CMakeFiles/idx.dir/src/blasops.o.d"
+  "CMakeFiles/idx.dir/src/color_spaces.o"
+  "CMakeFiles/idx.dir/src/color_spaces.o.d"
+  "CMakeFiles/idx.dir/src/gemm.o"
+  "CMakeFiles/idx.dir/src/gemm.o.d"
+  "CMakeFiles/idx.dir/src/half.o"
+  "CMakeFiles/idx.dir/src/half.o.d"
+  "CMakeFiles/idx.dir/src/idx.o"
+  "CMakeFiles/idx.dir/src/idx.o.d"
+  "CMakeFiles/idx.dir/src/idxIO.o"
+  "CMakeFiles/idx.dir/src/idxIO.o.d"
+  "CMakeFiles/idx.dir/src/idxops.o"
+  "CMakeFiles/idx.dir/src/idxops.o.d"
+  "CMakeFiles/idx.dir/src/idxspec.o"
+  "CMakeFiles/idx.dir/src/idxspec.o.d"
+  "CMakeFiles/idx.dir/src/image.o"
+  "CMakeFiles/idx.dir/src/image.o.d"
+  "CMakeFiles/idx.dir/src/imageIO.o"
+  "CMakeFiles/idx.dir/src/imageIO.o.d"
+  "CMakeFiles/idx.dir/src/ipp.o"
+  "CMakeFiles/idx.dir/src/ipp.o.d"
+  "CMakeFiles/idx.dir/src/ippops.o"
+  "CMakeFiles/idx.dir/src/ippops.o.d"
+  "CMakeFiles/idx.dir/src/lzcodec.o"
+  "CMakeFiles/idx.dir/src/lzcodec.o.d"
+  "CMakeFiles/idx.dir/src/matlab.o"
+  "CMakeFiles/idx.dir/src/matlab.o.d"
+  "CMakeFiles/idx.dir/src/numerics.o"
+  "CMakeFiles/idx.dir/src/numerics.o.d"
+  "CMakeFiles/idx.dir/src/prefetcher.o"
+  "CMakeFiles/idx.dir/src/prefetcher.o.d"
+  "CMakeFiles/idx.dir/src/random.o"
+  "CMakeFiles/idx.dir/src/random.o.d"
+  "CMakeFiles/idx.dir/src/resampler.o"
+  "CMakeFiles/idx.dir/src/resampler.o.d"
+  "CMakeFiles/idx.dir/src/simd.o"
+  "CMakeFiles/idx.dir/src/simd.o.d"
+  "CMakeFiles/idx.dir/src/smart.o"
+  "CMakeFiles/idx.dir/src/smart.o.d"
+  "CMakeFiles/idx.dir/src/srg.o"
+  "CMakeFiles/idx.dir/src/srg.o.d"
+  "CMakeFiles/idx.dir/src/stl.o"
+  "CMakeFiles/idx.dir/src/stl.o.d"
+  "CMakeFiles/idx.dir/src/string_utils.o"
+  "CMakeFiles/idx.dir/src/string_utils.o.d"
+  "CMakeFiles/idx.dir/src/th.o"
+  "CMakeFiles/idx.dir/src/th.o.d"
+  "CMakeFiles/idx.dir/src/thops.o"
+  "CMakeFiles/idx.dir/src/thops.o.d"
+  "CMakeFiles/idx.dir/src/utils.o"
+  "CMakeFiles/idx.dir/src/utils.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/idx.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -41,6 +41,32 @@
 
 namespace ebl {
 
+// datasource_prefetch /////////////////////////////////////////////////////////
+
+//! Owning pointer to the read-ahead of a datasource. Copies of a datasource
+//! do not share the read-ahead of the original (which would be deleted
+//! twice): a copied or assigned pointer is NULL, i.e. copies read their
+//! samples directly until set_prefetching() is called on them.
+template <typename Tdata> class datasource_prefetch {
+ public:
+  datasource_prefetch() : p(NULL) {}
+  datasource_prefetch(const datasource_prefetch<Tdata> &) : p(NULL) {}
+  ~datasource_prefetch() { reset(NULL); }
+  datasource_prefetch<Tdata>& operator=(const datasource_prefetch<Tdata> &) {
+    reset(NULL);
+    return *this;
+  }
+  //! Deletes the current read-ahead and takes ownership of 'q'.
+  void reset(midx_prefetcher<Tdata> *q) {
+    if (p) delete p;
+    p = q;
+  }
+  midx_prefetcher<Tdata>* operator->() const { return p; }
+  operator bool() const { return p != NULL; }
+ private:
+  midx_prefetcher<Tdata> *p;
+};
+
 // datasource //////////////////////////////////////////////////////////////////
 
 //! A class handling a data source. This datasource does can not contain
@@ -163,8 +189,11 @@ template<typename T, typename Tdata> class datasource {
   //!   (class, confidence, etc).
   //! \param target The target answer, i.e. the groundtruth equivalent of
   //!    'estimates'.
+  //! \param index If -1, set current sample's energy, otherwise sample's at
+  //!   'index' position (see get_current_index()).
   virtual void set_sample_energy(double e, bool correct, idx<T> &raw_outputs,
-                                 idx<T> &answers, idx<T> &target);
+                                 idx<T> &answers, idx<T> &target,
+                                 intg index = -1);
   //! If 'keep' is true, then we keep for each sample the 'raw_outputs',
   //! the 'answers' and the 'target' of the model (see set_sample_energy()).
   //! This may be expensive in memory.
@@ -189,6 +218,13 @@ template<typename T, typename Tdata> class datasource {
   virtual void set_shuffle_passes(bool activate);
   //! Add a feature dimension with size 1 in front of data.
   virtual void add_features_dimension();
+  //! Enables reading ahead samples loaded on-demand (see load_matrices())
+  //! in a background thread, following the order in which next() or
+  //! next_train() will return them. At most 'budget' bytes of samples are
+  //! kept in memory and at most 'depth' upcoming samples are scheduled.
+  //! A budget of 0 disables read-ahead. This has no effect on data that is
+  //! already in memory.
+  virtual void set_prefetching(intg budget, intg depth = 256);
 
   //! Activate or deactivate weighing of samples based on classification
   //! results. Wrong answers give a higher probability for a sample
@@ -225,6 +261,8 @@ template<typename T, typename Tdata> class datasource {
   virtual intg get_epoch_size();
   //! Return the number of samples this epoch has processed.
   virtual intg get_epoch_count();
+  //! Returns the index of the current sample in the data matrix.
+  virtual intg get_current_index();
   //! Set the number of samples to train on for one epoch.
   //! If not called, default number used is the one returned
   //! by get_lowest_common_size().
@@ -290,6 +328,16 @@ template<typename T, typename Tdata> class datasource {
   //! Return a vector of sample indices, sorted by their picking counts.
   virtual std::map<uint,intg>& get_pickings();
 
+  // read-ahead methods //////////////////////////////////////////////////////
+
+  //! Returns all matrices of sample 'index' from the read-ahead cache and
+  //! schedules the samples that follow it.
+  virtual midx<Tdata> prefetched_sample(intg index);
+  //! Fills 'order' with the indices of at most 'n' samples that next()
+  //! or next_train() (depending on which was called last) will return
+  //! after the current one.
+  virtual void upcoming_samples(intg n, std::vector<intg> &order);
+
   // members /////////////////////////////////////////////////////////////////
  public:
   T                   bias;
@@ -324,6 +372,11 @@ template<typename T, typename Tdata> class datasource {
   intg                it_test;          //!< Current test index in data matrix.
   intg                it_train;         //!< Current train index in vector 'indices'.
   idx<intg>           indices;          //!< Vector of indices to the data matrix.
+  bool                iterating_train;  //!< Last iteration was next_train().
+  ////////////////////////////////////////////////////////////////////////////
+  // read-ahead
+  datasource_prefetch<Tdata> prefetch;  //!< Read-ahead of on-demand samples.
+  intg                prefetch_depth;   //!< Number of samples scheduled.
   ////////////////////////////////////////////////////////////////////////////
   // state saving
   bool                state_saved;      //!< State has been saved or not.
@@ -725,6 +778,10 @@ class class_datasource : public labeled_datasource<T, Tdata, Tlabel> {
   //! Draw a random number between 0 and 1 and return true if higher
   //! than current sample's probability.
   virtual bool pick_current();
+  //! Fills 'order' with the indices of at most 'n' samples that will be
+  //! returned after the current one, following the class-balanced order
+  //! if balanced training is on.
+  virtual void upcoming_samples(intg n, std::vector<intg> &order);
 
   // members /////////////////////////////////////////////////////////////////
  protected:
@@ -750,6 +807,7 @@ class class_datasource : public labeled_datasource<T, Tdata, Tlabel> {
   using datasource<T,Tdata>::epoch_sz;
   using datasource<T,Tdata>::epoch_timer;
   using datasource<T,Tdata>::epoch_show_printed;
+  using datasource<T,Tdata>::iterating_train;
   // class-balanced iterating indices
   using datasource<T,Tdata>::epoch_done_counters;
   bool		 balance;	//!< Balance iterating or not.
@@ -69,7 +69,8 @@ datasource(const char *data_fname, const char *name_) {
 		// try to load as csv if file is not a matrix
 		if (!is_matrix(data_fname)) {
       multimat = false;
-      idx<Tdata> data_ = load_csv_matrix<Tdata>(data_fname);
+      idx<Tdata> data_ = load_csv_matrix<Tdata>(data_fname, false, true, false,
+                                                false, csv_caching());
       init(data_, name_);
 		} else {
 			// matrix format
@@ -90,6 +91,7 @@ datasource(const char *data_fname, const char *name_) {
 
 template <typename T, typename Tdata>
 datasource<T,Tdata>::~datasource() {
+  prefetch.reset(NULL); // stop reading ahead before members go away
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -101,6 +103,7 @@ init(midx<Tdata> &datas_, const char *name_) {
   datas = datas_;
   data = (idx<Tdata>&) datas_;
   multimat = true;
+  add_features_dimension_ = false;
   init2(name_);
 }
 
@@ -126,12 +129,16 @@ init2(const char *name_) {
   it = 0;
   it_test = 0;
   it_train = 0;
+  iterating_train = false;
   shuffle_passes = false;
   test_set = false;
   epoch_sz = 0;
   epoch_cnt = 0;
   epoch_pick_cnt = 0;
   epoch_mode = 1; // default (1): all samples are seen at least once.
+  // read-ahead, data may have changed
+  prefetch.reset(NULL);
+  prefetch_depth = 0;
   hardest_focus = false;
   _ignore_correct = false;
   // state saving
@@ -267,6 +274,11 @@ intg datasource<T,Tdata>::get_epoch_count() {
   return epoch_cnt;
 }
 
+template <typename T, typename Tdata>
+intg datasource<T,Tdata>::get_current_index() {
+  return it;
+}
+
 template <typename T, typename Tdata>
 void datasource<T,Tdata>::set_epoch_size(intg sz) {
   std::cout << _name << ": Setting epoch size to " << sz << std::endl;
@@ -290,7 +302,8 @@ template <typename T, typename Tdata>
 void datasource<T,Tdata>::fprop1_data(idx<T> &out) {
   // get sample
   idx<Tdata> dat;
-  if (multimat) dat = datas.mget(it);
+  if (multimat && prefetch) dat = prefetched_sample(it).mget(0);
+  else if (multimat) dat = datas.mget(it);
   else dat = data[it];
   // resize output if necessary
   idxdim d = dat.get_idxdim();
@@ -311,7 +324,8 @@ template <typename T, typename Tdata>
 void datasource<T,Tdata>::fprop_data(state<T> &out) {
   // copy data
   if (multimat) { // multiple matrices per sample
-    midx<Tdata> sample = datas.select(0, it);
+    midx<Tdata> sample =
+      prefetch ? prefetched_sample(it) : datas.select(0, it);
     out.deep_copy(sample);
   } else this->fprop1_data(out); // single matrix per sample
   EDEBUG_MAT("datasource sample " << it << ":", out);
@@ -357,6 +371,7 @@ bool datasource<T,Tdata>::next() {
   }
   // set main iterator used by fprop
   it = it_test;
+  iterating_train = false;
   return true;
 }
 
@@ -380,6 +395,7 @@ bool datasource<T,Tdata>::next_train() {
       normalize_probas();
   }
   it = indices.get(it_train); // set main iterator to the train iterator
+  iterating_train = true;
   // recursively loop until we find a sample that is picked for this class
   pick = this->pick_current();
   epoch_cnt++;
@@ -452,6 +468,7 @@ template <typename T, typename Tdata>
 void datasource<T,Tdata>::seek_begin() {
   it_test = 0; // reset test iterator
   it = it_test; // set main iterator to test iterator
+  iterating_train = false;
   test_timer.restart();
 }
 
@@ -461,6 +478,7 @@ void datasource<T,Tdata>::seek_begin_train() {
   it_train = 0;
   // set main iterator to train iterator
   it = indices.get(it_train);
+  iterating_train = true;
 }
 
 template <typename T, typename Tdata>
@@ -478,6 +496,18 @@ void datasource<T,Tdata>::add_features_dimension() {
   add_features_dimension_ = true;
 }
 
+template <typename T, typename Tdata>
+void datasource<T,Tdata>::set_prefetching(intg budget, intg depth) {
+  prefetch.reset(NULL);
+  prefetch_depth = depth;
+  if (budget <= 0 || !multimat || !datas.get_file_pointer()) return ;
+  prefetch.reset(new midx_prefetcher<Tdata>(datas, budget));
+  if (!silent)
+    std::cout << _name << ": Reading ahead up to " << depth
+              << " samples within " << budget / (1024 * 1024) << "Mb."
+              << std::endl;
+}
+
 // picking probability methods /////////////////////////////////////////////////
 
 template <typename T, typename Tdata>
@@ -586,7 +616,8 @@ template <typename T, typename Tdata>
 void datasource<T,Tdata>::set_sample_energy(double e, bool correct_,
                                             idx<T> &raw_,
                                             idx<T> &answers_,
-                                            idx<T> &target) {
+                                            idx<T> &target, intg index) {
+  intg it = index >= 0 ? index : this->it;
   energies.set(e, it);
   correct.set(correct_ ? 1 : 0, it);
 
@@ -742,6 +773,9 @@ void datasource<T,Tdata>::pretty_progress(bool newline) {
 	elapsed((long) ((sz - i) *
                         (test_timer.elapsed_seconds()
                          /(double)std::max((intg)1,i))));
+    if (prefetch)
+      std::cout << ", read-ahead hits: " << prefetch->hits()
+                << " misses: " << prefetch->misses();
     if (newline)
       std::cout << std::endl;
   }
@@ -809,7 +843,7 @@ bool datasource<T,Tdata>::pick_current() {
     return true;
   // draw random number between 0 and 1 and return true if lower
   // than sample's probability.
-  double r = drand(); // [0..1]
+  double r = thread_random().drand(); // [0..1]
   if (r <= probas.get(it))
     return true;
   return false;
@@ -826,6 +860,33 @@ std::map<uint,intg>& datasource<T,Tdata>::get_pickings() {
   return picksmap;
 }
 
+// read-ahead methods //////////////////////////////////////////////////////////
+
+template <typename T, typename Tdata>
+midx<Tdata> datasource<T,Tdata>::prefetched_sample(intg index) {
+  midx<Tdata> sample = prefetch->get(index);
+  std::vector<intg> order;
+  upcoming_samples(prefetch_depth, order);
+  prefetch->schedule(order);
+  return sample;
+}
+
+template <typename T, typename Tdata>
+void datasource<T,Tdata>::upcoming_samples(intg n, std::vector<intg> &order) {
+  order.clear();
+  if (iterating_train) { // follow training indices
+    intg sz = indices.dim(0);
+    for (intg k = 1; k <= n && k < sz; ++k) {
+      intg j = it_train + k;
+      // order after the end of the pass is unknown if shuffled
+      if (j >= sz && shuffle_passes) break ;
+      order.push_back(indices.get(j % sz));
+    }
+  } else // follow original order
+    for (intg j = it_test + 1; j < data.dim(0) && (intg) order.size() < n; ++j)
+      order.push_back(j);
+}
+
 ////////////////////////////////////////////////////////////////
 // labeled_datasource
 
@@ -924,7 +985,8 @@ init(const char *data_fname, const char *labels_fname,
   try {
 		// try to load as csv if file is not a matrix
 		if (!is_matrix(data_fname))
-			lab = load_csv_matrix<Tlabel>(labels_fname);
+			lab = load_csv_matrix<Tlabel>(labels_fname, false, true, false, false,
+                                    csv_caching());
 		else // regular format
 			lab = load_matrix<Tlabel>(labels_fname);
   } eblcatcherror_msg("Failed to load dataset file");
@@ -1211,7 +1273,7 @@ class_datasource<T, Tdata, Tlabel>::
 class_datasource(midx<Tdata> &data_, idx<Tlabel> &labels_,
                  std::vector<std::string*> *lblstr_, const char *name_) {
   defaults();
-  init(data_, labels_, name_, lblstr_);
+  init(data_, labels_, lblstr_, name_);
   this->init_epoch();
   this->pretty(); // print info about dataset
 }
@@ -1221,7 +1283,7 @@ class_datasource<T, Tdata, Tlabel>::
 class_datasource(idx<Tdata> &data_, idx<Tlabel> &labels_,
                  std::vector<std::string*> *lblstr_, const char *name_) {
   defaults();
-  init(data_, labels_, name_, lblstr_);
+  init(data_, labels_, lblstr_, name_);
   this->init_epoch();
   this->pretty(); // print info about dataset
 }
@@ -1262,7 +1324,7 @@ class_datasource(const char *data_name, const char *labels_name,
 template <typename T, typename Tdata, typename Tlabel>
 class_datasource<T, Tdata, Tlabel>::
 class_datasource(const class_datasource<T, Tdata, Tlabel> &ds)
-    : datasource<T,Tdata>((const datasource<T,Tdata>&) ds),
+    : labeled_datasource<T,Tdata,Tlabel>(ds),
       lblstr(NULL) {
   defaults();
   if (ds.lblstr) {
@@ -1548,6 +1610,7 @@ bool class_datasource<T,Tdata,Tlabel>::next_train() {
     next_balanced_class();
   it = bal_indices[class_it][bal_it[class_it]];
   bal_it[class_it] += 1;
+  iterating_train = true;
   // decide if we want to select this sample for training
   pick = this->pick_current();
   // decrement epoch counter
@@ -1608,7 +1671,7 @@ template <typename T, typename Tdata, typename Tlabel>
 void class_datasource<T,Tdata,Tlabel>::next_balanced_class() {
   // classes have custom chances to be picked
   if (class_probabilities.size() > 0) {
-    float r = (float) drand(); // random number in [0,1]
+    float r = (float) thread_random().drand(); // random number in [0,1]
     float total = 0; 
     for (class_it = 0; r > total && class_it < class_probabilities.size(); 
 	 ++class_it) {
@@ -2083,6 +2146,30 @@ bool class_datasource<T,Tdata,Tlabel>::pick_current() {
   return datasource<T,Tdata>::pick_current();
 }
 
+template <typename T, typename Tdata, typename Tlabel>
+void class_datasource<T,Tdata,Tlabel>::
+upcoming_samples(intg n, std::vector<intg> &order) {
+  if (!iterating_train || !balance || class_order.size() == 0) {
+    datasource<T,Tdata>::upcoming_samples(n, order);
+    return ;
+  }
+  // follow classes in their balanced order, starting with current class,
+  // each class continuing from its own sample iterator
+  order.clear();
+  std::vector<uint> pos = bal_it;
+  uint c = class_it, oi = class_it_it;
+  for (intg k = 0; (intg) order.size() < n && k < n + nclasses; ++k) {
+    std::vector<intg> &clist = bal_indices[c];
+    if (clist.size() > 0 && !(bexclusion && excluded[c])) {
+      // order after the end of the class list is unknown if shuffled
+      if (pos[c] >= clist.size() && !shuffle_passes) pos[c] = 0;
+      if (pos[c] < clist.size()) order.push_back(clist[pos[c]++]);
+    }
+    oi = (oi + 1) % class_order.size();
+    c = class_order[oi];
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //! class_node
 
@@ -196,6 +196,10 @@ template <typename T> class detector {
   void set_bbox_scalings(mfidxdim &scalings);
   //! Apply a gain to input image.
   void set_input_gain(double gain);
+  //! Build the inputs of all scales as an image pyramid, each scale being
+  //! resized from the nearest larger one and linear color conversions
+  //! being done once per image (see resizepp_module::set_pyramid()).
+  void set_pyramid(bool enable);
 
   // execution /////////////////////////////////////////////////////////////////
 
@@ -346,6 +350,7 @@ template <typename T> class detector {
   bool                      resizepp_outside; //!< resizepp is not contained in net
   idx<T>                    image;
   T                         input_gain; //!< Factor on input image.
+  bool                      pyramid;    //!< Scales are an image pyramid.
   idx<float>                sizes;
   state<T>                  finput;     //! A forward buffer containing input image.
   state<T>                 *input;      //!< input buffer
@@ -50,6 +50,7 @@ detector<T>::detector(module_1_1<T> &thenet_, std::vector<std::string> &labels_,
                       std::ostream &o, std::ostream &e, bool adapt_scales_)
     : thenet(thenet_), thenet_nopp(NULL), resizepp(resize),
       resizepp_delete(false), resizepp_outside(false), input_gain(1),
+      pyramid(false),
       input(NULL), minput(NULL), netdim_fixed(false),
       bgclass(-1), mask_class(-1), pnms(NULL), scales_step(0), min_scale(1.0),
       max_scale(1.0), restype(ORIGINAL), silent(false), save_mode(false),
@@ -415,6 +416,14 @@ void detector<T>::set_input_gain(double gain) {
   eblprinto(mout, "Setting input gain to " << gain << std::endl);
 }
 
+template <typename T>
+void detector<T>::set_pyramid(bool enable) {
+  pyramid = enable;
+  resizepp->set_pyramid(enable);
+  eblprinto(mout, (enable ? "Enabling" : "Disabling")
+            << " image pyramid for multi-scale inputs" << std::endl);
+}
+
 // initialization //////////////////////////////////////////////////////////////
 
 template <typename T>
@@ -1671,7 +1680,18 @@ void detector<T>::multi_res_fprop() {
   // timing
   timer t;
   t.start();
+  // a pyramid is built from largest to smallest scale
+  std::vector<uint> order;
   for (uint i = 0; i < scales.size(); ++i) {
+    uint j = order.size();
+    if (pyramid)
+      while (j > 0 && scales[order[j - 1]].nelements() < scales[i].nelements())
+        j--;
+    order.insert(order.begin() + j, i);
+  }
+  if (pyramid) resizepp->new_pyramid();
+  for (uint k = 0; k < order.size(); ++k) {
+    uint i = order[k];
     prepare_scale(i);
     *input = image; // put image in input state
     // keep a copy of preprocess' output if displaying
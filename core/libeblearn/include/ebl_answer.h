@@ -388,6 +388,21 @@ class trainable_module {
   virtual void bprop(labeled_datasource<T,Tds1,Tds2> &ds, state<T> &energy);
   virtual void bbprop(labeled_datasource<T,Tds1,Tds2> &ds, state<T> &energy);
 
+  // propagations of a batch of samples ///////////////////////////////////////
+
+  //! Copies the inputs of current sample of 'ds' into the 'i'-th tensors
+  //! of the batch input states. Samples must be added in order, starting
+  //! from 0 for each new batch.
+  virtual void fprop_batch_sample(labeled_datasource<T,Tds1,Tds2> &ds,
+                                  uint i);
+  //! Forward propagates the first 'n' samples of the batch in a single pass
+  //! through the modules, 'energy' receiving one energy per sample.
+  virtual void fprop_batch(uint n, state<T> &energy);
+  //! Backpropagates the batch of last fprop_batch(), each sample's energy
+  //! being weighted by its derivative in 'energy'. Parameter gradients
+  //! are accumulated over all samples.
+  virtual void bprop_batch(state<T> &energy);
+
   virtual int infer2(labeled_datasource<T,Tds1,Tds2> &ds, state<T> &energy);
   //! Randomize internal modules using randomization parameters 'fp'.
   virtual void forget(forget_param_linear &fp);
@@ -428,6 +443,8 @@ class trainable_module {
  protected:
   //! Update the scale switch if an ms module was found in mod1.
   void update_scale(labeled_datasource<T,Tds1,Tds2> &ds);
+  //! Copies the single tensor of 'in' into the 'i'-th tensor of 'batch'.
+  void batch_copy(state<T> &in, state<T> &batch, uint i);
 
   // members /////////////////////////////////////////////////////////////////
  protected:
@@ -445,6 +462,8 @@ class trainable_module {
   state<T>                    targets;
   std::string                 mod_name;
   state<T>                    tmp_energy;
+  state<T>                    batch_in1; //!< Batch of inputs 1.
+  state<T>                    batch_in2; //!< Batch of inputs 2.
   ms_module<T>               *ms_switch;
 };
 
@@ -711,32 +711,33 @@ void scaler_answer<T,Tds1,Tds2>::fprop1(idx<T> &in, idx<T> &out) {
     out.resize(d);
   // loop on features (dimension 0) to set answers
   uint classid; T conf;
-  idx_eloop2(ii, in, T, oo, out, T) {
-    idx_eloop2(iii, ii, T, ooo, oo, T) {
+  idx_view<T,3> vin(in), vout(out);
+  view_eloop2(ii, vin, oo, vout) {
+    view_eloop2(iii, ii, ooo, oo) {
       // set class answer
-      T i = iii.get(0);
+      T i = iii(0);
       classid = ((i <= threshold) ? negative_id : positive_id);
-      ooo.set((T) classid, 0); // set classid answer
+      ooo(0) = (T) classid; // set classid answer
       if (raw_confidence) {
-        ooo.set(i, 1); // conf is simply the output
-        ooo.set(i, 2);
+        ooo(1) = i; // conf is simply the output
+        ooo(2) = i;
       } else { // confidence is the position in the margin area
         conf = std::min((T)1, std::max((T)0, (T) ((i + 1) / 2)));
         if (classid == negative_id) {
-          ooo.set((T) 1 - conf, 1); // conf
-          ooo.set((T) 0, 2);
+          ooo(1) = (T) 1 - conf; // conf
+          ooo(2) = (T) 0;
           if (spatial) {
-            ooo.set((T) 0, 3);
-            ooo.set((T) 0, 4);
+            ooo(3) = (T) 0;
+            ooo(4) = (T) 0;
           }
           //ooo.set((T) std::min((T) 1, std::max(0, -i - 1)), 1); // conf
           //	  ooo.set(std::max((T)0, -i), 1); // conf
         } else {
-          ooo.set(conf, 1); // conf
-          ooo.set(i, 2); // scale answer
+          ooo(1) = conf; // conf
+          ooo(2) = i; // scale answer
           if (spatial) {
-            ooo.set(iii.get(1), 3); // h answer
-            ooo.set(iii.get(2), 4); // w answer
+            ooo(3) = iii(1); // h answer
+            ooo(4) = iii(2); // w answer
           }
 					//ooo.set((T) std::min((T) 1, std::max((T) 0, i / 2 + 1)), 1); // conf
 					//	  ooo.set(std::max((T) 0, i + 1), 1); // conf
@@ -904,6 +905,21 @@ void trainable_module<T,Tds1,Tds2>::update_scale
   if (ms_switch && ds.has_scales()) ms_switch->set_switch(ds.fprop_scale());
 }
 
+template <typename T, typename Tds1, typename Tds2>
+void trainable_module<T,Tds1,Tds2>::
+batch_copy(state<T> &in, state<T> &batch, uint i) {
+  if (in.x.size() != 1)
+    eblerror("batches expect samples with a single tensor but got "
+             << in.x.size() << " tensors: " << in);
+  idx<T> &x = in.x[0];
+  if (i == 0 && batch.order() != x.order()) batch.reset(x.get_idxdim(), 1);
+  if (i < batch.x.size()) {
+    if (!batch.x[i].same_dim(x)) batch.x[i].resize(x.get_idxdim());
+    idx_copy(x, batch.x[i]);
+  } else
+    batch.add_x_new(x);
+}
+
 // propagations given input states /////////////////////////////////////////////
 
 template <typename T, typename Tds1, typename Tds2>
@@ -1021,6 +1037,46 @@ bbprop(labeled_datasource<T,Tds1,Tds2> &ds, state<T> &energy) {
   TIMING2("entire bbprop");
 }
 
+// propagations of a batch of samples /////////////////////////////////////////
+
+template <typename T, typename Tds1, typename Tds2>
+void trainable_module<T,Tds1,Tds2>::
+fprop_batch_sample(labeled_datasource<T,Tds1,Tds2> &ds, uint i) {
+  if (ms_switch && ds.has_scales())
+    eblerror("cannot switch scales for each sample of a batch");
+  // forward data 1 and 2
+  if (dsmod) dsmod->fprop_ds1(ds, in1); // specific data production
+  else ds.fprop_data(in1);           // generic, simply take ds' input 1
+  if (dsmod) dsmod->fprop_ds2(ds, in2); // specific data production
+  else ds.fprop_label_net(in2);      // generic, simply take ds' input 2
+  // append them to the batch
+  batch_copy(in1, batch_in1, i);
+  batch_copy(in2, batch_in2, i);
+}
+
+template <typename T, typename Tds1, typename Tds2>
+void trainable_module<T,Tds1,Tds2>::fprop_batch(uint n, state<T> &energy) {
+  if (n == 0 || n > batch_in1.x.size())
+    eblerror("cannot fprop a batch of " << n << " samples, only "
+             << batch_in1.x.size() << " were added");
+  if (dynamic_cast<scalerclass_energy<T>*>(&energy_mod))
+    eblerror("scalerclass_energy keeps targets of a single sample and "
+             << "cannot process batches");
+  // forget samples of a previous bigger batch
+  if (batch_in1.x.size() > n) {
+    batch_in1.x.remove(n, batch_in1.x.size() - 1);
+    batch_in2.x.remove(n, batch_in2.x.size() - 1);
+  }
+  fprop(batch_in1, batch_in2, energy);
+}
+
+template <typename T, typename Tds1, typename Tds2>
+void trainable_module<T,Tds1,Tds2>::bprop_batch(state<T> &energy) {
+  batch_in1.resize_dx(); // TODO: backprop into input seems a waste here
+  batch_in1.zero_dx();
+  bprop(batch_in1, batch_in2, energy);
+}
+
 template <typename T, typename Tds1, typename Tds2>
 int trainable_module<T,Tds1,Tds2>::
 infer2(labeled_datasource<T,Tds1,Tds2> &ds, state<T> &energy) {
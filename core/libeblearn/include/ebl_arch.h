@@ -130,6 +130,16 @@ template <typename T> class layers : public module_1_1<T> {
   virtual module_1_1<T>* copy(parameter<T> *p = NULL);
   //! Swap the dual buffers used for memory optimization.
   virtual void swap_buffers();
+  //! Enables or disables half precision hidden states (disabled by
+  //! default). When enabled, each hidden state kept for backpropagation,
+  //! i.e. with backward tensors, is stored in float16 (see
+  //! state::pack_half()) as soon as the next module has used it, and
+  //! converted back to T when backpropagating. Modules still compute in T.
+  //! This trades one allocation and two conversions per hidden state and
+  //! per sample for half the memory during training. Forward-only hidden
+  //! states, e.g. when detecting, are never packed. Packed hidden states
+  //! must not be accessed directly after an fprop.
+  virtual void set_half_states(bool enable);
   //! Return the number of layers contained in this object.
   virtual uint size();
   //! Zero-out internal hidden's states backward tensors.
@@ -174,6 +184,7 @@ template <typename T> class layers : public module_1_1<T> {
   std::vector<state<T>*>			hiddens;
  protected:
   bool own_contents;
+  bool half_states; //!< Store hidden states in float16 between uses.
   state<T>* hi; //! temporary buffer pointer
   state<T>* ho; //! temporary buffer pointer
   state<T>* htmp; //! temporary buffer pointer used for swapping
@@ -35,7 +35,8 @@ namespace ebl {
 // layers //////////////////////////////////////////////////////////////////////
 
 template <typename T> layers<T>::layers(bool oc, const char *name_)
-    : module_1_1<T>(name_), hi(NULL), ho(NULL), htmp(NULL) {
+    : module_1_1<T>(name_), half_states(false), hi(NULL), ho(NULL),
+      htmp(NULL) {
   this->own_contents = oc;
   this->default_name("layers");
 }
@@ -215,11 +216,13 @@ mfidxdim layers<T>::bprop_size(mfidxdim &osize) {
 template <typename T>
 module_1_1<T>* layers<T>::copy(parameter<T> *p) {
   layers<T> *l2 = new layers<T>(true);
+  l2->set_half_states(half_states);
   //! Loop through all the modules and buffers and copy them
   int niter = this->modules.size();
   for (int i = 0; i < niter; i++) {
     l2->add_module(this->modules[i]->copy(p));
-    if (this->hiddens[i] != NULL) {
+    // packed buffers are not copied, they are only reallocated when used
+    if (this->hiddens[i] != NULL && !this->hiddens[i]->packed_half()) {
       l2->hiddens[i] = new state<T>(*(this->hiddens[i]));
       l2->hiddens[i]->deep_copy(*(l2->hiddens[i]));
     }
@@ -234,6 +237,14 @@ void layers<T>::swap_buffers() {
   ho = htmp;
 }
 
+template <typename T>
+void layers<T>::set_half_states(bool enable) {
+  half_states = enable;
+  if (!enable) // restore packed hidden states
+    for (uint i = 0; i < hiddens.size(); ++i)
+      if (hiddens[i]) hiddens[i]->unpack_half();
+}
+
 template <typename T>
 uint layers<T>::size() {
   return modules.size();
@@ -329,8 +340,9 @@ std::string layers<T>::info() {
     if (modules[i]) s << modules[i]->name();
     else s << "null";
     s << " hiddens[" << i << "] ";
-    if (hiddens[i]) s << hiddens[i]->info();
-    else s << "null";
+    if (!hiddens[i]) s << "null";
+    else if (hiddens[i]->packed_half()) s << "float16";
+    else s << hiddens[i]->info();
   }
   return s;
 }
@@ -361,6 +373,11 @@ void layers<T>::set_output_streams(std::ostream &out,
 template <typename T>
 void layers<T>::forward(state<T>& in, state<T>& out, fprop_type fp) {
   if (modules.empty()) eblerror("trying to fprop through empty layers");
+  // hidden states packed by previous fprop are overwritten, reallocate
+  // them without converting their content
+  for (uint i = 0; i < hiddens.size(); ++i)
+    if (hiddens[i] && hiddens[i]->packed_half())
+      hiddens[i]->unpack_half(false);
   // initialize buffers
   hi = &in;
   ho = &out;
@@ -388,6 +405,11 @@ void layers<T>::forward(state<T>& in, state<T>& out, fprop_type fp) {
       default: eblerror("unknown type");
     }
     EDEBUG_MAT(mod->name() << ": out", *ho);
+    // input hidden state is not needed until bprop, unless out is a view.
+    // states without backward tensors are not bprop'ed, keep them as is.
+    if (half_states && i > 0 && hi->dx.size() > 0
+	&& !ho->shares_x_storage(*hi))
+      hi->pack_half();
     hi = ho;
     LOCAL_TIMING_REPORT(mod->name()); // timing debugging
   }
@@ -414,6 +436,7 @@ void layers<T>::backward(state<T>& in, state<T>& out, bprop_type bp) {
     // set input
     if (i == 0) hi = &in;
     else hi = hiddens[i - 1];
+    if (hi->packed_half()) hi->unpack_half();
     // make sure input's backward tensors exist
     hi->resize_dx();
     // run module
@@ -446,6 +469,7 @@ void layers<T>::bbackward(state<T>& in, state<T>& out, bprop_type bp) {
     // set input
     if (i == 0) hi = &in;
     else hi = hiddens[i-1];
+    if (hi->packed_half()) hi->unpack_half();
     // make sure input's backward tensors exist
     hi->resize_ddx();
     // run module
@@ -37,6 +37,7 @@
 #include "libidx.h"
 #include "ebl_arch.h"
 #include "ebl_utils.h"
+#include "ebl_convolution.h"
 #include "bbox.h"
 
 namespace ebl {
@@ -66,6 +67,14 @@ template <typename T> class linear_module: public module_1_1<T> {
   virtual void bprop1(state<T> &in, state<T> &out);
   //! second-derivative backward propagation from out to in
   virtual void bbprop1(state<T> &in, state<T> &out);
+  //! Forward propagation of all tensors of 'in'. When 'in' is a batch, i.e.
+  //! contains several tensors of identical dimensions, all of them are
+  //! combined with a single matrix product, otherwise each tensor is
+  //! propagated with fprop1().
+  virtual void fprop(state<T> &in, state<T> &out);
+  //! Backward propagation of all tensors, with a single matrix product for
+  //! weights and inputs gradients when 'in' is a batch (see fprop()).
+  virtual void bprop(state<T> &in, state<T> &out);
   //! order of operation
   virtual int replicable_order() { return 1; }
   //! forgetting weights by replacing with random values
@@ -90,9 +99,22 @@ template <typename T> class linear_module: public module_1_1<T> {
   //! into files. This can be useful for debugging.
   virtual void fprop1_dump(idx<T> &in, idx<T> &out);
 
+  // internal methods
+ protected:
+  //! Returns the number of positions to which the linear combination
+  //! applies in each tensor of 'in' if 'in' is a batch that can be
+  //! processed at once, 0 otherwise.
+  intg batch_positions(state<T> &in);
+  //! Copies the tensors of 'in' (or their gradients if 'dx') into the
+  //! columns of 'batch', 'n' columns per tensor.
+  void batch_gather(state<T> &in, idx<T> &batch, intg n, bool dx);
+
   // members
  public:
   state<T> w;
+ protected:
+  idx<T>   batch_in;  //!< Batch inputs, one or more columns per sample.
+  idx<T>   batch_out; //!< Batch outputs, one or more columns per sample.
 };
 
 /**
@@ -238,6 +260,26 @@ template <typename T> class convolution_module : public module_1_1<T> {
   //! Calls fprop and then dumps internal buffers, inputs and outputs
   //! into files. This can be useful for debugging.
   virtual void fprop1_dump(idx<T> &in, idx<T> &out);
+  //! Use algorithm 'a' to compute convolutions (see conv_algorithm).
+  virtual void set_algorithm(conv_algorithm a);
+  //! Returns the algorithm used to compute convolutions.
+  virtual conv_algorithm get_algorithm();
+
+ protected:
+  //! Returns the execution plan for convolutions of 'in' into 'out',
+  //! creating it if this size was not seen before.
+  virtual conv_plan<T>* get_plan(idx<T> &in, idx<T> &out);
+  //! Deletes all execution plans.
+  virtual void clear_plans();
+  //! Returns the engine computing convolutions of 'in' into 'out',
+  //! CONV_GEMM, CONV_WINOGRAD or CONV_FFT, or CONV_DEFAULT if none of them
+  //! should be used. Only CONV_GEMM is returned when 'forward' is false.
+  virtual conv_algorithm select_algorithm(idx<T> &in, idx<T> &out,
+					  bool forward);
+  //! Decides for each 2D kernel if it is computed as a box, with separable
+  //! factors or with a full convolution (see sepkinds), and caches the
+  //! factors. This is only recomputed when kernels change.
+  virtual void update_separable();
 
   // members /////////////////////////////////////////////////////////////////
  public:
@@ -258,6 +300,19 @@ template <typename T> class convolution_module : public module_1_1<T> {
   idx<T>    outtmp;            //!< a tmp buffer for IPP conv output
   bool      ipp_err_printed;   //!< Print an error msg only once.
   bool      use_ipp;           //!< IPP is useable or not.
+  // convolution algorithms //////////////////////////////////////////////////
+  conv_algorithm algorithm;    //!< Algorithm used to compute convolutions.
+  conv_gemm<T>   gemm;         //!< Grouped im2col + gemm engine.
+  std::vector<conv_plan<T>*> plans; //!< Plans of recent input sizes.
+  // CONV_SEPARABLE buffers //////////////////////////////////////////////////
+  idx<T>    sepkernel;         //!< Kernels of the cached decisions.
+  //! Fast path of each kernel: 0 for a full 2D convolution, 1 for a box
+  //! kernel and 2 for separable factors.
+  std::vector<int> sepkinds;
+  idx<T>    sepcols, seprows;  //!< Separable factors of each kernel.
+  idx<T>    septmp;            //!< Convolution of a single kernel.
+  idx<T>    sepbuf;            //!< Horizontal pass of separable kernels.
+  idx<double> sepintegral;     //!< Integral image for box kernels.
 };
 
 //! The replicable version of convolution_module.
@@ -750,6 +805,7 @@ template <typename T> class dropout_module : module_1_1<T> {
 
  protected:
   idx<ubyte>		keep;						//!< Binary map of kept inputs.
+  idx<float32>		draws;						//!< Uniform draws deciding 'keep'.
   double				drop_proba; 		//!< Probability of dropping input.
   bool          test_time;
 };
@@ -66,13 +66,25 @@ void linear_module<T>::bprop1(state<T> &in, state<T> &out) {
   DEBUG_CHECK_DX(in); // in debug mode, check backward tensors are allocated
   idx<T> inx = in.flat(), indx = in.dx[0].flat(), outdx = out.dx[0].flat();
   idx<T> twx(w.transpose(0, 1)); // switch dimensions 0 and 1
-  if (outdx.nelements() != w.dx[0].dim(0))
-    eblerror("output should have " << w.dx[0].dim(0) << " elements "
-             << "but has " << outdx.nelements() << " (" << outdx << ")");
+  intg n = outdx.nelements() / w.dx[0].dim(0); // number of positions
+  if (n == 0 || outdx.nelements() != n * w.dx[0].dim(0)
+      || inx.nelements() != n * w.dx[0].dim(1))
+    eblerror("output should have a multiple of " << w.dx[0].dim(0)
+             << " elements but has " << outdx.nelements()
+             << " (" << outdx << ")");
 
   // bprop
-  idx_m1extm1acc(outdx, inx, w.dx[0]); // backprop to weights
-  idx_m2dotm1acc(twx, outdx, indx); // backprop to input
+  if (n == 1) {
+    idx_m1extm1acc(outdx, inx, w.dx[0]); // backprop to weights
+    idx_m2dotm1acc(twx, outdx, indx); // backprop to input
+  } else { // linear combination was applied at each of the n positions
+    idx<T> inm(inx.getstorage(), inx.offset(), w.dim(1), n);
+    idx<T> indxm(indx.getstorage(), indx.offset(), w.dim(1), n);
+    idx<T> outdxm(outdx.getstorage(), outdx.offset(), w.dim(0), n);
+    idx<T> tinm(inm.transpose(0, 1));
+    idx_m2dotm2acc(outdxm, tinm, w.dx[0]); // backprop to weights
+    idx_m2dotm2acc(twx, outdxm, indxm); // backprop to input
+  }
 }
 
 template <typename T>
@@ -80,22 +92,118 @@ void linear_module<T>::bbprop1(state<T> &in, state<T> &out) {
   DEBUG_CHECK_DDX(in); // in debug mode, check backward tensors are allocated
   idx<T> inx = in.flat(), inddx = in.ddx[0].flat(), outddx = out.ddx[0].flat();
   idx<T> twx = w.transpose(0, 1); // switch dimensions 0 and 1
-  if (outddx.nelements() != w.ddx[0].dim(0))
-    eblerror("output should have " << w.ddx[0].dim(0) << " elements "
-             << "but has " << outddx.nelements() << " (" << outddx << ")");
+  intg n = outddx.nelements() / w.ddx[0].dim(0); // number of positions
+  if (n == 0 || outddx.nelements() != n * w.ddx[0].dim(0)
+      || inx.nelements() != n * w.ddx[0].dim(1))
+    eblerror("output should have a multiple of " << w.ddx[0].dim(0)
+             << " elements but has " << outddx.nelements()
+             << " (" << outddx << ")");
 
   // bbprop
-  idx_m1squextm1acc(outddx, inx, w.ddx[0]); // backprop to weights
-  idx_m2squdotm1acc(twx, outddx, inddx); // backprop to input
+  if (n == 1) {
+    idx_m1squextm1acc(outddx, inx, w.ddx[0]); // backprop to weights
+    idx_m2squdotm1acc(twx, outddx, inddx); // backprop to input
+  } else { // linear combination was applied at each of the n positions
+    idx<T> inm(inx.getstorage(), inx.offset(), w.dim(1), n);
+    idx<T> inddxm(inddx.getstorage(), inddx.offset(), w.dim(1), n);
+    idx<T> outddxm(outddx.getstorage(), outddx.offset(), w.dim(0), n);
+    idx<T> insq(w.dim(1), n), twsq(w.dim(1), w.dim(0));
+    idx_mul(inm, inm, insq);
+    idx_mul(twx, twx, twsq);
+    idx<T> tinsq(insq.transpose(0, 1));
+    idx_m2dotm2acc(outddxm, tinsq, w.ddx[0]); // backprop to weights
+    idx_m2dotm2acc(twsq, outddxm, inddxm); // backprop to input
+  }
+}
+
+template <typename T>
+void linear_module<T>::fprop(state<T> &in, state<T> &out) {
+  intg n = batch_positions(in);
+  if (n == 0) { // not a batch, process each tensor separately
+    module_1_1<T>::fprop(in, out);
+    return ;
+  }
+  this->resize_output_orders(in, out);
+  intg nout = w.dim(0);
+  idxdim d(in.x[0]);
+  d.remove_dim(0);
+  d.insert_dim(0, nout);
+  for (uint i = 0; i < in.x.size(); ++i) {
+    this->resize_output(in.x[i], out.x[i], &d); // resize (iff necessary)
+    //!\note Outputs must be contiguous, as in fprop1
+    CHECK_CONTIGUOUS1(out.x[i]);
+  }
+  // linear combination of all samples at once
+  batch_gather(in, batch_in, n, false);
+  if (batch_out.order() != 2) batch_out = idx<T>(nout, batch_in.dim(1));
+  else batch_out.resize(nout, batch_in.dim(1));
+  idx_m2dotm2(w, batch_in, batch_out);
+  // scatter outputs
+  for (uint i = 0; i < in.x.size(); ++i) {
+    idx<T> outx(out.x[i].getstorage(), out.x[i].offset(), nout, n);
+    idx<T> o = batch_out.narrow(1, n, i * n);
+    idx_copy(o, outx);
+  }
+  // remember number of input/outputs
+  this->ninputs = in.x.size();
+  this->noutputs = out.x.size();
+}
+
+template <typename T>
+void linear_module<T>::bprop(state<T> &in, state<T> &out) {
+  intg n = batch_positions(in);
+  if (n == 0 || out.dx.size() != in.x.size()) {
+    module_1_1<T>::bprop(in, out);
+    return ;
+  }
+  DEBUG_CHECK_DX(in); // in debug mode, check backward tensors are allocated
+  //!\note Gradients are viewed as matrices and must be contiguous
+  for (uint i = 0; i < in.dx.size(); ++i)
+    CHECK_CONTIGUOUS2(in.dx[i], out.dx[i]);
+  // backprop to weights, summed over all samples
+  batch_gather(in, batch_in, n, false);
+  batch_gather(out, batch_out, n, true);
+  idx<T> tin(batch_in.transpose(0, 1));
+  idx_m2dotm2acc(batch_out, tin, w.dx[0]);
+  // backprop to inputs
+  idx<T> twx(w.transpose(0, 1));
+  idx_m2dotm2(twx, batch_out, batch_in);
+  for (uint i = 0; i < in.dx.size(); ++i) {
+    idx<T> indx(in.dx[i].getstorage(), in.dx[i].offset(), w.dim(1), n);
+    idx<T> d = batch_in.narrow(1, n, i * n);
+    idx_add(d, indx);
+  }
+}
+
+template <typename T>
+intg linear_module<T>::batch_positions(state<T> &in) {
+  if (in.x.size() < 2 || !in.x[0].contiguousp()) return 0;
+  intg n = in.x[0].nelements() / w.dim(1);
+  if (n == 0 || in.x[0].nelements() != n * w.dim(1)) return 0;
+  for (uint i = 1; i < in.x.size(); ++i)
+    if (!in.x[i].same_dim(in.x[0]) || !in.x[i].contiguousp()) return 0;
+  return n;
+}
+
+template <typename T>
+void linear_module<T>::batch_gather(state<T> &in, idx<T> &batch, intg n,
+                                    bool dx) {
+  svector<idx<T> > &v = dx ? in.dx : in.x;
+  intg nrows = v[0].nelements() / n;
+  if (batch.order() != 2) batch = idx<T>(nrows, n * v.size());
+  else batch.resize(nrows, n * v.size());
+  for (uint i = 0; i < v.size(); ++i) {
+    idx<T> m(v[i].getstorage(), v[i].offset(), nrows, n);
+    idx<T> b = batch.narrow(1, n, i * n);
+    idx_copy(m, b);
+  }
 }
 
 template <typename T>
 void linear_module<T>::forget(forget_param_linear &fp) {
   double fanin_ = w.dim(1);
   double z = fp.value / pow(fanin_, fp.exponent);
-  idx_aloop1(lx, w, T) {
-    *lx = (T) fp.generator.drand(-z, z);
-  }
+  fp.generator.fill_uniform(w, -z, z);
 }
 
 template <typename T>
@@ -342,7 +450,7 @@ convolution_module(parameter<T> *p, idxdim &ker_, idxdim &stride_,
                    idx<intg> &tbl, const char *name_, bool crop_)
     : module_1_1<T>(name_), ker(ker_), stride(stride_), table(tbl),
       warnings_shown(false), float_precision(false), double_precision(false),
-      crop(crop_), use_ipp(false)  {
+      crop(crop_), use_ipp(false), algorithm(CONV_DEFAULT) {
   this->default_name("convolution");
   idxdim d(ker);
   d.insert_dim(0, tbl.dim(0));
@@ -373,6 +481,8 @@ convolution_module(parameter<T> *p, idxdim &ker_, idxdim &stride_,
   // check if its a full-table
   if ( (((tablemax + 1) * thickness) == table.dim(0)) && !not_using_all_inputs)
     fulltable = true;
+  // group table for the backward gemm engine
+  gemm.init(table, kernel.dim(1), kernel.dim(2));
 
 #if __TH__
   // check precision to decide if we use TH or not
@@ -409,6 +519,7 @@ convolution_module(parameter<T> *p, idxdim &ker_, idxdim &stride_,
 
 template <typename T>
 convolution_module<T>::~convolution_module() {
+  clear_plans();
 }
 
 template <typename T>
@@ -425,35 +536,56 @@ void convolution_module<T>::fprop1(idx<T> &in, idx<T> &out) {
     in = in.narrow(1, in.dim(1) - oi % si, 0);
   if (crop && oj % stride.dim(1) != 0)
     in = in.narrow(2, in.dim(2) - oj % sj, 0);
+  // 2D convolutions with separable or box fast paths
+  if (algorithm == CONV_SEPARABLE && si == 1 && sj == 1) {
+    idx_clear(out);
+    update_separable();
+    if (septmp.order() != 2) septmp = idx<T>(out.dim(1), out.dim(2));
+    else septmp.resize(out.dim(1), out.dim(2));
+    uint k = 0;
+    idx_bloop2(lk, kernel, T, lt, table, intg) {
+      idx<T> sin(in.select(0, lt.get(0)));
+      idx<T> sout(out.select(0, lt.get(1)));
+      if (sepkinds[k] == 1)
+        idx_2dconvol_box(sin, ki, kj, lk.get(0, 0), septmp, sepintegral);
+      else if (sepkinds[k] == 2) {
+        idx<T> col = sepcols.select(0, k), row = seprows.select(0, k);
+        idx_2dconvol_separable(sin, col, row, septmp, sepbuf);
+      } else {
+        idx<T> uin(sin.unfold(0, ki, 1));
+        uin = uin.unfold(1, kj, 1);
+        idx_m4dotm2(uin, lk, septmp);
+      }
+      idx_add(septmp, sout);
+      k++;
+    }
+    return ;
+  }
+  // grouped im2col + gemm, Winograd or fft engines of this input size
+  conv_plan<T> *plan = get_plan(in, out);
+  if (plan->algorithm != CONV_DEFAULT && conv_gemm<T>::usable(in, out)) {
+    idx_clear(out);
+    plan->fprop(in, kernel, out);
+    return ;
+  }
 #ifdef __TH__
   // a direct 3D-map optimization
-  if((float_precision || double_precision) && in.order()==3) {
+  if((float_precision || double_precision) && in.order()==3
+     && algorithm == CONV_DEFAULT) {
 #ifdef __OPENMP__
-    svector< idx<T> > lk_list, suin_list, sout_list;
-    svector<idx<T> > outtmp_list;
-    std::vector< idx<intg> > lt_list;
-    idx_bloop2(lk, kernel, T, lt, table, intg) {
-      lk_list.push_back(new idx<T>(lk));
-      lt_list.push_back(lt);
-      suin_list.push_back(new idx<T>(in.select(0, lt.get(0))));
-      sout_list.push_back(new idx<T>((out).select(0, lt.get(1))));
-      // need own outtmp variable for parallelization
-      outtmp_list.push_back(new idx<T>(outtmp.get_idxdim()));
-    }
-    intg i;
-    intg num_outputs = lk_list.size();
+    // views and buffers of each table entry are cached by the plan
+    plan->update_views(in, kernel, out);
+    intg i, nentries = plan->kernels.size(), nout = plan->outputs.size();
 #pragma omp parallel for private(i)
-    for ( i = 0; i < num_outputs; ++i) {
-      // 2D convolution
-      th_convolution(suin_list[i], lk_list[i], outtmp_list[i],
+    for (i = 0; i < nentries; ++i) // 2D convolution of each entry
+      th_convolution(plan->inputs[i], plan->kernels[i], plan->tmps[i],
                      stride.dim(0), stride.dim(1));
-    } // end of for loop
 #pragma omp parallel for private(i)
-    for ( i = 0; i < out.dim(0); ++i) {
-      for(int j=0; j < lt_list.size(); j++) {
-        if(lt_list[j].get(1) == i)
-          th_add(outtmp_list[i],sout_list[i]);
-      }
+    for (i = 0; i < nout; ++i) { // sum entries of each output
+      std::vector<intg> &entries = plan->output_entries[i];
+      idx_clear(plan->outputs[i]);
+      for (uint j = 0; j < entries.size(); ++j)
+        th_add(plan->tmps[entries[j]], plan->outputs[i]);
     }
 #else
     th_convolution_3dmap(in, kernel, out, table, stride.dim(0), stride.dim(1));
@@ -482,7 +614,7 @@ void convolution_module<T>::fprop1(idx<T> &in, idx<T> &out) {
   { idx_bloop2(lk, kernel, T, lt, table, intg) {
       idx<T> sout((out).select(0, lt.get(1)));
 #ifdef __IPP__
-      if (float_precision && use_ipp) {
+      if (float_precision && use_ipp && algorithm == CONV_DEFAULT) {
         rev_idx2_tr(lk, revkernel);
         //		idx_clear(outtmp);
         idx<T> suin(in.select(0, lt.get(0)));
@@ -518,8 +650,14 @@ void convolution_module<T>::bprop1(state<T> &in, state<T> &out) {
     inx = inx.narrow(2, inx.dim(2) - oj % sj, 0);
     indx = indx.narrow(2, inx.dim(2) - oj % sj, 0);
   }
+  // grouped im2col + gemm
+  if (select_algorithm(inx, out.dx[0], false) == CONV_GEMM) {
+    gemm.bprop(inx, kernel, out.dx[0], indx, kernel.dx[0], si, sj);
+    return ;
+  }
 #ifdef __TH__
-  if ((float_precision || double_precision) && in.order() == 3) {
+  if ((float_precision || double_precision) && in.order() == 3
+      && algorithm == CONV_DEFAULT) {
     idx_clear(indx);
     th_convolution_3dmap_bprop(inx, kernel, out.dx[0], indx,
                                kernel.dx[0], table,
@@ -562,7 +700,7 @@ void convolution_module<T>::bprop1(state<T> &in, state<T> &out) {
       idx<T> sborp(borp.select(0, islice));
       idx<T> sout(out.dx[0].select(0, lt.get(1)));
 #ifdef __IPP__
-      if (float_precision && use_ipp)
+      if (float_precision && use_ipp && algorithm == CONV_DEFAULT)
         idx_m2extm2acc(sout, revkernel, suin); // backward convolution
       else
         idx_m2extm2acc(sout, lkf, suin); // backward convolution
@@ -593,6 +731,12 @@ void convolution_module<T>::bbprop1(state<T> &in, state<T> &out) {
     inx = inx.narrow(2, inx.dim(2) - oj % si, 0);
     inddx = inddx.narrow(2, inx.dim(2) - oj % sj, 0);
   }
+  // grouped im2col + gemm, on squared inputs and kernels
+  if (select_algorithm(inx, out.ddx[0], false) == CONV_GEMM) {
+    gemm.bprop(inx, kernel, out.ddx[0], inddx, kernel.ddx[0], si, sj, true);
+    EDEBUG_MAT(this->name() << ": kernel.ddx ", kernel.ddx[0]);
+    return ;
+  }
   // backprop through convolution
   idx<T> uuin(inddx.unfold(1, kernel.ddx[0].dim(1), stride.dim(0)));
   uuin = uuin.unfold(2, kernel.ddx[0].dim(2), stride.dim(1));
@@ -608,7 +752,7 @@ void convolution_module<T>::bbprop1(state<T> &in, state<T> &out) {
       idx<T> sout((out.ddx[0]).select(0, lt.get(1)));
 
 #ifdef __IPP__
-      if (float_precision && use_ipp)
+      if (float_precision && use_ipp && algorithm == CONV_DEFAULT)
         idx_m2squextm2acc(sout, revkernel, suin); // backward convolution
       else
         idx_m2squextm2acc(sout, lkf, suin); // backward convolution
@@ -634,12 +778,7 @@ void convolution_module<T>::forget(forget_param_linear &fp) {
   { idx_bloop2(tab, table, intg, x, kx, T) {
       double s = fp.value / pow((vsize * hsize * fanin_.get(tab.get(1))),
                                 fp.exponent);
-      { idx_bloop1(lx, x, T) {
-          { idx_bloop1(llx, lx, T) {
-              T n = (T) fp.generator.drand(-s, s);
-              llx.set(n);
-            }}
-        }}
+      fp.generator.fill_uniform(x, -s, s);
     }}
 }
 
@@ -745,12 +884,46 @@ fidxdim convolution_module<T>::bprop1_size(const fidxdim &osize) {
   return isize;
 }
 
+template <typename T>
+void convolution_module<T>::update_separable() {
+  // nothing to do if kernels did not change
+  if (sepkernel.same_dim(kernel)) {
+    bool same = true;
+    { idx_aloop2(k, kernel, T, s, sepkernel, T) {
+        if (*k != *s) { same = false; break ; }
+      }}
+    if (same) return ;
+  } else {
+    sepkernel = idx<T>(kernel.get_idxdim());
+    sepcols = idx<T>(kernel.dim(0), kernel.dim(1));
+    seprows = idx<T>(kernel.dim(0), kernel.dim(2));
+  }
+  idx_copy(kernel, sepkernel);
+  intg ki = kernel.dim(1), kj = kernel.dim(2);
+  sepkinds.assign(kernel.dim(0), 0);
+  // 1D passes are only cheaper than the full kernel for larger kernels,
+  // and separated factors of integer kernels are not integers.
+  if (std::numeric_limits<T>::is_integer || ki * kj <= ki + kj) return ;
+  for (intg k = 0; k < kernel.dim(0); ++k) {
+    idx<T> lk = kernel.select(0, k);
+    T v = lk.get(0, 0);
+    bool box = true;
+    { idx_aloop1(e, lk, T) {
+        if (*e != v) { box = false; break ; }
+      }}
+    idx<T> col = sepcols.select(0, k), row = seprows.select(0, k);
+    if (box) sepkinds[k] = 1;
+    else if (idx_separable(lk, col, row)) sepkinds[k] = 2;
+  }
+}
+
 template <typename T>
 module_1_1<T>* convolution_module<T>::copy(parameter<T> *p) {
   convolution_module<T> *l2 =
       new convolution_module<T>(p, ker, stride, table, this->name());
   if (!p) // assign same parameter state if no parameters were specified
     l2->kernel = kernel;
+  l2->set_algorithm(algorithm);
   return (module_1_1<T>*) l2;
 }
 
@@ -785,6 +958,8 @@ std::string convolution_module<T>::describe() {
        << " kernels with size " << ker << ", stride " << stride
        << " and table " << table << " (" << tablemax+1 << "->" << thickness
        << ")";
+  if (algorithm != CONV_DEFAULT)
+    desc << " using " << conv_algorithm_name(algorithm) << " algorithm";
   return desc;
 }
 
@@ -797,6 +972,74 @@ void convolution_module<T>::fprop1_dump(idx<T> &in, idx<T> &out) {
   DUMP(out, this->name() << "_convolution_module_out");
 }
 
+template <typename T>
+void convolution_module<T>::set_algorithm(conv_algorithm a) {
+  algorithm = a;
+  clear_plans(); // engines were selected for the previous algorithm
+}
+
+template <typename T>
+conv_algorithm convolution_module<T>::get_algorithm() {
+  return algorithm;
+}
+
+template <typename T>
+conv_plan<T>* convolution_module<T>::get_plan(idx<T> &in, idx<T> &out) {
+  for (uint i = 0; i < plans.size(); ++i)
+    if (plans[i]->matches(in, out))
+      return plans[i];
+  // forget the oldest plan when too many sizes were seen
+  if (plans.size() >= CONV_MAXPLANS) {
+    delete plans.front();
+    plans.erase(plans.begin());
+  }
+  conv_algorithm a = select_algorithm(in, out, true);
+  EDEBUG(this->name() << ": new " << conv_algorithm_name(a)
+	 << " plan for input " << in);
+  plans.push_back(new conv_plan<T>(table, kernel.dim(1), kernel.dim(2),
+				   stride.dim(0), stride.dim(1),
+				   in.get_idxdim(), out.get_idxdim(), a));
+  return plans.back();
+}
+
+template <typename T>
+void convolution_module<T>::clear_plans() {
+  for (uint i = 0; i < plans.size(); ++i)
+    delete plans[i];
+  plans.clear();
+}
+
+template <typename T>
+conv_algorithm convolution_module<T>::select_algorithm(idx<T> &in,
+						       idx<T> &out,
+						       bool forward) {
+  if (!conv_gemm<T>::usable(in, out)) return CONV_DEFAULT;
+  intg ki = kernel.dim(1), kj = kernel.dim(2);
+  intg si = stride.dim(0), sj = stride.dim(1);
+  conv_algorithm a = algorithm;
+  if (a == CONV_UNFOLD) return CONV_DEFAULT;
+  // separable kernels are handled by fprop1(), gemm computes the rest
+  if (a == CONV_SEPARABLE) return forward ? CONV_DEFAULT : CONV_GEMM;
+  if (a == CONV_DEFAULT) {
+#ifdef __TH__
+    if (float_precision || double_precision)
+      return CONV_DEFAULT; // use TH instead
+#endif
+#ifdef __IPP__
+    if (float_precision && use_ipp) return CONV_DEFAULT; // use IPP instead
+#endif
+    a = conv_choose_algorithm(ki, kj, si, sj, in.dim(0), out.dim(0),
+			      table.dim(0), out.dim(1), out.dim(2));
+  }
+  // Winograd and fft engines only compute forward convolutions
+  if (a == CONV_WINOGRAD
+      && (!forward || !conv_winograd<T>::usable(ki, kj, si, sj)))
+    a = CONV_GEMM;
+  if (a == CONV_FFT && (!forward || !conv_fft<T>::usable(si, sj)))
+    a = CONV_GEMM;
+  return a;
+}
+
 // addc_module /////////////////////////////////////////////////////////////////
 
 template <typename T>
@@ -1478,6 +1721,21 @@ void fsum_module<T>::fprop1(idx<T> &in, idx<T> &out) {
   uint i, ngroup, size = in.dim(0);
   uint nsplit = std::max((uint) 2, (uint) (in.dim(0) * split));
   idx<T> igroup, ogroup;
+  if (split == 1.0 && in.order() == 3) { // sum whole feature planes at once
+    idx<T> o0 = out.select(0, 0), ink, outk;
+    ink = in.select(0, 0);
+    if (ink.idx_ptr() != o0.idx_ptr()) idx_copy(ink, o0);
+    for (i = 1; i < size; ++i) {
+      ink = in.select(0, i);
+      idx_add(ink, o0, o0);
+    }
+    if (div) idx_dotc(o0, (T) (1.0 / size), o0);
+    for (i = 1; i < size; ++i) {
+      outk = out.select(0, i);
+      idx_copy(o0, outk);
+    }
+    return ;
+  }
   idx_eloop2(inx2, in, T, outx2, out, T) {
     idx_eloop2(inx1, inx2, T, outx1, outx2, T) {
       if (split != 1.0) { // sum in groups
@@ -1942,8 +2200,10 @@ void dropout_module<T>::fprop1(idx<T> &in, idx<T> &out) {
     idx_dotc(in, 1 - drop_proba, out);
   } else {
     // decide which inputs to keep
-    idx_aloopf1(k, keep, ubyte, {
-        if (drand() > drop_proba) *k = 1; else *k = 0; });
+    if (!draws.same_dim(in)) draws = idx<float32>(in.get_idxdim());
+    thread_random().fill_uniform(draws);
+    idx_aloopf2(k, keep, ubyte, d, draws, float32, {
+        if (*d > drop_proba) *k = 1; else *k = 0; });
     // copy and multiply by keep flag to output
     idx_mul(in, keep, out);
   }
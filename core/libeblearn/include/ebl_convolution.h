@@ -0,0 +1,362 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef EBL_CONVOLUTION_H_
+#define EBL_CONVOLUTION_H_
+
+#include "ebl_defines.h"
+#include "libidx.h"
+
+#ifdef __OPENMP__
+#include <omp.h>
+#endif
+
+namespace ebl {
+
+// conv_algorithm //////////////////////////////////////////////////////////////
+
+//! Algorithms available to convolution_module to compute its convolutions.
+//! Winograd and FFT algorithms only compute forward stride-1 convolutions,
+//! CONV_GEMM is used instead for other cases and backward passes.
+enum conv_algorithm {
+  //! Torch or IPP code when compiled in, otherwise the algorithm returned
+  //! by conv_choose_algorithm().
+  CONV_DEFAULT = 0,
+  //! Unfolded input multiplied by each kernel of the table.
+  CONV_UNFOLD = 1,
+  //! Grouped im2col followed by matrix products.
+  CONV_GEMM = 2,
+  //! Winograd minimal filtering F(2x2,3x3) or F(4x4,3x3), 3x3 kernels only.
+  CONV_WINOGRAD = 3,
+  //! Products in the frequency domain over overlapping fft tiles.
+  CONV_FFT = 4,
+  //! Each table entry convolved with idx_2dconvol(), which uses 1D passes
+  //! for separable kernels and integral images for box kernels. Meant for
+  //! fixed smoothing kernels, e.g. of normalization modules.
+  CONV_SEPARABLE = 5
+};
+
+//! Returns the name of algorithm 'a', e.g. "gemm".
+EXPORT const char* conv_algorithm_name(conv_algorithm a);
+//! Returns the algorithm with name 's' ("default", "unfold", "gemm",
+//! "winograd", "fft" or "separable").
+//! This throws an exception if 's' is not a known algorithm.
+EXPORT conv_algorithm string_to_conv_algorithm(const std::string &s);
+//! Returns the fastest algorithm for a forward convolution with kernels of
+//! size (ki x kj), strides (si x sj), 'nconn' table connections between
+//! 'nin' input and 'nout' output maps and an output of size (oh x ow).
+//! Winograd and fft transforms are shared by all connections of a map,
+//! they are chosen when there are enough connections per map.
+EXPORT conv_algorithm conv_choose_algorithm(intg ki, intg kj, intg si,
+					    intg sj, intg nin, intg nout,
+					    intg nconn, intg oh, intg ow);
+//! Sets 'bt', 'g' and 'at' to the (m+2 x m+2) input, (m+2 x 3) kernel and
+//! (m x m+2) output transforms of Winograd's F(m x m, 3 x 3), m = 2 or 4.
+EXPORT void conv_winograd_transforms(intg m, const double *&bt,
+				     const double *&g, const double *&at);
+
+// conv_group //////////////////////////////////////////////////////////////////
+
+//! A group of input maps connected to the exact same set of output maps by a
+//! convolution table. The kernels of a group form a dense
+//! (outputs x inputs) block, which allows to compute all its convolutions
+//! with a single matrix product.
+class EXPORT conv_group {
+ public:
+  idx<intg> inputs;             //!< Input maps of this group.
+  idx<intg> outputs;            //!< Output maps, in increasing order.
+  idx<intg> entries;            //!< Table entry of each (output, input) pair.
+  intg      row;                //!< First row of this group in im2col buffer.
+  bool      contiguous_outputs; //!< Outputs are consecutive maps.
+};
+
+//! Splits convolution table 'table' into groups of inputs with identical
+//! outputs, 'kersize' being the number of elements of each kernel.
+//! Repeated (input, output) entries are put in separate groups, so that
+//! their convolutions are summed.
+//! Returns the total number of im2col rows needed by all groups.
+EXPORT intg conv_table_groups(idx<intg> &table, intg kersize,
+			      std::vector<conv_group> &groups);
+
+// conv_gemm ///////////////////////////////////////////////////////////////////
+
+//! Computes convolutions following a connection table with matrix products.
+//! Each group of inputs sharing the same outputs (see conv_group) is lowered
+//! to a (outputs x inputs.kernel) . (inputs.kernel x pixels) product, where
+//! the right-hand side is built by copying input windows (im2col).
+//! Outputs are processed by tiles of rows to bound the memory of the
+//! im2col buffers.
+template <typename T> class conv_gemm {
+ public:
+  //! Creates an empty engine, init() must be called before use.
+  conv_gemm();
+  //! Prepares the engine for table 'table' and kernels of size (ki x kj).
+  void init(idx<intg> &table, intg ki, intg kj);
+  //! Returns true if 'in' and 'out' can be processed by this engine, i.e.
+  //! are of order 3 and 'out' has contiguous rows.
+  static bool usable(idx<T> &in, idx<T> &out);
+  //! Accumulates into 'out' the convolutions of 'in' with each 'kernel'
+  //! following the table, with strides 'si' and 'sj'.
+  void fprop(idx<T> &in, idx<T> &kernel, idx<T> &out, intg si, intg sj);
+  //! Accumulates gradients 'indx' and 'kerneldx' given output gradient
+  //! 'outdx'. If 'square' is true, squared inputs and kernels are used
+  //! instead, i.e. 2nd derivatives are accumulated.
+  void bprop(idx<T> &in, idx<T> &kernel, idx<T> &outdx, idx<T> &indx,
+	     idx<T> &kerneldx, intg si, intg sj, bool square = false);
+
+ protected:
+  //! Returns the number of output rows processed at once for output width
+  //! 'ow' and height 'oh'.
+  intg tile_rows(intg oh, intg ow);
+  //! Allocates buffers for tiles of 'nr' rows of width 'ow'.
+  void resize_buffers(intg nr, intg ow, bool backward);
+  //! Copies 'kernel' (squared if 'square') into the matrices of each group.
+  void load_weights(idx<T> &kernel, bool square);
+  //! Copies the input windows of output rows [r0, r0 + nr) into 'col'.
+  void im2col(idx<T> &in, intg r0, intg nr, intg ow, intg si, intg sj,
+	      bool square);
+  //! Accumulates 'coldx' for output rows [r0, r0 + nr) into 'indx'.
+  void col2im(idx<T> &indx, intg r0, intg nr, intg ow, intg si, intg sj);
+
+  // members ///////////////////////////////////////////////////////////////
+ protected:
+  std::vector<conv_group> groups;  //!< Groups of the table.
+  intg                    ki, kj;  //!< Kernel size.
+  intg                    nrows;   //!< Number of im2col rows.
+  intg                    maxout;  //!< Max number of outputs of a group.
+  idx<T>                  col;     //!< im2col buffer.
+  idx<T>                  coldx;   //!< Gradient of im2col buffer.
+  idx<T>                  tmp;     //!< Non-contiguous outputs buffer.
+  std::vector<idx<T> >    w;       //!< Kernels matrix of each group.
+  std::vector<idx<T> >    wdx;     //!< Kernels gradients of each group.
+};
+
+// conv_winograd ///////////////////////////////////////////////////////////////
+
+//! Computes 3x3 stride-1 convolutions following a connection table with
+//! Winograd's minimal filtering algorithm F(m x m, 3 x 3): the output is
+//! split in m x m tiles, and input tiles and kernels are transformed so that
+//! each tile only needs (m + 2)^2 multiplications per connection instead of
+//! 9 m^2. Products of all connections of a group (see conv_group) are
+//! computed with one matrix product per transformed position.
+//! m is 4 for outputs of at least 8x8, 2 otherwise.
+template <typename T> class conv_winograd {
+ public:
+  //! Creates an empty engine, init() must be called before use.
+  conv_winograd();
+  //! Prepares the engine for table 'table'.
+  void init(idx<intg> &table);
+  //! Returns true if this engine handles kernels of size (ki x kj) and
+  //! strides (si x sj).
+  static bool usable(intg ki, intg kj, intg si, intg sj);
+  //! Accumulates into 'out' the convolutions of 'in' with each 3x3 'kernel'
+  //! following the table.
+  void fprop(idx<T> &in, idx<T> &kernel, idx<T> &out);
+
+ protected:
+  //! Selects the F(m x m, 3 x 3) transforms.
+  void set_tile(intg m);
+  //! Transforms 'kernel' into 'u' if it changed since last call.
+  void transform_kernels(idx<T> &kernel);
+
+  // members ///////////////////////////////////////////////////////////////
+ protected:
+  std::vector<conv_group> groups;  //!< Groups of the table.
+  intg                    nrows;   //!< Number of inputs used by the table.
+  intg                    maxout;  //!< Max number of outputs of a group.
+  intg                    m;       //!< Output tile size.
+  intg                    alpha;   //!< Input tile size, m + 2.
+  const double           *bt;      //!< Input transform (alpha x alpha).
+  const double           *g;       //!< Kernel transform (alpha x 3).
+  const double           *at;      //!< Output transform (m x alpha).
+  idx<T>                  kcache;  //!< Kernels of last transform.
+  std::vector<idx<T> >    u;       //!< Transformed kernels of each group.
+  idx<T>                  v;       //!< Transformed input tiles.
+  idx<T>                  mbuf;    //!< Transformed output tiles.
+  idx<T>                  dbuf;    //!< Tiles before/after transforms.
+  idx<T>                  tbuf;    //!< Temporary buffer of transforms.
+};
+
+// conv_fft ////////////////////////////////////////////////////////////////////
+
+//! Computes stride-1 convolutions following a connection table in the
+//! frequency domain. The input is cut in overlapping (n x n) tiles
+//! (overlap-save) whose spectra are multiplied by the conjugate kernel
+//! spectra and summed for each output, followed by one inverse transform per
+//! output and tile. Kernel spectra are only recomputed when kernels change.
+template <typename T> class conv_fft {
+ public:
+  //! Creates an empty engine, init() must be called before use.
+  conv_fft();
+  //! Prepares the engine for table 'table' and kernels of size (ki x kj).
+  void init(idx<intg> &table, intg ki, intg kj);
+  //! Returns true if this engine handles strides (si x sj).
+  static bool usable(intg si, intg sj);
+  //! Accumulates into 'out' the convolutions of 'in' with each 'kernel'
+  //! following the table.
+  void fprop(idx<T> &in, idx<T> &kernel, idx<T> &out);
+
+ protected:
+  //! Selects (n x n) fft tiles.
+  void set_size(intg n);
+  //! In-place 2D fft of (n x n) split complex (re, im), transposed output.
+  //! If 'inverse' is true, computes the unscaled inverse transform of a
+  //! transposed spectrum.
+  void fft2d(T *re, T *im, bool inverse);
+  //! In-place fft of each column of (n x n) split complex (re, im).
+  void fft_columns(T *re, T *im, bool inverse);
+  //! Computes kernel spectra if 'kernel' changed since last call.
+  void transform_kernels(idx<T> &kernel);
+
+  // members ///////////////////////////////////////////////////////////////
+ protected:
+  std::vector<conv_group> groups;  //!< Groups of the table.
+  intg                    nrows;   //!< Number of inputs used by the table.
+  intg                    ki, kj;  //!< Kernel size.
+  intg                    n;       //!< fft tile size.
+  idx<T>                  tw;      //!< Twiddle factors (2 x n/2).
+  idx<intg>               rev;     //!< Bit reversal permutation.
+  idx<T>                  kcache;  //!< Kernels of last transform.
+  idx<T>                  kspec;   //!< Kernel spectra (entries x 2 x n^2).
+  idx<T>                  xspec;   //!< Input spectra (inputs x 2 x n^2).
+  idx<T>                  yspec;   //!< Output spectra (outputs x 2 x n^2).
+  std::vector<intg>       outputs; //!< Outputs used by the table.
+};
+
+// conv_int8 ///////////////////////////////////////////////////////////////////
+
+//! Computes convolutions following a connection table with int8 products:
+//! the input is quantized once with a single scale, kernels of each output
+//! with their own scale (see idx_quantize_rows_s8), and each group (see
+//! conv_group) is one int8 matrix product of its kernels with a transposed
+//! im2col buffer, accumulated in int32 and rescaled into the outputs
+//! (see idx_gemm_s8).
+template <typename T> class conv_int8 {
+ public:
+  //! Creates an empty engine, init() must be called before use.
+  conv_int8();
+  //! Prepares the engine for table 'table' and kernels of size (ki x kj).
+  void init(idx<intg> &table, intg ki, intg kj);
+  //! Quantizes 'kernel' into the matrices of each group. Kernels are not
+  //! compared to their previous values (which would cost as much as the
+  //! int8 products), this must be called again whenever they change.
+  void set_weights(idx<T> &kernel);
+  //! Accumulates into 'out' the convolutions of 'in' quantized with scale
+  //! 'scale' with the kernels of set_weights() following the table, with
+  //! strides 'si' and 'sj'. 'in' and 'out' must be of order 3 and 'out'
+  //! have contiguous rows (see conv_gemm::usable).
+  void fprop(idx<T> &in, T scale, idx<T> &out, intg si, intg sj);
+
+ protected:
+  //! Copies the quantized input windows of output rows [r0, r0 + nr)
+  //! into the rows of 'col', one row per output pixel.
+  void im2col(intg r0, intg nr, intg ow, intg si, intg sj);
+
+  // members ///////////////////////////////////////////////////////////////
+ protected:
+  std::vector<conv_group> groups;  //!< Groups of the table.
+  intg                    ki, kj;  //!< Kernel size.
+  intg                    nrows;   //!< Number of im2col columns.
+  intg                    maxout;  //!< Max number of outputs of a group.
+  idx<byte>               qin;     //!< Quantized input.
+  idx<byte>               col;     //!< Transposed im2col buffer.
+  idx<T>                  tmp;     //!< Non-contiguous outputs buffer.
+  std::vector<idx<byte> > w;       //!< Quantized kernels of each group.
+  std::vector<idx<float32> > wscale; //!< Kernels scales of each group.
+  idx<float32>            rowscale; //!< Output scales of current product.
+};
+
+// conv_plan ///////////////////////////////////////////////////////////////////
+
+//! Execution plan of convolutions for one input size: the engine selected
+//! for that size with its scratch buffers and transformed kernels, the
+//! partition of output rows among threads, and views of the last inputs and
+//! outputs. Reusing a plan for repeated sizes (e.g. the scales of a
+//! detector) avoids reallocating or recomputing any of them.
+template <typename T> class conv_plan {
+ public:
+  //! Creates a plan for inputs of size 'insize' and outputs of size
+  //! 'outsize' with kernels of size (ki x kj) and strides (si x sj),
+  //! computed by engine 'a' (CONV_GEMM, CONV_WINOGRAD or CONV_FFT), or map
+  //! by map by the caller if 'a' is CONV_DEFAULT.
+  conv_plan(idx<intg> &table, intg ki, intg kj, intg si, intg sj,
+	    const idxdim &insize, const idxdim &outsize, conv_algorithm a);
+  //! Destructor.
+  virtual ~conv_plan();
+  //! Returns true if this plan is for inputs of size 'in' and outputs of
+  //! size 'out'.
+  bool matches(idx<T> &in, idx<T> &out);
+  //! Accumulates into 'out' the convolutions of 'in' with each 'kernel'
+  //! following the table, with each band of output rows computed by a
+  //! separate thread.
+  void fprop(idx<T> &in, idx<T> &kernel, idx<T> &out);
+  //! Updates per-entry and per-output views of 'in', 'kernel' and 'out'
+  //! if they changed since last call, for map by map computations.
+  void update_views(idx<T> &in, idx<T> &kernel, idx<T> &out);
+
+ protected:
+  //! Updates views of input and output bands if 'in' or 'out' changed.
+  void update_bands(idx<T> &in, idx<T> &out);
+
+  // members ///////////////////////////////////////////////////////////////
+ public:
+  idxdim                 insize;    //!< Input size of this plan.
+  idxdim                 outsize;   //!< Output size of this plan.
+  conv_algorithm         algorithm; //!< Engine of this plan.
+  // map by map views, see update_views()
+  std::vector<idx<T> >   kernels;   //!< Kernel of each table entry.
+  std::vector<idx<T> >   inputs;    //!< Input map of each table entry.
+  std::vector<idx<T> >   tmps;      //!< Output buffer of each table entry.
+  std::vector<idx<T> >   outputs;   //!< Output maps.
+  std::vector<std::vector<intg> > output_entries; //!< Entries of outputs.
+ protected:
+  idx<intg>              table;     //!< Connection table.
+  intg                   ki, kj;    //!< Kernel size.
+  intg                   si, sj;    //!< Strides.
+  std::vector<intg>      bands;     //!< First output row of each band.
+  std::vector<idx<T> >   inbands;   //!< Input rows of each band.
+  std::vector<idx<T> >   outbands;  //!< Output rows of each band.
+  std::vector<conv_gemm<T> >     gemms;     //!< gemm engine of each band.
+  std::vector<conv_winograd<T> > winograds; //!< Winograd engines.
+  std::vector<conv_fft<T> >      ffts;      //!< fft engines.
+  idx<T>                 bandin;    //!< Input of band views.
+  idx<T>                 bandout;   //!< Output of band views.
+  idx<T>                 viewin;    //!< Input of map views.
+  idx<T>                 viewkernel;//!< Kernels of map views.
+  idx<T>                 viewout;   //!< Output of map views.
+};
+
+} // namespace ebl
+
+#include "ebl_convolution.hpp"
+
+#endif /* EBL_CONVOLUTION_H_ */
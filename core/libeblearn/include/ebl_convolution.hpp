@@ -0,0 +1,808 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef EBL_CONVOLUTION_HPP_
+#define EBL_CONVOLUTION_HPP_
+
+// number of im2col elements processed at once
+#define CONV_GEMM_TILE (1 << 20)
+// minimum number of output rows computed by each thread of a conv_plan
+#define CONV_PLAN_MINROWS 8
+// maximum number of plans kept by convolution_module
+#define CONV_MAXPLANS 32
+
+namespace ebl {
+
+// Returns a 2D (m.dim(0) x nr * m.dim(2)) view of rows [r0, r0 + nr) of
+// 3D 'm', whose 2 last dimensions must be contiguous.
+template <typename T> idx<T> conv_rows2d(idx<T> &m, intg r0, intg nr) {
+  intg dims[2] = { m.dim(0), nr * m.dim(2) };
+  intg mods[2] = { m.mod(0), 1 };
+  return idx<T>(m.getstorage(), m.offset() + r0 * m.mod(1), 2, dims, mods);
+}
+
+// conv_gemm ///////////////////////////////////////////////////////////////////
+
+template <typename T>
+conv_gemm<T>::conv_gemm() : ki(0), kj(0), nrows(0), maxout(0) {
+}
+
+template <typename T>
+void conv_gemm<T>::init(idx<intg> &table, intg ki_, intg kj_) {
+  ki = ki_;
+  kj = kj_;
+  nrows = conv_table_groups(table, ki * kj, groups);
+  maxout = 0;
+  w.clear();
+  wdx.clear();
+  for (uint g = 0; g < groups.size(); ++g) {
+    intg nout = groups[g].outputs.dim(0);
+    maxout = std::max(maxout, nout);
+    w.push_back(idx<T>(nout, groups[g].inputs.dim(0) * ki * kj));
+    wdx.push_back(idx<T>(nout, groups[g].inputs.dim(0) * ki * kj));
+  }
+}
+
+template <typename T>
+bool conv_gemm<T>::usable(idx<T> &in, idx<T> &out) {
+  return in.order() == 3 && out.order() == 3 && out.mod(2) == 1
+    && (out.mod(1) == out.dim(2) || out.dim(1) == 1);
+}
+
+template <typename T>
+void conv_gemm<T>::fprop(idx<T> &in, idx<T> &kernel, idx<T> &out,
+			 intg si, intg sj) {
+  intg oh = out.dim(1), ow = out.dim(2);
+  intg step = tile_rows(oh, ow);
+  resize_buffers(step, ow, false);
+  load_weights(kernel, false);
+  for (intg r0 = 0; r0 < oh; r0 += step) {
+    intg nr = std::min(step, oh - r0), np = nr * ow;
+    im2col(in, r0, nr, ow, si, sj, false);
+    idx<T> out2 = conv_rows2d(out, r0, nr);
+    for (uint g = 0; g < groups.size(); ++g) {
+      conv_group &gr = groups[g];
+      intg nout = gr.outputs.dim(0);
+      idx<T> c = col.narrow(0, w[g].dim(1), gr.row).narrow(1, np, 0);
+      if (gr.contiguous_outputs) { // accumulate directly into outputs
+	idx<T> o = out2.narrow(0, nout, gr.outputs.get(0));
+	idx_m2dotm2acc(w[g], c, o);
+      } else { // compute in a buffer and add to each output
+	idx<T> t = tmp.narrow(0, nout, 0).narrow(1, np, 0);
+	idx_m2dotm2(w[g], c, t);
+	for (intg o = 0; o < nout; ++o) {
+	  idx<T> to = t.select(0, o), oo = out2.select(0, gr.outputs.get(o));
+	  idx_add(to, oo);
+	}
+      }
+    }
+  }
+}
+
+template <typename T>
+void conv_gemm<T>::bprop(idx<T> &in, idx<T> &kernel, idx<T> &outdx,
+			 idx<T> &indx, idx<T> &kerneldx, intg si, intg sj,
+			 bool square) {
+  intg oh = outdx.dim(1), ow = outdx.dim(2);
+  intg step = tile_rows(oh, ow);
+  resize_buffers(step, ow, true);
+  load_weights(kernel, square);
+  for (uint g = 0; g < groups.size(); ++g)
+    idx_clear(wdx[g]);
+  for (intg r0 = 0; r0 < oh; r0 += step) {
+    intg nr = std::min(step, oh - r0), np = nr * ow;
+    im2col(in, r0, nr, ow, si, sj, square);
+    idx<T> outdx2 = conv_rows2d(outdx, r0, nr);
+    for (uint g = 0; g < groups.size(); ++g) {
+      conv_group &gr = groups[g];
+      intg nout = gr.outputs.dim(0);
+      idx<T> c = col.narrow(0, w[g].dim(1), gr.row).narrow(1, np, 0);
+      idx<T> cdx = coldx.narrow(0, w[g].dim(1), gr.row).narrow(1, np, 0);
+      idx<T> o;
+      if (gr.contiguous_outputs)
+	o = outdx2.narrow(0, nout, gr.outputs.get(0));
+      else { // gather outputs gradients
+	o = tmp.narrow(0, nout, 0).narrow(1, np, 0);
+	for (intg i = 0; i < nout; ++i) {
+	  idx<T> src = outdx2.select(0, gr.outputs.get(i)), dst = o.select(0, i);
+	  idx_copy(src, dst);
+	}
+      }
+      // kernels gradients: wdx += outdx . col'
+      idx<T> ct = c.transpose(0, 1);
+      idx_m2dotm2acc(o, ct, wdx[g]);
+      // inputs gradients: coldx = w' . outdx
+      idx<T> wt = w[g].transpose(0, 1);
+      idx_m2dotm2(wt, o, cdx);
+    }
+    col2im(indx, r0, nr, ow, si, sj);
+  }
+  // accumulate groups gradients into each kernel gradient
+  intg kk = ki * kj;
+  for (uint g = 0; g < groups.size(); ++g) {
+    conv_group &gr = groups[g];
+    for (intg o = 0; o < gr.outputs.dim(0); ++o)
+      for (intg i = 0; i < gr.inputs.dim(0); ++i) {
+	idx<T> src = wdx[g].select(0, o).narrow(0, kk, i * kk);
+	idx<T> dst = kerneldx.select(0, gr.entries.get(o, i));
+	T *s = src.idx_ptr();
+	{ idx_aloop1(d, dst, T) { *d += *s++; }}
+      }
+  }
+}
+
+template <typename T>
+intg conv_gemm<T>::tile_rows(intg oh, intg ow) {
+  intg n = CONV_GEMM_TILE / std::max((intg) 1, nrows * ow);
+  return std::max((intg) 1, std::min(n, oh));
+}
+
+template <typename T>
+void conv_gemm<T>::resize_buffers(intg nr, intg ow, bool backward) {
+  intg np = nr * ow;
+  if (col.order() != 2 || col.dim(0) != nrows || col.dim(1) < np)
+    col = idx<T>(nrows, np);
+  if (backward && (coldx.order() != 2 || coldx.dim(0) != nrows
+		   || coldx.dim(1) < np))
+    coldx = idx<T>(nrows, np);
+  if (tmp.order() != 2 || tmp.dim(0) != maxout || tmp.dim(1) < np)
+    tmp = idx<T>(maxout, np);
+}
+
+template <typename T>
+void conv_gemm<T>::load_weights(idx<T> &kernel, bool square) {
+  intg kk = ki * kj;
+  for (uint g = 0; g < groups.size(); ++g) {
+    conv_group &gr = groups[g];
+    for (intg o = 0; o < gr.outputs.dim(0); ++o)
+      for (intg i = 0; i < gr.inputs.dim(0); ++i) {
+	idx<T> src = kernel.select(0, gr.entries.get(o, i));
+	T *d = w[g].select(0, o).narrow(0, kk, i * kk).idx_ptr();
+	{ idx_aloop1(s, src, T) { *d++ = square ? *s * *s : *s; }}
+      }
+  }
+}
+
+template <typename T>
+void conv_gemm<T>::im2col(idx<T> &in, intg r0, intg nr, intg ow,
+			  intg si, intg sj, bool square) {
+  intg im0 = in.mod(0), im1 = in.mod(1), im2 = in.mod(2) * sj;
+  intg cm0 = col.mod(0);
+  for (uint g = 0; g < groups.size(); ++g) {
+    conv_group &gr = groups[g];
+    for (intg i = 0; i < gr.inputs.dim(0); ++i) {
+      T *pin = in.idx_ptr() + gr.inputs.get(i) * im0;
+      T *pc = col.idx_ptr() + (gr.row + i * ki * kj) * cm0;
+      for (intg a = 0; a < ki; ++a)
+	for (intg b = 0; b < kj; ++b, pc += cm0) {
+	  T *dst = pc;
+	  for (intg y = 0; y < nr; ++y, dst += ow) {
+	    T *src = pin + ((r0 + y) * si + a) * im1 + b * in.mod(2);
+	    if (im2 == 1 && !square)
+	      memcpy(dst, src, ow * sizeof (T));
+	    else if (!square)
+	      for (intg x = 0; x < ow; ++x) dst[x] = src[x * im2];
+	    else
+	      for (intg x = 0; x < ow; ++x) dst[x] = src[x * im2] * src[x * im2];
+	  }
+	}
+    }
+  }
+}
+
+template <typename T>
+void conv_gemm<T>::col2im(idx<T> &indx, intg r0, intg nr, intg ow,
+			  intg si, intg sj) {
+  intg im0 = indx.mod(0), im1 = indx.mod(1), im2 = indx.mod(2) * sj;
+  intg cm0 = coldx.mod(0);
+  for (uint g = 0; g < groups.size(); ++g) {
+    conv_group &gr = groups[g];
+    for (intg i = 0; i < gr.inputs.dim(0); ++i) {
+      T *pin = indx.idx_ptr() + gr.inputs.get(i) * im0;
+      T *pc = coldx.idx_ptr() + (gr.row + i * ki * kj) * cm0;
+      for (intg a = 0; a < ki; ++a)
+	for (intg b = 0; b < kj; ++b, pc += cm0) {
+	  T *src = pc;
+	  for (intg y = 0; y < nr; ++y, src += ow) {
+	    T *dst = pin + ((r0 + y) * si + a) * im1 + b * indx.mod(2);
+	    for (intg x = 0; x < ow; ++x) dst[x * im2] += src[x];
+	  }
+	}
+    }
+  }
+}
+
+// Returns true if 'kernel' differs from 'cache', in which case 'cache' is
+// updated to 'kernel'.
+template <typename T> bool conv_kernel_changed(idx<T> &kernel, idx<T> &cache) {
+  if (cache.get_idxdim() != kernel.get_idxdim()) {
+    cache = idx<T>(kernel.get_idxdim());
+    idx_copy(kernel, cache);
+    return true;
+  }
+  bool changed = false;
+  T *c = cache.idx_ptr();
+  { idx_aloop1(k, kernel, T) {
+      if (*k != *c) { *c = *k; changed = true; }
+      ++c;
+    }}
+  return changed;
+}
+
+// number of lanes transformed at once by conv_winograd_transform
+#define CONV_WINOGRAD_LANES 64
+
+// Computes for each of 'n' lanes (r x r) 'out' = l . d . l' where 'l' is
+// (r x c) and 'd' is (c x c). Element (i, j) of lane t is d[(i * c + j) * ld
+// + t] in 'd' and out[(i * r + j) * lo + t] in 'out'. 'tmp' is a buffer of
+// r * c * CONV_WINOGRAD_LANES elements. Zero coefficients of 'l' are
+// skipped, and the inner loops run over blocks of lanes.
+template <typename T>
+void conv_winograd_transform(const double *l, intg r, intg c, const T *d,
+			     intg ld, T *out, intg lo, T *tmp, intg n) {
+  for (intg x0 = 0; x0 < n; x0 += CONV_WINOGRAD_LANES) {
+    intg nx = std::min((intg) CONV_WINOGRAD_LANES, n - x0);
+    for (intg i = 0; i < r; ++i) // tmp = l . d
+      for (intg j = 0; j < c; ++j) {
+	T *t = tmp + (i * c + j) * CONV_WINOGRAD_LANES;
+	for (intg x = 0; x < nx; ++x) t[x] = 0;
+	for (intg k = 0; k < c; ++k) {
+	  T a = (T) l[i * c + k];
+	  if (a == 0) continue ;
+	  const T *dk = d + (k * c + j) * ld + x0;
+	  for (intg x = 0; x < nx; ++x) t[x] += a * dk[x];
+	}
+      }
+    for (intg i = 0; i < r; ++i) // out = tmp . l'
+      for (intg j = 0; j < r; ++j) {
+	T *o = out + (i * r + j) * lo + x0;
+	for (intg x = 0; x < nx; ++x) o[x] = 0;
+	for (intg k = 0; k < c; ++k) {
+	  T a = (T) l[j * c + k];
+	  if (a == 0) continue ;
+	  const T *tk = tmp + (i * c + k) * CONV_WINOGRAD_LANES;
+	  for (intg x = 0; x < nx; ++x) o[x] += a * tk[x];
+	}
+      }
+  }
+}
+
+// conv_winograd ///////////////////////////////////////////////////////////////
+
+template <typename T>
+conv_winograd<T>::conv_winograd()
+  : nrows(0), maxout(0), m(0), alpha(0), bt(NULL), g(NULL), at(NULL) {
+}
+
+template <typename T>
+void conv_winograd<T>::init(idx<intg> &table) {
+  nrows = conv_table_groups(table, 1, groups);
+  maxout = 0;
+  for (uint i = 0; i < groups.size(); ++i)
+    maxout = std::max(maxout, groups[i].outputs.dim(0));
+  m = 0;
+  kcache = idx<T>();
+}
+
+template <typename T>
+bool conv_winograd<T>::usable(intg ki, intg kj, intg si, intg sj) {
+  return ki == 3 && kj == 3 && si == 1 && sj == 1;
+}
+
+template <typename T>
+void conv_winograd<T>::fprop(idx<T> &in, idx<T> &kernel, idx<T> &out) {
+  intg oh = out.dim(1), ow = out.dim(2), ih = in.dim(1), iw = in.dim(2);
+  set_tile(oh >= 8 && ow >= 8 ? 4 : 2);
+  transform_kernels(kernel);
+  intg aa = alpha * alpha, th = (oh + m - 1) / m, tw = (ow + m - 1) / m;
+  intg im0 = in.mod(0), im1 = in.mod(1), im2 = in.mod(2);
+  intg om0 = out.mod(0), om1 = out.mod(1), om2 = out.mod(2);
+  // number of tile rows transformed at once
+  intg step = CONV_GEMM_TILE / std::max((intg) 1, aa * nrows * tw);
+  step = std::max((intg) 1, std::min(step, th));
+  intg nt = step * tw;
+  if (v.order() != 3 || v.dim(1) != nrows || v.dim(2) != nt)
+    v = idx<T>(aa, nrows, nt);
+  if (mbuf.order() != 3 || mbuf.dim(1) != maxout || mbuf.dim(2) != nt)
+    mbuf = idx<T>(aa, maxout, nt);
+  if (dbuf.order() != 2 || dbuf.dim(0) != aa || dbuf.dim(1) != nt) {
+    dbuf = idx<T>(aa, nt);
+    tbuf = idx<T>(aa, CONV_WINOGRAD_LANES);
+  }
+  intg vm0 = v.mod(0), mm0 = mbuf.mod(0);
+  T *d = dbuf.idx_ptr(), *tmp = tbuf.idx_ptr();
+  for (intg ty0 = 0; ty0 < th; ty0 += step) {
+    intg ntiles = std::min(step, th - ty0) * tw;
+    // transform input tiles
+    for (uint g = 0; g < groups.size(); ++g) {
+      conv_group &gr = groups[g];
+      for (intg i = 0; i < gr.inputs.dim(0); ++i) {
+	T *pin = in.idx_ptr() + gr.inputs.get(i) * im0;
+	for (intg p = 0; p < aa; ++p) { // gather zero-padded tiles
+	  intg a = p / alpha, b = p % alpha;
+	  T *dp = d + p * ntiles;
+	  for (intg t = 0, y = ty0 * m + a; t < ntiles; y += m)
+	    for (intg tx = 0, x = b; tx < tw; ++tx, ++t, x += m)
+	      dp[t] = (y < ih && x < iw) ? pin[y * im1 + x * im2] : 0;
+	}
+	T *pv = v.idx_ptr() + (gr.row + i) * nt;
+	conv_winograd_transform(bt, alpha, alpha, d, ntiles, pv, vm0, tmp,
+				ntiles);
+      }
+    }
+    for (uint g = 0; g < groups.size(); ++g) {
+      conv_group &gr = groups[g];
+      intg nout = gr.outputs.dim(0), nin = gr.inputs.dim(0);
+      // one product per transformed position
+      for (intg p = 0; p < aa; ++p) {
+	idx<T> up = u[g].select(0, p);
+	idx<T> vp = v.select(0, p).narrow(0, nin, gr.row).narrow(1, ntiles, 0);
+	idx<T> mp = mbuf.select(0, p).narrow(0, nout, 0).narrow(1, ntiles, 0);
+	idx_m2dotm2(up, vp, mp);
+      }
+      // inverse transform output tiles
+      for (intg o = 0; o < nout; ++o) {
+	T *pout = out.idx_ptr() + gr.outputs.get(o) * om0;
+	T *pm = mbuf.idx_ptr() + o * nt;
+	conv_winograd_transform(at, m, alpha, pm, mm0, d, ntiles, tmp, ntiles);
+	for (intg p = 0; p < m * m; ++p) { // scatter into output
+	  intg a = p / m, b = p % m;
+	  T *dp = d + p * ntiles;
+	  for (intg t = 0, y = ty0 * m + a; t < ntiles; y += m)
+	    for (intg tx = 0, x = b; tx < tw; ++tx, ++t, x += m)
+	      if (y < oh && x < ow) pout[y * om1 + x * om2] += dp[t];
+	}
+      }
+    }
+  }
+}
+
+template <typename T>
+void conv_winograd<T>::set_tile(intg m_) {
+  if (m == m_) return ;
+  m = m_;
+  alpha = m + 2;
+  conv_winograd_transforms(m, bt, g, at);
+  kcache = idx<T>(); // force kernels transform
+}
+
+template <typename T>
+void conv_winograd<T>::transform_kernels(idx<T> &kernel) {
+  if (!conv_kernel_changed(kernel, kcache)) return ;
+  intg aa = alpha * alpha;
+  T k[3 * 3], r[6 * 6], tmp[6 * 3 * CONV_WINOGRAD_LANES];
+  u.clear();
+  for (uint i = 0; i < groups.size(); ++i) {
+    conv_group &gr = groups[i];
+    intg nout = gr.outputs.dim(0), nin = gr.inputs.dim(0);
+    idx<T> ug(aa, nout, nin);
+    for (intg o = 0; o < nout; ++o)
+      for (intg j = 0; j < nin; ++j) {
+	idx<T> ker = kcache.select(0, gr.entries.get(o, j));
+	T *pk = k;
+	{ idx_aloop1(e, ker, T) { *pk++ = *e; }}
+	conv_winograd_transform(g, alpha, 3, k, 1, r, 1, tmp, 1);
+	for (intg p = 0; p < aa; ++p) ug.set(r[p], p, o, j);
+      }
+    u.push_back(ug);
+  }
+}
+
+// conv_fft ////////////////////////////////////////////////////////////////////
+
+template <typename T>
+conv_fft<T>::conv_fft() : nrows(0), ki(0), kj(0), n(0) {
+}
+
+template <typename T>
+void conv_fft<T>::init(idx<intg> &table, intg ki_, intg kj_) {
+  ki = ki_;
+  kj = kj_;
+  nrows = conv_table_groups(table, 1, groups);
+  outputs.clear();
+  if (table.dim(0) > 0) {
+    idx<intg> tout = table.select(1, 1);
+    std::vector<bool> used(idx_max(tout) + 1, false);
+    for (uint g = 0; g < groups.size(); ++g)
+      for (intg o = 0; o < groups[g].outputs.dim(0); ++o)
+	used[groups[g].outputs.get(o)] = true;
+    for (uint o = 0; o < used.size(); ++o)
+      if (used[o]) outputs.push_back(o);
+  }
+  n = 0;
+  kcache = idx<T>();
+}
+
+template <typename T>
+bool conv_fft<T>::usable(intg si, intg sj) {
+  return si == 1 && sj == 1;
+}
+
+template <typename T>
+void conv_fft<T>::fprop(idx<T> &in, idx<T> &kernel, idx<T> &out) {
+  intg oh = out.dim(1), ow = out.dim(2), ih = in.dim(1), iw = in.dim(2);
+  // tiles of at least 64x64 and twice the kernel size, or the smallest
+  // power of 2 covering the input when it is smaller
+  intg size = 64, cover = 1;
+  while (size < 2 * std::max(ki, kj)) size <<= 1;
+  while (cover < std::max(ih, iw)) cover <<= 1;
+  set_size(std::min(size, cover));
+  transform_kernels(kernel);
+  intg nn = n * n, vi = n - ki + 1, vj = n - kj + 1;
+  if (xspec.order() != 3 || xspec.dim(0) != nrows || xspec.dim(2) != nn)
+    xspec = idx<T>(nrows, 2, nn);
+  if (yspec.order() != 3 || yspec.dim(0) < out.dim(0) || yspec.dim(2) != nn)
+    yspec = idx<T>(out.dim(0), 2, nn);
+  intg im0 = in.mod(0), im1 = in.mod(1), im2 = in.mod(2);
+  intg om0 = out.mod(0), om1 = out.mod(1), om2 = out.mod(2);
+  T scale = (T) 1 / (T) nn;
+  for (intg y0 = 0; y0 < oh; y0 += vi)
+    for (intg x0 = 0; x0 < ow; x0 += vj) {
+      // input tiles spectra
+      for (uint g = 0; g < groups.size(); ++g) {
+	conv_group &gr = groups[g];
+	for (intg i = 0; i < gr.inputs.dim(0); ++i) {
+	  T *pin = in.idx_ptr() + gr.inputs.get(i) * im0;
+	  T *xr = xspec.idx_ptr() + (gr.row + i) * 2 * nn, *xi = xr + nn;
+	  for (intg a = 0; a < n; ++a)
+	    for (intg b = 0; b < n; ++b) {
+	      intg y = y0 + a, x = x0 + b;
+	      xr[a * n + b] = (y < ih && x < iw) ? pin[y * im1 + x * im2] : 0;
+	    }
+	  memset(xi, 0, nn * sizeof (T));
+	  fft2d(xr, xi, false);
+	}
+      }
+      // sum of products with conjugate kernel spectra
+      for (uint o = 0; o < outputs.size(); ++o) {
+	T *yr = yspec.idx_ptr() + outputs[o] * 2 * nn;
+	memset(yr, 0, 2 * nn * sizeof (T));
+      }
+      for (uint g = 0; g < groups.size(); ++g) {
+	conv_group &gr = groups[g];
+	for (intg o = 0; o < gr.outputs.dim(0); ++o) {
+	  T *yr = yspec.idx_ptr() + gr.outputs.get(o) * 2 * nn, *yi = yr + nn;
+	  for (intg i = 0; i < gr.inputs.dim(0); ++i) {
+	    const T *xr = xspec.idx_ptr() + (gr.row + i) * 2 * nn, *xi = xr + nn;
+	    const T *kr = kspec.idx_ptr() + gr.entries.get(o, i) * 2 * nn;
+	    const T *kim = kr + nn;
+	    for (intg f = 0; f < nn; ++f) {
+	      yr[f] += xr[f] * kr[f] + xi[f] * kim[f];
+	      yi[f] += xi[f] * kr[f] - xr[f] * kim[f];
+	    }
+	  }
+	}
+      }
+      // inverse transforms, keeping the non-circular part of each tile
+      intg ny = std::min(vi, oh - y0), nx = std::min(vj, ow - x0);
+      for (uint o = 0; o < outputs.size(); ++o) {
+	T *yr = yspec.idx_ptr() + outputs[o] * 2 * nn, *yi = yr + nn;
+	fft2d(yr, yi, true);
+	T *pout = out.idx_ptr() + outputs[o] * om0 + y0 * om1 + x0 * om2;
+	for (intg a = 0; a < ny; ++a)
+	  for (intg b = 0; b < nx; ++b)
+	    pout[a * om1 + b * om2] += yr[a * n + b] * scale;
+      }
+    }
+}
+
+template <typename T>
+void conv_fft<T>::set_size(intg n_) {
+  if (n == n_) return ;
+  n = n_;
+  tw = idx<T>(2, n / 2);
+  for (intg j = 0; j < n / 2; ++j) {
+    double a = 8 * atan(1.0) * j / (double) n; // 2 pi j / n
+    tw.set((T) cos(a), 0, j);
+    tw.set((T) -sin(a), 1, j);
+  }
+  rev = idx<intg>(n);
+  intg nbits = 0;
+  while (((intg) 1 << nbits) < n) nbits++;
+  for (intg i = 0; i < n; ++i) {
+    intg r = 0;
+    for (intg b = 0; b < nbits; ++b)
+      if (i & ((intg) 1 << b)) r |= (intg) 1 << (nbits - 1 - b);
+    rev.set(r, i);
+  }
+  kcache = idx<T>(); // force kernels transform
+}
+
+template <typename T>
+void conv_fft<T>::fft2d(T *re, T *im, bool inverse) {
+  fft_columns(re, im, inverse);
+  for (intg i = 0; i < n; ++i) // transpose
+    for (intg j = i + 1; j < n; ++j) {
+      std::swap(re[i * n + j], re[j * n + i]);
+      std::swap(im[i * n + j], im[j * n + i]);
+    }
+  fft_columns(re, im, inverse);
+}
+
+template <typename T>
+void conv_fft<T>::fft_columns(T *re, T *im, bool inverse) {
+  // bit reversal permutation of rows
+  for (intg i = 0; i < n; ++i) {
+    intg j = rev.get(i);
+    if (j > i) {
+      std::swap_ranges(re + i * n, re + (i + 1) * n, re + j * n);
+      std::swap_ranges(im + i * n, im + (i + 1) * n, im + j * n);
+    }
+  }
+  // butterflies between whole rows
+  const T *twr = tw.idx_ptr(), *twi = twr + tw.mod(0);
+  for (intg len = 2; len <= n; len <<= 1) {
+    intg half = len >> 1, step = n / len;
+    for (intg i = 0; i < n; i += len)
+      for (intg j = 0; j < half; ++j) {
+	T wr = twr[j * step], wi = inverse ? -twi[j * step] : twi[j * step];
+	T *ar = re + (i + j) * n, *ai = im + (i + j) * n;
+	T *br = ar + half * n, *bi = ai + half * n;
+	for (intg k = 0; k < n; ++k) {
+	  T tr = wr * br[k] - wi * bi[k], ti = wr * bi[k] + wi * br[k];
+	  br[k] = ar[k] - tr;
+	  bi[k] = ai[k] - ti;
+	  ar[k] += tr;
+	  ai[k] += ti;
+	}
+      }
+  }
+}
+
+template <typename T>
+void conv_fft<T>::transform_kernels(idx<T> &kernel) {
+  if (!conv_kernel_changed(kernel, kcache)) return ;
+  intg nn = n * n, nk = kcache.dim(0);
+  if (kspec.order() != 3 || kspec.dim(0) != nk || kspec.dim(2) != nn)
+    kspec = idx<T>(nk, 2, nn);
+  idx_clear(kspec);
+  for (intg e = 0; e < nk; ++e) {
+    T *kr = kspec.idx_ptr() + e * 2 * nn;
+    for (intg a = 0; a < ki; ++a)
+      for (intg b = 0; b < kj; ++b)
+	kr[a * n + b] = kcache.get(e, a, b);
+    fft2d(kr, kr + nn, false);
+  }
+}
+
+// Returns true if 'a' and 'b' view the same elements.
+template <typename T> bool conv_same_view(idx<T> &a, idx<T> &b) {
+  if (a.getstorage() != b.getstorage() || a.offset() != b.offset()
+      || a.order() != b.order())
+    return false;
+  for (int i = 0; i < a.order(); ++i)
+    if (a.dim(i) != b.dim(i) || a.mod(i) != b.mod(i))
+      return false;
+  return true;
+}
+
+// conv_int8 ///////////////////////////////////////////////////////////////////
+
+template <typename T>
+conv_int8<T>::conv_int8() : ki(0), kj(0), nrows(0), maxout(0) {
+}
+
+template <typename T>
+void conv_int8<T>::init(idx<intg> &table, intg ki_, intg kj_) {
+  ki = ki_;
+  kj = kj_;
+  nrows = conv_table_groups(table, ki * kj, groups);
+  maxout = 0;
+  for (uint g = 0; g < groups.size(); ++g)
+    maxout = std::max(maxout, groups[g].outputs.dim(0));
+  w.resize(groups.size());
+  wscale.resize(groups.size());
+  rowscale = idx<float32>(std::max((intg) 1, maxout));
+}
+
+template <typename T>
+void conv_int8<T>::fprop(idx<T> &in, T scale, idx<T> &out, intg si, intg sj) {
+  intg oh = out.dim(1), ow = out.dim(2);
+  // quantize the entire input once
+  if (qin.get_idxdim() != in.get_idxdim())
+    qin = idx<byte>(in.get_idxdim());
+  idx_quantize_s8(in, qin, scale);
+  intg step = CONV_GEMM_TILE / std::max((intg) 1, nrows * ow);
+  step = std::max((intg) 1, std::min(step, oh));
+  if (col.order() != 2 || col.dim(1) != nrows || col.dim(0) < step * ow)
+    col = idx<byte>(step * ow, nrows);
+  if (tmp.order() != 2 || tmp.dim(0) != maxout || tmp.dim(1) < step * ow)
+    tmp = idx<T>(maxout, step * ow);
+  for (intg r0 = 0; r0 < oh; r0 += step) {
+    intg nr = std::min(step, oh - r0), np = nr * ow;
+    im2col(r0, nr, ow, si, sj);
+    idx<T> out2 = conv_rows2d(out, r0, nr);
+    for (uint g = 0; g < groups.size(); ++g) {
+      conv_group &gr = groups[g];
+      intg nout = gr.outputs.dim(0);
+      idx<byte> c = col.narrow(0, np, 0).narrow(1, w[g].dim(1), gr.row);
+      // outputs scales: kernels scales times input scale
+      idx<float32> rs = rowscale.narrow(0, nout, 0);
+      { idx_aloop2(r, rs, float32, s, wscale[g], float32) {
+	  *r = *s * (float32) scale; }}
+      if (gr.contiguous_outputs) { // accumulate directly into outputs
+	idx<T> o = out2.narrow(0, nout, gr.outputs.get(0));
+	idx_gemm_s8(w[g], c, o, rs);
+      } else { // compute in a buffer and add to each output
+	idx<T> t = tmp.narrow(0, nout, 0).narrow(1, np, 0);
+	idx_clear(t);
+	idx_gemm_s8(w[g], c, t, rs);
+	for (intg o = 0; o < nout; ++o) {
+	  idx<T> to = t.select(0, o), oo = out2.select(0, gr.outputs.get(o));
+	  idx_add(to, oo);
+	}
+      }
+    }
+  }
+}
+
+template <typename T>
+void conv_int8<T>::set_weights(idx<T> &kernel) {
+  intg kk = ki * kj;
+  for (uint g = 0; g < groups.size(); ++g) {
+    conv_group &gr = groups[g];
+    idx<T> wg(gr.outputs.dim(0), gr.inputs.dim(0) * kk);
+    for (intg o = 0; o < gr.outputs.dim(0); ++o)
+      for (intg i = 0; i < gr.inputs.dim(0); ++i) {
+	idx<T> src = kernel.select(0, gr.entries.get(o, i));
+	T *d = wg.select(0, o).narrow(0, kk, i * kk).idx_ptr();
+	{ idx_aloop1(s, src, T) { *d++ = *s; }}
+      }
+    idx_quantize_rows_s8(wg, w[g], wscale[g]);
+  }
+}
+
+template <typename T>
+void conv_int8<T>::im2col(intg r0, intg nr, intg ow, intg si, intg sj) {
+  intg qm0 = qin.mod(0), qm1 = qin.mod(1), cm0 = col.mod(0);
+  byte *pc = col.idx_ptr();
+  for (intg y = 0; y < nr; ++y) {
+    intg iy = (r0 + y) * si;
+    for (intg x = 0; x < ow; ++x, pc += cm0)
+      for (uint g = 0; g < groups.size(); ++g) {
+	conv_group &gr = groups[g];
+	byte *dst = pc + gr.row;
+	for (intg i = 0; i < gr.inputs.dim(0); ++i) {
+	  const byte *src = qin.idx_ptr() + gr.inputs.get(i) * qm0
+	    + iy * qm1 + x * sj;
+	  for (intg a = 0; a < ki; ++a, dst += kj, src += qm1)
+	    for (intg b = 0; b < kj; ++b) dst[b] = src[b]; // short rows
+	}
+      }
+  }
+}
+
+// conv_plan ///////////////////////////////////////////////////////////////////
+
+template <typename T>
+conv_plan<T>::conv_plan(idx<intg> &table_, intg ki_, intg kj_, intg si_,
+			intg sj_, const idxdim &insize_,
+			const idxdim &outsize_, conv_algorithm a)
+  : insize(insize_), outsize(outsize_), algorithm(a), table(table_),
+    ki(ki_), kj(kj_), si(si_), sj(sj_) {
+  // partition output rows among threads
+  intg oh = outsize.dim(1), nbands = 1;
+#ifdef __OPENMP__
+  nbands = std::min((intg) omp_get_max_threads(), oh / CONV_PLAN_MINROWS);
+  nbands = std::max((intg) 1, nbands);
+#endif
+  if (algorithm == CONV_DEFAULT) nbands = 0; // computed map by map
+  for (intg b = 0; b <= nbands; ++b)
+    bands.push_back(oh * b / std::max((intg) 1, nbands));
+  // one engine per band
+  for (intg b = 0; b < nbands; ++b)
+    switch (algorithm) {
+    case CONV_WINOGRAD:
+      winograds.push_back(conv_winograd<T>());
+      winograds.back().init(table);
+      break ;
+    case CONV_FFT:
+      ffts.push_back(conv_fft<T>());
+      ffts.back().init(table, ki, kj);
+      break ;
+    default:
+      gemms.push_back(conv_gemm<T>());
+      gemms.back().init(table, ki, kj);
+    }
+}
+
+template <typename T>
+conv_plan<T>::~conv_plan() {
+}
+
+template <typename T>
+bool conv_plan<T>::matches(idx<T> &in, idx<T> &out) {
+  return in.get_idxdim() == insize && out.get_idxdim() == outsize;
+}
+
+template <typename T>
+void conv_plan<T>::fprop(idx<T> &in, idx<T> &kernel, idx<T> &out) {
+  update_bands(in, out);
+  intg b, nbands = inbands.size();
+#ifdef __OPENMP__
+#pragma omp parallel for private(b)
+#endif
+  for (b = 0; b < nbands; ++b) {
+    if (algorithm == CONV_WINOGRAD)
+      winograds[b].fprop(inbands[b], kernel, outbands[b]);
+    else if (algorithm == CONV_FFT)
+      ffts[b].fprop(inbands[b], kernel, outbands[b]);
+    else
+      gemms[b].fprop(inbands[b], kernel, outbands[b], si, sj);
+  }
+}
+
+template <typename T>
+void conv_plan<T>::update_bands(idx<T> &in, idx<T> &out) {
+  if (inbands.size() > 0 && conv_same_view(in, bandin)
+      && conv_same_view(out, bandout))
+    return ;
+  bandin = in;
+  bandout = out;
+  inbands.clear();
+  outbands.clear();
+  for (uint b = 0; b + 1 < bands.size(); ++b) {
+    intg r0 = bands[b], nr = bands[b + 1] - r0;
+    inbands.push_back(in.narrow(1, (nr - 1) * si + ki, r0 * si));
+    outbands.push_back(out.narrow(1, nr, r0));
+  }
+}
+
+template <typename T>
+void conv_plan<T>::update_views(idx<T> &in, idx<T> &kernel, idx<T> &out) {
+  if (kernels.size() > 0 && conv_same_view(in, viewin)
+      && conv_same_view(kernel, viewkernel) && conv_same_view(out, viewout))
+    return ;
+  viewin = in;
+  viewkernel = kernel;
+  viewout = out;
+  kernels.clear();
+  inputs.clear();
+  outputs.clear();
+  for (intg e = 0; e < table.dim(0); ++e) {
+    kernels.push_back(kernel.select(0, e));
+    inputs.push_back(in.select(0, table.get(e, 0)));
+  }
+  for (intg o = 0; o < out.dim(0); ++o)
+    outputs.push_back(out.select(0, o));
+  if (tmps.size() == 0) { // per-entry buffers and entries of each output
+    output_entries.resize(out.dim(0));
+    for (intg e = 0; e < table.dim(0); ++e) {
+      tmps.push_back(idx<T>(outsize.dim(1), outsize.dim(2)));
+      output_entries[table.get(e, 1)].push_back(e);
+    }
+  }
+}
+
+} // namespace ebl
+
+#endif /* EBL_CONVOLUTION_HPP_ */
@@ -142,8 +142,11 @@ template <typename T> class ebm_2 : public module_2_1<T> {
   // full state propagation //////////////////////////////////////////////////
 
   //! Forward propagation of all tensors from 'in' tensors to 'out' tensors.
+  //! If inputs contain n > 1 tensors, e.g. a batch of samples, 'out'
+  //! receives n energies, the i-th one computed from the i-th tensors.
   virtual void fprop(state<T> &in1, state<T> &in2, state<T> &out);
   //! 1st order backward propagation of all tensors from out to in.
+  //! Each energy is backpropagated with its own derivative in out.dx.
   virtual void bprop(state<T> &in1, state<T> &in2, state<T> &out);
   //! 2nd order backward propagation of all tensors from out to in.
   virtual void bbprop(state<T> &in1, state<T> &in2, state<T> &out);
@@ -172,19 +172,44 @@ void ebm_2<T>::bbprop1(state<T> &i1, state<T> &i2, state<T> &energy) {
 
 template <typename T>
 void ebm_2<T>::fprop(state<T> &i1, state<T> &i2, state<T> &energy) {
-  if (i1.x.size() > 1 || i2.x.size() > 1)
-    eblerror("expected only 1 tensor in input states");
-  fprop1(i1, i2, energy);
+  if (i1.x.size() != i2.x.size())
+    eblerror("expected same number of tensors in input states but got "
+             << i1.x.size() << " and " << i2.x.size());
+  if (i1.x.size() == 1) {
+    fprop1(i1, i2, energy);
+    return ;
+  }
+  // a batch: one order-0 energy per pair of tensors
+  if (energy.x.size() != i1.x.size()) {
+    idx<T> e;
+    energy.reset(e.get_idxdim(), i1.x.size());
+  }
+  for (uint i = 0; i < i1.x.size(); ++i)
+    fprop1(i1.x[i], i2.x[i], energy.x[i]);
 }
 
 template <typename T>
 void ebm_2<T>::bprop(state<T> &i1, state<T> &i2, state<T> &energy) {
-  bprop1(i1, i2, energy);
+  if (i1.x.size() == 1) {
+    bprop1(i1, i2, energy);
+    return ;
+  }
+  for (uint i = 0; i < i1.x.size(); ++i) {
+    state<T> s1 = i1.get_dx(i), s2 = i2.get_dx(i), e = energy.get_dx(i);
+    bprop1(s1, s2, e);
+  }
 }
 
 template <typename T>
 void ebm_2<T>::bbprop(state<T> &i1, state<T> &i2, state<T> &energy) {
-  bbprop1(i1, i2, energy);
+  if (i1.x.size() == 1) {
+    bbprop1(i1, i2, energy);
+    return ;
+  }
+  for (uint i = 0; i < i1.x.size(); ++i) {
+    state<T> s1 = i1.get_ddx(i), s2 = i2.get_ddx(i), e = energy.get_ddx(i);
+    bbprop1(s1, s2, e);
+  }
 }
 
 template <typename T>
@@ -109,6 +109,12 @@ public:
   virtual void bprop(state<T> &in, state<T> &out);
   //! 2nd order backward propagation of all tensors from out to in.
   virtual void bbprop(state<T> &in, state<T> &out);
+  //! Makes the buffers kept by fprop1() for bprop1() and bbprop1()
+  //! (see tensor_buffers) those of tensor 'i'. fprop(), bprop() and bbprop()
+  //! select each tensor before propagating it, so that each tensor of a
+  //! state keeps its own buffers. Modules containing modules with buffers
+  //! also select tensor 'i' in them.
+  virtual void select_tensor(uint i);
 
   // dumping /////////////////////////////////////////////////////////////////
 
@@ -216,6 +222,11 @@ protected:
   bool					bmstate_output;	//!< Output is multi-state.
   uint					ninputs, noutputs;			//!< Current # of i/o states.
   idxdim				outdims;				//!< Last out dimensions.
+  //! Buffers computed by fprop1() and used by bprop1() or bbprop1().
+  std::vector<state<T>*>		tensor_buffers;
+  //! Buffers of each tensor, empty until a tensor is selected.
+  std::vector<std::vector<state<T>*> >	tensor_banks;
+  uint					tensor;	//!< Selected tensor.
 };
 
 // module_2_1 //////////////////////////////////////////////////////////////////
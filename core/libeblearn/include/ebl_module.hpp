@@ -38,12 +38,15 @@ template <typename T>
 module_1_1<T>::module_1_1(const char *name, bool bresize_)
     : module(name), bresize(bresize_), memoptimized(false),
       bmstate_input(false), bmstate_output(false), ninputs(1),
-      noutputs(1){
+      noutputs(1), tensor(0) {
 }
 
 template <typename T>
 module_1_1<T>::~module_1_1() {
   EDEBUG("deleting module_1_1: " << _name);
+  for (uint i = 0; i < tensor_banks.size(); ++i)
+    for (uint k = 0; k < tensor_banks[i].size(); ++k)
+      delete tensor_banks[i][k];
 }
 
 // single propagation methods ////////////////////////////////////////////////
@@ -71,8 +74,10 @@ void module_1_1<T>::fprop(state<T> &in, state<T> &out) {
   for (uint i = 0; i < in.x.size(); ++i) {
     EDEBUG(this->name() << ": fprop at tensor " << i << " in: "
            << in << " and out: " << out);
+    select_tensor(i);
     fprop1(in.x[i], out.x[i]);
   }
+  select_tensor(0);
   // remember number of input/outputs
   ninputs = in.x.size();
   noutputs = out.x.size();
@@ -89,8 +94,10 @@ void module_1_1<T>::bprop(state<T> &in, state<T> &out) {
            << " min " << idx_min(sin) << " max " << idx_max(sin)
            << " out.dx[" << i << "] " << sout
            << " min " << idx_min(sout) << " max " << idx_max(sout));
+    select_tensor(i);
     bprop1(sin, sout);
   }
+  select_tensor(0);
 }
 
 template <typename T>
@@ -100,8 +107,38 @@ void module_1_1<T>::bbprop(state<T> &in, state<T> &out) {
   for (int i = (int) in.ddx.size() - 1; i >= 0; --i) {
     state<T> inbb = in.get_ddx(i);
     state<T> outbb = out.get_ddx(i);
+    select_tensor(i);
     bbprop1(inbb, outbb);
   }
+  select_tensor(0);
+}
+
+template <typename T>
+void module_1_1<T>::select_tensor(uint i) {
+  if (i == tensor) return ;
+  if (!tensor_buffers.empty()) {
+    if (tensor_banks.size() <= std::max(i, tensor))
+      tensor_banks.resize(std::max(i, tensor) + 1);
+    // keep buffers of current tensor (sharing their storages)
+    std::vector<state<T>*> &cur = tensor_banks[tensor];
+    for (uint k = 0; k < tensor_buffers.size(); ++k) {
+      if (k < cur.size()) *cur[k] = *tensor_buffers[k];
+      else cur.push_back(new state<T>(*tensor_buffers[k]));
+    }
+    // restore buffers of tensor i, allocate them the first time
+    std::vector<state<T>*> &sel = tensor_banks[i];
+    for (uint k = 0; k < tensor_buffers.size(); ++k) {
+      state<T> &b = *tensor_buffers[k];
+      if (k < sel.size()) b = *sel[k];
+      else {
+        state<T> s(b.get_idxdim());
+        if (!b.dx.empty()) s.resize_dx();
+        if (!b.ddx.empty()) s.resize_ddx();
+        b = s;
+      }
+    }
+  }
+  tensor = i;
 }
 
 // dumping ///////////////////////////////////////////////////////////////////
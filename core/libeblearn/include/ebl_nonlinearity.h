@@ -48,7 +48,11 @@ template <typename T> class stdsigmoid_module: public module_1_1<T> {
 	//! \param linear_coeff If non-zero, a linear term is added to the output
 	//!   with coefficient 'linear_coeff': y = tanh(x) + linear_coeff * x
 	//!   A linear term can be good to avoid flat regions.
-	stdsigmoid_module(double linear_coeff = 0, const char *name = "stdsigmoid");
+	//! \param fast If true, use a rational approximation (see tanh_fast())
+	//!   instead of the exact function, with a maximum error of 1.7e-4.
+	//!   Backward propagation uses the exact derivative of the approximation.
+	stdsigmoid_module(double linear_coeff = 0, const char *name = "stdsigmoid",
+	                   bool fast = false);
 	//! Destructor.
 	virtual ~stdsigmoid_module();
 
@@ -70,6 +74,7 @@ template <typename T> class stdsigmoid_module: public module_1_1<T> {
  protected:
 	idx<T>				tmp;						//!< Temporary buffer.
 	double				alpha;					//!< Coefficient of the linear term.
+	bool					fast;						//!< Use the fast approximation.
 };
 
 // tanh ////////////////////////////////////////////////////////////////////////
@@ -81,7 +86,11 @@ template <typename T> class tanh_module: public module_1_1<T> {
 	//! \param linear_coeff If non-zero, a linear term is added to the output
 	//!   with coefficient 'linear_coeff': y = tanh(x) + linear_coeff * x
 	//!   A linear term can be good to avoid flat regions.
-	tanh_module(double linear_coeff = 0, const char *name = "tanh");
+	//! \param fast If true, use a rational approximation (see tanh_fast())
+	//!   instead of the exact function, with a maximum error of 1e-4.
+	//!   Backward propagation uses the exact derivative of the approximation.
+	tanh_module(double linear_coeff = 0, const char *name = "tanh",
+	             bool fast = false);
 	virtual ~tanh_module();
 
 	//! Forward propagation from 'in' tensor to 'out' tensor.
@@ -105,6 +114,7 @@ template <typename T> class tanh_module: public module_1_1<T> {
  protected:
 	idx<T>				tmp;						//!< Temporary buffer.
 	double				alpha;					//!< Coefficient of the linear term.
+	bool					fast;						//!< Use the fast approximation.
 };
 
 // softmax /////////////////////////////////////////////////////////////////////
@@ -34,8 +34,9 @@ namespace ebl {
 // stdsigmoid //////////////////////////////////////////////////////////////////
 
 template <typename T>
-stdsigmoid_module<T>::stdsigmoid_module(double alpha_, const char *name_)
-    : module_1_1<T>(name_), alpha(alpha_) {
+stdsigmoid_module<T>::stdsigmoid_module(double alpha_, const char *name_,
+                                        bool fast_)
+    : module_1_1<T>(name_), alpha(alpha_), fast(fast_) {
 }
 
 template <typename T>
@@ -46,7 +47,8 @@ template <typename T>
 void stdsigmoid_module<T>::fprop1(idx<T> &in, idx<T> &out) {
   this->resize_output(in, out); // resize iff necessary
   this->resize_output(in, tmp); // resize iff necessary
-  idx_stdsigmoid(in, out);
+  if (fast) idx_tanh_fast(in, out, (T) STDSIGMOID_A, (T) STDSIGMOID_B);
+  else idx_stdsigmoid(in, out);
   if (alpha != 0) idx_dotcacc(out, (T) alpha, out);
 }
 
@@ -54,7 +56,8 @@ template <typename T>
 void stdsigmoid_module<T>::bprop1(state<T> &in, state<T> &out) {
   DEBUG_CHECK_DX(in); // in debug mode, check backward tensors are allocated
   // backprop
-  idx_dstdsigmoid(in, tmp);
+  if (fast) idx_dtanh_fast(in, tmp, (T) STDSIGMOID_A, (T) STDSIGMOID_B);
+  else idx_dstdsigmoid(in, tmp);
   if (alpha != 0) idx_addc(tmp, (T) alpha);
   idx_mulacc(tmp, out.dx[0], in.dx[0]);
 }
@@ -63,14 +66,15 @@ template <typename T>
 void stdsigmoid_module<T>::bbprop1(state<T> &in, state<T> &out) {
   DEBUG_CHECK_DDX(in); // in debug mode, check backward tensors are allocated
   // backprop
-  idx_dstdsigmoid(in, tmp);
+  if (fast) idx_dtanh_fast(in, tmp, (T) STDSIGMOID_A, (T) STDSIGMOID_B);
+  else idx_dstdsigmoid(in, tmp);
   idx_mul(tmp, tmp, tmp);
   idx_mulacc(tmp, out.ddx[0], in.ddx[0]);
 }
 
 template <typename T>
 module_1_1<T>* stdsigmoid_module<T>::copy(parameter<T> *p) {
-  return (module_1_1<T>*) new stdsigmoid_module<T>(alpha);
+  return (module_1_1<T>*) new stdsigmoid_module<T>(alpha, this->name(), fast);
 }
 
 template <typename T>
@@ -78,14 +82,15 @@ std::string stdsigmoid_module<T>::describe() {
   std::string s;
   s << "stdsigmoid module " << this->name() << " with linear coefficient "
     << alpha;
+  if (fast) s << " (fast approximation)";
   return s;
 }
 
 // tanh ////////////////////////////////////////////////////////////////////////
 
 template <typename T>
-tanh_module<T>::tanh_module(double alpha_, const char *name_)
-    : module_1_1<T>(name_), alpha(alpha_) {
+tanh_module<T>::tanh_module(double alpha_, const char *name_, bool fast_)
+    : module_1_1<T>(name_), alpha(alpha_), fast(fast_) {
 }
 
 template <typename T>
@@ -96,7 +101,8 @@ template <typename T>
 void tanh_module<T>::fprop1(idx<T> &in, idx<T> &out) {
   this->resize_output(in, out); // resize iff necessary
   this->resize_output(in, tmp); // resize iff necessary
-  idx_tanh(in, out);
+  if (fast) idx_tanh_fast(in, out);
+  else idx_tanh(in, out);
   if (alpha != 0) idx_dotcacc(in, (T) alpha, out);
 }
 
@@ -104,7 +110,8 @@ template <typename T>
 void tanh_module<T>::bprop1(state<T> &in, state<T> &out) {
   DEBUG_CHECK_DX(in); // in debug mode, check backward tensors are allocated
   // backprop
-  idx_dtanh(in, tmp);
+  if (fast) idx_dtanh_fast(in, tmp);
+  else idx_dtanh(in, tmp);
   if (alpha != 0) idx_addc(tmp, (T) alpha);
   idx_mulacc(tmp, out.dx[0], in.dx[0]);
 }
@@ -113,7 +120,8 @@ template <typename T>
 void tanh_module<T>::bbprop1(state<T> &in, state<T> &out) {
   DEBUG_CHECK_DDX(in); // in debug mode, check backward tensors are allocated
   // backprop
-  idx_dtanh(in, tmp);
+  if (fast) idx_dtanh_fast(in, tmp);
+  else idx_dtanh(in, tmp);
   idx_mul(tmp, tmp, tmp);
   idx_mulacc(tmp, out.ddx[0], in.ddx[0]);
 }
@@ -127,13 +135,14 @@ void tanh_module<T>::fprop1_dump(idx<T> &in, idx<T> &out) {
 
 template <typename T>
 module_1_1<T>* tanh_module<T>::copy(parameter<T> *p) {
-  return (module_1_1<T>*) new tanh_module<T>(alpha);
+  return (module_1_1<T>*) new tanh_module<T>(alpha, this->name(), fast);
 }
 
 template <typename T>
 std::string tanh_module<T>::describe() {
   std::string s;
   s << "tanh module " << this->name() << " with linear coefficient " << alpha;
+  if (fast) s << " (fast approximation)";
   return s;
 }
 
@@ -78,6 +78,9 @@ template <typename T> class divisive_norm_module : public module_1_1<T> {
   virtual void bprop1(state<T> &in, state<T> &out);
   //! 2nd order backward propagation from out to in (first state tensor only).
   virtual void bbprop1(state<T> &in, state<T> &out);
+  //! Selects the buffers of tensor 'i' in this module and in its
+  //! convolution layers (see module_1_1::select_tensor()).
+  virtual void select_tensor(uint i);
 
   //! Calls fprop and then dumps internal buffers, inputs and outputs
   //! into files. This can be useful for debugging.
@@ -111,6 +114,11 @@ template <typename T> class divisive_norm_module : public module_1_1<T> {
                     double epsilon2_);
   //! Copies and replicates kernel into divconv.
   virtual void set_kernel(idx<T> &kernel);
+  //! Declares the buffers used by bprop1() and bbprop1(), which are kept
+  //! for each tensor.
+  void init_buffers();
+  //! Sets the threshold to the mean of 'instd' if thresholding.
+  void update_threshold();
   //! out = in / thstd
   virtual void invert(idx<T> &in, idx<T> &thstd, idx<T> &out);
 
@@ -181,6 +189,9 @@ template <typename T> class subtractive_norm_module : public module_1_1<T> {
   virtual void bprop1(state<T> &in, state<T> &out);
   //! 2nd order backward propagation from out to in (first state tensor only).
   virtual void bbprop1(state<T> &in, state<T> &out);
+  //! Selects the buffers of tensor 'i' in this module and in its
+  //! convolution layers (see module_1_1::select_tensor()).
+  virtual void select_tensor(uint i);
 
   //! Calls fprop and then dumps internal buffers, inputs and outputs
   //! into files. This can be useful for debugging.
@@ -274,6 +285,9 @@ class contrast_norm_module : public module_1_1<T> {
   virtual void bprop1(state<T> &in, state<T> &out);
   //! 2nd order backward propagation from out to in (first state tensor only).
   virtual void bbprop1(state<T> &in, state<T> &out);
+  //! Selects the buffers of tensor 'i' in this module and in its
+  //! normalization modules (see module_1_1::select_tensor()).
+  virtual void select_tensor(uint i);
 
   //! Calls fprop and then dumps internal buffers, inputs and outputs
   //! into files. This can be useful for debugging.
@@ -38,6 +38,7 @@ template <typename T>
 divisive_norm_module<T>::divisive_norm_module(const char *name_)
     : module_1_1<T>(name_), convvar(true, name_), invmod(-1),
       thres((T) 1.0, (T) 1.0) {
+  init_buffers();
 }
 
 template <typename T>
@@ -48,12 +49,14 @@ divisive_norm_module(idxdim &kerdim_, int nf, bool mirror_, bool threshold_,
                      double epsilon_, double epsilon2_)
     : module_1_1<T>(name_), convvar(true, name_), invmod(-1),
       thres((T) 1.0, (T) 1.0) {
+  init_buffers();
   // common initializations
   init(kerdim_, nf, mirror_, threshold_, param_, af, cgauss_, fsum_div_,
        fsum_split_, epsilon_, epsilon2_);
   // local initializations
   divconv = new convolution_module<T>(param, kerdim, stride, conv_table,
                                       name_);
+  divconv->set_algorithm(CONV_SEPARABLE); // gaussian kernels are separable
   set_kernel(gaussian_kernel);
   convvar.add_module(divconv);
   // feature sum module to sum along features
@@ -99,6 +102,16 @@ init(idxdim &kerdim_, int nf, bool mirror_, bool threshold_,
   convvar.add_module(padding);
 }
 
+template <typename T>
+void divisive_norm_module<T>::init_buffers() {
+  // buffers used by bprop1 and bbprop1
+  this->tensor_buffers.push_back(&insq);
+  this->tensor_buffers.push_back(&invar);
+  this->tensor_buffers.push_back(&instd);
+  this->tensor_buffers.push_back(&thstd);
+  this->tensor_buffers.push_back(&invstd);
+}
+
 template <typename T>
 void divisive_norm_module<T>::set_kernel(idx<T> &w) {
   // copy kernel to convolution param
@@ -117,17 +130,28 @@ divisive_norm_module<T>::~divisive_norm_module() {
 
 template <typename T>
 void divisive_norm_module<T>::fprop1(idx<T> &in, idx<T> &out) {
-  if (epsilon2 != 0)
-    idx_addc(in, (T) epsilon2, in); // avoid div by 0
-  // insq = in^2 TODO: would this be faster with idx_mul(in, in, insq)?
-  sqmod->fprop1(in, insq);
+  // insq = in^2, fused with avoiding div by 0 on in
+  this->resize_output(in, insq);
+  idx_eval(in, idx_lazy(in) + (T) epsilon2, insq, idx_lazy(in) * idx_lazy(in));
   // invar = sum_j (w_j in^2)
   convvar.fprop1(insq, invar);
-  if (epsilon != 0) idx_addc(invar, (T) epsilon, invar); // avoid div by 0
   // if learning filters, make sure they stay positive
   //    if (param) idx_abs(divconv->kernel, divconv->kernel);
-  // instd = sqrt(sum_j (w_j in^2))
-  sqrtmod->fprop1(invar, instd);
+  // instd = sqrt(sum_j (w_j in^2)), fused with avoiding div by 0 on invar
+  this->resize_output(invar, instd);
+  idx_eval(invar, idx_lazy(invar) + (T) epsilon,
+	   instd, lazy_sqrt(idx_lazy(invar)));
+  update_threshold();
+  // std(std<mean(std)) = mean(std)
+  thres.fprop1(instd, thstd);
+  // out = in / thstd
+  this->invert(in, thstd, out);
+  // remember output dimensions
+  this->update_outdims(out);
+}
+
+template <typename T>
+void divisive_norm_module<T>::update_threshold() {
   // the threshold is the average of all the standard deviations over
   // the entire input. values below it will be set to the threshold.
   if (threshold) { // don't update threshold for inputs
@@ -136,20 +160,15 @@ void divisive_norm_module<T>::fprop1(idx<T> &in, idx<T> &out) {
     thres.thres = mm;
     thres.val = mm;
   }
-  // std(std<mean(std)) = mean(std)
-  thres.fprop1(instd, thstd);
-  // out = in / thstd
-  this->invert(in, thstd, out);
-  // remember output dimensions
-  this->update_outdims(out);
 }
 
 template <typename T>
 void divisive_norm_module<T>::invert(idx<T> &in, idx<T> &thstd_, idx<T> &out) {
-  // invstd = 1 / thstd
-  invmod.fprop1(thstd_, invstd);
-  // out = in / thstd
-  mcw.fprop1(in, invstd, out);
+  // invstd = 1 / thstd and out = in / thstd in a single pass
+  this->resize_output(thstd_, invstd);
+  this->resize_output(in, out);
+  idx_eval(invstd, (T) 1 / idx_lazy(thstd_),
+	   out, idx_lazy(in) * idx_lazy(invstd));
 }
 
 template <typename T>
@@ -169,6 +188,7 @@ void divisive_norm_module<T>::bprop1(state<T> &in, state<T> &out) {
   thstd.zero_dx();
   invstd.zero_dx();
   convvar.zero_dx();
+  update_threshold(); // threshold of the tensor of these buffers
   // out = in/std
   mcw.bprop1(in, invstd, out);
   // 1/std
@@ -200,6 +220,7 @@ void divisive_norm_module<T>::bbprop1(state<T> &in, state<T> &out) {
   thstd.zero_ddx();
   invstd.zero_ddx();
   convvar.zero_ddx();
+  update_threshold(); // threshold of the tensor of these buffers
   // out = in/std
   mcw.bbprop1(in, invstd, out);
   // 1/std
@@ -214,6 +235,12 @@ void divisive_norm_module<T>::bbprop1(state<T> &in, state<T> &out) {
   sqmod->bbprop1(in, insq);
 }
 
+template <typename T>
+void divisive_norm_module<T>::select_tensor(uint i) {
+  module_1_1<T>::select_tensor(i);
+  convvar.select_tensor(i);
+}
+
 template <typename T>
 void divisive_norm_module<T>::fprop1_dump(idx<T> &in, idx<T> &out) {
   fprop1(in, out);
@@ -265,6 +292,7 @@ void divisive_norm_module<T>::set_epsilon(double eps) {
 template <typename T>
 subtractive_norm_module<T>::subtractive_norm_module(const char *name_)
     : module_1_1<T>(name_), convmean(true, name_) {
+  this->tensor_buffers.push_back(&inmean); // used by bprop1
 }
 
 template <typename T>
@@ -274,11 +302,13 @@ subtractive_norm_module(idxdim &kerdim_, int nf, bool mirror_,
                         const char *name_, bool af, double cgauss_,
                         bool fsum_div_, float fsum_split_, bool valid_)
     : module_1_1<T>(name_), convmean(true, name_), valid(valid_) {
+  this->tensor_buffers.push_back(&inmean); // used by bprop1
   // common initializations
   init(kerdim_, nf, mirror_, global_norm_, param_, af, cgauss_, fsum_div_,
        fsum_split_, valid);
   // local initializations
   meanconv = new convolution_module<T>(param, kerdim, stride, conv_table,name_);
+  meanconv->set_algorithm(CONV_SEPARABLE); // gaussian kernels are separable
   set_kernel(gaussian_kernel);
   convmean.add_module(meanconv);
   // feature sum module to sum along features
@@ -397,6 +427,12 @@ void subtractive_norm_module<T>::bbprop1(state<T> &in, state<T> &out) {
   convmean.bbprop1(in, inmean);
 }
 
+template <typename T>
+void subtractive_norm_module<T>::select_tensor(uint i) {
+  module_1_1<T>::select_tensor(i);
+  convmean.select_tensor(i);
+}
+
 template <typename T>
 void subtractive_norm_module<T>::fprop1_dump(idx<T> &in, idx<T> &out) {
   fprop1(in, out);
@@ -442,6 +478,7 @@ std::string subtractive_norm_module<T>::describe() {
 template <typename T>
 contrast_norm_module<T>::contrast_norm_module(const char *name_)
     : module_1_1<T>(name_), subnorm(NULL), divnorm(NULL) {
+  this->tensor_buffers.push_back(&tmp); // used by bprop1
 }
 
 template <typename T>
@@ -452,6 +489,7 @@ contrast_norm_module(idxdim &kerdim, int nf, bool mirror, bool threshold,
                      bool fsum_div, float fsum_split, double epsilon,
                      double epsilon2, bool valid)
     : module_1_1<T>(name_), learn_mean(lm) {
+  this->tensor_buffers.push_back(&tmp); // used by bprop1
   this->default_name("cnorm");
   // setting names
   std::string sname, dname;
@@ -510,6 +548,13 @@ void contrast_norm_module<T>::bbprop1(state<T> &in, state<T> &out) {
   subnorm->bbprop1(in, tmp);
 }
 
+template <typename T>
+void contrast_norm_module<T>::select_tensor(uint i) {
+  module_1_1<T>::select_tensor(i);
+  if (subnorm) subnorm->select_tensor(i);
+  if (divnorm) divnorm->select_tensor(i);
+}
+
 template <typename T>
 void contrast_norm_module<T>::fprop1_dump(idx<T> &in, idx<T> &out) {
   subnorm->fprop1_dump(in, tmp);
@@ -567,6 +612,7 @@ laplacian_module(int nf, bool mirror_, bool global_norm_, const char *name_)
   idx<intg> table = one2one_table(nfeatures);
   conv =
       new convolution_module<T>(&param, kerdim, stride, table);
+  conv->set_algorithm(CONV_SEPARABLE); // burt-adelson kernel is separable
   idx_bloop1(kx, conv->kernel, T)
       idx_copy(filter, kx);
   // create modules
@@ -112,7 +112,9 @@ public:
 
 // parameter /////////////////////////////////////////////////////////////////
 
-//! A forward set of parameters.
+//! A forward set of parameters. Forward weights can be kept in float16
+//! while the modules using them are idle with pack_half() and
+//! unpack_half() (see state), e.g. to host more models per process.
 template <typename T> class parameter : public state<T> {
  public:
   //! initialize the bbparameter with size initial_size.
@@ -136,7 +138,9 @@ template <typename T> class parameter : public state<T> {
   //! Load forward weights from matrix m.
   bool load_x(idx<T> &m);
   //! Saves the forward component to a file.
-  bool save_x(const char *filename);
+  //! \param half If true, weights are stored as float16, which halves the
+  //!   file size. load_x() converts them back to T transparently.
+  bool save_x(const char *filename, bool half = false);
   //! Permute blocks in x following permutation vector.
   void permute_x(std::vector<intg> &blocks, std::vector<uint> &permutations);
 
@@ -204,6 +208,14 @@ template <typename T> class ddparameter : public parameter<T> {
   ddparameter(intg initial_size = 100, bool silent = false);
   //! initialize the bddparameter with a previously saved x component.
   ddparameter(const char *param_filename);
+  //! Initialize a parameter whose forward tensor uses the storage of
+  //! 'shared' while having its own backward tensors, update buffers and
+  //! epsilons. Modules allocated on it in the same order as on 'shared'
+  //! read and update the weights of 'shared', but accumulate their own
+  //! gradients, e.g. for several threads training the same weights.
+  //! Note: allocating modules clears their weights, the weights of 'shared'
+  //! should be saved before and restored after allocation.
+  ddparameter(parameter<T> &shared, bool silent = false);
   //! destructor
   virtual ~ddparameter();
 };
@@ -137,8 +137,13 @@ bool parameter<T>::load_x(idx<T> &m) {
 }
 
 template <typename T>
-bool parameter<T>::save_x(const char *s) {
-  if (!save_matrix(*this, s))
+bool parameter<T>::save_x(const char *s, bool half) {
+  if (half) {
+    idx<float16> h(this->get_idxdim());
+    idx_copy(*this, h);
+    if (!save_matrix(h, s))
+      return false;
+  } else if (!save_matrix(*this, s))
     return false;
   return true;
 }
@@ -213,18 +218,22 @@ void parameter<T>::update_weights(gd_param &arg) {
   EDEBUG("updating weights with dx[0] " << dx[0].info()
          << " epsilons " << epsilons.info() << " deltax " << deltax.info());
   if (dx.empty()) eblerror("gradient tensors not found");
-  // L2 gradients regularization
-  if (arg.decay_l2 > 0) idx_dotcacc(x[0], arg.decay_l2, dx[0]);
-  // L1 gradients regularization
-  if (arg.decay_l1 > 0) idx_signdotcacc(x[0], (T) arg.decay_l1, dx[0]);
-  // weights update
-  if (arg.inertia == 0) {
-    idx_mul(dx[0], epsilons, dx[0]);
-    idx_dotcacc(dx[0], -arg.eta, x[0]);
-  } else {
-    update_deltax((T) (1 - arg.inertia), (T) arg.inertia);
-    idx_mul(deltax, epsilons, dx[0]);
-    idx_dotcacc(dx[0], -arg.eta, x[0]);
+  // regularization coefficients (0 when disabled)
+  T l2 = (T) (arg.decay_l2 > 0 ? arg.decay_l2 : 0);
+  T l1 = (T) (arg.decay_l1 > 0 ? arg.decay_l1 : 0);
+  T eta = (T) arg.eta;
+  idx<T> &w = x[0], &dw = dx[0];
+  // weights update, gradients regularization and step are fused in a single
+  // pass: x -= eta * eps * (dx + l2 * x + l1 * sign(x))
+  if (arg.inertia == 0)
+    idx_eval(w, idx_lazy(w) - eta * idx_lazy(epsilons)
+	     * (idx_lazy(dw) + l2 * idx_lazy(w) + l1 * lazy_sign(idx_lazy(w))));
+  else {
+    T knew = (T) (1 - arg.inertia), kold = (T) arg.inertia;
+    idx_eval(deltax, knew * (idx_lazy(dw) + l2 * idx_lazy(w)
+			     + l1 * lazy_sign(idx_lazy(w)))
+	     + kold * idx_lazy(deltax),
+	     w, idx_lazy(w) - eta * idx_lazy(deltax) * idx_lazy(epsilons));
   }
 }
 
@@ -284,6 +293,18 @@ ddparameter<T>::ddparameter(const char *param_filename) : parameter<T>(1) {
   }
 }
 
+template <typename T>
+ddparameter<T>::ddparameter(parameter<T> &shared, bool silent_)
+    : parameter<T>(1, silent_) {
+  // forward tensor starts empty at the beginning of shared storage
+  idxdim d(this->get_idxdim());
+  ((idx<T>&)*this) = idx<T>(shared.getstorage(), 0, d);
+  // initialize backward tensors
+  this->dx.push_back(new idx<T>(this->get_idxdim()));
+  this->ddx.push_back(new idx<T>(this->get_idxdim()));
+  this->resize_parameter(0);
+}
+
 template <typename T>
 ddparameter<T>::~ddparameter() {
 }
@@ -376,7 +376,7 @@ template <typename T> class maxss_module : public subsampling_module<T> {
   bool     float_precision;  //!< check the precision of the module
   bool     double_precision; //!< check the precision of the module
   //#ifdef __TH__
-  idx<T>   indices;          //!< Remember max locations
+  state<T> indices;          //!< Remember max locations
   //#endif
 };
 
@@ -40,6 +40,7 @@ subsampling_module(parameter<T> *p, uint thick, idxdim &kernel_,
                    idxdim &stride_, const char *name_, bool crop_, bool pad_)
     : module_1_1<T>(name_), coeff(thick, p), thickness(thick),
       kernel(kernel_), stride(stride_), crop(crop_), pad(pad_) {
+  this->tensor_buffers.push_back(&sub); // used by bprop1
   // insert thickness dimension
   idxdim d = kernel;
   d.insert_dim(0, thickness);
@@ -276,6 +277,9 @@ lppooling_module(uint thick, idxdim &kernel_, idxdim &stride_, uint lppower_,
     : module_1_1<T>(name_), thickness(thick),
       kernel(kernel_), stride(stride_), crop(crop_), lp_pow(lppower_),
       sqmod((T)lppower_), sqrtmod((T)(1.0/(T)lppower_)) {
+  // used by bprop1
+  this->tensor_buffers.push_back(&squared);
+  this->tensor_buffers.push_back(&convolved);
   // insert thickness dimension
   idxdim d = kernel;
   d.insert_dim(0, thick);
@@ -723,6 +727,7 @@ maxss_module<T>::maxss_module(uint thick, idxdim &kernel_, idxdim &stride_,
       switches(thickness, 1, 1, 2),
       float_precision(false), double_precision(false),
       indices(thickness, 1, 1, 2) {
+  this->tensor_buffers.push_back(&indices); // used by bprop1
 #ifdef __TH__
   // check precision to decide if we use TH or not
   state<T> *temp = new state<T>(1,1);
@@ -62,12 +62,21 @@ template <typename T> class channels_module: public module_1_1<T> {
   //! preprocessing.
   virtual void bprop1(state<T> &in, state<T> &out) {};
   virtual void bbprop1(state<T> &in, state<T> &out) {};
+  //! If this module starts with a linear conversion of each pixel's
+  //! channels (e.g. RGB to Y), puts the conversion of 'in' into 'out' and
+  //! returns true, otherwise returns false. Such conversions commute with
+  //! resizing and can be applied once to a full image before resizing it
+  //! at multiple scales.
+  virtual bool convert(idx<T> &in, idx<T> &out);
+  //! Tells fprop1 whether its inputs were already converted by convert().
+  virtual void set_converted(bool converted);
 
   //! Friends.
   template <typename T1> friend class laplacian_pyramid_module;
 
  protected:
   bool globnorm; //!< Normalize globally or not.
+  bool converted; //!< Inputs are already converted by convert().
 };
 
 // channorm_module /////////////////////////////////////////////////////////////
@@ -309,6 +318,8 @@ template <typename T> class rgb_to_y_module: public channels_module<T> {
   virtual ~rgb_to_y_module();
   //! forward propagation from in to out
   virtual void fprop1(idx<T> &in, idx<T> &out);
+  //! Puts the Y channel of 'in' into 'out' and returns true.
+  virtual bool convert(idx<T> &in, idx<T> &out);
   //! Returns a deep copy of this module.
   //! \param p If NULL, the copy points to the same weights as this module.
   virtual module_1_1<T>* copy(parameter<T> *p = NULL);
@@ -335,6 +346,8 @@ template <typename T> class rgb_to_yn_module: public channorm_module<T> {
   virtual ~rgb_to_yn_module();
   //! forward propagation from in to out
   virtual void fprop1(idx<T> &in, idx<T> &out);
+  //! Puts the Y channel of 'in' into 'out' and returns true.
+  virtual bool convert(idx<T> &in, idx<T> &out);
   //! Returns a deep copy of this module.
   //! \param p If NULL, the copy points to the same weights as this module.
   virtual module_1_1<T>* copy(parameter<T> *p = NULL);
@@ -413,6 +426,8 @@ template <typename T> class bgr_to_yp_module : public channorm_module<T> {
   virtual ~bgr_to_yp_module();
   //! forward propagation from in to out
   virtual void fprop1(idx<T> &in, idx<T> &out);
+  //! Puts the Y channel of 'in' into 'out' and returns true.
+  virtual bool convert(idx<T> &in, idx<T> &out);
   //! Returns a deep copy of this module.
   //! \param p If NULL, the copy points to the same weights as this module.
   virtual module_1_1<T>* copy(parameter<T> *p = NULL);
@@ -614,6 +629,7 @@ template <typename T> class resize_module: virtual public module_1_1<T> {
   std::vector<rect<int> >   original_bboxes; //!< bbox of original inputs in out
   module_1_1<T>  *mod;                  //!< Module to mimic outputs sizes.
   idxdim          modadd;               //!< Pixels to add to mod's mimiced size
+  resampler<T>    rs;                   //!< Cached resizing coefficients.
 };
 
 // resizepp_module /////////////////////////////////////////////////////////////
@@ -682,6 +698,16 @@ template <typename T> class resizepp_module: public resize_module<T> {
   //! Process 'in' into 'out' which will contain an array of idx, where each
   //! idx has different scale with different dimensions.
   virtual void fprop(state<T> &in, midx<T> &out);
+  //! Enables or disables building successive outputs of a same input as an
+  //! image pyramid: each scale is resized from the nearest larger scale
+  //! already computed (see resampler::set_pyramid()) and a linear color
+  //! conversion of the preprocessing module (see channels_module::convert())
+  //! is applied once to the full input instead of once per scale.
+  //! Scales should be requested from largest to smallest, and new_pyramid()
+  //! called for each new input.
+  virtual void set_pyramid(bool enable);
+  //! Forgets the scales computed for the previous input.
+  virtual void new_pyramid();
 
   //! Returns a deep copy of this module.
   //! \param p If NULL, the copy points to the same weights as this module.
@@ -694,6 +720,11 @@ template <typename T> class resizepp_module: public resize_module<T> {
   module_1_1<T> *pp;                    //!< preprocessing module
   bool           own_pp;                //!< responsible for pp's deletion
   state<T>       inpp, outpp;           //!< input/output buffers for pp
+  bool           pyramid;               //!< Build scales as a pyramid.
+  idx<T>         pyrin;                 //!< Input of the current pyramid.
+  idx<T>         pyrconv;               //!< Color conversion of pyrin.
+  bool           pyrstarted;            //!< pyrin is set.
+  channels_module<T> *pyrpp;            //!< pp if pyrconv is used.
 
   using resize_module<T>::size;
   using resize_module<T>::height;
@@ -720,6 +751,7 @@ template <typename T> class resizepp_module: public resize_module<T> {
   using resize_module<T>::scale_wfactor;
   using resize_module<T>::lout;
   using resize_module<T>::lastout;
+  using resize_module<T>::rs;
 };
 
 // fovea_module ////////////////////////////////////////////////////////////////
@@ -36,13 +36,23 @@ namespace ebl {
 
 template <typename T>
 channels_module<T>::channels_module(bool globnorm_, const char *name_)
-    : module_1_1<T>(name_), globnorm(globnorm_) {
+    : module_1_1<T>(name_), globnorm(globnorm_), converted(false) {
 }
 
 template <typename T>
 channels_module<T>::~channels_module() {
 }
 
+template <typename T>
+bool channels_module<T>::convert(idx<T> &in, idx<T> &out) {
+  return false;
+}
+
+template <typename T>
+void channels_module<T>::set_converted(bool conv) {
+  converted = conv;
+}
+
 // channorm_module /////////////////////////////////////////////////////////////
 
 template <typename T>
@@ -124,11 +134,8 @@ void rgb_to_ynuv_module<T>::fprop1(idx<T> &in, idx<T> &out) {
     // cerr << "warning: in rgb_to_ynuv, input is not 3-channel, "
     // 	   << "ignoring color." << endl;
   } else {
-    idx<T> uv, yuv;
     // RGB to YUV
-    idx_eloop2(inx, in, T, outx, out, T) {
-      idx_eloop2(inxx, inx, T, outxx, outx, T) {
-        rgb_to_yuv_1D(inxx, outxx); }}
+    rgb_to_yuv_planar(in, out);
   }
   EDEBUG(this->name() << ": yuv " << out << " min " << idx_min(out)
          << " max " << idx_max(out));
@@ -178,11 +185,8 @@ void rgb_to_ynuvn_module<T>::fprop1(idx<T> &in, idx<T> &out) {
     // cerr << "warning: in rgb_to_ynuvn, input is not 3-channel, "
     // 	   << "ignoring color." << endl;
   } else {
-    idx<T> uv, yuv;
     // RGB to YUV
-    idx_eloop2(inx, in, T, outx, out, T) {
-      idx_eloop2(inxx, inx, T, outxx, outx, T) {
-        rgb_to_yuv_1D(inxx, outxx); }}
+    rgb_to_yuv_planar(in, out);
   }
   // normalize Y
   this->tmp = out.narrow(0, 1, 0);
@@ -222,11 +226,8 @@ void rgb_to_ynunvn_module<T>::fprop1(idx<T> &in, idx<T> &out) {
     // cerr << "warning: in rgb_to_ynunvn, input is not 3-channel, "
     // 	   << "ignoring color." << endl;
   } else {
-    idx<T> uv, yuv;
     // RGB to YUV
-    idx_eloop2(inx, in, T, outx, out, T) {
-      idx_eloop2(inxx, inx, T, outxx, outx, T) {
-        rgb_to_yuv_1D(inxx, outxx); }}
+    rgb_to_yuv_planar(in, out);
   }
   // normalize Y
   this->tmp = out.narrow(0, 1, 0);
@@ -267,9 +268,7 @@ void rgb_to_yuv_module<T>::fprop1(idx<T> &in, idx<T> &out) {
     eblerror("expected 3 channels in dim 0 but found: " << in);
   } else {
     // RGB to YUV
-    idx_eloop2(inx, in, T, outx, out, T) {
-      idx_eloop2(inxx, inx, T, outxx, outx, T) {
-        rgb_to_yuv_1D(inxx, outxx); }}
+    rgb_to_yuv_planar(in, out);
     // remove global mean and divide by stddev
     if (this->globnorm) { // normalize Y
       idx<T> y = out.narrow(0, 1, 0);
@@ -313,9 +312,7 @@ void rgb_to_yuvn_module<T>::fprop1(idx<T> &in, idx<T> &out) {
     eblerror("expected 3 channels in dim 0 but found: " << in);
   } else {
     // RGB to YUV
-    idx_eloop2(inx, in, T, outx, out, T) {
-      idx_eloop2(inxx, inx, T, outxx, outx, T) {
-        rgb_to_yuv_1D(inxx, outxx); }}
+    rgb_to_yuv_planar(in, out);
   }
   // first normalize globally Y and UV separately
   idx<T> y = out.narrow(0, 1, 0);
@@ -427,18 +424,29 @@ void rgb_to_y_module<T>::fprop1(idx<T> &in, idx<T> &out) {
   idxdim d(in);
   d.setdim(0, 1);
   this->resize_output(in, out, &d); // resize (iff necessary)
-  if (in.dim(0) != 3) {
+  if (this->converted) {
+    idx_copy(in, out);
+    if (this->globnorm) image_global_normalization(out);
+  } else if (in.dim(0) != 3) {
     eblerror("expected 3 channels in dim 0 but found: " << in);
   } else {
     // RGB to YUV
-    idx_eloop2(inx, in, T, outx, out, T) {
-      idx_eloop2(inxx, inx, T, outxx, outx, T) {
-        rgb_to_y_1D(inxx, outxx); }}
+    rgb_to_y_planar(in, out);
     // remove global mean and divide by stddev
     if (this->globnorm) image_global_normalization(out);
   }
 }
 
+template <typename T>
+bool rgb_to_y_module<T>::convert(idx<T> &in, idx<T> &out) {
+  if (in.dim(0) != 3) return false;
+  idxdim d(in);
+  d.setdim(0, 1);
+  this->resize_output(in, out, &d); // resize (iff necessary)
+  rgb_to_y_planar(in, out);
+  return true;
+}
+
 template <typename T>
 module_1_1<T>* rgb_to_y_module<T>::copy(parameter<T> *p) {
   return new rgb_to_y_module<T>(this->globnorm);
@@ -463,21 +471,29 @@ void rgb_to_yn_module<T>::fprop1(idx<T> &in, idx<T> &out) {
   idxdim d(in);
   d.setdim(0, 1);
   this->resize_output(in, out, &d); // resize (iff necessary)
-  if (in.dim(0) != 3) {
+  if (in.dim(0) != 3 || this->converted) {
     // cerr << "warning: in rgb_to_yn, input is not 3-channel, "
     // 	   << "ignoring color." << endl;
     // convert Y to Yp
     this->norm->fprop1(in, out); // local
   } else {
     // RGB to Y
-    idx_eloop2(inx, in, T, tmpx, this->tmp, T) {
-      idx_eloop2(inxx, inx, T, tmpxx, tmpx, T) {
-        rgb_to_y_1D(inxx, tmpxx); }}
+    rgb_to_y_planar(in, this->tmp);
     // convert Y to Yp
     this->norm->fprop1(this->tmp, out); // local
   }
 }
 
+template <typename T>
+bool rgb_to_yn_module<T>::convert(idx<T> &in, idx<T> &out) {
+  if (in.dim(0) != 3) return false;
+  idxdim d(in);
+  d.setdim(0, 1);
+  module_1_1<T>::resize_output(in, out, &d); // resize (iff necessary)
+  rgb_to_y_planar(in, out);
+  return true;
+}
+
 template <typename T>
 module_1_1<T>* rgb_to_yn_module<T>::copy(parameter<T> *p) {
   return new rgb_to_yn_module<T>(this->normker, this->mirror,
@@ -532,11 +548,7 @@ void bgr_to_ypuv_module<T>::fprop1(idx<T> &in, idx<T> &out) {
   idx<T> uv, yp, yuv;
 
   // BGR to YUV
-  idx_eloop2(inx, in, T, outx, out, T) {
-    idx_eloop2(inxx, inx, T, outxx, outx, T) {
-      bgr_to_yuv_1D(inxx, outxx);
-    }
-  }
+  bgr_to_yuv_planar(in, out);
   // remove global mean and divide by stddev
   uv = out.narrow(0, 2, 1);
   if (this->globnorm) image_global_normalization(uv);
@@ -571,15 +583,27 @@ template <typename T>
 void bgr_to_yp_module<T>::fprop1(idx<T> &in, idx<T> &out) {
   idxdim d(in);
   d.setdim(0, 1);
-  this->resize_output(in, out, d); // resize (iff necessary)
+  this->resize_output(in, out, &d); // resize (iff necessary)
+  if (this->converted) {
+    this->norm->fprop1(in, out); // local
+    return ;
+  }
   // BGR to YUV
-  idx_eloop2(inx, in, T, tmpx, this->tmp, T) {
-    idx_eloop2(inxx, inx, T, tmpxx, tmpx, T) {
-      bgr_to_y_1D(inxx, tmpxx); }}
+  bgr_to_y_planar(in, this->tmp);
   // convert Y to Yp
   this->norm->fprop1(this->tmp, out); // local
 }
 
+template <typename T>
+bool bgr_to_yp_module<T>::convert(idx<T> &in, idx<T> &out) {
+  if (in.dim(0) != 3) return false;
+  idxdim d(in);
+  d.setdim(0, 1);
+  module_1_1<T>::resize_output(in, out, &d); // resize (iff necessary)
+  bgr_to_y_planar(in, out);
+  return true;
+}
+
 template <typename T>
 module_1_1<T>* bgr_to_yp_module<T>::copy(parameter<T> *p) {
   return new bgr_to_yp_module<T>(this->normker, this->mirror,
@@ -607,9 +631,7 @@ void rgb_to_hp_module<T>::fprop1(idx<T> &in, idx<T> &out) {
   d.setdim(0, 1);
   this->resize_output(in, out, &d); // resize (iff necessary)
   // RGB to YUV
-  idx_eloop2(inx, in, T, tmpx, this->tmp, T) {
-    idx_eloop2(inxx, inx, T, tmpxx, tmpx, T) {
-      rgb_to_h_1D(inxx, tmpxx); }}
+  rgb_to_h_planar(in, this->tmp);
   // convert H to Hp
   this->norm->fprop1(this->tmp, out); // local
 }
@@ -917,20 +939,23 @@ void resize_module<T>::fprop1(idx<T> &in, idx<T> &out) {
   switch (mode) {
     case BILINEAR_RESIZE:
       if (input_mode == 2) { // use ratios
-	resized = image_resize(tmp, hratio, wratio, input_mode, &r, &outr);
+	resized = image_resize(tmp, hratio, wratio, input_mode, &r, &outr,
+			       &rs);
 	EDEBUG(this->name() << ": resizing with ratios " << hratio
                << " and " << wratio);
       } else // use pixels
 	resized = image_resize(tmp, (double) outrect.height,
-			       (double) outrect.width, input_mode, &r, &outr);
+			       (double) outrect.width, input_mode, &r, &outr,
+			       &rs);
       break ;
     case GAUSSIAN_RESIZE:
       resized = image_gaussian_resize(tmp, outrect.height,
-				      outrect.width, input_mode, &r,&outr);
+				      outrect.width, input_mode, &r, &outr,
+				      &rs);
       break ;
     case MEAN_RESIZE:
       resized = image_mean_resize(tmp, outrect.height,
-				  outrect.width, input_mode, &r, &outr);
+				  outrect.width, input_mode, &r, &outr, &rs);
       break ;
     default:
       eblerror("unknown resizing mode");
@@ -1114,7 +1139,8 @@ resizepp_module<T>::
 resizepp_module(idxdim &size_, uint mode_, module_1_1<T> *pp_,
                 bool own_pp_, idxdim *dzpad_, bool pratio, const char *name_)
     : resize_module<T>(size_, mode_, dzpad_, pratio, name_),
-      pp(pp_), own_pp(own_pp_) {
+      pp(pp_), own_pp(own_pp_), pyramid(false), pyrstarted(false),
+      pyrpp(NULL) {
   this->set_name(name_);
 }
 
@@ -1123,7 +1149,8 @@ resizepp_module<T>::
 resizepp_module(uint mode_, module_1_1<T> *pp_,
                 bool own_pp_, idxdim *dzpad_, bool pratio, const char *name_)
     : resize_module<T>(mode_, dzpad_, pratio, name_),
-      pp(pp_), own_pp(own_pp_) {
+      pp(pp_), own_pp(own_pp_), pyramid(false), pyrstarted(false),
+      pyrpp(NULL) {
   this->set_name(name_);
 }
 
@@ -1133,7 +1160,8 @@ resizepp_module(double hratio_, double wratio_, uint mode_,
                 module_1_1<T> *pp_,
                 bool own_pp_, idxdim *dzpad_, bool pratio, const char *name_)
     : resize_module<T>(hratio_, wratio_, mode_, dzpad_, pratio, name_),
-      pp(pp_), own_pp(own_pp_) {
+      pp(pp_), own_pp(own_pp_), pyramid(false), pyrstarted(false),
+      pyrpp(NULL) {
   this->set_name(name_);
 }
 
@@ -1149,26 +1177,40 @@ void resizepp_module<T>::fprop1(idx<T> &in, idx<T> &out) {
   input_bboxes[0] = r;
   EDEBUG("resizing " << in << " to " << outrect << " with ROI " << r);
   rect<int> outr;
+  // when building a pyramid, convert colors once for all scales
+  if (pyramid && (!pyrstarted || !same_view(in, pyrin))) {
+    new_pyramid();
+    pyrin = in;
+    pyrstarted = true;
+    pyrpp = dynamic_cast<channels_module<T>*>(pp);
+    if (pyrpp && !pyrpp->convert(in, pyrconv))
+      pyrpp = NULL;
+  }
   // resize input while preserving aspect ratio
-  tmp = in.shift_dim(0, 2); // resize functions expect channels in 3rd dim
+  // (resize functions expect channels in 3rd dim)
+  if (pyrpp) tmp = pyrconv.shift_dim(0, 2);
+  else tmp = in.shift_dim(0, 2);
   idx<T> resized;
   switch (mode) {
     case BILINEAR_RESIZE:
       if (input_mode == 2) { // use ratios
-	resized = image_resize(tmp, hratio, wratio, input_mode, &r, &outr);
+	resized = image_resize(tmp, hratio, wratio, input_mode, &r, &outr,
+			       &rs);
 	EDEBUG(this->name() << ": resizing with ratios " << hratio
                << " and " << wratio);
       } else // use pixels
 	resized = image_resize(tmp, (double) outrect.height,
-			       (double) outrect.width, input_mode, &r, &outr);
+			       (double) outrect.width, input_mode, &r, &outr,
+			       &rs);
       break ;
     case GAUSSIAN_RESIZE:
       resized = image_gaussian_resize(tmp, outrect.height,
-				      outrect.width, input_mode, &r,&outr);
+				      outrect.width, input_mode, &r, &outr,
+				      &rs);
       break ;
     case MEAN_RESIZE:
       resized = image_mean_resize(tmp, outrect.height,
-				  outrect.width, input_mode, &r, &outr);
+				  outrect.width, input_mode, &r, &outr, &rs);
       break ;
     default:
       eblerror("unknown resizing mode");
@@ -1179,7 +1221,9 @@ void resizepp_module<T>::fprop1(idx<T> &in, idx<T> &out) {
   if (pp) { // no preprocessing if NULL module
     EDEBUG_MAT(pp->name() << ": in", resized);
     inpp = resized;
+    if (pyrpp) pyrpp->set_converted(true);
     pp->fprop1(resized, outpp);
+    if (pyrpp) pyrpp->set_converted(false);
     resized = outpp;
     EDEBUG_MAT(pp->name() << ": out", resized);
   }
@@ -1242,6 +1286,21 @@ void resizepp_module<T>::fprop(state<T> &in, midx<T> &out) {
   out.mset(tmp, 0);
 }
 
+template <typename T>
+void resizepp_module<T>::set_pyramid(bool enable) {
+  pyramid = enable;
+  rs.set_pyramid(enable);
+  new_pyramid();
+}
+
+template <typename T>
+void resizepp_module<T>::new_pyramid() {
+  pyrin = idx<T>();
+  pyrstarted = false;
+  pyrpp = NULL;
+  rs.new_pyramid();
+}
+
 template <typename T>
 module_1_1<T>* resizepp_module<T>::copy(parameter<T> *p) {
   module_1_1<T> *newpp = NULL;
@@ -1753,7 +1812,7 @@ void laplacian_pyramid_module<T>::
 resize(idx<T> &im, idxdim &tgt, rect<int> &inr, rect<int> &outr) {
   // resize bilinearly to tgt
   im = image_resize(im, (double) tgt.dim(0), (double) tgt.dim(1),
-                    keep_aspect_ratio ? 0 : 1, &inr, &outr);
+                    keep_aspect_ratio ? 0 : 1, &inr, &outr, &this->rs);
   inr = outr;
   im = im.shift_dim(2, 0);
   // call preprocessing
@@ -1994,11 +2053,12 @@ void jitter_module<T>::fprop1(idx<T> &in, idx<T> &out) {
   this->resize_output(*i, out);
   if (this->ignored1(in, out)) return ;
   // random deformations
-  int th = (int) drand(th0, th1), tw = (int) drand(tw0, tw1); // translation
-  float deg = drand(deg0, deg1); // rotation
-  float sh = drand(sh0, sh1), sw = drand(sw0, sw1); // scale
-  float shh = drand(shh0, shh1), shw = drand(shw0, shw1); // shear
-  uint elsize = (uint) drand(elsz0, elsz1);
+  random &g = thread_random(); // safe when jittering from several threads
+  int th = (int) g.drand(th0, th1), tw = (int) g.drand(tw0, tw1); // translation
+  float deg = g.drand(deg0, deg1); // rotation
+  float sh = g.drand(sh0, sh1), sw = g.drand(sw0, sw1); // scale
+  float shh = g.drand(shh0, shh1), shw = g.drand(shw0, shw1); // shear
+  uint elsize = (uint) g.drand(elsz0, elsz1);
   float elc = elsize; // elastic
   // expect channels to be in dim 2,
   // TODO: allow specifying planar or interleaved in image_deformation
@@ -0,0 +1,177 @@
+/***************************************************************************
+ *   Copyright (C) 2012 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef EBL_QUANTIZATION_H_
+#define EBL_QUANTIZATION_H_
+
+#include "ebl_defines.h"
+#include "libidx.h"
+#include "ebl_arch.h"
+#include "ebl_basic.h"
+#include "ebl_convolution.h"
+
+namespace ebl {
+
+// int8_quantizer //////////////////////////////////////////////////////////////
+
+//! Symmetric int8 quantization of the inputs of a module: inputs are
+//! quantized with scale range / 127, where 'range' is the maximum absolute
+//! input value expected, values beyond it being saturated. The range is
+//! either given, calibrated over sample inputs, or if 0 computed
+//! dynamically for each input. Weights are quantized at the first fprop
+//! and after load_x() or forget(), requantize() must be called if they are
+//! modified otherwise (e.g. through their parameter).
+template <typename T> class int8_quantizer {
+ public:
+  //! Constructor, 'range' of 0 means dynamic range.
+  int8_quantizer(float range = 0);
+  //! Destructor.
+  virtual ~int8_quantizer();
+  //! Sets the inputs range, 0 meaning dynamic range.
+  virtual void set_range(float range);
+  //! Returns the inputs range, 0 meaning dynamic range.
+  virtual float get_range();
+  //! Starts recording the range of inputs. While calibrating, modules
+  //! compute their outputs in floating point.
+  virtual void start_calibration();
+  //! Stops recording and uses the recorded range if any input was seen.
+  virtual void stop_calibration();
+  //! Returns true while calibrating.
+  virtual bool calibrating();
+  //! Forces weights to be quantized again at the next fprop.
+  virtual void requantize();
+
+ protected:
+  //! Records the maximum absolute value of 'in'.
+  virtual void observe(idx<T> &in);
+  //! Returns the quantization scale of input 'in'.
+  virtual T input_scale(idx<T> &in);
+
+  // members ///////////////////////////////////////////////////////////////
+ protected:
+  float range;       //!< Maximum absolute input, 0 for dynamic range.
+  float observed;    //!< Maximum absolute input seen during calibration.
+  bool  bcalibrate;  //!< Calibrating or not.
+  bool  wquantized;  //!< Weights are quantized or not.
+};
+
+// linear_int8_module //////////////////////////////////////////////////////////
+
+//! A linear module computing its products in int8 with int32 accumulation:
+//! weights are quantized with one scale per output, inputs with one scale
+//! (see int8_quantizer).
+//! This module is for inference only, bprop1 and bbprop1 are errors.
+template <typename T> class linear_int8_module
+  : public linear_module<T>, public int8_quantizer<T> {
+ public:
+  //! Constructor, see linear_module and int8_quantizer.
+  linear_int8_module(parameter<T> *p, intg in, intg out, float range = 0,
+		     const char *name = "linear_int8");
+  //! Destructor.
+  virtual ~linear_int8_module();
+  //! forward propagation from in to out
+  virtual void fprop1(idx<T> &in, idx<T> &out);
+  //! Not available, this module is for inference only.
+  virtual void bprop1(state<T> &in, state<T> &out);
+  //! Not available, this module is for inference only.
+  virtual void bbprop1(state<T> &in, state<T> &out);
+  //! Initializes weights and quantizes them again at next fprop.
+  virtual void forget(forget_param_linear &fp);
+  //! Loads weights and quantizes them again at next fprop.
+  virtual void load_x(idx<T> &weights);
+  //! Returns a deep copy of this module.
+  //! \param p If NULL, reuse current parameter space, otherwise allocate new
+  //!   weights on parameter 'p'.
+  virtual module_1_1<T>* copy(parameter<T> *p = NULL);
+  //! Returns a string describing this module and its parameters.
+  virtual std::string describe();
+
+  // members ///////////////////////////////////////////////////////////////
+ protected:
+  idx<byte>    qw;      //!< Quantized weights.
+  idx<float32> wscale;  //!< Scale of each weights row.
+  idx<byte>    qin;     //!< Quantized transposed input.
+  idx<T>       tmp;     //!< Transposed output.
+  idx<float32> inscale; //!< Input scale of each output column.
+};
+
+// convolution_int8_module /////////////////////////////////////////////////////
+
+//! A convolution module computing its products in int8 with int32
+//! accumulation (see conv_int8): kernels are quantized with one scale per
+//! output, inputs with one scale (see int8_quantizer). Inputs that the
+//! int8 engine cannot handle are convolved in floating point.
+//! This module is for inference only, bprop1 and bbprop1 are errors.
+template <typename T> class convolution_int8_module
+  : public convolution_module<T>, public int8_quantizer<T> {
+ public:
+  //! Constructor, see convolution_module and int8_quantizer.
+  convolution_int8_module(parameter<T> *p, idxdim &ker, idxdim &stride,
+			  idx<intg> &table, float range = 0,
+			  const char *name = "convolution_int8",
+			  bool crop = true);
+  //! Destructor.
+  virtual ~convolution_int8_module();
+  //! forward propagation from in to out
+  virtual void fprop1(idx<T> &in, idx<T> &out);
+  //! Not available, this module is for inference only.
+  virtual void bprop1(state<T> &in, state<T> &out);
+  //! Not available, this module is for inference only.
+  virtual void bbprop1(state<T> &in, state<T> &out);
+  //! Initializes weights and quantizes them again at next fprop.
+  virtual void forget(forget_param_linear &fp);
+  //! Loads weights and quantizes them again at next fprop.
+  virtual void load_x(idx<T> &weights);
+  //! Returns a deep copy of this module.
+  //! \param p If NULL, reuse current parameter space, otherwise allocate new
+  //!   weights on parameter 'p'.
+  virtual module_1_1<T>* copy(parameter<T> *p = NULL);
+  //! Returns a string describing this module and its parameters.
+  virtual std::string describe();
+
+  // members ///////////////////////////////////////////////////////////////
+ protected:
+  conv_int8<T> engine; //!< int8 convolutions engine.
+};
+
+// utilities ///////////////////////////////////////////////////////////////////
+
+//! Appends to 'found' all modules of 'm' (looking into layers recursively)
+//! that quantize their inputs, i.e. that are also an int8_quantizer.
+template <typename T>
+void find_int8_modules(module_1_1<T> &m, std::vector<module_1_1<T>*> &found);
+
+} // namespace ebl
+
+#include "ebl_quantization.hpp"
+
+#endif /* EBL_QUANTIZATION_H_ */
@@ -0,0 +1,293 @@
+/***************************************************************************
+ *   Copyright (C) 2012 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+namespace ebl {
+
+// int8_quantizer //////////////////////////////////////////////////////////////
+
+template <typename T>
+int8_quantizer<T>::int8_quantizer(float range_)
+  : range(range_), observed(0), bcalibrate(false), wquantized(false) {
+}
+
+template <typename T>
+int8_quantizer<T>::~int8_quantizer() {
+}
+
+template <typename T>
+void int8_quantizer<T>::set_range(float range_) {
+  if (range_ < 0) eblerror("expected a positive int8 range but got " << range_);
+  range = range_;
+}
+
+template <typename T>
+float int8_quantizer<T>::get_range() {
+  return range;
+}
+
+template <typename T>
+void int8_quantizer<T>::start_calibration() {
+  bcalibrate = true;
+  observed = 0;
+}
+
+template <typename T>
+void int8_quantizer<T>::stop_calibration() {
+  bcalibrate = false;
+  if (observed > 0) range = observed;
+}
+
+template <typename T>
+bool int8_quantizer<T>::calibrating() {
+  return bcalibrate;
+}
+
+template <typename T>
+void int8_quantizer<T>::requantize() {
+  wquantized = false;
+}
+
+template <typename T>
+void int8_quantizer<T>::observe(idx<T> &in) {
+  { idx_aloop1(i, in, T) {
+      float v = (float) fabs((double) *i);
+      if (v > observed) observed = v;
+    }}
+}
+
+template <typename T>
+T int8_quantizer<T>::input_scale(idx<T> &in) {
+  float r = range;
+  if (r <= 0) { // dynamic range
+    { idx_aloop1(i, in, T) {
+	float v = (float) fabs((double) *i);
+	if (v > r) r = v;
+      }}
+  }
+  return r > 0 ? (T) (r / 127) : (T) 1;
+}
+
+// linear_int8_module //////////////////////////////////////////////////////////
+
+template <typename T>
+linear_int8_module<T>::linear_int8_module(parameter<T> *p, intg in, intg out,
+					  float range_, const char *name_)
+  : linear_module<T>(p, in, out, name_), int8_quantizer<T>(range_) {
+}
+
+template <typename T>
+linear_int8_module<T>::~linear_int8_module() {
+}
+
+template <typename T>
+void linear_int8_module<T>::fprop1(idx<T> &in, idx<T> &out) {
+  if (this->calibrating()) { // record inputs and compute in floating point
+    this->observe(in);
+    linear_module<T>::fprop1(in, out);
+    return ;
+  }
+  CHECK_CONTIGUOUS2(in, out);
+  // flatten dimensions starting from second one
+  idxdim d(in);
+  d.remove_dim(0);
+  idx<T> inx(in.getstorage(), 0, in.dim(0), d.nelements());
+  d.insert_dim(0, this->w.dim(0));
+  this->resize_output(in, out, &d); // resize (iff necessary)
+  idx<T> outx(out.getstorage(), 0, out.dim(0), inx.dim(1));
+  if (!this->wquantized) {
+    idx_quantize_rows_s8(this->w, qw, wscale);
+    this->wquantized = true;
+  }
+  // quantize transposed inputs, so that each column is a contiguous row
+  intg n = inx.dim(1);
+  if (qin.order() != 2 || qin.dim(0) != n || qin.dim(1) != inx.dim(0))
+    qin = idx<byte>(n, inx.dim(0));
+  T s = this->input_scale(inx);
+  idx<T> inxt = inx.transpose(0, 1);
+  idx_quantize_s8(inxt, qin, s);
+  // (n x out) products, one weights row per column, rescaled by the input
+  // scale while accumulating, then by each weights row scale
+  if (tmp.order() != 2 || tmp.dim(0) != n || tmp.dim(1) != qw.dim(0))
+    tmp = idx<T>(n, qw.dim(0));
+  if (inscale.order() != 1 || inscale.dim(0) != n)
+    inscale = idx<float32>(n);
+  idx_fill(inscale, (float32) s);
+  idx_clear(tmp);
+  idx_gemm_s8(qin, qw, tmp, inscale);
+  idx<T> tmpt = tmp.transpose(0, 1);
+  idx_copy(tmpt, outx);
+  idx_bloop2(o, outx, T, ws, wscale, float32) {
+    T sc = (T) ws.get();
+    idx_dotc(o, sc, o);
+  }
+}
+
+template <typename T>
+void linear_int8_module<T>::bprop1(state<T> &in, state<T> &out) {
+  eblerror("int8 module " << this->name() << " is for inference only");
+}
+
+template <typename T>
+void linear_int8_module<T>::bbprop1(state<T> &in, state<T> &out) {
+  eblerror("int8 module " << this->name() << " is for inference only");
+}
+
+template <typename T>
+void linear_int8_module<T>::forget(forget_param_linear &fp) {
+  linear_module<T>::forget(fp);
+  this->requantize();
+}
+
+template <typename T>
+void linear_int8_module<T>::load_x(idx<T> &weights) {
+  linear_module<T>::load_x(weights);
+  this->requantize();
+}
+
+template <typename T>
+module_1_1<T>* linear_int8_module<T>::copy(parameter<T> *p) {
+  linear_int8_module<T> *l2 = new linear_int8_module<T>
+    (p, this->w.dim(1), this->w.dim(0), this->range, this->name());
+  // assign same parameter state if no parameters were specified
+  if (!p) l2->w = this->w;
+  return (module_1_1<T>*) l2;
+}
+
+template <typename T>
+std::string linear_int8_module<T>::describe() {
+  std::string desc = linear_module<T>::describe();
+  desc << " with int8 products and ";
+  if (this->range > 0) desc << "input range " << this->range;
+  else desc << "dynamic input range";
+  return desc;
+}
+
+// convolution_int8_module /////////////////////////////////////////////////////
+
+template <typename T>
+convolution_int8_module<T>::
+convolution_int8_module(parameter<T> *p, idxdim &ker_, idxdim &stride_,
+			idx<intg> &table_, float range_, const char *name_,
+			bool crop_)
+  : convolution_module<T>(p, ker_, stride_, table_, name_, crop_),
+    int8_quantizer<T>(range_) {
+  engine.init(this->table, ker_.dim(0), ker_.dim(1));
+}
+
+template <typename T>
+convolution_int8_module<T>::~convolution_int8_module() {
+}
+
+template <typename T>
+void convolution_int8_module<T>::fprop1(idx<T> &in, idx<T> &out) {
+  if (this->calibrating()) { // record inputs and compute in floating point
+    this->observe(in);
+    convolution_module<T>::fprop1(in, out);
+    return ;
+  }
+  if (!this->resize_output(in, out))
+    return ; // do nothing if resizing failed
+  // temporarly crop input if mismatch in size
+  intg ki = this->kernel.dim(1), kj = this->kernel.dim(2);
+  intg si = this->stride.dim(0), sj = this->stride.dim(1);
+  intg oi = in.dim(1) - (ki - si), oj = in.dim(2) - (kj - sj);
+  idx<T> inc = in;
+  if (this->crop && oi % si != 0)
+    inc = inc.narrow(1, inc.dim(1) - oi % si, 0);
+  if (this->crop && oj % sj != 0)
+    inc = inc.narrow(2, inc.dim(2) - oj % sj, 0);
+  if (!conv_gemm<T>::usable(inc, out)) { // floating point fallback
+    convolution_module<T>::fprop1(in, out);
+    return ;
+  }
+  if (!this->wquantized) {
+    engine.set_weights(this->kernel);
+    this->wquantized = true;
+  }
+  idx_clear(out);
+  engine.fprop(inc, this->input_scale(inc), out, si, sj);
+}
+
+template <typename T>
+void convolution_int8_module<T>::bprop1(state<T> &in, state<T> &out) {
+  eblerror("int8 module " << this->name() << " is for inference only");
+}
+
+template <typename T>
+void convolution_int8_module<T>::bbprop1(state<T> &in, state<T> &out) {
+  eblerror("int8 module " << this->name() << " is for inference only");
+}
+
+template <typename T>
+void convolution_int8_module<T>::forget(forget_param_linear &fp) {
+  convolution_module<T>::forget(fp);
+  this->requantize();
+}
+
+template <typename T>
+void convolution_int8_module<T>::load_x(idx<T> &weights) {
+  convolution_module<T>::load_x(weights);
+  this->requantize();
+}
+
+template <typename T>
+module_1_1<T>* convolution_int8_module<T>::copy(parameter<T> *p) {
+  convolution_int8_module<T> *l2 = new convolution_int8_module<T>
+    (p, this->ker, this->stride, this->table, this->range, this->name(),
+     this->crop);
+  // assign same parameter state if no parameters were specified
+  if (!p) l2->kernel = this->kernel;
+  return (module_1_1<T>*) l2;
+}
+
+template <typename T>
+std::string convolution_int8_module<T>::describe() {
+  std::string desc = convolution_module<T>::describe();
+  desc << " with int8 products and ";
+  if (this->range > 0) desc << "input range " << this->range;
+  else desc << "dynamic input range";
+  return desc;
+}
+
+// utilities ///////////////////////////////////////////////////////////////////
+
+template <typename T>
+void find_int8_modules(module_1_1<T> &m, std::vector<module_1_1<T>*> &found) {
+  if (dynamic_cast<int8_quantizer<T>*>(&m))
+    found.push_back(&m);
+  layers<T> *l = dynamic_cast<layers<T>*>(&m);
+  if (l)
+    for (uint i = 0; i < l->modules.size(); ++i)
+      find_int8_modules(*l->modules[i], found);
+}
+
+} // end namespace ebl
@@ -293,6 +293,25 @@ template <typename T> class state : public idx<T> {
   //! and pad areas that do not overlap, then puts result in multi-idx 'all'.
   virtual void get_padded_midx(mfidxdim &regions, midx<T> &all);
 
+  // half precision storage ////////////////////////////////////////////////////
+
+  //! Stores the data of the storages of forward tensors in float16 and
+  //! releases their memory in type T, e.g. to keep feature maps or weights
+  //! in half the memory while they are not used. All idx on these storages
+  //! (views, module weights on a parameter) keep their geometry but must
+  //! not be accessed until unpack_half() is called. Backward tensors are
+  //! not changed.
+  virtual void pack_half();
+  //! Reallocates the storages released by pack_half() and, if 'restore' is
+  //! true, converts their float16 data back to T. Otherwise their content
+  //! is undefined, e.g. for buffers about to be overwritten.
+  virtual void unpack_half(bool restore = true);
+  //! Returns true if forward tensors are stored in float16 (see pack_half()).
+  virtual bool packed_half();
+  //! Returns true if a forward tensor of this state and one of 's' share
+  //! the same storage.
+  virtual bool shares_x_storage(state<T> &s);
+
   // info printing /////////////////////////////////////////////////////////////
 
   //! Prints a string describing internal tensors.
@@ -350,6 +369,8 @@ template <typename T> class state : public idx<T> {
   svector<idx<T> > ddx; //!< 2nd order backward tensors.
  private:
   bool forward_only;
+  std::vector<idx<T> > halfsrc; //!< Tensors whose storage is packed.
+  std::vector<idx<float16> > halfx; //!< Packed data of each storage.
 };
 
 // state operations //////////////////////////////////////////////////////////
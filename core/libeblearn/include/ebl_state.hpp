@@ -213,6 +213,8 @@ template<typename T>
 state<T> & state<T>::operator=(const state<T> &s) {
   forward_only = s.forward_only;
   x.clear();
+  dx.clear();
+  ddx.clear();
   // forward
   for (uint i = 0; i < s.x.size(); ++i)
     if (s.x.exists(i)) add_x_new(s.x.at_const(i));
@@ -688,6 +690,59 @@ void state<T>::get_padded_midx(mfidxdim &dims, midx<T> &all) {
   }
 }
 
+// half precision storage ////////////////////////////////////////////////////
+
+template <typename T>
+void state<T>::pack_half() {
+  if (packed_half()) return ;
+  for (uint i = 0; i < x.size(); ++i) {
+    srg<T> *s = x[i].getstorage();
+    if (s->size() == 0) continue ;
+    uint j;
+    for (j = 0; j < halfsrc.size(); ++j) // storage already packed
+      if (halfsrc[j].getstorage() == s) break ;
+    if (j < halfsrc.size()) continue ;
+    idx<T> all(s, 0, s->size());
+    idx<float16> h(s->size());
+    idx_copy(all, h);
+    halfsrc.push_back(x[i]);
+    halfx.push_back(h);
+  }
+  // release memory once all storages are converted
+  for (uint i = 0; i < halfsrc.size(); ++i)
+    halfsrc[i].getstorage()->changesize(0);
+}
+
+template <typename T>
+void state<T>::unpack_half(bool restore) {
+  for (uint i = 0; i < halfsrc.size(); ++i) {
+    srg<T> *s = halfsrc[i].getstorage();
+    intg n = halfx[i].nelements();
+    if (s->changesize(n) < 0)
+      eblerror("failed to reallocate " << n << " elements");
+    if (restore) {
+      idx<T> all(s, 0, n);
+      idx_copy(halfx[i], all);
+    }
+  }
+  halfsrc.clear();
+  halfx.clear();
+}
+
+template <typename T>
+bool state<T>::packed_half() {
+  return !halfsrc.empty();
+}
+
+template <typename T>
+bool state<T>::shares_x_storage(state<T> &s) {
+  for (uint i = 0; i < x.size(); ++i)
+    for (uint j = 0; j < s.x.size(); ++j)
+      if (x[i].getstorage() == s.x[j].getstorage())
+	return true;
+  return false;
+}
+
 // info printing methods /////////////////////////////////////////////////////
 
 template <typename T>
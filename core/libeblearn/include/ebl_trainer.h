@@ -95,10 +95,11 @@ class supervised_trainer {
   //! \param hessian_period Recompute 2nd order derivatives at every
   //!   'hessian_period' samples if > 0.
   //! \param nhessian Estimate 2nd order derivatives on 'nhessian' samples.
-  void train(labeled_datasource<T, Tdata, Tlabel> &ds,
-             classifier_meter &log, gd_param &args, int niter,
-             infer_param &infp,
-             intg hessian_period = 0, intg nhessian = 0, double mu = .02);
+  virtual void train(labeled_datasource<T, Tdata, Tlabel> &ds,
+                     classifier_meter &log, gd_param &args, int niter,
+                     infer_param &infp,
+                     intg hessian_period = 0, intg nhessian = 0,
+                     double mu = .02);
   //! compute hessian
   void compute_diaghessian(labeled_datasource<T, Tdata, Tlabel> &ds,
                            intg niter, double mu);
@@ -110,6 +111,10 @@ class supervised_trainer {
   void set_iteration(int i);
   //! Set the modulo at which test results are displayed (0 by default).
   void set_test_display_modulo(intg modulo);
+  //! Set the number of samples propagated together by train() before each
+  //! update of the parameters (1 by default). Each update uses the
+  //! average gradient of the samples of the batch.
+  void set_batch_size(uint n);
   //! pretty some information about training, e.g. input and network sizes.
   void pretty(labeled_datasource<T, Tdata, Tlabel> &ds);
   //! Sets the name of the file indicating progress of training.
@@ -124,6 +129,8 @@ class supervised_trainer {
 
   // template <class Tdata, class Tlabel> friend class supervised_trainer_gui;
   template <class T1, class T2, class T3> friend class supervised_trainer_gui;
+  template <class T1, class T2, class T3> friend class hogwild_trainer;
+  template <class T1, class T2, class T3> friend class hogwild_thread;
 
   // internal methods ////////////////////////////////////////////////////////
  protected:
@@ -133,6 +140,29 @@ class supervised_trainer {
   //! unless new_iteration is false.
   void init(labeled_datasource<T, Tdata, Tlabel> &ds,
             classifier_meter *log = NULL, bool new_iteration = false);
+  //! Normalizes the samples probabilities of 'ds' at the end of a training
+  //! epoch and reports the epoch's count, time 't' and running test.
+  void end_epoch(labeled_datasource<T, Tdata, Tlabel> &ds,
+                 classifier_meter &log, timer &t);
+  //! Trains on the next 'batch_size' samples of 'ds' (or less at the end
+  //! of the epoch) with a single update of the parameters, then updates
+  //! 'log' and the energies of 'ds' for each sample. 'selected' tells if
+  //! current sample was selected for training and is updated for the sample
+  //! following the batch.
+  void train_batch(labeled_datasource<T, Tdata, Tlabel> &ds,
+                   classifier_meter &log, gd_param &args, bool &selected);
+  //! Copies the next 'batch_size' samples of 'ds' (or less at the end of the
+  //! epoch) into the batch buffers and returns their number.
+  //! 'selected' tells if current sample was selected for training and is
+  //! updated for the sample following the batch.
+  uint gather_batch(labeled_datasource<T, Tdata, Tlabel> &ds, bool &selected);
+  //! Propagates the 'n' gathered samples and updates the parameters once
+  //! with the average gradient of the selected ones, then computes answers.
+  void learn_batch(uint n, gd_param &args);
+  //! Updates 'log' and the energies of 'ds' for each of the 'n' samples of
+  //! the last batch, increments age and anneals the learning rate.
+  void record_batch(labeled_datasource<T, Tdata, Tlabel> &ds,
+                    classifier_meter &log, uint n, gd_param &args);
 
   // members /////////////////////////////////////////////////////////////////
  protected:
@@ -150,6 +180,12 @@ class supervised_trainer {
   bool            test_running;         //!< Show test on trained.
   intg            test_display_modulo;  //!< Modulo at which to display.
 	bool            silent;
+  uint            batch_size;           //!< Number of samples per update.
+  state<T>        batch_energy;         //!< Energies of a batch.
+  state<T>        batch_labels;         //!< Labels of a batch.
+  state<T>        batch_targets;        //!< Targets of a batch.
+  std::vector<intg> batch_indices;      //!< Samples indices of a batch.
+  std::vector<bool> batch_selected;     //!< Samples selected for training.
 };
 
 } // namespace ebl {
@@ -43,7 +43,8 @@ supervised_trainer(trainable_module<T,Tdata,Tlabel> &m, ddparameter<T> &p,
 									 bool silent_)
     : machine(m), param(p), energy(), answers(NULL), label(NULL), age(0),
       iteration(-1), iteration_ptr(NULL), prettied(false), progress_cnt(0),
-      test_running(false), test_display_modulo(0), silent(silent_) {
+      test_running(false), test_display_modulo(0), silent(silent_),
+      batch_size(1) {
   energy.resize_dx();
   energy.resize_ddx();
   energy.dx[0].set(1.0); // d(E)/dE is always 1
@@ -169,6 +170,11 @@ train(labeled_datasource<T, Tdata, Tlabel> &ds, classifier_meter &log,
       if (hessian_period > 0 && nhessian > 0 &&
           ds.get_epoch_count() % hessian_period == 0)
         compute_diaghessian(ds, nhessian, mu);
+      // propagate several samples per update
+      if (batch_size > 1) {
+        train_batch(ds, log, gdp, selected);
+        continue ;
+      }
       // get label
       ds.fprop_label_net(*label);
       if (selected) // selected for training
@@ -194,20 +200,102 @@ train(labeled_datasource<T, Tdata, Tlabel> &ds, classifier_meter &log,
       }
       update_progress(); // tell the outside world we're still running
     }
-    ds.normalize_all_probas();
-    eblprint( "epoch_count=" << ds.get_epoch_count() << std::endl);
-    eblprint( "training_time="; t.pretty_elapsed());
+    end_epoch(ds, log, t);
+  }
+}
+
+template <typename T, typename Tdata, typename Tlabel>
+void supervised_trainer<T,Tdata,Tlabel>::
+end_epoch(labeled_datasource<T,Tdata,Tlabel> &ds, classifier_meter &log,
+          timer &t) {
+  ds.normalize_all_probas();
+  eblprint( "epoch_count=" << ds.get_epoch_count() << std::endl);
+  eblprint( "training_time="; t.pretty_elapsed());
+  eblprint( std::endl);
+  // report accuracy on trained sample
+  if (test_running) {
+    if (!silent) eblprint( "Training running test:" << std::endl);
+    // TODO: simplify this
+    class_datasource<T,Tdata,Tlabel> *cds =
+	dynamic_cast<class_datasource<T,Tdata,Tlabel>*>(&ds);
+    log.display(iteration, ds.name(), cds ? cds->lblstr : NULL,
+                ds.is_test());
     eblprint( std::endl);
-    // report accuracy on trained sample
-    if (test_running) {
-      if (!silent) eblprint( "Training running test:" << std::endl);
-      // TODO: simplify this
-      class_datasource<T,Tdata,Tlabel> *cds =
-	  dynamic_cast<class_datasource<T,Tdata,Tlabel>*>(&ds);
-      log.display(iteration, ds.name(), cds ? cds->lblstr : NULL,
-                  ds.is_test());
-      eblprint( std::endl);
+  }
+}
+
+template <typename T, typename Tdata, typename Tlabel>
+void supervised_trainer<T,Tdata,Tlabel>::
+train_batch(labeled_datasource<T,Tdata,Tlabel> &ds, classifier_meter &log,
+            gd_param &gdp, bool &selected) {
+  uint n = gather_batch(ds, selected);
+  learn_batch(n, gdp);
+  record_batch(ds, log, n, gdp);
+}
+
+template <typename T, typename Tdata, typename Tlabel>
+uint supervised_trainer<T,Tdata,Tlabel>::
+gather_batch(labeled_datasource<T,Tdata,Tlabel> &ds, bool &selected) {
+  // gather samples, their labels and targets
+  uint n = 0;
+  batch_indices.resize(batch_size);
+  batch_selected.resize(batch_indices.size());
+  do {
+    ds.fprop_label_net(*label);
+    machine.fprop_batch_sample(ds, n);
+    machine.batch_copy(*label, batch_labels, n);
+    state<T> target(machine.compute_targets(ds));
+    machine.batch_copy(target, batch_targets, n);
+    batch_indices[n] = ds.get_current_index();
+    batch_selected[n] = selected;
+    n++;
+    // select next sample
+    selected = ds.next_train();
+    ds.pretty_progress();
+  } while (n < batch_size && !ds.epoch_done());
+  return n;
+}
+
+template <typename T, typename Tdata, typename Tlabel>
+void supervised_trainer<T,Tdata,Tlabel>::learn_batch(uint n, gd_param &gdp) {
+  uint nselected = 0;
+  for (uint i = 0; i < n; ++i)
+    if (batch_selected[i]) nselected++;
+  // propagate all samples at once, non-selected samples are only tested
+  machine.fprop_batch(n, batch_energy);
+  if (nselected > 0) {
+    batch_energy.resize_dx();
+    for (uint i = 0; i < n; ++i) // average gradient of selected samples
+      batch_energy.dx[i].set(batch_selected[i] ? 1 / (T) nselected : 0);
+    param.zero_dx();
+    machine.bprop_batch(batch_energy);
+    param.update(gdp);
+  }
+  // answers are computed here as they only depend on this trainer
+  machine.compute_answers(*answers);
+}
+
+template <typename T, typename Tdata, typename Tlabel>
+void supervised_trainer<T,Tdata,Tlabel>::
+record_batch(labeled_datasource<T,Tdata,Tlabel> &ds, classifier_meter &log,
+             uint n, gd_param &gdp) {
+  for (uint i = 0; i < n; ++i) {
+    state<T> ans = answers->get_x(i), lab = batch_labels.get_x(i);
+    idx<T> e = batch_energy.x[i], raw = machine.out1.x[i];
+    idx<T> target = batch_targets.x[i];
+    bool correct = machine.correct(ans, lab);
+    machine.update_log(log, age, e, ans, lab, target, raw);
+    // use energy and answer as distance for samples probabilities
+    ds.set_sample_energy((double) e.get(), correct, raw, ans, target,
+                         batch_indices[i]);
+    age++;
+    // decrease learning rate if specified
+    if (gdp.anneal_period > 0 && ((age - 1) % gdp.anneal_period) == 0) {
+      gdp.eta = gdp.eta /
+          (1 + ((age / gdp.anneal_period) * gdp.anneal_value));
+      eblprint( "age: " << age << " updated eta=" << gdp.eta << std::endl);
     }
+    update_progress(); // tell the outside world we're still running
   }
 }
 
@@ -259,6 +347,14 @@ void supervised_trainer<T, Tdata, Tlabel>::set_test_display_modulo(intg mod) {
   test_display_modulo = mod;
 }
 
+template <typename T, typename Tdata, typename Tlabel>
+void supervised_trainer<T, Tdata, Tlabel>::set_batch_size(uint n) {
+  if (n == 0) eblerror("batch size must be at least 1");
+  batch_size = n;
+  if (!silent) eblprint( "Training with batches of " << n << " samples"
+                         << std::endl);
+}
+
 template <typename T, typename Tdata, typename Tlabel>
 void supervised_trainer<T, Tdata, Tlabel>::
 pretty(labeled_datasource<T, Tdata, Tlabel> &ds) {
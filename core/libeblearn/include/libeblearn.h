@@ -53,6 +53,7 @@
 #include "ebl_parameters.h"
 #include "ebl_pooling.h"
 #include "ebl_preprocessing.h"
+#include "ebl_quantization.h"
 #include "ebl_state.h"
 #include "ebl_utils.h"
 #include "libidx.h"
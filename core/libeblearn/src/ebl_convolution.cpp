@@ -0,0 +1,190 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#include <map>
+#include "ebl_convolution.h"
+
+// minimum number of connections per input and output map to use Winograd
+// convolutions, whose transforms are shared by all connections of a map
+#define CONV_WINOGRAD_MINRATIO 16
+// minimum kernel size and connections per map to use fft convolutions
+#define CONV_FFT_MINKERNEL 7
+#define CONV_FFT_MINRATIO 1
+
+namespace ebl {
+
+// conv_algorithm //////////////////////////////////////////////////////////////
+
+static const char *conv_algorithm_names[] =
+  { "default", "unfold", "gemm", "winograd", "fft", "separable" };
+#define CONV_NALGORITHMS 6
+
+const char* conv_algorithm_name(conv_algorithm a) {
+  if ((int) a < 0 || (int) a >= CONV_NALGORITHMS) return "unknown";
+  return conv_algorithm_names[(int) a];
+}
+
+conv_algorithm string_to_conv_algorithm(const std::string &s) {
+  for (int i = 0; i < CONV_NALGORITHMS; ++i)
+    if (!s.compare(conv_algorithm_names[i]))
+      return (conv_algorithm) i;
+  eblthrow("unknown convolution algorithm \"" << s << "\"");
+  return CONV_DEFAULT;
+}
+
+conv_algorithm conv_choose_algorithm(intg ki, intg kj, intg si, intg sj,
+				     intg nin, intg nout, intg nconn,
+				     intg oh, intg ow) {
+  if (si != 1 || sj != 1) return CONV_GEMM;
+  intg nmaps = nin + nout;
+  if (ki == 3 && kj == 3 && oh >= 4 && ow >= 4
+      && nconn >= CONV_WINOGRAD_MINRATIO * nmaps)
+    return CONV_WINOGRAD;
+  if (ki >= CONV_FFT_MINKERNEL && kj >= CONV_FFT_MINKERNEL
+      && nconn >= CONV_FFT_MINRATIO * nmaps)
+    return CONV_FFT;
+  return CONV_GEMM;
+}
+
+// conv_winograd_transforms ////////////////////////////////////////////////////
+
+// F(2x2, 3x3)
+static const double winograd2_bt[] = {
+  1,  0, -1,  0,
+  0,  1,  1,  0,
+  0, -1,  1,  0,
+  0,  1,  0, -1 };
+static const double winograd2_g[] = {
+  1,    0,   0,
+  .5,  .5,  .5,
+  .5, -.5,  .5,
+  0,    0,   1 };
+static const double winograd2_at[] = {
+  1, 1,  1,  0,
+  0, 1, -1, -1 };
+
+// F(4x4, 3x3)
+static const double winograd4_bt[] = {
+  4,  0, -5,  0, 1, 0,
+  0, -4, -4,  1, 1, 0,
+  0,  4, -4, -1, 1, 0,
+  0, -2, -1,  2, 1, 0,
+  0,  2, -1, -2, 1, 0,
+  0,  4,  0, -5, 0, 1 };
+static const double winograd4_g[] = {
+  1 / 4.0,         0,         0,
+  -1 / 6.0, -1 / 6.0,  -1 / 6.0,
+  -1 / 6.0,  1 / 6.0,  -1 / 6.0,
+  1 / 24.0,  1 / 12.0,  1 / 6.0,
+  1 / 24.0, -1 / 12.0,  1 / 6.0,
+  0,               0,         1 };
+static const double winograd4_at[] = {
+  1, 1,  1, 1,  1, 0,
+  0, 1, -1, 2, -2, 0,
+  0, 1,  1, 4,  4, 0,
+  0, 1, -1, 8, -8, 1 };
+
+void conv_winograd_transforms(intg m, const double *&bt, const double *&g,
+			      const double *&at) {
+  switch (m) {
+  case 2: bt = winograd2_bt; g = winograd2_g; at = winograd2_at; break ;
+  case 4: bt = winograd4_bt; g = winograd4_g; at = winograd4_at; break ;
+  default: eblerror("no Winograd transforms for tiles of size " << m);
+  }
+}
+
+// conv_table_groups ///////////////////////////////////////////////////////////
+
+intg conv_table_groups(idx<intg> &table, intg kersize,
+		       std::vector<conv_group> &groups) {
+  groups.clear();
+  if (table.dim(0) == 0) return 0;
+  idx<intg> tin = table.select(1, 0), tout = table.select(1, 1);
+  intg nin = idx_max(tin) + 1, nout = idx_max(tout) + 1;
+  // entry of each (input, output) connection, -1 if not connected. A
+  // connection repeated in the table goes to the next layer of 'conns', whose
+  // groups are separate, so that all engines sum the duplicate entries.
+  std::vector<idx<intg> > conns;
+  for (intg e = 0; e < table.dim(0); ++e) {
+    intg i = table.get(e, 0), o = table.get(e, 1);
+    uint l = 0;
+    while (l < conns.size() && conns[l].get(i, o) >= 0) ++l;
+    if (l == conns.size()) {
+      conns.push_back(idx<intg>(nin, nout));
+      idx_fill(conns.back(), (intg) -1);
+    }
+    conns[l].set(e, i, o);
+  }
+  // group inputs of each layer by identical sets of outputs
+  std::vector<std::vector<intg> > ins, outs;
+  std::vector<uint> layers;
+  for (uint l = 0; l < conns.size(); ++l) {
+    idx<intg> &conn = conns[l];
+    std::map<std::vector<intg>, uint> sets;
+    for (intg i = 0; i < nin; ++i) {
+      std::vector<intg> o;
+      for (intg j = 0; j < nout; ++j)
+	if (conn.get(i, j) >= 0) o.push_back(j);
+      if (o.empty()) continue ; // input not used
+      std::map<std::vector<intg>, uint>::iterator it = sets.find(o);
+      if (it == sets.end()) {
+	sets[o] = ins.size();
+	ins.push_back(std::vector<intg>(1, i));
+	outs.push_back(o);
+	layers.push_back(l);
+      } else
+	ins[it->second].push_back(i);
+    }
+  }
+  // create groups
+  intg row = 0;
+  for (uint g = 0; g < ins.size(); ++g) {
+    conv_group gr;
+    intg ni = ins[g].size(), no = outs[g].size();
+    gr.inputs = idx<intg>(ni);
+    gr.outputs = idx<intg>(no);
+    gr.entries = idx<intg>(no, ni);
+    for (intg i = 0; i < ni; ++i) gr.inputs.set(ins[g][i], i);
+    for (intg o = 0; o < no; ++o) gr.outputs.set(outs[g][o], o);
+    idx<intg> &conn = conns[layers[g]];
+    for (intg o = 0; o < no; ++o)
+      for (intg i = 0; i < ni; ++i)
+	gr.entries.set(conn.get(ins[g][i], outs[g][o]), o, i);
+    gr.contiguous_outputs = (outs[g][no - 1] - outs[g][0] == no - 1);
+    gr.row = row;
+    row += ni * kersize;
+    groups.push_back(gr);
+  }
+  return row;
+}
+
+} // namespace ebl
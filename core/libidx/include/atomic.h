@@ -0,0 +1,91 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef ATOMIC_H_
+#define ATOMIC_H_
+
+#include "defines.h"
+
+#ifdef __WINDOWS__
+#include <intrin.h>
+#endif
+
+// use __atomic builtins when available (gcc >= 4.7, clang),
+// otherwise fall back on the older full-barrier __sync builtins.
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || \
+  (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define __ATOMIC_BUILTINS__
+#endif
+
+namespace ebl {
+
+// atomic operations ///////////////////////////////////////////////////////////
+
+//! Atomically adds 'n' to '*v' and returns the new value, without imposing
+//! any ordering on surrounding memory operations (relaxed).
+//! T must be the size of an int or a long.
+template <typename T> inline T atomic_add_relaxed(T *v, T n) {
+#if defined(__WINDOWS__)
+  return (T) _InterlockedExchangeAdd((volatile long*) v, (long) n) + n;
+#elif defined(__ATOMIC_BUILTINS__)
+  return __atomic_add_fetch(v, n, __ATOMIC_RELAXED);
+#else
+  return __sync_add_and_fetch(v, n);
+#endif
+}
+
+//! Atomically adds 'n' to '*v' and returns the new value. Memory operations
+//! before this call are visible to a thread observing the result, and
+//! memory operations after it cannot be moved before it (acquire-release).
+//! T must be the size of an int or a long.
+template <typename T> inline T atomic_add_acq_rel(T *v, T n) {
+#if defined(__WINDOWS__)
+  return (T) _InterlockedExchangeAdd((volatile long*) v, (long) n) + n;
+#elif defined(__ATOMIC_BUILTINS__)
+  return __atomic_add_fetch(v, n, __ATOMIC_ACQ_REL);
+#else
+  return __sync_add_and_fetch(v, n);
+#endif
+}
+
+//! Returns the value of '*v', written concurrently by other threads.
+template <typename T> inline T atomic_load_relaxed(T *v) {
+#if defined(__ATOMIC_BUILTINS__) && !defined(__WINDOWS__)
+  return __atomic_load_n(v, __ATOMIC_RELAXED);
+#else
+  return *((volatile T*) v);
+#endif
+}
+
+} // end namespace ebl
+
+#endif /* ATOMIC_H_ */
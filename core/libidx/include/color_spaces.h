@@ -59,6 +59,10 @@ namespace ebl {
   template<class T>
     void rgb_to_yuv_1D(idx<T> &rgb, idx<T> &yuv);
 
+  //! RGB to YUV, on a single pixel view, used by the image loops.
+  template<class T>
+    void rgb_to_yuv_1D(idx_view<T,1> rgb, idx_view<T,1> yuv);
+
   //! Same as yuv_to_rgb with 2 arguments except that it allocates a target
   //! image and returns it.
   template<class T>
@@ -75,6 +79,10 @@ namespace ebl {
   template<class T>
     void rgb_to_y_1D(idx<T> &rgb, idx<T> &y);
 
+  //! RGB to Y, on a single pixel view, used by the image loops.
+  template<class T>
+    void rgb_to_y_1D(idx_view<T,1> rgb, idx_view<T,1> y);
+
   ////////////////////////////////////////////////////////////////
   // BGR -> YUV
 
@@ -218,6 +226,93 @@ namespace ebl {
   template<class T>
     void rgb_to_vph2sv(idx<T> &rgb, idx<T> &vph2sv, double s, int n);
 
+  ////////////////////////////////////////////////////////////////
+  // Whole-image conversions
+  // These convert all pixels of an image at once, walking rows through
+  // pointers instead of per-pixel views. Planar images have their channels
+  // in dimension 0 (e.g. 3xHxW, as used by the preprocessing modules),
+  // interleaved images in their last dimension (e.g. HxWx3, as returned by
+  // load_image). Input and output types may differ, so that ubyte images
+  // can be converted and cast to float in a single pass. float32 outputs
+  // use the simd kernels when available (single precision math), other
+  // outputs are computed in double precision like the per-pixel versions.
+  // Single-channel outputs may also be 2D (HxW).
+
+  //! Affine coefficients of RGB to YUV, 4 per output channel (see
+  //! simd_color_affine()).
+  extern const double rgb_yuv_affine[12];
+  //! Affine coefficients of RGB to Y.
+  extern const double rgb_y_affine[4];
+
+  //! Planar RGB to YUV.
+  template <typename Tin, typename Tout>
+    void rgb_to_yuv_planar(idx<Tin> &rgb, idx<Tout> &yuv);
+  //! Interleaved RGB to YUV.
+  template <typename Tin, typename Tout>
+    void rgb_to_yuv_interleaved(idx<Tin> &rgb, idx<Tout> &yuv);
+  //! Planar RGB to Y.
+  template <typename Tin, typename Tout>
+    void rgb_to_y_planar(idx<Tin> &rgb, idx<Tout> &y);
+  //! Interleaved RGB to Y.
+  template <typename Tin, typename Tout>
+    void rgb_to_y_interleaved(idx<Tin> &rgb, idx<Tout> &y);
+  //! Planar BGR to YUV.
+  template <typename Tin, typename Tout>
+    void bgr_to_yuv_planar(idx<Tin> &bgr, idx<Tout> &yuv);
+  //! Interleaved BGR to YUV.
+  template <typename Tin, typename Tout>
+    void bgr_to_yuv_interleaved(idx<Tin> &bgr, idx<Tout> &yuv);
+  //! Planar BGR to Y.
+  template <typename Tin, typename Tout>
+    void bgr_to_y_planar(idx<Tin> &bgr, idx<Tout> &y);
+  //! Interleaved BGR to Y.
+  template <typename Tin, typename Tout>
+    void bgr_to_y_interleaved(idx<Tin> &bgr, idx<Tout> &y);
+  //! Planar RGB to HSV.
+  template <typename Tin, typename Tout>
+    void rgb_to_hsv_planar(idx<Tin> &rgb, idx<Tout> &hsv);
+  //! Interleaved RGB to HSV.
+  template <typename Tin, typename Tout>
+    void rgb_to_hsv_interleaved(idx<Tin> &rgb, idx<Tout> &hsv);
+  //! Planar RGB to H.
+  template <typename Tin, typename Tout>
+    void rgb_to_h_planar(idx<Tin> &rgb, idx<Tout> &h);
+  //! Interleaved RGB to H.
+  template <typename Tin, typename Tout>
+    void rgb_to_h_interleaved(idx<Tin> &rgb, idx<Tout> &h);
+
+  // internal helpers /////////////////////////////////////////////////////////
+
+  //! Applies affine transform 'm' (see simd_color_affine()) to 'n' pixels of
+  //! channels c0, c1, c2 spaced by 'is' elements, writing 'nout' channels
+  //! o0, o1, o2 spaced by 'os' elements.
+  template <typename Tin, typename Tout>
+    void color_affine_row(const Tin *c0, const Tin *c1, const Tin *c2,
+			  intg is, Tout *o0, Tout *o1, Tout *o2, intg os,
+			  int nout, intg n, const double *m);
+  //! float32 version of color_affine_row, using the simd kernels.
+  EXPORT void color_affine_row(const float32 *c0, const float32 *c1,
+			       const float32 *c2, intg is, float32 *o0,
+			       float32 *o1, float32 *o2, intg os, int nout,
+			       intg n, const double *m);
+  //! ubyte to float32 version of color_affine_row, using the simd kernels.
+  EXPORT void color_affine_row(const ubyte *c0, const ubyte *c1,
+			       const ubyte *c2, intg is, float32 *o0,
+			       float32 *o1, float32 *o2, intg os, int nout,
+			       intg n, const double *m);
+  //! Same as color_affine_row() for the HSV transform, or only H if 'nout'
+  //! is 1.
+  template <typename Tin, typename Tout>
+    void color_hsv_row(const Tin *c0, const Tin *c1, const Tin *c2,
+		       intg is, Tout *o0, Tout *o1, Tout *o2, intg os,
+		       int nout, intg n);
+  //! Converts all pixels of image 'in' into 'nout' channels of 'out', with
+  //! the affine transform 'm', or HSV if 'm' is NULL. 'order' gives the
+  //! input planes to use as channels c0, c1 and c2.
+  template <typename Tin, typename Tout>
+    void color_convert(idx<Tin> &in, idx<Tout> &out, bool planar,
+		       const int order[3], int nout, const double *m);
+
 } // end namespace ebl
 
 #include "color_spaces.hpp"
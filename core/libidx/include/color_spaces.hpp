@@ -55,6 +55,13 @@ namespace ebl {
     yuv.set((T) (( 0.615 * r - 0.515 * g - 0.100 * b + 157) * 0.81300), 2);
   }
 
+  template<class T> void rgb_to_yuv_1D(idx_view<T,1> rgb, idx_view<T,1> yuv) {
+    double r = rgb(0), g = rgb(1), b = rgb(2);
+    yuv(0) = (T) (  0.299 * r + 0.587 * g + 0.114 * b);
+    yuv(1) = (T) ((-0.147 * r - 0.289 * g + 0.437 * b + 111) * 1.14678);
+    yuv(2) = (T) (( 0.615 * r - 0.515 * g - 0.100 * b + 157) * 0.81300);
+  }
+
   template<class T> void rgb_to_yuv(idx<T> &rgb, idx<T> &yuv) {
     idx_checknelems2_all(rgb, yuv);
     switch (rgb.order()) {
@@ -63,12 +70,7 @@ namespace ebl {
       //      idx_m2dotm1(rgb_yuv, rgb, yuv);
       return ;
     case 3: // process 2D image
-      { idx_bloop2(rg, rgb, T, yu, yuv, T) {
-	  { idx_bloop2(r, rg, T, y, yu, T) {
-	      rgb_to_yuv_1D(r, y);
-	      //	      idx_m2dotm1(rgb_yuv, r, y);
-	    }}
-	}}
+      rgb_to_yuv_interleaved(rgb, yuv);
       return ;
     default:
       eblerror("rgb_to_yuv dimension not implemented");
@@ -89,6 +91,11 @@ namespace ebl {
     y.set(  (T) 0.299 * (T) r + (T) 0.587 * (T) g + (T) 0.114 * (T) b, 0);
   }
 
+  template<class T> void rgb_to_y_1D(idx_view<T,1> rgb, idx_view<T,1> y) {
+    T r = (T) rgb(0), g = (T) rgb(1), b = (T) rgb(2);
+    y(0) = (T) 0.299 * r + (T) 0.587 * g + (T) 0.114 * b;
+  }
+
   template<class T> void rgb_to_y(idx<T> &rgb, idx<T> &y) {
     switch (rgb.order()) {
     case 1: // process 1 pixel
@@ -96,12 +103,7 @@ namespace ebl {
       //      idx_m2dotm1(rgb_yuv, rgb, yuv);
       return ;
     case 3: // process 2D image
-      { idx_bloop2(rg, rgb, T, yy, y, T) {
-	  { idx_bloop2(r, rg, T, yyy, yy, T) {
-	      rgb_to_y_1D(r, yyy);
-	      //	      idx_m2dotm1(rgb_yuv, r, y);
-	    }}
-	}}
+      rgb_to_y_interleaved(rgb, y);
       return ;
     default:
       eblerror("rgb_to_y dimension not implemented");
@@ -154,11 +156,7 @@ namespace ebl {
       bgr_to_y_1D(bgr, y);
       return ;
     case 3: // process 2D image
-      { idx_bloop2(bg, bgr, T, yy, y, T) {
-	  { idx_bloop2(b, bg, T, yyy, yy, T) {
-	      rgb_to_y_1D(b, yyy);
-	    }}
-	}}
+      bgr_to_y_interleaved(bgr, y);
       return ;
     default:
       eblerror("bgr_to_y dimension not implemented");
@@ -191,6 +189,25 @@ namespace ebl {
                              (T) (1.0 * y + 1.772 * u + 0.00000 * v))), 2);
   }
 
+  template<class T> void yuv_to_rgb_1D(idx_view<T,1> yuv, idx_view<T,1> rgb) {
+    float y, u, v;
+    y = std::min((float) 255, std::max((float) 0, 
+                                       (float) ((float) 1.164383562 
+                                                * (yuv(0) - 16))));
+    u = std::min((float) 128, std::max((float) -127, 
+                             (float) ((float) 1.133928571 
+                                      * (yuv(1) - 128))));
+    v = std::min((float) 128, std::max((float) -127, 
+                             (float) ((float) 1.133928571 
+                                      * (yuv(2) - 128))));
+    rgb(0) = std::min((T) 255, std::max((T) 0, 
+                             (T) (1.0 * y + 0.00000 * u + 1.402 * v)));
+    rgb(1) = std::min((T) 255, std::max((T) 0, 
+                             (T) (1.0 * y - 0.344 * u - 0.714 * v)));
+    rgb(2) = std::min((T) 255, std::max((T) 0, 
+                             (T) (1.0 * y + 1.772 * u + 0.00000 * v)));
+  }
+
   template<class T> void yuv_to_rgb(idx<T> &yuv, idx<T> &rgb) {
     idx_checknelems2_all(rgb, yuv);
     switch (yuv.order()) {
@@ -199,12 +216,15 @@ namespace ebl {
       //idx_m2dotm1(yuv_rgb, yuv, rgb);
       return ;
     case 3: // process 2D image
-      { idx_bloop2(rg, rgb, T, yu, yuv, T) {
-	  { idx_bloop2(r, rg, T, y, yu, T) {
-	      yuv_to_rgb_1D(y, r);
-	      //idx_m2dotm1(yuv_rgb, y, r);
-	    }}
-	}}
+      { if (rgb.idx_ptr() == yuv.idx_ptr())
+	  eblerror("yuv_to_rgb: dst must be different than src");
+	idx_view<T,3> vrgb(rgb), vyuv(yuv);
+	view_bloop2(rg, vrgb, yu, vyuv) {
+	  view_bloop2(r, rg, y, yu) {
+	    yuv_to_rgb_1D(y, r);
+	  }
+	}
+      }
       return ;
     default:
       eblerror("yuv_to_rgb dimension not implemented");
@@ -261,12 +281,7 @@ namespace ebl {
       //      idx_m2dotm1(rgb_hsv, rgb, hsv);
       return ;
     case 3: // process 2D image
-      { idx_bloop2(rg, rgb, T, yu, hsv, T) {
-	  { idx_bloop2(r, rg, T, y, yu, T) {
-	      rgb_to_hsv_1D(r, y);
-	      //	      idx_m2dotm1(rgb_hsv, r, y);
-	    }}
-	}}
+      rgb_to_hsv_interleaved(rgb, hsv);
       return ;
     default:
       eblerror("rgb_to_hsv dimension not implemented");
@@ -569,6 +584,157 @@ namespace ebl {
     //    vph2sv = vph2sv.narrow(1, vph2sv.dim(1) - n + 1, floor(n / 2));
   }
 
+  ////////////////////////////////////////////////////////////////
+  // Whole-image conversions
+
+  //! Input planes order for rgb and bgr inputs.
+  static const int color_rgb_order[3] = { 0, 1, 2 };
+  static const int color_bgr_order[3] = { 2, 1, 0 };
+
+  template <typename Tin, typename Tout>
+  void color_affine_row(const Tin *c0, const Tin *c1, const Tin *c2, intg is,
+			Tout *o0, Tout *o1, Tout *o2, intg os, int nout,
+			intg n, const double *m) {
+    Tout *o[3] = { o0, o1, o2 };
+    for (intg i = 0; i < n; ++i) {
+      double a = (double) c0[i * is], b = (double) c1[i * is],
+	c = (double) c2[i * is];
+      for (int j = 0; j < nout; ++j)
+	o[j][i * os] = (Tout) (m[4 * j] * a + m[4 * j + 1] * b
+			       + m[4 * j + 2] * c + m[4 * j + 3]);
+    }
+  }
+
+  template <typename Tin, typename Tout>
+  void color_hsv_row(const Tin *c0, const Tin *c1, const Tin *c2, intg is,
+		     Tout *o0, Tout *o1, Tout *o2, intg os, int nout,
+		     intg n) {
+    double h, s, v;
+    for (intg i = 0; i < n; ++i) {
+      PIX_RGB_TO_HSV_COMMON((double) c0[i * is], (double) c1[i * is],
+			    (double) c2[i * is], h, s, v, false);
+      o0[i * os] = (Tout) h;
+      if (nout == 3) {
+	o1[i * os] = (Tout) s;
+	o2[i * os] = (Tout) v;
+      }
+    }
+  }
+
+  template <typename Tin, typename Tout>
+  void color_convert(idx<Tin> &in, idx<Tout> &out, bool planar,
+		     const int order[3], int nout, const double *m) {
+    int cd = planar ? 0 : 2; // channels dimension
+    if (in.order() != 3 || in.dim(cd) != 3)
+      eblerror("expected 3 channels in dimension " << cd << " but found: "
+	       << in);
+    if ((void*) in.idx_ptr() == (void*) out.idx_ptr())
+      eblerror("dst must be different than src");
+    int hd = planar ? 1 : 0, wd = hd + 1; // spatial dimensions
+    intg h = in.dim(hd), w = in.dim(wd);
+    intg irs = in.mod(hd), is = in.mod(wd), ors, os;
+    Tin *p[3];
+    for (int k = 0; k < 3; ++k)
+      p[k] = in.idx_ptr() + order[k] * in.mod(cd);
+    Tout *q[3];
+    if (out.order() == 2 && nout == 1) { // single channel without channel dim
+      if (out.dim(0) != h || out.dim(1) != w)
+	eblerror("expected " << h << "x" << w << " output but found: " << out);
+      ors = out.mod(0);
+      os = out.mod(1);
+      q[0] = q[1] = q[2] = out.idx_ptr();
+    } else {
+      if (out.order() != 3 || out.dim(cd) != nout || out.dim(hd) != h
+	  || out.dim(wd) != w)
+	eblerror("expected " << nout << " channels in dimension " << cd
+		 << " of a " << h << "x" << w << " output but found: " << out);
+      ors = out.mod(hd);
+      os = out.mod(wd);
+      for (int k = 0; k < 3; ++k)
+	q[k] = out.idx_ptr() + (k < nout ? k : 0) * out.mod(cd);
+    }
+    // process short contiguous rows as a single long row
+    if (w < 64 && irs == w * is && ors == w * os) {
+      w *= h;
+      h = 1;
+    }
+#ifdef __OPENMP__
+#pragma omp parallel for
+#endif
+    for (intg i = 0; i < h; ++i) {
+      if (m)
+	color_affine_row((const Tin*) p[0] + i * irs,
+			 (const Tin*) p[1] + i * irs,
+			 (const Tin*) p[2] + i * irs, is, q[0] + i * ors,
+			 q[1] + i * ors, q[2] + i * ors, os, nout, w, m);
+      else
+	color_hsv_row((const Tin*) p[0] + i * irs,
+		      (const Tin*) p[1] + i * irs,
+		      (const Tin*) p[2] + i * irs, is, q[0] + i * ors,
+		      q[1] + i * ors, q[2] + i * ors, os, nout, w);
+    }
+  }
+
+  template <typename Tin, typename Tout>
+  void rgb_to_yuv_planar(idx<Tin> &rgb, idx<Tout> &yuv) {
+    color_convert(rgb, yuv, true, color_rgb_order, 3, rgb_yuv_affine);
+  }
+
+  template <typename Tin, typename Tout>
+  void rgb_to_yuv_interleaved(idx<Tin> &rgb, idx<Tout> &yuv) {
+    color_convert(rgb, yuv, false, color_rgb_order, 3, rgb_yuv_affine);
+  }
+
+  template <typename Tin, typename Tout>
+  void rgb_to_y_planar(idx<Tin> &rgb, idx<Tout> &y) {
+    color_convert(rgb, y, true, color_rgb_order, 1, rgb_y_affine);
+  }
+
+  template <typename Tin, typename Tout>
+  void rgb_to_y_interleaved(idx<Tin> &rgb, idx<Tout> &y) {
+    color_convert(rgb, y, false, color_rgb_order, 1, rgb_y_affine);
+  }
+
+  template <typename Tin, typename Tout>
+  void bgr_to_yuv_planar(idx<Tin> &bgr, idx<Tout> &yuv) {
+    color_convert(bgr, yuv, true, color_bgr_order, 3, rgb_yuv_affine);
+  }
+
+  template <typename Tin, typename Tout>
+  void bgr_to_yuv_interleaved(idx<Tin> &bgr, idx<Tout> &yuv) {
+    color_convert(bgr, yuv, false, color_bgr_order, 3, rgb_yuv_affine);
+  }
+
+  template <typename Tin, typename Tout>
+  void bgr_to_y_planar(idx<Tin> &bgr, idx<Tout> &y) {
+    color_convert(bgr, y, true, color_bgr_order, 1, rgb_y_affine);
+  }
+
+  template <typename Tin, typename Tout>
+  void bgr_to_y_interleaved(idx<Tin> &bgr, idx<Tout> &y) {
+    color_convert(bgr, y, false, color_bgr_order, 1, rgb_y_affine);
+  }
+
+  template <typename Tin, typename Tout>
+  void rgb_to_hsv_planar(idx<Tin> &rgb, idx<Tout> &hsv) {
+    color_convert(rgb, hsv, true, color_rgb_order, 3, (const double*) NULL);
+  }
+
+  template <typename Tin, typename Tout>
+  void rgb_to_hsv_interleaved(idx<Tin> &rgb, idx<Tout> &hsv) {
+    color_convert(rgb, hsv, false, color_rgb_order, 3, (const double*) NULL);
+  }
+
+  template <typename Tin, typename Tout>
+  void rgb_to_h_planar(idx<Tin> &rgb, idx<Tout> &h) {
+    color_convert(rgb, h, true, color_rgb_order, 1, (const double*) NULL);
+  }
+
+  template <typename Tin, typename Tout>
+  void rgb_to_h_interleaved(idx<Tin> &rgb, idx<Tout> &h) {
+    color_convert(rgb, h, false, color_rgb_order, 1, (const double*) NULL);
+  }
+
 } // end namespace ebl
 
 #endif /* COLOR_SPACES_HPP_ */
@@ -0,0 +1,107 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef GEMM_H_
+#define GEMM_H_
+
+#include "config.h"
+#include "defines.h"
+#include "idx.h"
+
+namespace ebl {
+
+  // idx_gemm //////////////////////////////////////////////////////////////////
+
+  //! General matrix-matrix product c <- alpha . a . b + beta . c, where a is
+  //! (m x k), b is (k x n) and c is (m x n). Operands can have any strides,
+  //! so transposed products are obtained by passing a.transpose(0, 1)
+  //! (which only swaps strides) without copying data.
+  //! If a, b and c are of order 3, dimension 0 is a batch dimension and
+  //! c[i] <- alpha . a[i] . b[i] + beta . c[i] for each i.
+  //! This uses cblas_?gemm when available and possible, and a cache-blocked
+  //! implementation otherwise (multithreaded with __OPENMP__).
+  EXPORT void idx_gemm(idx<float32> &a, idx<float32> &b, idx<float32> &c,
+		       float32 alpha = 1, float32 beta = 0);
+  //! General matrix-matrix product c <- alpha . a . b + beta . c.
+  //! See float32 version for details.
+  EXPORT void idx_gemm(idx<float64> &a, idx<float64> &b, idx<float64> &c,
+		       float64 alpha = 1, float64 beta = 0);
+
+  // m2dotm2 ///////////////////////////////////////////////////////////////////
+
+#ifndef __IPP__ // ipp already specializes these
+  //! Matrix-Matrix multiplication, y <- a . x, specialized float32 version.
+  template <> EXPORT
+    void idx_m2dotm2(idx<float32> &a, idx<float32> &x, idx<float32> &y);
+  //! Matrix-Matrix multiplication, y <- a . x, specialized float64 version.
+  template <> EXPORT
+    void idx_m2dotm2(idx<float64> &a, idx<float64> &x, idx<float64> &y);
+#endif
+  //! Matrix-Matrix multiplication, y <- y + a . x, specialized float32
+  //! version.
+  template <> EXPORT
+    void idx_m2dotm2acc(idx<float32> &a, idx<float32> &x, idx<float32> &y);
+  //! Matrix-Matrix multiplication, y <- y + a . x, specialized float64
+  //! version.
+  template <> EXPORT
+    void idx_m2dotm2acc(idx<float64> &a, idx<float64> &x, idx<float64> &y);
+
+  // int8 products /////////////////////////////////////////////////////////////
+
+  //! Quantizes 'in' into 'out' with out = round(in / scale), saturated to
+  //! [-127, 127] (symmetric quantization, -128 is never produced).
+  EXPORT void idx_quantize_s8(idx<float32> &in, idx<byte> &out, float32 scale);
+  //! Quantizes 'in' into 'out', see float32 version for details.
+  EXPORT void idx_quantize_s8(idx<float64> &in, idx<byte> &out, float64 scale);
+  //! Quantizes each row i of matrix 'w' into row i of 'q' with its own
+  //! scale 'scale'[i] = max_j |w[i][j]| / 127, resizing 'q' and 'scale'.
+  EXPORT void idx_quantize_rows_s8(idx<float32> &w, idx<byte> &q,
+				   idx<float32> &scale);
+  //! Quantizes each row of 'w' with its own scale, see float32 version.
+  EXPORT void idx_quantize_rows_s8(idx<float64> &w, idx<byte> &q,
+				   idx<float32> &scale);
+  //! Quantized matrix product c <- c + diag(scale) . a . bt', where a is an
+  //! (m x k) and bt an (n x k) int8 matrix, both with contiguous rows, i.e.
+  //! b is given transposed so that both operands are read along k.
+  //! Products are accumulated exactly in int32 and each row i is rescaled by
+  //! scale[i] while being added to c, i.e. dequantization is fused into the
+  //! product (multithreaded with __OPENMP__).
+  EXPORT void idx_gemm_s8(idx<byte> &a, idx<byte> &bt, idx<float32> &c,
+			  idx<float32> &scale);
+  //! Quantized matrix product c <- c + diag(scale) . a . bt'.
+  //! See float32 version for details.
+  EXPORT void idx_gemm_s8(idx<byte> &a, idx<byte> &bt, idx<float64> &c,
+			  idx<float32> &scale);
+
+} // end namespace ebl
+
+#endif /* GEMM_H_ */
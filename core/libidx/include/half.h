@@ -0,0 +1,169 @@
+/***************************************************************************
+ *   Copyright (C) 2012 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef HALF_H_
+#define HALF_H_
+
+#include <string.h>
+
+#include "defines.h"
+
+namespace ebl {
+
+  // float16 /////////////////////////////////////////////////////////////////
+
+  //! Returns the IEEE 754 half precision bits closest to 'f' (rounding to
+  //! nearest even). Values too large become infinities, NaNs stay NaNs.
+  inline uint16 float32_to_float16_bits(float32 f);
+  //! Returns the float32 value of half precision bits 'h' (exact).
+  inline float32 float16_bits_to_float32(uint16 h);
+
+  //! An IEEE 754 half precision (binary16) number: 1 sign bit, 5 exponent
+  //! bits and 10 mantissa bits, i.e. ~3 significant digits up to 65504.
+  //! This is a storage type: it converts to and from float32 implicitly
+  //! and arithmetic is carried out in float32.
+  class EXPORT float16 {
+  public:
+    float16() {}
+    float16(float32 f) : bits(float32_to_float16_bits(f)) {}
+    operator float32() const { return float16_bits_to_float32(bits); }
+    float16& operator+=(float32 f) { return *this = (float32) *this + f; }
+    float16& operator-=(float32 f) { return *this = (float32) *this - f; }
+    float16& operator*=(float32 f) { return *this = (float32) *this * f; }
+    float16& operator/=(float32 f) { return *this = (float32) *this / f; }
+  public:
+    uint16 bits; //!< Raw binary16 representation.
+  };
+
+  // bfloat16 ////////////////////////////////////////////////////////////////
+
+  //! Returns the bfloat16 bits closest to 'f' (rounding to nearest even).
+  //! NaNs stay (quiet) NaNs.
+  inline uint16 float32_to_bfloat16_bits(float32 f);
+  //! Returns the float32 value of bfloat16 bits 'h' (exact).
+  inline float32 bfloat16_bits_to_float32(uint16 h);
+
+  //! A 'brain' floating point number, i.e. the upper 16 bits of a float32:
+  //! same range as float32 but only 8 bits of mantissa (~2 digits).
+  //! This is a storage type: it converts to and from float32 implicitly
+  //! and arithmetic is carried out in float32.
+  class EXPORT bfloat16 {
+  public:
+    bfloat16() {}
+    bfloat16(float32 f) : bits(float32_to_bfloat16_bits(f)) {}
+    operator float32() const { return bfloat16_bits_to_float32(bits); }
+    bfloat16& operator+=(float32 f) { return *this = (float32) *this + f; }
+    bfloat16& operator-=(float32 f) { return *this = (float32) *this - f; }
+    bfloat16& operator*=(float32 f) { return *this = (float32) *this * f; }
+    bfloat16& operator/=(float32 f) { return *this = (float32) *this / f; }
+  public:
+    uint16 bits; //!< Upper 16 bits of the float32 representation.
+  };
+
+  // bulk conversions ////////////////////////////////////////////////////////
+  // These use the F16C or AVX-512 conversion instructions when available.
+
+  //! Converts 'n' float16 values of 'in' into 'out'.
+  EXPORT void float16_to_float32(const float16 *in, float32 *out, intg n);
+  //! Converts 'n' float32 values of 'in' into 'out' (round to nearest even).
+  EXPORT void float32_to_float16(const float32 *in, float16 *out, intg n);
+  //! Converts 'n' bfloat16 values of 'in' into 'out'.
+  EXPORT void bfloat16_to_float32(const bfloat16 *in, float32 *out, intg n);
+  //! Converts 'n' float32 values of 'in' into 'out' (round to nearest even).
+  EXPORT void float32_to_bfloat16(const float32 *in, bfloat16 *out, intg n);
+
+  // scalar conversions //////////////////////////////////////////////////////
+
+  inline uint16 float32_to_float16_bits(float32 f) {
+    uint32 u, sign;
+    memcpy(&u, &f, sizeof (u));
+    sign = u & 0x80000000u;
+    u ^= sign;
+    uint16 h;
+    if (u >= 0x47800000u) // overflow, infinity or NaN (exponent >= 16)
+      h = (u > 0x7f800000u) ? 0x7e00 : 0x7c00;
+    else if (u < 0x38800000u) { // subnormal or zero (exponent < -14)
+      // adding 0.5 aligns the mantissa so that the fpu does the rounding
+      float32 g, magic;
+      uint32 m = 0x3f000000u;
+      memcpy(&g, &u, sizeof (g));
+      memcpy(&magic, &m, sizeof (magic));
+      g += magic;
+      memcpy(&u, &g, sizeof (u));
+      h = (uint16) (u - m);
+    } else { // normal: rebias exponent and round the 13 dropped bits
+      uint32 odd = (u >> 13) & 1;
+      u += 0xc8000fffu + odd; // (15 - 127) << 23, plus rounding bias
+      h = (uint16) (u >> 13);
+    }
+    return h | (uint16) (sign >> 16);
+  }
+
+  inline float32 float16_bits_to_float32(uint16 h) {
+    uint32 u = (uint32) (h & 0x7fff) << 13, exp = u & 0x0f800000u;
+    u += 0x38000000u; // (127 - 15) << 23
+    if (exp == 0x0f800000u) // infinity or NaN
+      u += 0x38000000u;
+    else if (exp == 0) { // subnormal or zero: renormalize with the fpu
+      float32 f, magic;
+      uint32 m = 0x38800000u; // 2^-14
+      u += 0x00800000u;
+      memcpy(&f, &u, sizeof (f));
+      memcpy(&magic, &m, sizeof (magic));
+      f -= magic;
+      memcpy(&u, &f, sizeof (u));
+    }
+    u |= (uint32) (h & 0x8000) << 16;
+    float32 f;
+    memcpy(&f, &u, sizeof (f));
+    return f;
+  }
+
+  inline uint16 float32_to_bfloat16_bits(float32 f) {
+    uint32 u;
+    memcpy(&u, &f, sizeof (u));
+    if ((u & 0x7fffffffu) > 0x7f800000u) // NaN: truncate and keep it quiet
+      return (uint16) ((u | 0x00400000u) >> 16);
+    u += 0x7fff + ((u >> 16) & 1);
+    return (uint16) (u >> 16);
+  }
+
+  inline float32 bfloat16_bits_to_float32(uint16 h) {
+    uint32 u = (uint32) h << 16;
+    float32 f;
+    memcpy(&f, &u, sizeof (f));
+    return f;
+  }
+
+} // end namespace ebl
+
+#endif /* HALF_H_ */
@@ -39,6 +39,7 @@
 #include "stl.h"
 #include "idxspec.h"
 #include "idxiter.h"
+#include "idxview.h"
 #include "smart.h"
 
 namespace ebl {
@@ -1142,6 +1142,7 @@ void midx<T>::mset(idx<T> &e, intg i0, intg i1) {
 
 // early definition of load_matrix
 template <typename T> idx<T> load_matrix(FILE *fp, idx<T> *out = NULL);
+template <typename T> idx<T> load_matrix(std::file &f);
 
 template <typename T>
 idx<T> midx<T>::mget() {
@@ -1158,7 +1159,7 @@ idx<T> midx<T>::mget() {
                << "file is " << (intg) fppos.__pos << " big");
 #endif
     }
-    return load_matrix<T>(fp->get_fp());
+    return load_matrix<T>(*fp);
   } else { // all data is already loaded
     idx<T> *e = idx<idx<T>*>::get();
     if (!e) eblerror("trying to access null element in scalar midx");
@@ -1182,7 +1183,7 @@ idx<T> midx<T>::mget(intg i0) {
                << "file is " << (intg) fppos.__pos << " big");
 #endif
     }
-    return load_matrix<T>(fp->get_fp());
+    return load_matrix<T>(*fp);
   } else { // all data is already loaded
     idx<T> *e = idx<idx<T>*>::get(i0);
     if (!e) eblerror("trying to access null element at position " << i0);
@@ -1206,7 +1207,7 @@ idx<T> midx<T>::mget(intg i0, intg i1) {
                << "file is " << (intg) fppos.__pos << " big");
 #endif
     }
-    return load_matrix<T>(fp->get_fp());
+    return load_matrix<T>(*fp);
   } else { // all data is already loaded
     idx<T> *e = idx<idx<T>*>::get(i0, i1);
     if (!e)
@@ -90,6 +90,14 @@ extern std::string dump_prefix;
 #define MAGIC_UINT_MATRIX	0x1e3d4c59
 #define MAGIC_UINT64_MATRIX	0x1e3d4c5a
 #define MAGIC_INT64_MATRIX	0x1e3d4c5b
+#define MAGIC_FLOAT16_MATRIX	0x1e3d4c5c
+#define MAGIC_BFLOAT16_MATRIX	0x1e3d4c5d
+// prefix of matrices whose data is aligned in the file, followed by the
+// offset of the data and a regular header.
+#define MAGIC_ALIGNED_MATRIX	0x1e3d4c5f
+// prefix of matrices whose data is compressed in independent chunks,
+// followed by a regular header, a chunk index and the chunks.
+#define MAGIC_COMPRESSED_MATRIX	0x1e3d4c5e
 
 // pascal vincent's magic numbers
 #define MAGIC_UBYTE_VINCENT	0x0800
@@ -134,6 +142,15 @@ void load_matrix(idx<T>& m, const char *filename);
 //! This throws string exceptions upon errors.
 template <typename T>
 void load_matrix(idx<T>& m, const std::string &filename);
+//! Returns the matrix starting at the current position of file 'f' and
+//! moves the position to the end of the matrix. If mapped loading is
+//! enabled (see set_mapped_loading()) and the data is stored in type T
+//! at an offset aligned with T, the returned matrix directly aliases the
+//! pages of the file instead of being read into new memory, otherwise
+//! this is equivalent to load_matrix<T>(f.get_fp()).
+//! This throws string exceptions upon errors.
+template <typename T>
+idx<T> load_matrix(std::file &f);
 //! Loads a matrix from an opened file pointer 'fp'
 //! into given matrix out if given,
 //! allocates a new one otherwise. This returns either *out or the newly
@@ -151,11 +168,33 @@ idx<T> load_matrix(FILE *fp, idx<T> *out);
 //!   open and dynamically load each matrix when requested in the midx object.
 template <typename T>
 midx<T> load_matrices(const std::string &filename, bool ondemand = true);
-//! Loads a matrix from a csv file.
+//! Loads a matrix from a csv file. The file is mapped in memory and parsed
+//! in one pass, by multiple threads if OpenMP is enabled
+//! (see parse_csv_matrix()).
+//! \param cache If true, the matrix is saved next to the csv file
+//!   (see csv_cache_name()) and loaded from there instead of parsing the
+//!   csv file again, as long as it was modified strictly after the csv file
+//!   (modification times have a 1 second granularity).
 template <typename T>
   idx<T> load_csv_matrix(const char *filename, bool ignore_first_line = false,
 												 bool ignore_missing_value_lines = true,
-												 bool ignore_empty_cols = false, bool silent = false);
+												 bool ignore_empty_cols = false, bool silent = false,
+                         bool cache = false);
+//! Parses the 'size' bytes of csv text 'text' into a matrix with one row
+//! per line and one column per comma-separated value. The number of columns
+//! is given by the second line if any (the first may be a header).
+//! Empty or non-numeric values are missing and set to 0, extra values are
+//! ignored. The text is split into line-aligned chunks parsed in parallel
+//! if OpenMP is enabled.
+//! \param ignore_first_line If true, skip the first line (header).
+//! \param ignore_missing_value_lines If true, skip lines with missing values.
+//! \param ignore_empty_cols If true, remove columns without any value.
+//! \param silent If false, warn about each missing value.
+template <typename T>
+  idx<T> parse_csv_matrix(const char *text, intg size,
+                          bool ignore_first_line = false,
+                          bool ignore_missing_value_lines = true,
+                          bool ignore_empty_cols = false, bool silent = false);
 
 // saving //////////////////////////////////////////////////////////////////////
 
@@ -171,19 +210,30 @@ template <typename T2, typename T>
 bool save_matrix(idx<T>& m, const std::string &filename);
 //! Saves a matrix m in file filename.
 //! Returns true if successful, false otherwise.
+//! \param align If > 0, the data is written at a file offset multiple of
+//!   'align' bytes (e.g. the page size 4096) so that it can be mapped
+//!   directly in memory when loaded (see set_mapped_loading()).
+//!   Otherwise data is compressed if compressed saving is enabled
+//!   (see set_compressed_saving()).
 template <typename T>
-bool save_matrix(idx<T>& m, const char *filename);
+bool save_matrix(idx<T>& m, const char *filename, intg align = 0);
 //! Saves a matrix m into a file pointer 'fp'. The user is responsible
 //! for closing the file pointer afterwards, even if an error occured.
 //! Returns true if successful, false otherwise.
+//! \param align If > 0, the data is written at a file offset multiple of
+//!   'align' bytes.
+//! \param compress If true, the data is written in compressed chunks
+//!   (see write_compressed_data()) and 'align' is ignored.
 template <typename T>
-bool save_matrix(idx<T>& m, FILE *fp);
+bool save_matrix(idx<T>& m, FILE *fp, intg align = 0, bool compress = false);
 //! Saves a midx m into a single static matrix in file 'filename'.
 //! Returns true if successful, false otherwise.
 template <typename T>
 bool save_matrix(midx<T> m, const std::string &filename);
 //! Saves matrices m in file filename. Elements of m may be NULL and will
-//! be remembered as empty when loaded back.
+//! be remembered as empty when loaded back. Each matrix is compressed
+//! if compressed saving is enabled (see set_compressed_saving()), their
+//! offsets always remain directly accessible.
 //! Returns true if successful, false otherwise.
 template <typename T>
 bool save_matrices(midx<T>& m, const std::string &filename);
@@ -253,9 +303,57 @@ EXPORT bool is_magic(int magic);
 EXPORT idxdim get_matrix_dims(const char *filename);
 //! Return the dimensions found in the header and set 'magic' to the magic
 //! number found (either vincent or regular type).
-EXPORT idxdim read_matrix_header(FILE *fp, int &magic);
+//! \param compressed If not null, set to true if the data that follows
+//!   is compressed (see read_compressed_data()), false if it is raw.
+EXPORT idxdim read_matrix_header(FILE *fp, int &magic,
+                                 bool *compressed = NULL);
 //! Returns true if mat file 'filename' contains more than 1 matrix.
 EXPORT bool has_multiple_matrices(const char *filename);
+//! Returns the name of the binary cache of csv file 'filename' loaded
+//! into a matrix of type 'magic' (see get_magic()) with given options
+//! (see load_csv_matrix()), e.g. "data.csv.010.float.mat".
+EXPORT std::string csv_cache_name(const char *filename, int magic,
+                                  bool ignore_first_line,
+                                  bool ignore_missing_value_lines,
+                                  bool ignore_empty_cols);
+//! Enables or disables mapped loading (disabled by default). When enabled,
+//! matrices loaded from files share the pages of the files instead of
+//! being copied into new memory: loading is immediate and processes
+//! loading the same file share the same physical memory.
+//! Modifications of loaded matrices are private and never written back,
+//! but files must not be truncated or overwritten while mapped.
+EXPORT void set_mapped_loading(bool enable);
+//! Returns true if mapped loading is enabled.
+EXPORT bool mapped_loading();
+//! Enables or disables caching of csv files loaded by datasources (disabled
+//! by default), see the 'cache' argument of load_csv_matrix().
+EXPORT void set_csv_caching(bool enable);
+//! Returns true if csv caching is enabled.
+EXPORT bool csv_caching();
+//! Enables or disables compressed saving (disabled by default). When enabled,
+//! matrices saved to files by filename (unless aligned) and matrices saved
+//! by save_matrices() are compressed, which typically divides the size of
+//! image datasets by 3 to 5. Loading detects compressed data automatically.
+EXPORT void set_compressed_saving(bool enable);
+//! Returns true if compressed saving is enabled.
+EXPORT bool compressed_saving();
+
+// compressed data /////////////////////////////////////////////////////////////
+
+//! Writes the 'n' elements of 'size' bytes of 'data' to 'fp' as
+//! independently compressed chunks: an int header (filter, chunk size in
+//! bytes, number of chunks), the compressed size of each chunk and the
+//! chunks themselves. Multi-byte elements are byte-shuffled before
+//! compression and chunks that do not compress are stored raw.
+//! Returns true if successful, false otherwise.
+EXPORT bool write_compressed_data(FILE *fp, const char *data, intg n,
+                                  int size);
+//! Reads the data written by write_compressed_data() into 'data' of
+//! 'n' elements of 'size' bytes. This throws string exceptions upon errors.
+EXPORT void read_compressed_data(FILE *fp, char *data, intg n, int size);
+//! Moves 'fp' to the end of the compressed data at its current position,
+//! without decompressing it. This throws string exceptions upon errors.
+EXPORT void skip_compressed_data(FILE *fp);
 
 } // end namespace ebl
 
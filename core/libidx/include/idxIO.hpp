@@ -33,8 +33,12 @@
 #ifndef IDXIO_HPP_
 #define IDXIO_HPP_
 
+#include <algorithm>
+#include <vector>
+#include <string.h>
 #include "idxops.h"
 #include "string_utils.h"
+#include "utils.h"
 
 namespace ebl {
 
@@ -52,6 +56,8 @@ template <> inline int get_magic<double>()      {return MAGIC_DOUBLE_MATRIX; }
 template <> inline int get_magic<long>()        {return MAGIC_LONG_MATRIX; }
 template <> inline int get_magic<uint>()        {return MAGIC_UINT_MATRIX; }
 template <> inline int get_magic<uint64>()      {return MAGIC_UINT64_MATRIX; }
+template <> inline int get_magic<float16>()     {return MAGIC_FLOAT16_MATRIX; }
+template <> inline int get_magic<bfloat16>()    {return MAGIC_BFLOAT16_MATRIX; }
 
 // Pascal Vincent type
 template <class T> inline int get_magic_vincent() {
@@ -62,6 +68,8 @@ template <> inline int get_magic_vincent<float>(){return MAGIC_FLOAT_VINCENT;}
 template <> inline int get_magic_vincent<double>() {
   return MAGIC_DOUBLE_VINCENT; }
 template <> inline int get_magic_vincent<long>() {return 0x0000; }
+template <> inline int get_magic_vincent<float16>() {return 0x0000; }
+template <> inline int get_magic_vincent<bfloat16>() {return 0x0000; }
 
 // type to string function for debug message.
 inline std::string get_magic_str(int magic) {
@@ -80,6 +88,8 @@ inline std::string get_magic_str(int magic) {
 	case MAGIC_UINT_MATRIX: 	return "uint";
 	case MAGIC_UINT64_MATRIX: 	return "uint64";
 	case MAGIC_INT64_MATRIX: 	return "int64";
+	case MAGIC_FLOAT16_MATRIX: 	return "float16";
+	case MAGIC_BFLOAT16_MATRIX: 	return "bfloat16";
 		// pascal vincent format
 	case MAGIC_BYTE_VINCENT: 	return "byte (pascal vincent)";
 	case MAGIC_UBYTE_VINCENT: 	return "ubyte (pascal vincent)";
@@ -130,14 +140,31 @@ template <class T> inline T endian(T ptr) {
 }
 
 template <typename T, typename T2>
-void read_cast_matrix(FILE *fp, idx<T2> &out) {
+void read_cast_matrix(FILE *fp, idx<T2> &out, bool compressed = false) {
   idx<T> m(out.get_idxdim());
-  read_matrix_body(fp, m);
+  read_matrix_body(fp, m, compressed);
   idx_copy(m, out);
 }
 
 template <typename T>
-void read_matrix_body(FILE *fp, idx<T> &m) {
+void read_matrix_body(FILE *fp, idx<T> &m, bool compressed = false) {
+  if (compressed) { // decompress chunks into contiguous memory
+    if (m.contiguousp())
+      read_compressed_data(fp, (char*) m.idx_ptr(), m.nelements(), sizeof (T));
+    else {
+      idx<T> tmp(m.get_idxdim());
+      read_compressed_data(fp, (char*) tmp.idx_ptr(), tmp.nelements(),
+                           sizeof (T));
+      idx_copy(tmp, m);
+    }
+    return ;
+  }
+  if (m.contiguousp()) { // read all data at once
+    if (fread(m.idx_ptr(), sizeof (T), m.nelements(), fp)
+        != (size_t) m.nelements())
+      eblerror("Read incorrect number of bytes ");
+    return ;
+  }
   size_t read_count;
   idx_aloop1(i, m, T) {
     read_count = fread(&(*i), sizeof (T), 1, fp);
@@ -150,6 +177,16 @@ void read_matrix_body(FILE *fp, idx<T> &m) {
 
 template <typename T>
 idx<T> load_matrix(const char *filename) {
+  if (mapped_loading()) { // load through a mapping of the file
+    std::file f(filename, "rb");
+    idx<T> m;
+    try {
+      m = load_matrix<T>(f);
+    } catch(eblexception &e) {
+      eblthrow(" while loading " << filename)
+    }
+    return m;
+  }
   // open file
   FILE *fp = fopen(filename, "rb");
   if (!fp)
@@ -197,10 +234,38 @@ void load_matrix(idx<T>& m, const char *filename) {
   fclose(fp);
 }
 
+template <typename T>
+idx<T> load_matrix(std::file &f) {
+  FILE *fp = f.get_fp();
+  if (!mapped_loading())
+    return load_matrix<T>(fp);
+  // read header and locate data
+  long start = ftell(fp);
+  int magic;
+  bool compressed;
+  idxdim dims = read_matrix_header(fp, magic, &compressed);
+  long offset = ftell(fp);
+  intg n = dims.nelements();
+  // alias file pages if data has type T, is aligned for T and is raw
+  ebl::file_mapping *map = NULL;
+  if (!compressed && magic == get_magic<T>() && offset % sizeof (T) == 0)
+    map = f.mapping();
+  if (!map || offset + n * (intg) sizeof (T) > map->size()) {
+    fseek(fp, start, SEEK_SET); // read regularly
+    return load_matrix<T>(fp);
+  }
+  srg<T> *s = new srg<T>();
+  s->set_mapped(map, offset, n);
+  idx<T> m(s, 0, dims);
+  fseek(fp, offset + n * sizeof (T), SEEK_SET); // move to end of matrix
+  return m;
+}
+
 template <typename T>
 idx<T> load_matrix(FILE *fp, idx<T> *out_) {
   int magic;
-  idxdim dims = read_matrix_header(fp, magic);
+  bool compressed;
+  idxdim dims = read_matrix_header(fp, magic, &compressed);
   idx<T> out;
   idx<T> *pout = &out;
   if (!out_) // if no input matrix, allocate new one
@@ -219,36 +284,42 @@ idx<T> load_matrix(FILE *fp, idx<T> *out_) {
   //! if out matrix is same type as current, read directly
   if ((magic == get_magic<T>()) || (magic == get_magic_vincent<T>())) {
     // read
-    read_matrix_body(fp, *pout);
+    read_matrix_body(fp, *pout, compressed);
   } else { // different type, read original type, then copy/cast into out
     switch (magic) {
 		case MAGIC_BYTE_MATRIX:
 		case MAGIC_UBYTE_VINCENT:
-			read_cast_matrix<ubyte>(fp, *pout);
+			read_cast_matrix<ubyte>(fp, *pout, compressed);
 			break ;
 		case MAGIC_INTEGER_MATRIX:
 		case MAGIC_INT_VINCENT:
-			read_cast_matrix<int>(fp, *pout);
+			read_cast_matrix<int>(fp, *pout, compressed);
 			break ;
 		case MAGIC_FLOAT_MATRIX:
 		case MAGIC_FLOAT_VINCENT:
-			read_cast_matrix<float>(fp, *pout);
+			read_cast_matrix<float>(fp, *pout, compressed);
 			break ;
 		case MAGIC_DOUBLE_MATRIX:
 		case MAGIC_DOUBLE_VINCENT:
-			read_cast_matrix<double>(fp, *pout);
+			read_cast_matrix<double>(fp, *pout, compressed);
 			break ;
 		case MAGIC_LONG_MATRIX:
-			read_cast_matrix<long>(fp, *pout);
+			read_cast_matrix<long>(fp, *pout, compressed);
 			break ;
 		case MAGIC_UINT_MATRIX:
-			read_cast_matrix<uint>(fp, *pout);
+			read_cast_matrix<uint>(fp, *pout, compressed);
 			break ;
 		case MAGIC_UINT64_MATRIX:
-			read_cast_matrix<uint64>(fp, *pout);
+			read_cast_matrix<uint64>(fp, *pout, compressed);
 			break ;
 		case MAGIC_INT64_MATRIX:
-			read_cast_matrix<int64>(fp, *pout);
+			read_cast_matrix<int64>(fp, *pout, compressed);
+			break ;
+		case MAGIC_FLOAT16_MATRIX:
+			read_cast_matrix<float16>(fp, *pout, compressed);
+			break ;
+		case MAGIC_BFLOAT16_MATRIX:
+			read_cast_matrix<bfloat16>(fp, *pout, compressed);
 			break ;
 		default:
 			eblerror("unknown magic number");
@@ -291,7 +362,7 @@ midx<T> load_matrices(const std::string &filename, bool ondemand){
 #endif
         }
         // move fp to matrix beginning
-        idx<T> m = load_matrix<T>(fp);
+        idx<T> m = load_matrix<T>(*f);
         all.mset(m, i);
       }
     }
@@ -302,145 +373,188 @@ midx<T> load_matrices(const std::string &filename, bool ondemand){
 
 template <typename T>
 idx<T> load_csv_matrix(const char *filename, bool ignore_first_line,
-											 bool ignore_missing_value_lines, bool ignore_empty_cols,
-											 bool silent) {
-  char sep = ',';
-  T default_value = 0;
+                       bool ignore_missing_value_lines, bool ignore_empty_cols,
+                       bool silent, bool cache) {
+  // load binary cache of type T if more recent than csv file. a cache
+  // modified in the same second as the csv file may predate a rewrite of
+  // the csv within that second, so it is not trusted.
+  std::string cname;
+  if (cache) {
+    cname = csv_cache_name(filename, get_magic<T>(), ignore_first_line,
+                           ignore_missing_value_lines, ignore_empty_cols);
+    if (file_exists(cname) && file_modified(cname) > file_modified(filename)) {
+      try {
+        return load_matrix<T>(cname);
+      } catch(eblexception &e) {
+        eblwarn("failed to load csv cache " << cname << ", reparsing "
+                << filename);
+      }
+    }
+  }
   // open file
   FILE *fp = fopen(filename, "rb");
   if (!fp) eblthrow("load_csv_matrix failed to open " << filename);
-  // read it
+  // map whole file in memory, or read it if it cannot be mapped
+  file_mapping *map = file_mapping::map(fp);
+  std::vector<char> buf;
+  const char *text = NULL;
+  intg size = 0;
+  if (map) {
+    map->lock();
+    text = map->data();
+    size = map->size();
+  } else {
+    fseek(fp, 0, SEEK_END);
+    size = std::max((intg) 0, (intg) ftell(fp));
+    fseek(fp, 0, SEEK_SET);
+    buf.resize(size + 1);
+    size = fread(&buf[0], 1, size, fp);
+    text = &buf[0];
+  }
+  fclose(fp);
+  // parse it
   idx<T> m;
-  char *ret = NULL;
-  intg line = 0;
-  intg n = 1;
-  intg i = 0, j = 0;
-	uint buf_size = 4096;
-	char *buf = (char*) malloc(buf_size);
-  // figure out geometry
   try {
-		// test if buffer size is enough
-		bool big_enough = false;
-		while (!big_enough) {
-			ret = fgets(buf, buf_size, fp);
-			if (strlen(buf) == buf_size-1) {
-				buf_size *= 2;
-				free(buf);
-				buf = (char*) malloc(buf_size);
-			} else big_enough = true;
-			fseek(fp, 0, SEEK_SET); // reset point to beginnin of file
-		}
-		// find length of a line
-    while ((ret = fgets(buf, buf_size, fp))) {
-      if (line == 0 && ignore_first_line) {
-				line++;
-				continue ;
-      }
-      if (line == 0 || line == 1) {
-				n = 1;
-				std::string s = buf;
-				size_t pos = 0;
-				size_t len = s.size();
-				while (pos < len && ((pos = s.find(sep, pos)) != std::string::npos)) {
-					n++;
-					pos++;
-				}
+    m = parse_csv_matrix<T>(text, size, ignore_first_line,
+                            ignore_missing_value_lines, ignore_empty_cols,
+                            silent);
+  } catch(eblexception &e) {
+    if (map) map->unlock();
+    eblthrow(" while loading " << filename)
+  }
+  if (map) map->unlock();
+  if (cache && !save_matrix(m, cname))
+    eblwarn("failed to save csv cache " << cname);
+  return m;
+}
+
+//! Values, missing values and skipped lines of a chunk of csv lines.
+template <typename T> struct csv_chunk {
+  csv_chunk() : begin(NULL), end(NULL), nlines(0) {}
+  const char *begin, *end; //!< Text of the chunk.
+  intg nlines; //!< Number of lines in the chunk.
+  std::vector<T> values; //!< Values of kept lines.
+  std::vector<intg> counts; //!< Number of values found in each column.
+  //! Positions (line in chunk, column) of missing values.
+  std::vector<std::pair<intg,intg> > missing;
+  std::vector<intg> skipped; //!< Lines (in chunk) skipped.
+};
+
+//! Parses the lines of chunk 'c' into rows of 'n' values.
+template <typename T>
+void parse_csv_chunk(csv_chunk<T> &c, intg n, bool ignore_missing_value_lines) {
+  c.counts.assign(n, 0);
+  for (const char *p = c.begin; p < c.end; c.nlines++) {
+    const char *eol = (const char*) memchr(p, '\n', c.end - p);
+    if (!eol) eol = c.end;
+    size_t row = c.values.size();
+    c.values.resize(row + n, (T) 0);
+    bool missing = false;
+    double d;
+    // parse each value of the line
+    for (intg j = 0; ; ++j) {
+      const char *sep = (const char*) memchr(p, ',', eol - p);
+      const char *vend = sep ? sep : eol;
+      if (j < n) {
+        if (parse_double(p, vend, d)) {
+          c.values[row + j] = (T) d;
+          c.counts[j]++;
+        } else {
+          c.missing.push_back(std::pair<intg,intg>(c.nlines, j));
+          missing = true;
+        }
       }
-      line++;
-      i++;
+      if (!sep) break;
+      p = sep + 1;
     }
-    EDEBUG("found a " << i << "x" << n << " matrix");
-    m = idx<T>(i, n);
-		idx<int> counts(n);
-		idx_clear(counts);
-    idx_clear(m);
-    fseek(fp, 0, SEEK_SET); // reset fp to beginning
-    i = 0;
-    line = 0;
-    while ((ret = fgets(buf, buf_size, fp))) {
-      if (line == 0 && ignore_first_line) {
-				line++;
-				continue ;
-      }
-      std::string s = buf, tmp;
-      size_t pos0 = 0;
-      size_t pos1 = 0;
-      size_t len = s.size();
-      bool missing = false;
-      j = 0;
-      while (pos0 < len && ((pos1 = s.find(sep, pos0)) != std::string::npos)) {
-				if (pos1 - pos0 == 0) {
-					if (!silent)
-						eblwarn("no value at position " << i << ", " << j << ", setting to "
-										<< default_value);
-					m.set(default_value, i, j);
-					missing = true;
-				} else {
-					tmp = s.substr(pos0, pos1-pos0);
-					//EDEBUG("string to double from: " << tmp);
-					try {
-						m.set((T) string_to_double(tmp), i, j);
-						counts.set(counts.get(j) + 1, j);
-					} eblcatchwarn_extra(missing = true;);
-				}
-				j++;
-				pos0 = pos1 + 1;
-      }
-      if (len - pos0 - 1 == 0) {
-				if (!silent)
-					eblwarn("no value at position " << i << ", " << j << ", setting to "
-									<< default_value);
-				m.set(default_value, i, j);
-				missing = true;
-      } else {
-				tmp = s.substr(pos0, len-pos0);
-				//EDEBUG("string to double from: " << tmp);
-				try {
-					m.set((T) string_to_double(tmp), i, j);
-					counts.set(counts.get(j) + 1, j);
-				} eblcatchwarn_extra(missing = true;);
+    if (missing && ignore_missing_value_lines) {
+      c.values.resize(row);
+      c.skipped.push_back(c.nlines);
+    }
+    p = eol + 1;
+  }
+}
+
+template <typename T>
+idx<T> parse_csv_matrix(const char *text, intg size, bool ignore_first_line,
+                        bool ignore_missing_value_lines, bool ignore_empty_cols,
+                        bool silent) {
+  T default_value = 0;
+  const char *begin = text, *end = text + size, *eol;
+  if (ignore_first_line && begin < end) {
+    eol = (const char*) memchr(begin, '\n', end - begin);
+    begin = eol ? eol + 1 : end;
+  }
+  // figure out number of columns from 2nd line if any, 1st line otherwise
+  const char *line = text;
+  eol = (const char*) memchr(text, '\n', size);
+  if (eol && eol + 1 < end) line = eol + 1;
+  eol = (const char*) memchr(line, '\n', end - line);
+  if (!eol) eol = end;
+  intg n = 1 + std::count(line, eol, ',');
+  // split text into line-aligned chunks of about 4MB
+  int nchunks = (int) std::min((intg) 256, (end - begin) / (1 << 22) + 1);
+  std::vector<csv_chunk<T> > chunks(nchunks);
+  const char *p = begin;
+  for (int k = 0; k < nchunks; ++k) {
+    chunks[k].begin = p;
+    if (k < nchunks - 1) {
+      const char *q = std::max(p, begin + (end - begin) * (k + 1) / nchunks);
+      eol = q < end ? (const char*) memchr(q, '\n', end - q) : NULL;
+      p = eol ? eol + 1 : end;
+    } else
+      p = end;
+    chunks[k].end = p;
+  }
+  int k;
+#ifdef __OPENMP__
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (k = 0; k < nchunks; ++k)
+    parse_csv_chunk(chunks[k], n, ignore_missing_value_lines);
+  // assemble all rows and merge statistics
+  intg nrows = 0;
+  idx<intg> counts(n);
+  idx_clear(counts);
+  for (k = 0; k < nchunks; ++k) {
+    nrows += chunks[k].values.size() / n;
+    for (intg j = 0; j < n; ++j)
+      counts.set(counts.get(j) + chunks[k].counts[j], j);
+  }
+  idx<T> m(nrows, n);
+  intg row = 0, line0 = 0;
+  for (k = 0; k < nchunks; ++k) {
+    csv_chunk<T> &c = chunks[k];
+    if (c.values.size() > 0)
+      memcpy(m.idx_ptr() + row * n, &c.values[0], c.values.size() * sizeof (T));
+    row += c.values.size() / n;
+    if (!silent) {
+      for (size_t i = 0; i < c.missing.size(); ++i)
+        eblwarn("no value at position " << line0 + c.missing[i].first << ", "
+                << c.missing[i].second << ", setting to " << default_value);
+      for (size_t i = 0; i < c.skipped.size(); ++i)
+        eblwarn("ignoring line " << line0 + c.skipped[i]
+                << " because it contains a missing value");
+    }
+    line0 += c.nlines;
+  }
+  EDEBUG("found a " << m.dim(0) << "x" << n << " matrix");
+  // remove empty columns
+  if (ignore_empty_cols) {
+    std::vector<intg> cols;
+    for (intg j = 0; j < n; ++j) {
+      if (counts.get(j) > 0) cols.push_back(j);
+      else if (!silent) eblwarn("deleting empty column " << j);
+    }
+    if ((intg) cols.size() < n) {
+      idx<T> tmp(m.dim(0), (intg) cols.size());
+      for (size_t j = 0; j < cols.size(); ++j) {
+        idx<T> src = m.select(1, cols[j]), tgt = tmp.select(1, j);
+        idx_copy(src, tgt);
       }
-      idx<T> mtmp = m.select(0, i);
-      EDEBUG("row: " << mtmp.str());
-      if (n != m.dim(1))
-				eblerror("expected " << m.dim(1) << " values but found " << n);
-      line++;
-      if (missing && ignore_missing_value_lines) {
-				if (!silent)
-					eblwarn("ignoring line " << i
-									<< " because it contains a missing value");
-				m = m.narrow(0, m.dim(0) - 1, 0);
-      } else i++;
+      m = tmp;
     }
-		// remove empty columns
-		if (ignore_empty_cols) {
-			uint off = 0;
-			for (uint j = 0; j < counts.dim(0); ++j) {
-				if (counts.get(j) > 0) off++;
-				else { // empty column, shift to the left
-					if (!silent) eblwarn("deleting empty column " << j);
-					idx<T> tmp(m.dim(0), m.dim(1) - 1);
-					if (off == 0) { // right side
-						idx<T> right = m.narrow(1, m.dim(1) - 1, 1);
-						idx_copy(right, tmp);
-					} else if (off == m.dim(1) - 1) { // left side
-						idx<T> left = m.narrow(1, m.dim(1) - 1, 0);
-						idx_copy(left, tmp);
-					} else { // middle
-						idx<T> left = m.narrow(1, off, 0);
-						idx<T> right = m.narrow(1, m.dim(1) - off - 1, off + 1);
-						idx<T> tmpleft = tmp.narrow(1, off, 0);
-						idx<T> tmpright = tmp.narrow(1, tmp.dim(1) - off, off);
-						idx_copy(left, tmpleft);
-						idx_copy(right, tmpright);
-					}
-					m = tmp;
-				}
-			}
-		}
-    fclose(fp);
-  } catch(eblexception &e) { eblthrow(" while loading " << filename) }
-	free(buf);
+  }
   return m;
 }
 
@@ -459,14 +573,15 @@ bool save_matrix(idx<T>& m, const std::string &filename) {
 }
 
 // TODO: intg support
-template <typename T> bool save_matrix(idx<T>& m, const char *filename) {
+template <typename T>
+bool save_matrix(idx<T>& m, const char *filename, intg align) {
   FILE *fp = fopen(filename, "wb");
   if (!fp) {
     eblwarn( "save_matrix failed (" << filename << "): ");
     perror("");
     return false;
   }
-  bool ret = save_matrix(m, fp);
+  bool ret = save_matrix(m, fp, align, align == 0 && compressed_saving());
   if (!ret)
     eblwarn( "failed to write matrix " << m << " to " << filename << "."
              << std::endl);
@@ -475,8 +590,22 @@ template <typename T> bool save_matrix(idx<T>& m, const char *filename) {
 }
 
 // TODO: intg support
-template <typename T> bool save_matrix(idx<T>& m, FILE *fp) {
+template <typename T>
+bool save_matrix(idx<T>& m, FILE *fp, intg align, bool compress) {
   int v, i;
+  // aligned matrix: prefix header with offset of data padded to 'align'
+  long pad = 0;
+  if (compress) { // compressed matrix: prefix regular header
+    v = MAGIC_COMPRESSED_MATRIX;
+    if (fwrite(&v, sizeof (int), 1, fp) != 1) return false;
+  } else if (align > 0) {
+    long header = (4 + std::max((int) m.order(), 3)) * sizeof (int);
+    pad = (align - (ftell(fp) + header) % align) % align;
+    v = MAGIC_ALIGNED_MATRIX;
+    if (fwrite(&v, sizeof (int), 1, fp) != 1) return false;
+    v = (int) (header + pad);
+    if (fwrite(&v, sizeof (int), 1, fp) != 1) return false;
+  }
   // write header
   v = get_magic<T>();
   if (fwrite(&v, sizeof (int), 1, fp) != 1) return false;
@@ -489,7 +618,21 @@ template <typename T> bool save_matrix(idx<T>& m, FILE *fp) {
       v = 1;
     if (fwrite(&v, sizeof (int), 1, fp) != 1) return false;
   }
+  if (compress) { // write body as compressed chunks of contiguous data
+    idx<T> c = m;
+    if (!m.contiguousp()) {
+      c = idx<T>(m.get_idxdim());
+      idx_copy(m, c);
+    }
+    return write_compressed_data(fp, (const char*) c.idx_ptr(),
+                                 c.nelements(), sizeof (T));
+  }
+  for (; pad > 0; --pad)
+    if (fputc(0, fp) == EOF) return false;
   // write body
+  if (m.contiguousp()) // write all data at once
+    return fwrite(m.idx_ptr(), sizeof (T), m.nelements(), fp)
+      == (size_t) m.nelements();
   idx_aloop1(k, m, T)
     fwrite(&(*k), sizeof (T), 1, fp);
   return true;
@@ -567,7 +710,7 @@ bool save_matrices(midx<T>& m, const std::string &filename) {
 #endif
         // save matrix to file
         idx<T> e = m.mget(i);
-        ret = save_matrix(e, fp);
+        ret = save_matrix(e, fp, 0, compressed_saving());
         if (!ret) {
           eblwarn( "failed to write matrix " << e << " to " << filename << "."
                    << std::endl);
@@ -589,7 +732,7 @@ bool save_matrices(midx<T>& m, const std::string &filename) {
 #endif
           // save matrix to file
           idx<T> e = m.mget(i, j);
-          ret = save_matrix(e, fp);
+          ret = save_matrix(e, fp, 0, compressed_saving());
           if (!ret) {
             eblwarn( "failed to write matrix " << e << " to "
                      << filename << "." << std::endl);
@@ -699,7 +842,7 @@ bool save_matrices(midx<T>& m1, midx<T> &m2, const std::string &filename) {
 #endif
         // save matrix to file
         idx<T> e = m->mget(k);
-        ret = save_matrix(e, fp);
+        ret = save_matrix(e, fp, 0, compressed_saving());
         if (!ret) {
           eblwarn( "failed to write matrix " << e << " to " <<
                    filename << "." << std::endl);
@@ -726,7 +869,7 @@ bool save_matrices(midx<T>& m1, midx<T> &m2, const std::string &filename) {
 #endif
           // save matrix to file
           idx<T> e = m->mget(k, j);
-          ret = save_matrix(e, fp);
+          ret = save_matrix(e, fp, 0, compressed_saving());
           if (!ret) {
             eblwarn("failed to write matrix " << e << " to "
                     << filename << "." << std::endl);
@@ -805,7 +948,7 @@ bool save_matrices(std::list<std::string> &filenames,
 #endif
         // save matrix into file
         idx<T> ee = e.mget(k);
-        ret = save_matrix(ee, fp);
+        ret = save_matrix(ee, fp, 0, compressed_saving());
         if (!ret) {
           eblwarn( "failed to write matrix " << k << " to " << filename << "."
                    << std::endl);
@@ -823,7 +966,7 @@ bool save_matrices(std::list<std::string> &filenames,
       offsets.set((int64) pos.__pos, j);
 #endif
       // save matrix into file
-      ret = save_matrix(e, fp);
+      ret = save_matrix(e, fp, 0, compressed_saving());
       if (!ret) {
         eblwarn( "failed to write matrix " << e << " to " << filename << "."
                  << std::endl);
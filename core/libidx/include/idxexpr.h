@@ -0,0 +1,226 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef IDXEXPR_H_
+#define IDXEXPR_H_
+
+#include <math.h>
+#include "defines.h"
+#include "idx.h"
+
+namespace ebl {
+
+// lazy expressions ////////////////////////////////////////////////////////////
+// Elementwise expressions over idx are built lazily from idx_lazy() terms
+// and scalars with + - * / and the lazy_* functions below, and are evaluated
+// in a single pass by idx_eval(), without temporaries. Example:
+//   idx_eval(out, idx_lazy(a) * idx_lazy(b) + idx_lazy(c) * (T) 2);
+// All idx of an expression must have the same dimensions as the output.
+// The output may appear in the expression (e.g. x = x + y) as long as it is
+// the same idx and not a differently strided view of the same data.
+// The eager idx_* operations remain available and are preferable for single
+// operations, which may have specialized (e.g. IPP or SIMD) implementations.
+
+//! Leaf of an expression: an idx, read element by element.
+template <typename T> class lazy_leaf {
+ public:
+  typedef T value_type;
+  lazy_leaf(idx<T> &m_);
+  //! Returns the element at linear index i, for contiguous evaluation.
+  inline T operator[](intg i) const { return base[i]; }
+  //! Returns the current element, for strided evaluation.
+  inline T get() const { return *p; }
+  //! Moves current element by one in dimension d.
+  inline void step(int d) { p += mod[d]; }
+  //! Moves current element back to index 0 in dimension d.
+  inline void rewind(int d) { p -= dim[d] * mod[d]; }
+  inline bool contiguousp() const { return contiguous; }
+  //! Calls eblerror if dimensions differ from 'out'.
+  template <typename T2> void check(idx<T2> &out) const {
+    if (m->get_idxdim() != out.get_idxdim())
+      eblerror("expected same dimensions in lazy expression but got "
+	       << *m << " and " << out);
+  }
+ protected:
+  idx<T> *m;
+  T *base, *p;
+  bool contiguous;
+  intg dim[MAXDIMS], mod[MAXDIMS];
+};
+
+//! Leaf of an expression: a constant.
+template <typename T> class lazy_scalar {
+ public:
+  typedef T value_type;
+  lazy_scalar(T v_) : v(v_) {}
+  inline T operator[](intg i) const { return v; }
+  inline T get() const { return v; }
+  inline void step(int d) {}
+  inline void rewind(int d) {}
+  inline bool contiguousp() const { return true; }
+  template <typename T2> void check(idx<T2> &out) const {}
+ protected:
+  T v;
+};
+
+//! Node applying Op to the results of expressions L and R.
+template <class L, class R, class Op> class lazy_binary {
+ public:
+  typedef typename L::value_type value_type;
+  lazy_binary(const L &l_, const R &r_) : l(l_), r(r_) {}
+  inline value_type operator[](intg i) const { return Op::apply(l[i], r[i]); }
+  inline value_type get() const { return Op::apply(l.get(), r.get()); }
+  inline void step(int d) { l.step(d); r.step(d); }
+  inline void rewind(int d) { l.rewind(d); r.rewind(d); }
+  inline bool contiguousp() const { return l.contiguousp() && r.contiguousp(); }
+  template <typename T2> void check(idx<T2> &out) const {
+    l.check(out);
+    r.check(out);
+  }
+ protected:
+  L l;
+  R r;
+};
+
+//! Node applying Op to the result of expression E.
+template <class E, class Op> class lazy_unary {
+ public:
+  typedef typename E::value_type value_type;
+  lazy_unary(const E &e_) : e(e_) {}
+  inline value_type operator[](intg i) const { return Op::apply(e[i]); }
+  inline value_type get() const { return Op::apply(e.get()); }
+  inline void step(int d) { e.step(d); }
+  inline void rewind(int d) { e.rewind(d); }
+  inline bool contiguousp() const { return e.contiguousp(); }
+  template <typename T2> void check(idx<T2> &out) const { e.check(out); }
+ protected:
+  E e;
+};
+
+// operations //////////////////////////////////////////////////////////////////
+
+struct lazy_add {
+  template <typename T> static inline T apply(T a, T b) { return a + b; } };
+struct lazy_sub {
+  template <typename T> static inline T apply(T a, T b) { return a - b; } };
+struct lazy_mul {
+  template <typename T> static inline T apply(T a, T b) { return a * b; } };
+struct lazy_div {
+  template <typename T> static inline T apply(T a, T b) { return a / b; } };
+struct lazy_neg {
+  template <typename T> static inline T apply(T a) { return -a; } };
+struct lazy_sqrt_op {
+  template <typename T> static inline T apply(T a) { return (T) sqrt(a); } };
+//! Returns -1 for negative values, 1 otherwise.
+struct lazy_sign_op {
+  template <typename T> static inline T apply(T a) {
+    return a < 0 ? (T) -1 : (T) 1; } };
+
+// idx_expr ////////////////////////////////////////////////////////////////////
+
+//! Wrapper marking E as a lazy expression, on which operators are defined.
+template <class E> class idx_expr {
+ public:
+  typedef typename E::value_type value_type;
+  idx_expr(const E &e_) : e(e_) {}
+  E e; //!< The wrapped expression.
+};
+
+//! Returns a lazy expression term reading idx 'm'.
+template <typename T> inline idx_expr<lazy_leaf<T> > idx_lazy(idx<T> &m) {
+  return idx_expr<lazy_leaf<T> >(lazy_leaf<T>(m));
+}
+
+//! Defines lazy operator 'op' with Op, between expressions and with scalars
+//! on either side.
+#define LAZY_BINARY_OPERATOR(op, Op)					\
+  template <class L, class R>						\
+  inline idx_expr<lazy_binary<L, R, Op> >				\
+  operator op(const idx_expr<L> &l, const idx_expr<R> &r) {		\
+    return idx_expr<lazy_binary<L, R, Op> >				\
+      (lazy_binary<L, R, Op>(l.e, r.e));				\
+  }									\
+  template <class L>							\
+  inline idx_expr<lazy_binary<L, lazy_scalar<typename L::value_type>, Op> > \
+  operator op(const idx_expr<L> &l, typename L::value_type r) {		\
+    typedef lazy_scalar<typename L::value_type> S;			\
+    return idx_expr<lazy_binary<L, S, Op> >(lazy_binary<L, S, Op>(l.e, S(r))); \
+  }									\
+  template <class R>							\
+  inline idx_expr<lazy_binary<lazy_scalar<typename R::value_type>, R, Op> > \
+  operator op(typename R::value_type l, const idx_expr<R> &r) {		\
+    typedef lazy_scalar<typename R::value_type> S;			\
+    return idx_expr<lazy_binary<S, R, Op> >(lazy_binary<S, R, Op>(S(l), r.e)); \
+  }
+
+LAZY_BINARY_OPERATOR(+, lazy_add)
+LAZY_BINARY_OPERATOR(-, lazy_sub)
+LAZY_BINARY_OPERATOR(*, lazy_mul)
+LAZY_BINARY_OPERATOR(/, lazy_div)
+
+//! Lazy negation.
+template <class E> inline idx_expr<lazy_unary<E, lazy_neg> >
+operator-(const idx_expr<E> &e) {
+  return idx_expr<lazy_unary<E, lazy_neg> >(lazy_unary<E, lazy_neg>(e.e));
+}
+
+//! Lazy square root.
+template <class E> inline idx_expr<lazy_unary<E, lazy_sqrt_op> >
+lazy_sqrt(const idx_expr<E> &e) {
+  return idx_expr<lazy_unary<E, lazy_sqrt_op> >
+    (lazy_unary<E, lazy_sqrt_op>(e.e));
+}
+
+//! Lazy sign: -1 for negative elements, 1 otherwise.
+template <class E> inline idx_expr<lazy_unary<E, lazy_sign_op> >
+lazy_sign(const idx_expr<E> &e) {
+  return idx_expr<lazy_unary<E, lazy_sign_op> >
+    (lazy_unary<E, lazy_sign_op>(e.e));
+}
+
+// evaluation //////////////////////////////////////////////////////////////////
+
+//! Evaluates expression 'e' into 'out' in a single pass.
+template <typename T, class E> void idx_eval(idx<T> &out, const idx_expr<E> &e);
+
+//! Evaluates expressions 'e1' into 'out1' and 'e2' into 'out2' in a single
+//! pass. For each element, 'e1' is evaluated and stored first, so 'e2' may
+//! read the new value of 'out1'.
+template <typename T, class E1, class E2>
+void idx_eval(idx<T> &out1, const idx_expr<E1> &e1,
+	      idx<T> &out2, const idx_expr<E2> &e2);
+
+} // end namespace ebl
+
+#include "idxexpr.hpp"
+
+#endif /* IDXEXPR_H_ */
@@ -0,0 +1,149 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef IDXEXPR_HPP_
+#define IDXEXPR_HPP_
+
+namespace ebl {
+
+// lazy_leaf ///////////////////////////////////////////////////////////////////
+
+template <typename T>
+lazy_leaf<T>::lazy_leaf(idx<T> &m_)
+  : m(&m_), base(m_.idx_ptr()), p(base), contiguous(m_.contiguousp()) {
+  for (int i = 0; i < m_.order(); ++i) {
+    dim[i] = m_.dim(i);
+    mod[i] = m_.mod(i);
+  }
+}
+
+// assignments /////////////////////////////////////////////////////////////////
+
+//! Stores the results of expression E into an idx. It walks the output
+//! like expressions walk their leaves.
+template <typename T, class E> class lazy_assign {
+ public:
+  lazy_assign(idx<T> &out, const E &e_)
+    : e(e_), base(out.idx_ptr()), p(base),
+      contiguous(out.contiguousp() && e_.contiguousp()) {
+    e.check(out);
+    for (int i = 0; i < out.order(); ++i) {
+      dim[i] = out.dim(i);
+      mod[i] = out.mod(i);
+    }
+  }
+  inline bool contiguousp() const { return contiguous; }
+  inline void linear(intg i) { base[i] = (T) e[i]; }
+  inline void current() { *p = (T) e.get(); }
+  inline void step(int d) { p += mod[d]; e.step(d); }
+  inline void rewind(int d) { p -= dim[d] * mod[d]; e.rewind(d); }
+ protected:
+  E e;
+  T *base, *p;
+  bool contiguous;
+  intg dim[MAXDIMS], mod[MAXDIMS];
+};
+
+//! Performs assignments A1 then A2 on each element.
+template <class A1, class A2> class lazy_assign2 {
+ public:
+  lazy_assign2(const A1 &a1_, const A2 &a2_) : a1(a1_), a2(a2_) {}
+  inline bool contiguousp() const {
+    return a1.contiguousp() && a2.contiguousp(); }
+  inline void linear(intg i) { a1.linear(i); a2.linear(i); }
+  inline void current() { a1.current(); a2.current(); }
+  inline void step(int d) { a1.step(d); a2.step(d); }
+  inline void rewind(int d) { a1.rewind(d); a2.rewind(d); }
+ protected:
+  A1 a1;
+  A2 a2;
+};
+
+//! Runs assignment 'a' over all elements of an idx with the dimensions
+//! of 'shape', with a single linear loop when everything is contiguous.
+template <typename T, class A> void lazy_run(idx<T> &shape, A &a) {
+  intg n = shape.nelements();
+  if (n == 0) return ;
+  if (a.contiguousp()) {
+    for (intg i = 0; i < n; ++i)
+      a.linear(i);
+    return ;
+  }
+  int order = shape.order();
+  if (order == 0) {
+    a.current();
+    return ;
+  }
+  // walk all dimensions like an odometer, the last one being the fastest
+  intg d[MAXDIMS];
+  int k, last = order - 1;
+  intg i, nlast = shape.dim(last);
+  for (k = 0; k < order; ++k) d[k] = 0;
+  for (;;) {
+    for (i = 0; i < nlast; ++i) {
+      a.current();
+      a.step(last);
+    }
+    a.rewind(last);
+    for (k = last - 1; k >= 0; --k) {
+      a.step(k);
+      if (++d[k] < shape.dim(k))
+	break ;
+      a.rewind(k);
+      d[k] = 0;
+    }
+    if (k < 0) return ;
+  }
+}
+
+// evaluation //////////////////////////////////////////////////////////////////
+
+template <typename T, class E>
+void idx_eval(idx<T> &out, const idx_expr<E> &e) {
+  lazy_assign<T,E> a(out, e.e);
+  lazy_run(out, a);
+}
+
+template <typename T, class E1, class E2>
+void idx_eval(idx<T> &out1, const idx_expr<E1> &e1,
+	      idx<T> &out2, const idx_expr<E2> &e2) {
+  if (out1.get_idxdim() != out2.get_idxdim())
+    eblerror("expected same dimensions for outputs " << out1 << " and "
+	     << out2);
+  lazy_assign2<lazy_assign<T,E1>, lazy_assign<T,E2> >
+    a(lazy_assign<T,E1>(out1, e1.e), lazy_assign<T,E2>(out2, e2.e));
+  lazy_run(out1, a);
+}
+
+} // end namespace ebl
+
+#endif /* IDXEXPR_HPP_ */
@@ -33,9 +33,12 @@
 #ifndef IDXOPS_H
 #define IDXOPS_H
 
+#include <limits>
+
 #include "config.h"
 #include "numerics.h"
 #include "idx.h"
+#include "half.h"
 
 namespace ebl {
 
@@ -54,6 +57,18 @@ template <> void idx_copy(const idx<float32> &src, idx<float32> &dst);
 //! copy, specialized float64 version
 //! \ingroup index_operations
 template <> void idx_copy(const idx<float64> &src, idx<float64> &dst);
+//! copy, specialized float16 to float32 conversion
+//! \ingroup index_operations
+template <> void idx_copy(const idx<float16> &src, idx<float32> &dst);
+//! copy, specialized float32 to float16 conversion
+//! \ingroup index_operations
+template <> void idx_copy(const idx<float32> &src, idx<float16> &dst);
+//! copy, specialized bfloat16 to float32 conversion
+//! \ingroup index_operations
+template <> void idx_copy(const idx<bfloat16> &src, idx<float32> &dst);
+//! copy, specialized float32 to bfloat16 conversion
+//! \ingroup index_operations
+template <> void idx_copy(const idx<float32> &src, idx<bfloat16> &dst);
 //! Generic copy, returns the copied idx
 //! \ingroup index_operations
 template <typename T1, typename T2> idx<T1> idx_copy(const idx<T2> &src);
@@ -330,6 +345,13 @@ template <typename T> void idx_dtanh(idx<T> &inp, idx<T> &out);
 template <typename T> void idx_stdsigmoid(idx<T> &inp, idx<T> &out);
 //! derivative of standard Lush sigmoid
 template <typename T> void idx_dstdsigmoid(idx<T> &inp, idx<T> &out);
+//! Fast approximation of out = b * tanh(a * inp), using tanh_fast().
+//! e.g. a = STDSIGMOID_A and b = STDSIGMOID_B approximates idx_stdsigmoid().
+template <typename T>
+void idx_tanh_fast(idx<T> &inp, idx<T> &out, T a = 1, T b = 1);
+//! Derivative of idx_tanh_fast(): out = a * b * dtanh_fast(a * inp).
+template <typename T>
+void idx_dtanh_fast(idx<T> &inp, idx<T> &out, T a = 1, T b = 1);
 
 // idx_abs ///////////////////////////////////////////////////////////////////
 
@@ -557,6 +579,8 @@ template <typename T> void idx_m2dotm1acc(idx<T> &a, idx<T> &x, idx<T> &y);
 
 //! Matrix-Matrix multiplication, y <- a . x
 template <typename T> void idx_m2dotm2(idx<T> &a, idx<T> &x, idx<T> &y);
+//! Matrix-Matrix multiplication with accumulation, y <- y + a . x
+template <typename T> void idx_m2dotm2acc(idx<T> &a, idx<T> &x, idx<T> &y);
 //! Matrix-Matrix multiplication, y <- a . x
 template <typename T> void idx_m2dotm3(idx<T> &a, idx<T> &x, idx<T> &y);
 
@@ -633,9 +657,41 @@ EXPORT void idx_m1squextm1acc(idx<float> &a, idx<float> &x, idx<float> &y);
 // idx_2dconvol //////////////////////////////////////////////////////////////
 
 //! 2D convolution. all arguments are idx2.
+//! Floating-point box kernels (all coefficients equal) are computed with an
+//! integral image and separable kernels (e.g. gaussians) with two 1D
+//! passes, other kernels with a full 2D convolution.
 //! Be careful that it does not uses IPP
 // TODO: specialize a float version that uses IPP
 template <typename T> void idx_2dconvol(idx<T> &in, idx<T> &kernel, idx<T> &out);
+//! Returns true if 2D 'kernel' is the outer product of a column and a row
+//! vector (rank 1), i.e. if kernel(i,j) = col(i) * row(j) up to 'tolerance'
+//! times its largest absolute coefficient. 'col' and 'row' are written in
+//! place if they are already 1D with the kernel's sizes, allocated otherwise,
+//! and are only meaningful when true is returned.
+template <typename T> bool idx_separable(idx<T> &kernel, idx<T> &col,
+                                         idx<T> &row, double tolerance = 1e-5);
+//! 2D convolution of 'in' with the separable kernel col x row (see
+//! idx_separable()), computed with a horizontal 1D pass of 'row' followed by a
+//! vertical 1D pass of 'col'. Rows are computed in parallel with OpenMP.
+template <typename T> void idx_2dconvol_separable(idx<T> &in, idx<T> &col,
+                                                  idx<T> &row, idx<T> &out);
+//! Same as above, with 'tmp' holding the horizontal pass. 'tmp' is resized
+//! to (in.dim(0) x out.dim(1)) if needed, so that it is not reallocated when
+//! reused across calls.
+template <typename T> void idx_2dconvol_separable(idx<T> &in, idx<T> &col,
+                                                  idx<T> &row, idx<T> &out,
+                                                  idx<T> &tmp);
+//! 2D convolution of 'in' with a (ki x kj) box kernel whose coefficients
+//! all equal 'v'. Window sums are read from an integral image of 'in', so
+//! the cost does not depend on the kernel size. Rows are computed in
+//! parallel with OpenMP.
+template <typename T> void idx_2dconvol_box(idx<T> &in, intg ki, intg kj, T v,
+                                            idx<T> &out);
+//! Same as above, with the integral image held by 'integral', which is
+//! resized if needed so that it is not reallocated when reused across calls.
+template <typename T> void idx_2dconvol_box(idx<T> &in, intg ki, intg kj, T v,
+                                            idx<T> &out,
+                                            idx<double> &integral);
 //! 3D convolution, each layer of the first dimension is convolved
 //! using idx_2dconvol().
 template <typename T> void idx_3dconvol(idx<T> &in, idx<T> &kernel, idx<T> &out);
@@ -793,5 +849,7 @@ template <typename T> float64 idx_stddev(idx<T> &m);
 #include "ipp.h"
 #include "th.h"
 #include "blasops.h"
+#include "simd.h"
+#include "gemm.h"
 
 #endif
@@ -727,6 +727,27 @@ template <typename T> void idx_dstdsigmoid(idx<T> &inp, idx<T> &out) {
     });
 }
 
+// idx_tanh_fast /////////////////////////////////////////////////////////////
+
+template <typename T>
+void idx_tanh_fast(idx<T> &inp, idx<T> &out, T a, T b) {
+  idx_checknelems2_all(inp, out);
+  idx_aloopf2(pinp, inp, T, pout, out, T, {
+      *pout = b * tanh_fast(a * *pinp);
+    });
+}
+
+// idx_dtanh_fast ////////////////////////////////////////////////////////////
+
+template <typename T>
+void idx_dtanh_fast(idx<T> &inp, idx<T> &out, T a, T b) {
+  idx_checknelems2_all(inp, out);
+  T ab = a * b;
+  idx_aloopf2(pinp, inp, T, pout, out, T, {
+      *pout = ab * dtanh_fast(a * *pinp);
+    });
+}
+
 // idx_abs ///////////////////////////////////////////////////////////////////
 
 template <typename T> inline T abs2 (T a) {
@@ -1199,17 +1220,32 @@ void idx_m2dotm1acc(idx<T> &i1, idx<T> &i2, idx<T> &o1) {
 
 template <class T>
 void idx_m2dotm3(idx<T> &i1, idx<T> &i2, idx<T> &o1) {
-  idx_bloop2(ii2, i2, T, oo1, o1, T) {
-    idx_bloop2(iii2, ii2, T, ooo1, oo1, T) {
-      idx_m2dotm1(i1, iii2, ooo1);
+  idx_checkorder3(i1, 2, i2, 3, o1, 3);
+  if (i1.dim(1) != i2.dim(2) || i1.dim(0) != o1.dim(2))
+    idx_compatibility_error3(i1, i2, o1, "incompatible dimensions");
+  // the matrix is usually tiny (e.g. 2x3 for affine transforms), use views
+  // to avoid creating an idx per element.
+  idx_view<T,2> a(i1);
+  idx_view<T,3> x(i2), y(o1);
+  intg i, j, imax = a.dim[0], jmax = a.dim[1];
+  T f;
+  view_bloop2(xx, x, yy, y) {
+    view_bloop2(xxx, xx, yyy, yy) {
+      for (i = 0; i < imax; ++i) {
+	f = 0;
+	for (j = 0; j < jmax; ++j)
+	  f += a(i, j) * xxx(j);
+	yyy(i) = f;
+      }
     }
   }
 }
 
 // m2dotm2 ///////////////////////////////////////////////////////////////////
 
+// Computes o <- i1 . i2, or o <- o + i1 . i2 if 'acc' is true.
 template <class T>
-void idx_m2dotm2(idx<T> &i1, idx<T> &i2, idx<T> &o) {
+void idx_m2dotm2_generic(idx<T> &i1, idx<T> &i2, idx<T> &o, bool acc) {
   idx_checkorder3(i1, 2, i2, 2, o, 2);
   if (i1.dim(1) != i2.dim(0) || i1.dim(0) != o.dim(0) ||
           o.dim(1) != i2.dim(1))
@@ -1218,18 +1254,19 @@ void idx_m2dotm2(idx<T> &i1, idx<T> &i2, idx<T> &o) {
   T *c1, *c2, *c1_0, *ker;
   intg c1_m1 = i1.mod(1), c2_m0 = i2.mod(0);
   intg j, jmax = i2.dim(0);
-  intg c1_m0 = i1.mod(0), d1_m0 = o.mod(0);
+  intg c1_m0 = i1.mod(0), d1_m0 = o.mod(0), d1_m1 = o.mod(1);
+  intg c2_m1 = i2.mod(1);
   T *d1, f;
   intg i, imax = o.dim(0);
   intg k, kmax = o.dim(1);
   // loop on o.dim(1)
   for (k = 0; k < kmax; ++k) {
     c1_0 = i1.idx_ptr();
-    d1 = o.idx_ptr() + k;
-    ker = i2.idx_ptr() + k;
+    d1 = o.idx_ptr() + k * d1_m1;
+    ker = i2.idx_ptr() + k * c2_m1;
     // loop on o.dim(0)
     for (i=0; i<imax; i++){
-      f = 0;
+      f = acc ? *d1 : 0;
       c1 = c1_0;
       c2 = ker;
       // loop on
@@ -1249,6 +1286,16 @@ void idx_m2dotm2(idx<T> &i1, idx<T> &i2, idx<T> &o) {
   }
 }
 
+template <class T>
+void idx_m2dotm2(idx<T> &i1, idx<T> &i2, idx<T> &o) {
+  idx_m2dotm2_generic(i1, i2, o, false);
+}
+
+template <class T>
+void idx_m2dotm2acc(idx<T> &i1, idx<T> &i2, idx<T> &o) {
+  idx_m2dotm2_generic(i1, i2, o, true);
+}
+
 // m4dotm2 ///////////////////////////////////////////////////////////////////
 
 // TODO-0 write specialized blas version in cpp
@@ -1576,9 +1623,18 @@ template<typename T>
 void idx_m2oversample(idx<T>& small, intg nlin, intg ncol, idx<T>& big) {
   idx<T> uin  = big.unfold(0, nlin, nlin);
   idx<T> uuin = uin.unfold(1, ncol, ncol);
-  idx_eloop1(z1, uuin, T) {
-    idx_eloop1(z2, z1, T) {
-      idx_copy(small, z2);
+  idx_view<T,4> u(uuin);
+  idx_view<T,2> s(small);
+  view_checkdim2(u, s, 1);
+  T v;
+  view_bloop2(uu, u, ss, s) {
+    view_bloop2(uuu, uu, sss, ss) {
+      v = *sss;
+      view_bloop1(l, uuu) {
+	view_bloop1(c, l) {
+	  *c = v;
+	}
+      }
     }
   }
 }
@@ -1587,9 +1643,18 @@ template<typename T>
 void idx_m2oversampleacc(idx<T>& small, intg nlin, intg ncol, idx<T>& big) {
   idx<T> uin  = big.unfold(0, nlin, nlin);
   idx<T> uuin = uin.unfold(1, ncol, ncol);
-  idx_eloop1(z1, uuin, T) {
-    idx_eloop1(z2, z1, T) {
-      idx_add(small, z2, z2);
+  idx_view<T,4> u(uuin);
+  idx_view<T,2> s(small);
+  view_checkdim2(u, s, 1);
+  T v;
+  view_bloop2(uu, u, ss, s) {
+    view_bloop2(uuu, uu, sss, ss) {
+      v = *sss;
+      view_bloop1(l, uuu) {
+	view_bloop1(c, l) {
+	  *c += v;
+	}
+      }
     }
   }
 }
@@ -2034,11 +2099,170 @@ template <typename T> void idx_clip(idx<T> &i1, T m, idx<T> &o1) {
 
 template <typename T> void idx_2dconvol(idx<T> &in, idx<T> &kernel, idx<T> &out) {
   idx_checkorder3(in, 2, kernel, 2, out, 2);
+  intg ki = kernel.dim(0), kj = kernel.dim(1);
+  // fast paths when 1D passes are cheaper than the full kernel. integer
+  // types are excluded because separated factors are not integers.
+  if (!std::numeric_limits<T>::is_integer && ki * kj > ki + kj) {
+    T v = kernel.get(0, 0);
+    bool box = true;
+    for (intg i = 0; i < ki && box; ++i)
+      for (intg j = 0; j < kj && box; ++j)
+	if (kernel.get(i, j) != v) box = false;
+    if (box) {
+      idx_2dconvol_box(in, ki, kj, v, out);
+      return ;
+    }
+    idx<T> col, row;
+    if (idx_separable(kernel, col, row)) {
+      idx_2dconvol_separable(in, col, row, out);
+      return ;
+    }
+  }
   idx<T> uin(in.unfold(0, kernel.dim(0), 1));
   uin = uin.unfold(1, kernel.dim(1), 1);
   idx_m4dotm2(uin, kernel, out);
 }
 
+template <typename T>
+bool idx_separable(idx<T> &kernel, idx<T> &col, idx<T> &row,
+                   double tolerance) {
+  idx_checkorder1(kernel, 2);
+  intg ki = kernel.dim(0), kj = kernel.dim(1), i, j, pi = 0, pj = 0;
+  // pivot on the largest coefficient
+  double vmax = 0;
+  for (i = 0; i < ki; ++i)
+    for (j = 0; j < kj; ++j)
+      if (fabs((double) kernel.get(i, j)) > vmax) {
+	vmax = fabs((double) kernel.get(i, j));
+	pi = i;
+	pj = j;
+      }
+  if (vmax == 0) return false;
+  if (col.order() != 1 || col.dim(0) != ki) col = idx<T>(ki);
+  if (row.order() != 1 || row.dim(0) != kj) row = idx<T>(kj);
+  double p = (double) kernel.get(pi, pj);
+  for (i = 0; i < ki; ++i)
+    col.set(kernel.get(i, pj), i);
+  for (j = 0; j < kj; ++j)
+    row.set((T) (kernel.get(pi, j) / p), j);
+  // check that the outer product reconstructs the kernel
+  for (i = 0; i < ki; ++i)
+    for (j = 0; j < kj; ++j)
+      if (fabs((double) kernel.get(i, j) - (double) col.get(i) * row.get(j))
+	  > tolerance * vmax)
+	return false;
+  return true;
+}
+
+template <typename T>
+void idx_2dconvol_separable(idx<T> &in, idx<T> &col, idx<T> &row,
+                            idx<T> &out) {
+  idx<T> tmp;
+  idx_2dconvol_separable(in, col, row, out, tmp);
+}
+
+template <typename T>
+void idx_2dconvol_separable(idx<T> &in, idx<T> &col, idx<T> &row,
+                            idx<T> &out, idx<T> &tmp) {
+  idx_checkorder3(in, 2, col, 1, row, 1);
+  idx_checkorder1(out, 2);
+  intg ki = col.dim(0), kj = row.dim(0), ih = in.dim(0);
+  intg oh = out.dim(0), ow = out.dim(1), i;
+  if (ih != oh + ki - 1 || in.dim(1) != ow + kj - 1)
+    eblerror("expected " << in << " to be " << out << " plus (" << ki
+	     << "x" << kj << ") kernel minus 1");
+  if (tmp.order() != 2) tmp = idx<T>(ih, ow);
+  else tmp.resize(ih, ow);
+  const T *pc = col.idx_ptr(), *pr = row.idx_ptr();
+  intg cm = col.mod(0), rm = row.mod(0);
+  intg im0 = in.mod(0), im1 = in.mod(1), om0 = out.mod(0), om1 = out.mod(1);
+  // horizontal pass on every input row
+#ifdef __OPENMP__
+#pragma omp parallel for private(i)
+#endif
+  for (i = 0; i < ih; ++i) {
+    const T *pi = in.idx_ptr() + i * im0;
+    T *pt = tmp.idx_ptr() + i * ow;
+    for (intg j = 0; j < ow; ++j)
+      pt[j] = pi[j * im1] * pr[0];
+    for (intg b = 1; b < kj; ++b) {
+      const T *pib = pi + b * im1, rb = pr[b * rm];
+      for (intg j = 0; j < ow; ++j)
+	pt[j] += pib[j * im1] * rb;
+    }
+  }
+  // vertical pass on every output row
+#ifdef __OPENMP__
+#pragma omp parallel for private(i)
+#endif
+  for (i = 0; i < oh; ++i) {
+    const T *pt = tmp.idx_ptr() + i * ow;
+    T *po = out.idx_ptr() + i * om0;
+    for (intg j = 0; j < ow; ++j)
+      po[j * om1] = pt[j] * pc[0];
+    for (intg a = 1; a < ki; ++a) {
+      const T *pta = pt + a * ow, ca = pc[a * cm];
+      for (intg j = 0; j < ow; ++j)
+	po[j * om1] += pta[j] * ca;
+    }
+  }
+}
+
+template <typename T>
+void idx_2dconvol_box(idx<T> &in, intg ki, intg kj, T v, idx<T> &out) {
+  idx<double> integral;
+  idx_2dconvol_box(in, ki, kj, v, out, integral);
+}
+
+template <typename T>
+void idx_2dconvol_box(idx<T> &in, intg ki, intg kj, T v, idx<T> &out,
+                      idx<double> &integral) {
+  idx_checkorder2(in, 2, out, 2);
+  intg ih = in.dim(0), iw = in.dim(1), oh = out.dim(0), ow = out.dim(1), i;
+  if (ih != oh + ki - 1 || iw != ow + kj - 1)
+    eblerror("expected " << in << " to be " << out << " plus (" << ki
+	     << "x" << kj << ") kernel minus 1");
+  // integral image with a leading row and column of zeros, accumulated in
+  // double precision to avoid the drift of long float sums
+  if (integral.order() != 2) integral = idx<double>(ih + 1, iw + 1);
+  else integral.resize(ih + 1, iw + 1);
+  double *ii = integral.idx_ptr();
+  intg im0 = in.mod(0), im1 = in.mod(1), om0 = out.mod(0), om1 = out.mod(1);
+  intg w = iw + 1;
+  for (intg j = 0; j < w; ++j)
+    ii[j] = 0;
+  // prefix sums of each row
+#ifdef __OPENMP__
+#pragma omp parallel for private(i)
+#endif
+  for (i = 0; i < ih; ++i) {
+    const T *pi = in.idx_ptr() + i * im0;
+    double *pr = ii + (i + 1) * w, s = 0;
+    pr[0] = 0;
+    for (intg j = 0; j < iw; ++j) {
+      s += (double) pi[j * im1];
+      pr[j + 1] = s;
+    }
+  }
+  // prefix sums of each column
+  for (i = 1; i <= ih; ++i) {
+    double *pr = ii + i * w, *pp = pr - w;
+    for (intg j = 1; j < w; ++j)
+      pr[j] += pp[j];
+  }
+  // window sums
+#ifdef __OPENMP__
+#pragma omp parallel for private(i)
+#endif
+  for (i = 0; i < oh; ++i) {
+    const double *top = ii + i * w, *bottom = top + ki * w;
+    T *po = out.idx_ptr() + i * om0;
+    for (intg j = 0; j < ow; ++j)
+      po[j * om1] = (T) (v * (bottom[j + kj] - bottom[j]
+			      - top[j + kj] + top[j]));
+  }
+}
+
 template <typename T> void idx_3dconvol(idx<T> &in, idx<T> &kernel, idx<T> &out) {
   idx_bloop2(i, in, T, o, out, T) {
     idx_2dconvol(i, kernel, o);
@@ -0,0 +1,175 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef IDXVIEW_H_
+#define IDXVIEW_H_
+
+#include "defines.h"
+
+namespace ebl {
+
+// forward declarations
+template <typename T> class idx;
+
+// idx_view ////////////////////////////////////////////////////////////////////
+
+//! idx_view is a non-owning, non-refcounted window on the data of an idx of
+//! order N: a data pointer plus N dimensions and N strides.
+//! Unlike idx or idxlooper, constructing, copying or destroying a view does
+//! not touch any reference counter nor the heap, it is trivially copyable
+//! and can be passed by value to inner-loop functions.
+//! Element access is not bounds-checked unless __DEBUG__ is defined.
+//! A view must not outlive the storage of the idx it was taken from.
+//! Example:
+//!   idx_view<float,3> v(m);
+//!   { view_bloop1(row, v) { view_bloop1(pix, row) { pix(0) = 0; } } }
+template <typename T, int N> class idx_view {
+ public:
+  //! Order of this view.
+  enum { rank = N };
+  //! Empty constructor, members are left uninitialized.
+  idx_view();
+  //! Take a view on idx 'm', whose order must be N.
+  explicit idx_view(idx<T> &m);
+  //! Take a view on raw data with dimensions 'dims' and strides 'mods'.
+  idx_view(T *ptr, const intg *dims, const intg *mods);
+
+  //! Returns a view of order N-1 by fixing dimension 'd' to index 'i'.
+  idx_view<T,N-1> select(int d, intg i) const;
+  //! Equivalent to select(0, i).
+  idx_view<T,N-1> operator[](intg i) const;
+  //! Returns a view narrowed to 'size' elements of dimension 'd',
+  //! starting at 'offset'.
+  idx_view<T,N> narrow(int d, intg size, intg offset) const;
+
+  //! Element accessors, the number of indices must match N.
+  T& operator()(intg i0) const;
+  T& operator()(intg i0, intg i1) const;
+  T& operator()(intg i0, intg i1, intg i2) const;
+  T& operator()(intg i0, intg i1, intg i2, intg i3) const;
+
+  //! Returns the total number of elements.
+  intg nelements() const;
+  //! Returns true if elements are contiguous in memory.
+  bool contiguousp() const;
+
+  // members ///////////////////////////////////////////////////////////////
+  T *data; //!< Pointer to first element.
+  intg dim[N]; //!< Dimensions.
+  intg mod[N]; //!< Strides.
+};
+
+//! A view of order 0 is a pointer to a single element.
+template <typename T> class idx_view<T,0> {
+ public:
+  enum { rank = 0 };
+  idx_view() {}
+  explicit idx_view(T *ptr) : data(ptr) {}
+  //! Returns the element.
+  T& operator*() const { return *data; }
+  T& operator()() const { return *data; }
+  intg nelements() const { return 1; }
+  bool contiguousp() const { return true; }
+  T *data; //!< Pointer to element.
+};
+
+// view loops //////////////////////////////////////////////////////////////////
+
+//! The type of an expression, used to declare loop variables in view loops
+//! without having to spell out their rank.
+#if defined(_MSC_VER)
+#define EBL_TYPEOF(x) decltype(x)
+#else
+#define EBL_TYPEOF(x) __typeof__(x)
+#endif
+
+//! Calls eblerror if views src0 and src1 differ in dimension d.
+#define view_checkdim2(src0, src1, d)					\
+  if ((src0).dim[d] != (src1).dim[d])					\
+    eblerror("incompatible views, expected same sizes in dimension " << d \
+	     << " but got " << (src0).dim[d] << " and " << (src1).dim[d]);
+
+//! Calls eblerror if views src0, src1 and src2 differ in dimension d.
+#define view_checkdim3(src0, src1, src2, d)				\
+  view_checkdim2(src0, src1, d) view_checkdim2(src0, src2, d)
+
+//! view_bloopX are the idx_view counterparts of idx_bloopX: they loop over
+//! the first dimension of views src0, src1, ..., declaring views dst0,
+//! dst1, ... of order N-1. The loop variables are plain views whose data
+//! pointer is advanced at each step, no idx or refcount is involved.
+//! Like idx_bloop, calls must be enclosed in braces when loop variable names
+//! are reused in the same scope.
+#define view_bloop1(dst0, src0)						\
+  EBL_TYPEOF((src0).select(0, 0)) dst0 = (src0).select(0, 0);		\
+  for (intg dst0##_i = 0; dst0##_i < (src0).dim[0];			\
+       ++dst0##_i, dst0.data += (src0).mod[0])
+
+#define view_bloop2(dst0, src0, dst1, src1)				\
+  view_checkdim2(src0, src1, 0);					\
+  EBL_TYPEOF((src0).select(0, 0)) dst0 = (src0).select(0, 0);		\
+  EBL_TYPEOF((src1).select(0, 0)) dst1 = (src1).select(0, 0);		\
+  for (intg dst0##_i = 0; dst0##_i < (src0).dim[0]; ++dst0##_i,	\
+	 dst0.data += (src0).mod[0], dst1.data += (src1).mod[0])
+
+#define view_bloop3(dst0, src0, dst1, src1, dst2, src2)			\
+  view_checkdim3(src0, src1, src2, 0);					\
+  EBL_TYPEOF((src0).select(0, 0)) dst0 = (src0).select(0, 0);		\
+  EBL_TYPEOF((src1).select(0, 0)) dst1 = (src1).select(0, 0);		\
+  EBL_TYPEOF((src2).select(0, 0)) dst2 = (src2).select(0, 0);		\
+  for (intg dst0##_i = 0; dst0##_i < (src0).dim[0]; ++dst0##_i,	\
+	 dst0.data += (src0).mod[0], dst1.data += (src1).mod[0],	\
+	 dst2.data += (src2).mod[0])
+
+//! view_eloopX are the idx_view counterparts of idx_eloopX: they loop over
+//! the last dimension of the source views.
+#define view_eloop1(dst0, src0)						\
+  EBL_TYPEOF((src0).select((src0).rank - 1, 0)) dst0 =			\
+    (src0).select((src0).rank - 1, 0);					\
+  for (intg dst0##_i = 0; dst0##_i < (src0).dim[(src0).rank - 1];	\
+       ++dst0##_i, dst0.data += (src0).mod[(src0).rank - 1])
+
+#define view_eloop2(dst0, src0, dst1, src1)				\
+  if ((src0).dim[(src0).rank - 1] != (src1).dim[(src1).rank - 1])	\
+    eblerror("incompatible views for eloop");				\
+  EBL_TYPEOF((src0).select((src0).rank - 1, 0)) dst0 =			\
+    (src0).select((src0).rank - 1, 0);					\
+  EBL_TYPEOF((src1).select((src1).rank - 1, 0)) dst1 =			\
+    (src1).select((src1).rank - 1, 0);					\
+  for (intg dst0##_i = 0; dst0##_i < (src0).dim[(src0).rank - 1];	\
+       ++dst0##_i, dst0.data += (src0).mod[(src0).rank - 1],		\
+	 dst1.data += (src1).mod[(src1).rank - 1])
+
+} // end namespace ebl
+
+#include "idxview.hpp"
+
+#endif /* IDXVIEW_H_ */
@@ -0,0 +1,177 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef IDXVIEW_HPP_
+#define IDXVIEW_HPP_
+
+namespace ebl {
+
+#ifdef __DEBUG__
+#define view_checkindex(d, i)						\
+  if ((i) < 0 || (i) >= dim[d])						\
+    eblerror("index " << (i) << " out of bounds in dimension " << (d)	\
+	     << " of size " << dim[d]);
+#define view_checkrank(n)						\
+  if (N != (n)) eblerror("expected " << N << " indices but got " << (n));
+#else
+#define view_checkindex(d, i)
+#define view_checkrank(n)
+#endif
+
+// idx_view ////////////////////////////////////////////////////////////////////
+
+template <typename T, int N>
+idx_view<T,N>::idx_view() {
+}
+
+template <typename T, int N>
+idx_view<T,N>::idx_view(idx<T> &m) : data(m.idx_ptr()) {
+  if (m.order() != N)
+    eblerror("cannot take a view of order " << N << " on " << m);
+  for (int i = 0; i < N; ++i) {
+    dim[i] = m.dim(i);
+    mod[i] = m.mod(i);
+  }
+}
+
+template <typename T, int N>
+idx_view<T,N>::idx_view(T *ptr, const intg *dims, const intg *mods)
+  : data(ptr) {
+  for (int i = 0; i < N; ++i) {
+    dim[i] = dims[i];
+    mod[i] = mods[i];
+  }
+}
+
+//! Helper removing a dimension from a view, specialized for order 1 views
+//! since order 0 views do not have dimensions.
+template <typename T, int N> struct view_selector {
+  static inline idx_view<T,N-1> select(const idx_view<T,N> &m, int d,
+				       intg i) {
+    idx_view<T,N-1> v;
+    v.data = m.data + i * m.mod[d];
+    for (int k = 0, j = 0; k < N; ++k)
+      if (k != d) {
+	v.dim[j] = m.dim[k];
+	v.mod[j] = m.mod[k];
+	j++;
+      }
+    return v;
+  }
+};
+
+template <typename T> struct view_selector<T,1> {
+  static inline idx_view<T,0> select(const idx_view<T,1> &m, int d, intg i) {
+    return idx_view<T,0>(m.data + i * m.mod[0]);
+  }
+};
+
+template <typename T, int N>
+inline idx_view<T,N-1> idx_view<T,N>::select(int d, intg i) const {
+  view_checkindex(d, i);
+  return view_selector<T,N>::select(*this, d, i);
+}
+
+template <typename T, int N>
+inline idx_view<T,N-1> idx_view<T,N>::operator[](intg i) const {
+  return select(0, i);
+}
+
+template <typename T, int N>
+inline idx_view<T,N> idx_view<T,N>::narrow(int d, intg size, intg offset)
+  const {
+  if (offset < 0 || size < 0 || offset + size > dim[d])
+    eblerror("cannot narrow dimension " << d << " of size " << dim[d]
+	     << " to " << size << " elements at offset " << offset);
+  idx_view<T,N> v = *this;
+  v.data += offset * mod[d];
+  v.dim[d] = size;
+  return v;
+}
+
+template <typename T, int N>
+inline T& idx_view<T,N>::operator()(intg i0) const {
+  view_checkrank(1);
+  view_checkindex(0, i0);
+  return data[i0 * mod[0]];
+}
+
+template <typename T, int N>
+inline T& idx_view<T,N>::operator()(intg i0, intg i1) const {
+  view_checkrank(2);
+  view_checkindex(0, i0);
+  view_checkindex(1, i1);
+  return data[i0 * mod[0] + i1 * mod[1]];
+}
+
+template <typename T, int N>
+inline T& idx_view<T,N>::operator()(intg i0, intg i1, intg i2) const {
+  view_checkrank(3);
+  view_checkindex(0, i0);
+  view_checkindex(1, i1);
+  view_checkindex(2, i2);
+  return data[i0 * mod[0] + i1 * mod[1] + i2 * mod[2]];
+}
+
+template <typename T, int N>
+inline T& idx_view<T,N>::operator()(intg i0, intg i1, intg i2, intg i3)
+  const {
+  view_checkrank(4);
+  view_checkindex(0, i0);
+  view_checkindex(1, i1);
+  view_checkindex(2, i2);
+  view_checkindex(3, i3);
+  return data[i0 * mod[0] + i1 * mod[1] + i2 * mod[2] + i3 * mod[3]];
+}
+
+template <typename T, int N>
+inline intg idx_view<T,N>::nelements() const {
+  intg n = 1;
+  for (int i = 0; i < N; ++i)
+    n *= dim[i];
+  return n;
+}
+
+template <typename T, int N>
+inline bool idx_view<T,N>::contiguousp() const {
+  intg size = 1;
+  for (int i = N - 1; i >= 0; --i) {
+    if (mod[i] != size && dim[i] != 1)
+      return false;
+    size *= dim[i];
+  }
+  return true;
+}
+
+} // end namespace ebl
+
+#endif /* IDXVIEW_HPP_ */
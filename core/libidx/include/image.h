@@ -40,6 +40,7 @@
 #include "numerics.h"
 #include "filters.h"
 #include "padder.h"
+#include "resampler.h"
 
 namespace ebl {
   
@@ -75,9 +76,13 @@ namespace ebl {
   //!         target dimensions and background is filled with zeros.
   //! The sizes of the output image are rounded to nearest integers
   //! smaller than the computed sizes, or to 1, whichever is largest.
+  //! Non-integer images are interpolated by resampler 'rs', or by a
+  //! temporary one if NULL. Passing the same resampler to repeated calls
+  //! reuses its coefficient tables.
   template<typename T> 
     idx<T> image_resize(idx<T> &im, double h, double w, int mode = 1,
-			rect<int> *iregion = NULL, rect<int> *oregion = NULL);
+			rect<int> *iregion = NULL, rect<int> *oregion = NULL,
+			resampler<T> *rs = NULL);
 
   //! resizes an image (a region iregion of im if specified) into an image of
   //! size oheightxowidth using gaussian pyramids. Bilinear resizing is first
@@ -87,10 +92,13 @@ namespace ebl {
   //! iregion (the entire image if not specified).
   //! oregion is filled by the function if given and represents the resized
   //! region of iregion.
+  //! Non-integer images reduced by this function are resampled in a single
+  //! pass by resampler 'rs' (see image_resize()).
   template<typename T>
     idx<T> image_gaussian_resize(idx<T> &im_, double oheight, double owidth,
 				 uint mode = 0, rect<int> *iregion = NULL,
-				 rect<int> *oregion = NULL);
+				 rect<int> *oregion = NULL,
+				 resampler<T> *rs = NULL);
 
   //! resizes an image (a region iregion of im if specified) into an image of
   //! size oheightxowidth using mean. Bilinear resizing is first used to
@@ -100,10 +108,13 @@ namespace ebl {
   //! iregion (the entire image if not specified).
   //! oregion is filled by the function if given and represents the resized
   //! region of iregion.
+  //! Non-integer images reduced by this function are resampled in a single
+  //! pass by resampler 'rs' (see image_resize()).
   template<typename T>
     idx<T> image_mean_resize(idx<T> &im_, double oheight, double owidth,
 			     uint mode = 0, rect<int> *iregion = NULL,
-			     rect<int> *oregion = NULL);
+			     rect<int> *oregion = NULL,
+			     resampler<T> *rs = NULL);
 
   //! returns the biggest square image including image region r.
   template<typename T> 
@@ -63,7 +63,7 @@ namespace ebl {
 
   template<class T> idx<T> image_resize(idx<T> &image, double h, double w,
 					int mode, rect<int> *iregion_,
-					rect<int> *oregion_) {
+					rect<int> *oregion_, resampler<T> *rs) {
     if (image.order() < 2) eblerror("image must have at least an order of 2.");
     // iregion is optional, set it to entire image if not given
     rect<int> iregion = rect<int>(0, 0, image.dim(0), image.dim(1));
@@ -73,8 +73,10 @@ namespace ebl {
     double ratiow = w / iregion.width;
     double ratiomin = std::min(ratiow, ratioh);
     // if data is not contiguous, copy it to a contiguous buffer
+    // (resamplers read any strides)
     idx<T> contim(image);
-    if (!image.contiguousp()) {
+    bool separable = !std::numeric_limits<T>::is_integer;
+    if (!image.contiguousp() && !separable) {
       idxdim d(image.spec);
       idx<T> tmp(d);
       idx_copy(image, tmp);
@@ -139,19 +141,28 @@ namespace ebl {
     //       imh = contim.dim(0);
     //     }
     // resample from subsampled image with bilinear interpolation
-    idx<T> rez((intg) oh, (intg) ow, (contim.order() == 3) ? contim.dim(2) : 1);
-    idx<T> bg(4);
-    idx_clear(bg);
-    // the 0.5 thingies are necessary because warp-bilin interprets
-    // integer coordinates as being at the center of each pixel.
-    float x1 = (float) -0.5, y1 = (float) -0.5;
-    float x3 = (float) imw - (float) 0.5, y3 = (float) imh - (float) 0.5;
-    float p1 = (float) -0.5, q1 = (float) -0.5;
-    float p3 = (float) ow - (float) 0.5, q3 = (float) oh - (float) 0.5;
-    image_warp_quad(contim, rez, bg, 1, x1, y1, x3, y1, x3, y3, x1, y3,
-		    p1, q1, p3, q3);
-    if (contim.order() == 2)
-      return rez.select(2, 0);
+    idx<T> rez;
+    if (separable) { // separable tables, same coordinates as warp below
+      resampler<T> tmprs;
+      rez = (rs ? rs : &tmprs)->bilinear(contim, (intg) oh, (intg) ow);
+      if (contim.order() == 2)
+	return rez;
+    } else {
+      rez = idx<T>((intg) oh, (intg) ow,
+		   (contim.order() == 3) ? contim.dim(2) : 1);
+      idx<T> bg(4);
+      idx_clear(bg);
+      // the 0.5 thingies are necessary because warp-bilin interprets
+      // integer coordinates as being at the center of each pixel.
+      float x1 = (float) -0.5, y1 = (float) -0.5;
+      float x3 = (float) imw - (float) 0.5, y3 = (float) imh - (float) 0.5;
+      float p1 = (float) -0.5, q1 = (float) -0.5;
+      float p3 = (float) ow - (float) 0.5, q3 = (float) oh - (float) 0.5;
+      image_warp_quad(contim, rez, bg, 1, x1, y1, x3, y1, x3, y3, x1, y3,
+		      p1, q1, p3, q3);
+      if (contim.order() == 2)
+	return rez.select(2, 0);
+    }
     // copy preserved ratio output in the middle of the wanted out size
     if ((mode == 3) && ((rez.dim(0) != h) || (rez.dim(1) != w))) {
       idx<T> out((intg) h, (intg) w, rez.dim(2));
@@ -167,7 +178,7 @@ namespace ebl {
   template <typename T>
   idx<T> image_gaussian_resize(idx<T> &im, double oheight, double owidth,
 			       uint mode, rect<int> *iregion_,
-			       rect<int> *oregion) {
+			       rect<int> *oregion, resampler<T> *rs) {
     // only accept 2D or 3D images
     if ((im.order() != 2) && (im.order() != 3)) {
       eblwarn("illegal order: " << im << std::endl);
@@ -220,11 +231,18 @@ namespace ebl {
 	* (double) im.dim(0);
       double exact_imw = (exact_inr.width / (double) iregion.width)
 	* (double) im.dim(1);
-      rim = image_resize(im, exact_imh, exact_imw, 1);
-      // now gaussian resize to exact target size
-      rim = rim.shift_dim(2, 0);
-      rim = gp.reduce(rim, reductions);
-      rim = rim.shift_dim(0, 2);
+      if (!std::numeric_limits<T>::is_integer) {
+	// bilinear resizing and reductions with a single table per axis
+	resampler<T> tmprs;
+	rim = (rs ? rs : &tmprs)->gaussian(im, (intg) exact_imh,
+					    (intg) exact_imw, reductions);
+      } else {
+	rim = image_resize(im, exact_imh, exact_imw, 1);
+	// now gaussian resize to exact target size
+	rim = rim.shift_dim(2, 0);
+	rim = gp.reduce(rim, reductions);
+	rim = rim.shift_dim(0, 2);
+      }
     ////////////////////////////////////////////////////////////////
     } else { // expand
       uint expansions;
@@ -255,7 +273,7 @@ namespace ebl {
       // TODO: casting to int correct?
       rect<int> oor2, oor;
       oor2 = outr2; oor = outr;
-      rim = image_resize(rim, oheight, owidth, mode, &oor2, &oor);
+      rim = image_resize(rim, oheight, owidth, mode, &oor2, &oor, rs);
       outr2 = oor2; outr = oor;
     }
     ////////////////////////////////////////////////////////////////
@@ -266,7 +284,8 @@ namespace ebl {
 
   template <typename T>
   idx<T> image_mean_resize(idx<T> &im, double oheight, double owidth,
-			   uint mode, rect<int> *iregion_, rect<int> *oregion) {
+			   uint mode, rect<int> *iregion_, rect<int> *oregion,
+			   resampler<T> *rs) {
     // only accept 2D or 3D images
     if ((im.order() != 2) && (im.order() != 3)) {
       eblwarn( "illegal order: " << im << std::endl);
@@ -327,7 +346,16 @@ namespace ebl {
       uint fact = (std::min)((uint)floor(iregion.height / (float) outr.height),
 			     (uint)floor(iregion.width / (float) outr.width));
       if (fact == 0) // no multiple smaller than input, go straight for bilinear
-	return image_resize(im, oheight, owidth, mode, iregion_, oregion);
+	return image_resize(im, oheight, owidth, mode, iregion_, oregion, rs);
+      if (!std::numeric_limits<T>::is_integer) {
+	// bilinear resizing and means with a single table per axis
+	resampler<T> tmprs;
+	out = (rs ? rs : &tmprs)->mean(im, (intg) (inr.height * fact),
+				       (intg) (inr.width * fact), fact);
+	if (oregion)
+	  *oregion = outr;
+	return out;
+      }
       // bilinear resize at closest resolution to current resolution
       rim = image_resize(im, inr.height * fact, inr.width * fact, 1);
       //  add extra padding around original image if it's not a multiple of fact
@@ -358,7 +386,7 @@ namespace ebl {
       }
     ////////////////////////////////////////////////////////////////
     } else { // expansion: return bilinear resizing
-      return image_resize(im, oheight, owidth, mode, iregion_, oregion);
+      return image_resize(im, oheight, owidth, mode, iregion_, oregion, rs);
     }
     ////////////////////////////////////////////////////////////////
     if (oregion)
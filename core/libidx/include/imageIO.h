@@ -76,6 +76,15 @@ namespace ebl {
   template <class T>
     idx<T> load_image(const std::string &fname);
 
+  //! Load the image in 'fname' and return it, allowing the decoder to
+  //! downscale it as long as it remains at least 'minh' x 'minw', e.g. when
+  //! it is going to be resized to 'minh' x 'minw' anyway. Only JPEG images
+  //! are currently downscaled (see image_decode()), other images and
+  //! matrices are loaded like load_image().
+  //! This throws string exceptions upon errors.
+  template <class T>
+    idx<T> load_image(const std::string &fname, intg minh, intg minw);
+
   ////////////////////////////////////////////////////////////////
   // saving
   
@@ -104,11 +113,26 @@ namespace ebl {
 
   //! read any kind of image that can be converted to a PPM by ImageMagick
   //! See above for description, as it is the same function used,
-  //! after a conversion to PPM
+  //! after a conversion to PPM. Images that image_decode() supports are
+  //! decoded directly without ImageMagick.
   //! \param attempts If imagemagick conversion fails, try again this number of
   //!        times.
+  //! \param minh,minw Minimum dimensions the image may be downscaled to
+  //!        while decoding (see image_decode()).
   template <class T>
-    idx<T> image_read(const char *fname, idx<T> *out = NULL, int attempts = 3);
+    idx<T> image_read(const char *fname, idx<T> *out = NULL, int attempts = 3,
+                      intg minh = 0, intg minw = 0);
+
+  //! Decodes the image in 'fname' into 'out' (resized to
+  //! height x width x 3 RGB) without external programs, if its format is
+  //! supported: binary PGM/PPM (P5, P6) of 8-bit depth, PNG if compiled with
+  //! libpng (__PNG__) and JPEG if compiled with libjpeg (__JPEG__).
+  //! Returns false if the format is not supported or decoding failed.
+  //! \param minh,minw If > 0, JPEG images are downscaled while decoding by
+  //!        the largest factor among 2, 4 and 8 that keeps them at least
+  //!        minh x minw, which also makes decoding much faster.
+  EXPORT bool image_decode(const char *fname, idx<ubyte> &out,
+                           intg minh = 0, intg minw = 0);
 
 } // end namespace ebl
 
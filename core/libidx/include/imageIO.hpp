@@ -61,8 +61,11 @@ namespace ebl {
   // I/O: helper functions
 
   template<class T>
-  idx<T> image_read(const char *fname, idx<T> *out_, int attempts) {
+  idx<T> image_read(const char *fname, idx<T> *out_, int attempts,
+                    intg minh, intg minw) {
     idx<ubyte> tmp;
+    // decode directly if possible, otherwise rely on ImageMagick
+    if (!image_decode(fname, tmp, minh, minw)) {
 #ifdef __MAGICKPP__
     // we are under any platform, convert is not available but Magick++ is
     try {
@@ -107,7 +110,7 @@ namespace ebl {
 	eblwarn( "Warning: " << err << std::endl);
 	eblwarn( "trying again... (remaining attempts: " << attempts << ")"
                  << std::endl);
-	return image_read(fname, out_, attempts - 1);
+	return image_read(fname, out_, attempts - 1, minh, minw);
       } else
 	eblthrow(err);
     }
@@ -123,7 +126,7 @@ namespace ebl {
 	eblwarn( "Warning: " << err << std::endl);
 	eblwarn( "trying again... (remaining attempts: " << attempts << ")"
                  << std::endl);
-	return image_read(fname, out_, attempts - 1);
+	return image_read(fname, out_, attempts - 1, minh, minw);
       } else
 	eblthrow(err);
     }
@@ -137,6 +140,7 @@ namespace ebl {
 	     << "please install");
 #endif /* __IMAGEMAGICK__ */
 #endif /* __MAGICK++__ */
+    }
 
     idxdim dims(tmp);
     idx<T> out;
@@ -202,6 +206,13 @@ namespace ebl {
     return load_image<T>(fname.c_str());
   }
 
+  template<class T>
+  idx<T> load_image(const std::string &fname, intg minh, intg minw) {
+    if (is_matrix(fname.c_str())) // matrices are loaded regularly
+      return load_image<T>(fname.c_str());
+    return image_read<T>(fname.c_str(), NULL, 3, minh, minw);
+  }
+
   ////////////////////////////////////////////////////////////////
   // I/O: saving
 
@@ -40,8 +40,12 @@
 #include "srg.h"
 #include "idx.h"
 #include "idxiter.h"
+#include "idxview.h"
 #include "idxIO.h"
+#include "prefetcher.h"
+#include "lzcodec.h"
 #include "idxops.h"
+#include "idxexpr.h"
 #include "ippops.h"
 #include "thops.h"
 #include "color_spaces.h"
@@ -49,6 +53,7 @@
 #include "filters.h"
 #include "pyramids.h"
 #include "geometry.h"
+#include "resampler.h"
 #include "image.h"
 #include "imageIO.h"
 #include "utils.h"
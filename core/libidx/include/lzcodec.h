@@ -0,0 +1,66 @@
+/***************************************************************************
+ *   Copyright (C) 2012 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef LZCODEC_H_
+#define LZCODEC_H_
+
+#include "config.h"
+#include "defines.h"
+
+namespace ebl {
+
+  // lz codec //////////////////////////////////////////////////////////////////
+
+  //! Returns the maximum compressed size of 'n' bytes.
+  EXPORT intg lz_bound(intg n);
+  //! Compresses 'n' bytes of 'src' into 'dst' of capacity 'cap' bytes and
+  //! returns the compressed size, or 0 if it does not fit in 'cap' (e.g. for
+  //! incompressible data when 'cap' is 'n'). Blocks are in the LZ4 block
+  //! format: greedy matching of at least 4 bytes within a 64KB window,
+  //! favoring speed over ratio.
+  EXPORT intg lz_compress(const char *src, intg n, char *dst, intg cap);
+  //! Decompresses the 'csize' bytes of block 'src' into 'dst' of 'n' bytes.
+  //! Returns false if the block is corrupted or does not decompress to
+  //! exactly 'n' bytes. This never reads or writes out of bounds.
+  EXPORT bool lz_decompress(const char *src, intg csize, char *dst, intg n);
+
+  //! Reorders the 'n' elements of 'size' bytes of 'src' into 'dst' so that
+  //! all first bytes come first, then all second bytes, etc. This groups
+  //! slowly varying bytes (e.g. exponents) and helps compression of
+  //! multi-byte types.
+  EXPORT void byte_shuffle(const char *src, intg n, int size, char *dst);
+  //! Reverts byte_shuffle().
+  EXPORT void byte_unshuffle(const char *src, intg n, int size, char *dst);
+
+} // end namespace ebl
+
+#endif /* LZCODEC_H_ */
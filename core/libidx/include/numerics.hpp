@@ -72,6 +72,28 @@ T angle_distance(T a1, T a2) {
   }
 }
 
+template <typename T>
+inline T tanh_fast(T x) {
+  const T c = (T) TANH_FAST_CLAMP;
+  x = x < c ? x : c;
+  x = x > -c ? x : -c;
+  T s = x * x;
+  return x * ((T) 135135 + s * ((T) 17325 + s * ((T) 378 + s)))
+    / ((T) 135135 + s * ((T) 62370 + s * ((T) 3150 + s * (T) 28)));
+}
+
+template <typename T>
+inline T dtanh_fast(T x) {
+  T s = x * x;
+  if (!(s < (T) (TANH_FAST_CLAMP * TANH_FAST_CLAMP))) return 0;
+  // with tanh_fast(x) = x n(s) / d(s) and s = x^2, the derivative is
+  // ((n + 2 s n') d - 2 s n d') / d^2, whose numerator expands to:
+  T n = (T) 18261468225.0 + s * ((T) -1404728325.0 + s * ((T) 58939650
+    + s * ((T) -1819125 + s * ((T) 47250 + s * ((T) -1134 + s * (T) 28)))));
+  T d = (T) 135135 + s * ((T) 62370 + s * ((T) 3150 + s * (T) 28));
+  return n / (d * d);
+}
+
 #define saturate(in, T) (saturator<T>::saturate(in))
 
 } // end namespace ebl
@@ -0,0 +1,154 @@
+/***************************************************************************
+ *   Copyright (C) 2012 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef PREFETCHER_H_
+#define PREFETCHER_H_
+
+#include "config.h"
+#include "defines.h"
+#include "idx.h"
+
+#ifndef __WINDOWS__
+#include <pthread.h>
+#endif
+
+namespace ebl {
+
+  ////////////////////////////////////////////////////////////////
+  // prefetcher
+
+  //! An abstract read-ahead cache of samples, loaded by a background thread.
+  //! The owner tells which samples it will need next with schedule() and
+  //! retrieves them with take(). Loaded samples are kept until taken or
+  //! scheduled out, and loading stops while they exceed the memory budget.
+  //! Subclasses implement the loading of a sample with load().
+  //! Without threads support (Windows), nothing is prefetched and every
+  //! take() is a miss.
+  class IDXEXPORT prefetcher {
+  public:
+    //! \param budget Maximum number of bytes of loaded samples to keep.
+    prefetcher(intg budget);
+    //! Subclasses must call stop() in their destructor, before
+    //! the objects used by load() are destroyed.
+    virtual ~prefetcher();
+
+    //! Replaces the samples to load ahead by 'order', most urgent first.
+    //! Loaded samples not in 'order' are released. This starts the
+    //! loading thread on first call.
+    void schedule(const std::vector<intg> &order);
+    //! Blocks until all scheduled samples are loaded or the budget is full.
+    void wait();
+    //! Returns the number of samples that were already loaded when taken.
+    intg hits();
+    //! Returns the number of samples that were not loaded when taken.
+    intg misses();
+    //! Returns the number of bytes of currently loaded samples.
+    intg bytes();
+    //! Resets hits and misses counters.
+    void reset_counters();
+
+  protected:
+    //! Returns sample 'i' if it was loaded (locked once, to be unlocked by
+    //! the caller), waiting for it if it is being loaded, or NULL
+    //! otherwise. Hits and misses are counted here.
+    smart_pointer* take(intg i);
+    //! Loads sample 'i' and sets 'size' to its size in bytes. This is
+    //! called by the loading thread only.
+    virtual smart_pointer* load(intg i, intg &size) = 0;
+    //! Stops the loading thread and releases all loaded samples.
+    void stop();
+
+  private:
+    //! Main loop of the loading thread.
+    void run();
+    //! Entry point of the loading thread.
+    static void* entrypoint(void *pthis);
+    //! Returns the next scheduled sample that is not loaded yet, or -1.
+    intg next();
+
+  private:
+    //! A loaded sample.
+    struct entry {
+      smart_pointer *sample;
+      intg size;
+    };
+    intg budget_;			//!< Maximum number of loaded bytes.
+    intg bytes_;			//!< Currently loaded bytes.
+    intg maxsize;			//!< Largest sample size seen.
+    intg hits_;
+    intg misses_;
+    std::vector<intg> order;		//!< Scheduled samples.
+    std::map<intg, entry> loaded;	//!< Loaded samples.
+    intg loading;			//!< Sample being loaded or -1.
+    intg waiting;			//!< Sample waited for by take() or -1.
+    bool started;			//!< The thread is running.
+    bool stopping;			//!< The thread was asked to stop.
+#ifndef __WINDOWS__
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;		//!< Signals any change of state.
+#endif
+  };
+
+  ////////////////////////////////////////////////////////////////
+  // midx_prefetcher
+
+  //! Reads ahead samples of an midx loaded on-demand (see load_matrices()),
+  //! a sample being all matrices of a slice of dimension 0. Samples are
+  //! read from a separate file pointer in the background, so that get()
+  //! returns without I/O when the disk keeps up with the consumer.
+  template <typename T> class midx_prefetcher : public prefetcher {
+  public:
+    //! \param data An on-demand midx of order 1 or 2.
+    //! \param budget Maximum number of bytes of samples to keep loaded.
+    midx_prefetcher(midx<T> &data, intg budget);
+    virtual ~midx_prefetcher();
+    //! Returns all matrices of sample 'i' in a midx of order 1, from the
+    //! read-ahead cache if loaded, otherwise directly read from 'data'.
+    midx<T> get(intg i);
+
+  protected:
+    //! Loads sample 'i' from the separate file pointer.
+    virtual smart_pointer* load(intg i, intg &size);
+    //! Returns a new midx with all matrices of sample 'i' of 'src'.
+    midx<T>* read(midx<T> &src, intg i, intg &size);
+
+  protected:
+    midx<T> data;	//!< On-demand data, read by the caller only.
+    midx<T> *ahead;	//!< Same data on a separate file, read by the thread.
+  };
+
+} // end namespace ebl
+
+#include "prefetcher.hpp"
+
+#endif /* PREFETCHER_H_ */
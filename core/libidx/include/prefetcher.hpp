@@ -0,0 +1,99 @@
+/***************************************************************************
+ *   Copyright (C) 2012 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef PREFETCHER_HPP_
+#define PREFETCHER_HPP_
+
+namespace ebl {
+
+  ////////////////////////////////////////////////////////////////
+  // midx_prefetcher
+
+  template <typename T>
+  midx_prefetcher<T>::midx_prefetcher(midx<T> &data_, intg budget)
+    : prefetcher(budget), data(data_), ahead(NULL) {
+    std::file *fp = data.get_file_pointer();
+    if (!fp) eblerror("prefetching requires an on-demand midx");
+    if (data.order() < 1 || data.order() > 2)
+      eblerror("expected an midx of order 1 or 2 but got " << data);
+    // open a separate file pointer, so that the thread can seek in it
+    idx<int64> offsets = data.get_offsets();
+    idxdim d(offsets);
+    ahead = new midx<T>(d, new std::file(fp->name(), "rb"), &offsets);
+  }
+
+  template <typename T>
+  midx_prefetcher<T>::~midx_prefetcher() {
+    stop();
+    ahead->clear(); // closes file
+    delete ahead;
+  }
+
+  template <typename T>
+  midx<T> midx_prefetcher<T>::get(intg i) {
+    smart_pointer *p = take(i);
+    intg size;
+    midx<T> *s = p ? (midx<T>*) p : read(data, i, size);
+    midx<T> sample(*s);
+    if (p) p->unlock();
+    else delete s;
+    return sample;
+  }
+
+  template <typename T>
+  smart_pointer* midx_prefetcher<T>::load(intg i, intg &size) {
+    return read(*ahead, i, size);
+  }
+
+  template <typename T>
+  midx<T>* midx_prefetcher<T>::read(midx<T> &src, intg i, intg &size) {
+    intg n = src.order() == 2 ? src.dim(1) : 1;
+    midx<T> *s = new midx<T>(n);
+    idx<T> e;
+    size = 0;
+    for (intg j = 0; j < n; ++j) {
+      if (src.order() == 2) {
+	if (!src.exists(i, j)) continue ;
+	e = src.mget(i, j);
+      } else {
+	if (!src.exists(i)) continue ;
+	e = src.mget(i);
+      }
+      s->mset(e, j);
+      size += e.nelements() * sizeof (T);
+    }
+    return s;
+  }
+
+} // end namespace ebl
+
+#endif /* PREFETCHER_HPP_ */
@@ -34,15 +34,36 @@
 #define RANDOM_H
 
 #include "defines.h"
+#include "idx.h"
 #include <string>
 
 namespace ebl {
 
+// philox //////////////////////////////////////////////////////////////////////
+
+#define PHILOX_M0 0xD2511F53U //!< Philox4x32 round multipliers.
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U //!< Philox4x32 key increments.
+#define PHILOX_W1 0xBB67AE85U
+
+//! Philox4x32-10 counter-based generator (Salmon et al., 2011): encrypts the
+//! 128-bit counter 'ctr' with the 64-bit key 'key' into 4 random words 'out'.
+//! Each (key, counter) pair yields an independent block, which makes streams
+//! trivially splittable across threads and vectorizable.
+EXPORT void philox4x32(const uint32 ctr[4], const uint32 key[2],
+		       uint32 out[4]);
+
 // random //////////////////////////////////////////////////////////////////////
 
+//! A random number generator based on the Philox4x32-10 counter-based
+//! generator. A generator is a (seed, stream) pair and a 64-bit block
+//! counter, so that different streams of the same seed are independent and
+//! each can jump to any position with set_counter() in constant time.
+//! A generator must not be shared by several threads, use thread_random()
+//! to get one stream per thread instead.
 class EXPORT random {
 public:
-  //! Empty constructor, doesn't set any seed.
+  //! Empty constructor, seeds with 0 without printing anything.
   random();
   //! Constructs a random number generator with seed 'x'.
   //! Use x == 0 to construct a fixed-seed generator.
@@ -60,9 +81,19 @@ public:
   //! if present. This can be useful if several programs are called at the
   //! same time with different input arguments.
   void time_args_seed(int argc, char **argv);
+  //! Sets the seed to 'x' and selects independent sequence 'stream' of this
+  //! seed, then rewinds the counter to the beginning of the sequence.
+  void seed(int x, uint32 stream = 0);
+  //! Moves to block 'ctr' of the current sequence. Each block holds 4 32-bit
+  //! words, a double uses 2 words.
+  void set_counter(uint64 ctr);
+  //! Returns the index of the next block that will be generated.
+  uint64 get_counter();
 
+  //! Returns the next 32 random bits.
+  uint32 next32();
   //! random number generator. Return a random number
-  //! drawn from a uniform distribution over [0,1].
+  //! drawn from a uniform distribution over [0,1).
   double drand(void);
   //! random number generator. Return a random number
   //! drawn from a uniform distribution over [-v,+v].
@@ -70,6 +101,36 @@ public:
   //! random number generator. Return a random number
   //! drawn from a uniform distribution over [v0,v1].
   double drand(double v0, double v1);
+  //! Return a random number drawn from a normal distribution
+  //! of mean 0 and variance 1.
+  double dgauss(void);
+  //! Return a random number drawn from a normal distribution
+  //! of mean 0 and standard deviation 'sigma'.
+  double dgauss(double sigma);
+  //! Return a random number drawn from a normal distribution
+  //! of mean 'm' and standard deviation 'sigma'.
+  double dgauss(double m, double sigma);
+
+  // bulk generation ///////////////////////////////////////////////////////////
+  // Bulk functions start at the next block boundary and generate all blocks
+  // at once with the simd kernels (and OpenMP if enabled), the result does
+  // not depend on the number of threads.
+
+  //! Fills the 'n' elements of 'out' with uniform numbers over [v0,v1).
+  //! float32 values use 24 random bits, float64 values 53.
+  void uniform(float32 *out, intg n, double v0 = 0.0, double v1 = 1.0);
+  void uniform(float64 *out, intg n, double v0 = 0.0, double v1 = 1.0);
+  //! Fills the 'n' elements of 'out' with normal numbers of mean 'm' and
+  //! standard deviation 'sigma'.
+  void gauss(float32 *out, intg n, double m = 0.0, double sigma = 1.0);
+  void gauss(float64 *out, intg n, double m = 0.0, double sigma = 1.0);
+  //! Fills all elements of 'x' with uniform numbers over [v0,v1).
+  template <typename T>
+  void fill_uniform(idx<T> &x, double v0 = 0.0, double v1 = 1.0);
+  //! Fills all elements of 'x' with normal numbers of mean 'm' and
+  //! standard deviation 'sigma'.
+  template <typename T>
+  void fill_gauss(idx<T> &x, double m = 0.0, double sigma = 1.0);
 
 protected:
   //! Initialize seed.
@@ -82,10 +143,44 @@ protected:
   void dseed(int x);
 
 private:
-  int inext, inextp;
-  int ma[56];		/* Should not be modified */
+  uint32 key[2];	//!< Seed and stream.
+  uint64 counter;	//!< Next block to generate.
+  uint32 buf[4];	//!< Current block.
+  int bufpos;		//!< Next unused word of 'buf', 4 if none.
+  bool has_spare;	//!< dgauss() generates normal numbers by pairs.
+  double spare;
 };
 
+//! Specialized contiguous version.
+template <> EXPORT void random::fill_uniform(idx<float32> &x, double v0,
+					     double v1);
+//! Specialized contiguous version.
+template <> EXPORT void random::fill_uniform(idx<float64> &x, double v0,
+					     double v1);
+//! Specialized contiguous version.
+template <> EXPORT void random::fill_gauss(idx<float32> &x, double m,
+					   double sigma);
+//! Specialized contiguous version.
+template <> EXPORT void random::fill_gauss(idx<float64> &x, double m,
+					   double sigma);
+
+// per-thread generators ///////////////////////////////////////////////////////
+
+//! Seeds all per-thread generators with 'x'. Generators already created are
+//! re-seeded the next time they are used.
+EXPORT void thread_random_seed(int x);
+//! Returns the generator of the calling thread. Each thread uses its own
+//! stream of the seed given to thread_random_seed() (0 by default), fixed
+//! when the thread first calls thread_random(): the OpenMP thread number
+//! if called inside an OpenMP parallel region, otherwise the next stream
+//! from 65535 on. A thread keeps its stream afterwards, e.g. the main
+//! thread keeps stream 65535 as OpenMP thread 0 if it first used its
+//! generator outside a parallel region. Without threads support
+//! (Windows), a single generator is shared.
+EXPORT random& thread_random();
+
 } // end namespace ebl
 
+#include "random.hpp"
+
 #endif /* RANDOM_H */
@@ -0,0 +1,191 @@
+/***************************************************************************
+ *   Copyright (C) 2012 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef RESAMPLER_H_
+#define RESAMPLER_H_
+
+#include <vector>
+
+#include "defines.h"
+#include "idx.h"
+#include "idxops.h"
+
+// maximum number of plans (size combinations) cached by a resampler
+#define RESAMPLE_MAXPLANS 32
+
+namespace ebl {
+
+// resample_table //////////////////////////////////////////////////////////////
+
+//! Coefficients resampling one image axis of 'nin' pixels into 'nout'
+//! pixels: output pixel o is the sum of the 'ntaps' consecutive input pixels
+//! starting at start(o), weighted by weights(o, 0 .. ntaps - 1).
+//! Pixels outside of the input are background pixels of value 0 and do not
+//! appear in the tables.
+class EXPORT resample_table {
+ public:
+  //! Creates an empty table.
+  resample_table();
+  virtual ~resample_table();
+  //! Sets the coefficients of 'nin' inputs to 'taps.size()' outputs,
+  //! output o being the sum of (input index, weight) pairs of taps[o].
+  //! Taps outside of [0, nin) or with zero weights are ignored.
+  void set(intg nin,
+	   std::vector<std::vector<std::pair<intg,double> > > &taps);
+  //! Returns the (input index, weight) pairs of output 'o'.
+  std::vector<std::pair<intg,double> > taps(intg o);
+
+  // members ///////////////////////////////////////////////////////////////////
+  intg        nin;     //!< Number of input pixels.
+  intg        nout;    //!< Number of output pixels.
+  intg        ntaps;   //!< Number of input pixels read by each output.
+  idx<intg>   start;   //!< First input pixel of each output.
+  idx<double> weights; //!< Weights of each output's input pixels.
+};
+
+//! Sets 'rows' and 'cols' to the tables of the bilinear interpolation of
+//! a (ih x iw) image into a (oh x ow) image computed by image_resize(),
+//! with the exact same fixed-point coordinates as image_warp_quad().
+EXPORT void resample_bilinear(intg ih, intg iw, intg oh, intg ow,
+			      resample_table &rows, resample_table &cols);
+//! Returns the table averaging blocks of 'fact' inputs out of 'nin' inputs,
+//! as done by image_mean_resize() (trailing inputs are ignored).
+EXPORT resample_table resample_mean(intg nin, uint fact);
+//! Returns the table of one reduction of 'nin' inputs by a gaussian_pyramid
+//! with parameter 'a', i.e. a 5-tap Burt-Adelson filter with stride 2.
+EXPORT resample_table resample_gaussian_reduce(intg nin, double a = .375);
+//! Returns the table applying 'first' then 'second'.
+EXPORT resample_table resample_compose(resample_table &first,
+				       resample_table &second);
+
+// resample_plan ///////////////////////////////////////////////////////////////
+
+//! Kinds of resampling of a resample_plan.
+enum resample_kind { RESAMPLE_BILINEAR = 0, RESAMPLE_MEAN = 1,
+		     RESAMPLE_GAUSSIAN = 2 };
+
+//! Row and column tables of one resampling of an input size into an output
+//! size (see resampler).
+template <typename T> class resample_plan {
+ public:
+  //! Creates the tables of the bilinear resizing of a (ih x iw) image into
+  //! a (h x w) image, followed by 'arg' gaussian reductions if 'kind' is
+  //! RESAMPLE_GAUSSIAN or by means of (arg x arg) blocks if RESAMPLE_MEAN.
+  resample_plan(resample_kind kind, intg ih, intg iw, intg h, intg w,
+		uint arg);
+  virtual ~resample_plan();
+  //! Returns true if this plan is for the given resampling.
+  bool matches(resample_kind kind, intg ih, intg iw, intg h, intg w,
+	       uint arg);
+
+  // members ///////////////////////////////////////////////////////////////////
+  resample_kind  kind;    //!< Kind of resampling.
+  intg           ih, iw;  //!< Input size.
+  intg           h, w;    //!< Bilinear resizing size.
+  uint           arg;     //!< Reductions or mean factor.
+  resample_table rows;    //!< Coefficients of the vertical pass.
+  resample_table cols;    //!< Coefficients of the horizontal pass.
+  idx<T>         rweights; //!< Vertical weights in type T.
+  idx<T>         cweights; //!< Horizontal weights in type T.
+};
+
+// resampler ///////////////////////////////////////////////////////////////////
+
+//! Resizes images with separable coefficient tables: a vertical pass over
+//! input rows followed by a horizontal pass, each output row being computed
+//! by a different OpenMP thread. Tables depend only on the input and output
+//! sizes and are cached, so repeated resizings of the same sizes (e.g. the
+//! scales of each frame of a detector) only pay for the passes.
+//! Images are (height x width) or (height x width x channels) with any
+//! strides. Intermediate results are in type T, floating point types should
+//! be used.
+template <typename T> class resampler {
+ public:
+  resampler();
+  //! Copies do not share cached tables, they start with empty caches.
+  resampler(const resampler<T> &r);
+  virtual ~resampler();
+  //! Empties the cache, tables of 'r' are not copied.
+  resampler<T>& operator=(const resampler<T> &r);
+  //! Returns the bilinear resizing of 'in' into a (h x w) image, identical
+  //! to the interpolation of image_resize().
+  idx<T> bilinear(idx<T> &in, intg h, intg w);
+  //! Returns the bilinear resizing of 'in' into a (h x w) image followed by
+  //! the means of its (fact x fact) blocks, as in image_mean_resize().
+  idx<T> mean(idx<T> &in, intg h, intg w, uint fact);
+  //! Returns the bilinear resizing of 'in' into a (h x w) image followed by
+  //! 'reductions' gaussian pyramid reductions, as in image_gaussian_resize().
+  idx<T> gaussian(idx<T> &in, intg h, intg w, uint reductions);
+  //! Forgets all cached tables.
+  void clear();
+  //! Enables or disables pyramid resampling. When enabled, the first image
+  //! resampled after new_pyramid() becomes the source of a pyramid: the
+  //! bilinear resizing of each resampling of that same source derives from
+  //! the nearest larger bilinear resizing already produced from it, when
+  //! within a factor 2 of the requested size, instead of from the full
+  //! source (as levels of a gaussian_pyramid derive from each other). Mean
+  //! and gaussian reductions are then applied to that resizing, as without
+  //! pyramid. The output geometry is unchanged.
+  //! Images returned while the pyramid is in use must not be modified.
+  void set_pyramid(bool enable);
+  //! Forgets the pyramid source and its levels. This must be called when
+  //! the content of the source changes, e.g. for each new frame.
+  void new_pyramid();
+
+ protected:
+  //! Returns the cached plan for this resampling, creating it if needed.
+  resample_plan<T>* get_plan(resample_kind kind, idx<T> &in, intg h, intg w,
+			     uint arg);
+  //! Resamples 'in' with 'plan' and returns the result.
+  idx<T> apply(idx<T> &in, resample_plan<T> &plan);
+  //! Returns the resampling of 'in' described by 'plan', resizing from the
+  //! nearest larger pyramid level if 'in' is the pyramid source.
+  idx<T> apply_pyramid(idx<T> &in, resample_plan<T> &plan);
+
+  // members ///////////////////////////////////////////////////////////////////
+ protected:
+  std::vector<resample_plan<T>*> plans; //!< Cached plans, oldest first.
+  idx<T>                         buf;   //!< Output of the vertical pass.
+  bool                           pyramid; //!< Pyramid resampling or not.
+  bool                           pyrsrc_set; //!< Pyramid source is known.
+  idx<T>                         pyrsrc; //!< Source of the pyramid.
+  std::vector<idx<T> >           levels; //!< Bilinear resizings of pyrsrc.
+};
+
+//! Returns true if 'a' and 'b' view the same elements of the same storage.
+template <typename T> bool same_view(idx<T> &a, idx<T> &b);
+
+} // end namespace ebl
+
+#include "resampler.hpp"
+
+#endif /* RESAMPLER_H_ */
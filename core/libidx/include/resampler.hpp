@@ -0,0 +1,267 @@
+/***************************************************************************
+ *   Copyright (C) 2012 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef RESAMPLER_HPP_
+#define RESAMPLER_HPP_
+
+namespace ebl {
+
+// resample_plan ///////////////////////////////////////////////////////////////
+
+template <typename T>
+resample_plan<T>::resample_plan(resample_kind kind_, intg ih_, intg iw_,
+				intg h_, intg w_, uint arg_)
+  : kind(kind_), ih(ih_), iw(iw_), h(h_), w(w_), arg(arg_) {
+  resample_bilinear(ih, iw, h, w, rows, cols);
+  switch (kind) {
+  case RESAMPLE_MEAN: {
+    resample_table mr = resample_mean(h, arg), mc = resample_mean(w, arg);
+    rows = resample_compose(rows, mr);
+    cols = resample_compose(cols, mc);
+  } break ;
+  case RESAMPLE_GAUSSIAN:
+    for (uint i = 0; i < arg; ++i) {
+      resample_table gr = resample_gaussian_reduce(rows.nout);
+      resample_table gc = resample_gaussian_reduce(cols.nout);
+      rows = resample_compose(rows, gr);
+      cols = resample_compose(cols, gc);
+    }
+    break ;
+  default: ;
+  }
+  rweights = idx<T>(rows.nout, rows.ntaps);
+  cweights = idx<T>(cols.nout, cols.ntaps);
+  idx_copy(rows.weights, rweights);
+  idx_copy(cols.weights, cweights);
+}
+
+template <typename T>
+resample_plan<T>::~resample_plan() {
+}
+
+template <typename T>
+bool resample_plan<T>::matches(resample_kind kind_, intg ih_, intg iw_,
+			       intg h_, intg w_, uint arg_) {
+  return kind == kind_ && ih == ih_ && iw == iw_ && h == h_ && w == w_
+    && (kind == RESAMPLE_BILINEAR || arg == arg_);
+}
+
+// resampler ///////////////////////////////////////////////////////////////////
+
+template <typename T>
+resampler<T>::resampler() : pyramid(false), pyrsrc_set(false) {
+}
+
+template <typename T>
+resampler<T>::resampler(const resampler<T> &r)
+  : pyramid(r.pyramid), pyrsrc_set(false) {
+}
+
+template <typename T>
+resampler<T>::~resampler() {
+  clear();
+}
+
+template <typename T>
+resampler<T>& resampler<T>::operator=(const resampler<T> &r) {
+  if (this != &r) {
+    clear();
+    pyramid = r.pyramid;
+  }
+  return *this;
+}
+
+template <typename T>
+idx<T> resampler<T>::bilinear(idx<T> &in, intg h, intg w) {
+  resample_plan<T> *plan = get_plan(RESAMPLE_BILINEAR, in, h, w, 0);
+  if (pyramid) return apply_pyramid(in, *plan);
+  return apply(in, *plan);
+}
+
+template <typename T>
+idx<T> resampler<T>::mean(idx<T> &in, intg h, intg w, uint fact) {
+  if (fact == 0) eblerror("expected a non-zero mean factor");
+  resample_plan<T> *plan = get_plan(RESAMPLE_MEAN, in, h, w, fact);
+  if (pyramid) return apply_pyramid(in, *plan);
+  return apply(in, *plan);
+}
+
+template <typename T>
+idx<T> resampler<T>::gaussian(idx<T> &in, intg h, intg w, uint reductions) {
+  resample_plan<T> *plan = get_plan(RESAMPLE_GAUSSIAN, in, h, w, reductions);
+  if (pyramid) return apply_pyramid(in, *plan);
+  return apply(in, *plan);
+}
+
+template <typename T>
+void resampler<T>::clear() {
+  for (uint i = 0; i < plans.size(); ++i)
+    delete plans[i];
+  plans.clear();
+  new_pyramid();
+}
+
+template <typename T>
+void resampler<T>::set_pyramid(bool enable) {
+  pyramid = enable;
+  new_pyramid();
+}
+
+template <typename T>
+void resampler<T>::new_pyramid() {
+  pyrsrc_set = false;
+  pyrsrc = idx<T>();
+  levels.clear();
+}
+
+template <typename T>
+resample_plan<T>* resampler<T>::get_plan(resample_kind kind, idx<T> &in,
+					 intg h, intg w, uint arg) {
+  if (in.order() != 2 && in.order() != 3)
+    eblerror("expected a 2D or 3D image but got " << in);
+  if (h <= 0 || w <= 0)
+    eblerror("cannot resample " << in << " to " << h << "x" << w);
+  intg ih = in.dim(0), iw = in.dim(1);
+  for (uint i = 0; i < plans.size(); ++i)
+    if (plans[i]->matches(kind, ih, iw, h, w, arg))
+      return plans[i];
+  // forget the oldest plan when too many sizes were seen
+  if (plans.size() >= RESAMPLE_MAXPLANS) {
+    delete plans.front();
+    plans.erase(plans.begin());
+  }
+  plans.push_back(new resample_plan<T>(kind, ih, iw, h, w, arg));
+  return plans.back();
+}
+
+template <typename T>
+idx<T> resampler<T>::apply(idx<T> &in, resample_plan<T> &plan) {
+  intg iw = in.dim(1), oh = plan.rows.nout, ow = plan.cols.nout, i;
+  intg nc = in.order() == 3 ? in.dim(2) : 1;
+  idxdim d(in);
+  d.setdim(0, oh);
+  d.setdim(1, ow);
+  idx<T> out(d);
+  if (buf.nelements() < nc * oh * iw)
+    buf = idx<T>(nc * oh * iw);
+  intg im0 = in.mod(0), im1 = in.mod(1), im2 = nc > 1 ? in.mod(2) : 0;
+  intg om0 = out.mod(0), om1 = out.mod(1), om2 = nc > 1 ? out.mod(2) : 0;
+  intg rt = plan.rows.ntaps, ct = plan.cols.ntaps;
+  const intg *rs = plan.rows.start.idx_ptr(), *cs = plan.cols.start.idx_ptr();
+  const T *rw = plan.rweights.idx_ptr(), *cw = plan.cweights.idx_ptr();
+  T *tmp = buf.idx_ptr();
+  // vertical pass: each output row from its input rows, for all columns.
+  // the 2 passes evaluate the exact same products and sums as
+  // image_interpolate_bilin() for bilinear tables.
+#ifdef __OPENMP__
+#pragma omp parallel for private(i)
+#endif
+  for (i = 0; i < oh; ++i) {
+    const T *wr = rw + i * rt;
+    for (intg k = 0; k < nc; ++k) {
+      const T *pi = in.idx_ptr() + rs[i] * im0 + k * im2;
+      T *pt = tmp + (k * oh + i) * iw;
+      for (intg j = 0; j < iw; ++j)
+	pt[j] = wr[0] * pi[j * im1];
+      for (intg t = 1; t < rt; ++t) {
+	const T *pit = pi + t * im0;
+	T wt = wr[t];
+	for (intg j = 0; j < iw; ++j)
+	  pt[j] += wt * pit[j * im1];
+      }
+    }
+  }
+  // horizontal pass
+#ifdef __OPENMP__
+#pragma omp parallel for private(i)
+#endif
+  for (i = 0; i < oh; ++i) {
+    for (intg k = 0; k < nc; ++k) {
+      const T *pt = tmp + (k * oh + i) * iw;
+      T *po = out.idx_ptr() + i * om0 + k * om2;
+      for (intg j = 0; j < ow; ++j) {
+	const T *wc = cw + j * ct, *ptj = pt + cs[j];
+	T s = wc[0] * ptj[0];
+	for (intg t = 1; t < ct; ++t)
+	  s += wc[t] * ptj[t];
+	po[j * om1] = s;
+      }
+    }
+  }
+  return out;
+}
+
+template <typename T>
+idx<T> resampler<T>::apply_pyramid(idx<T> &in, resample_plan<T> &plan) {
+  if (!pyrsrc_set) {
+    pyrsrc = in;
+    pyrsrc_set = true;
+  } else if (!same_view(in, pyrsrc)) // not the pyramid's image
+    return apply(in, plan);
+  intg h = plan.h, w = plan.w;
+  resample_kind kind = plan.kind;
+  uint arg = plan.arg;
+  // levels are bilinear resizings: find the smallest level larger than the
+  // bilinear size, within a factor 2
+  idx<T> *src = NULL;
+  for (uint i = 0; i < levels.size(); ++i) {
+    idx<T> &l = levels[i];
+    if (l.dim(0) >= h && l.dim(1) >= w && l.dim(0) <= 2 * h
+	&& l.dim(1) <= 2 * w && (!src || l.dim(0) < src->dim(0)))
+      src = &l;
+  }
+  // bilinear resizing from that level, or from the source if none.
+  // 'plan' may be deleted by get_plan(), do not use it below.
+  idx<T> &from = src ? *src : in;
+  idx<T> resized = apply(from, *get_plan(RESAMPLE_BILINEAR, from, h, w, 0));
+  levels.push_back(resized);
+  if (kind == RESAMPLE_BILINEAR)
+    return resized;
+  // mean or gaussian reduction of the bilinear resizing, as in 'plan'
+  return apply(resized, *get_plan(kind, resized, h, w, arg));
+}
+
+// utilities ///////////////////////////////////////////////////////////////////
+
+template <typename T> bool same_view(idx<T> &a, idx<T> &b) {
+  if (a.getstorage() != b.getstorage() || a.offset() != b.offset()
+      || a.order() != b.order())
+    return false;
+  for (int i = 0; i < a.order(); ++i)
+    if (a.dim(i) != b.dim(i) || a.mod(i) != b.mod(i))
+      return false;
+  return true;
+}
+
+} // end namespace ebl
+
+#endif /* RESAMPLER_HPP_ */
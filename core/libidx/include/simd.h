@@ -0,0 +1,269 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef SIMD_H_
+#define SIMD_H_
+
+#include "config.h"
+#include "defines.h"
+#include "idx.h"
+#include "half.h"
+
+// Native vectorized elementwise kernels are available on x86 with gcc or
+// clang, unless explicitly disabled with __NOSIMD__. The best instruction
+// set supported by the cpu is selected at runtime.
+#if defined(__clang__) || (defined(__GNUC__) &&				\
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(__NOSIMD__)
+#define __SIMD__
+#endif
+#endif
+
+#ifdef __SIMD__
+
+namespace ebl {
+
+  // simd levels /////////////////////////////////////////////////////////////
+
+  //! Instruction sets used by the simd kernels, in increasing order.
+  enum simd_level { SIMD_NONE = 0, SIMD_SSE4 = 1, SIMD_AVX2 = 2,
+		    SIMD_AVX512 = 3 };
+
+  //! Returns the instruction set currently used by the simd kernels.
+  EXPORT simd_level simd_get_level();
+  //! Returns the best instruction set supported by this cpu.
+  EXPORT simd_level simd_max_level();
+  //! Use instruction set 'l' for all simd kernels, or the best supported
+  //! one if 'l' is not supported by this cpu. SIMD_NONE uses scalar code.
+  EXPORT void simd_set_level(simd_level l);
+  //! Returns the name of instruction set 'l'.
+  EXPORT const char* simd_level_name(simd_level l);
+
+  // contiguous kernels //////////////////////////////////////////////////////
+  // All kernels operate on 'n' contiguous elements, 'out' may be the same
+  // buffer as any of the inputs but must not partially overlap them.
+
+  //! out = i1 + i2
+  EXPORT void simd_add(const float32 *i1, const float32 *i2, float32 *out,
+		       intg n);
+  EXPORT void simd_add(const float64 *i1, const float64 *i2, float64 *out,
+		       intg n);
+  EXPORT void simd_add(const ubyte *i1, const ubyte *i2, ubyte *out, intg n);
+  //! out = i1 - i2
+  EXPORT void simd_sub(const float32 *i1, const float32 *i2, float32 *out,
+		       intg n);
+  EXPORT void simd_sub(const float64 *i1, const float64 *i2, float64 *out,
+		       intg n);
+  EXPORT void simd_sub(const ubyte *i1, const ubyte *i2, ubyte *out, intg n);
+  //! out = i1 * i2
+  EXPORT void simd_mul(const float32 *i1, const float32 *i2, float32 *out,
+		       intg n);
+  EXPORT void simd_mul(const float64 *i1, const float64 *i2, float64 *out,
+		       intg n);
+  EXPORT void simd_mul(const ubyte *i1, const ubyte *i2, ubyte *out, intg n);
+  //! out = in + c
+  EXPORT void simd_addc(const float32 *in, float32 c, float32 *out, intg n);
+  EXPORT void simd_addc(const float64 *in, float64 c, float64 *out, intg n);
+  EXPORT void simd_addc(const ubyte *in, ubyte c, ubyte *out, intg n);
+  //! out = in * c
+  EXPORT void simd_dotc(const float32 *in, float32 c, float32 *out, intg n);
+  EXPORT void simd_dotc(const float64 *in, float64 c, float64 *out, intg n);
+  EXPORT void simd_dotc(const ubyte *in, ubyte c, ubyte *out, intg n);
+  //! out = k1 * i1 + k2 * i2
+  EXPORT void simd_lincomb(const float32 *i1, float32 k1, const float32 *i2,
+			   float32 k2, float32 *out, intg n);
+  EXPORT void simd_lincomb(const float64 *i1, float64 k1, const float64 *i2,
+			   float64 k2, float64 *out, intg n);
+  EXPORT void simd_lincomb(const ubyte *i1, ubyte k1, const ubyte *i2,
+			   ubyte k2, ubyte *out, intg n);
+
+  // color kernels ///////////////////////////////////////////////////////////
+  // Affine color transforms of 'n' contiguous pixels whose channels are in
+  // separate planes c0, c1 and c2. For each output plane k < 'nout' (1 or 3):
+  // ok = m[4k] * c0 + m[4k+1] * c1 + m[4k+2] * c2 + m[4k+3].
+  // o1 and o2 are ignored when 'nout' is 1. ubyte inputs are cast to float32
+  // on the fly.
+
+  EXPORT void simd_color_affine(const float32 *c0, const float32 *c1,
+				const float32 *c2, const float32 *m,
+				float32 *o0, float32 *o1, float32 *o2,
+				int nout, intg n);
+  EXPORT void simd_color_affine(const ubyte *c0, const ubyte *c1,
+				const ubyte *c2, const float32 *m,
+				float32 *o0, float32 *o1, float32 *o2,
+				int nout, intg n);
+
+  // nonlinearity kernels ////////////////////////////////////////////////////
+
+  //! out = b * tanh_fast(a * in)
+  EXPORT void simd_tanh_fast(const float32 *in, float32 a, float32 b,
+			     float32 *out, intg n);
+  EXPORT void simd_tanh_fast(const float64 *in, float64 a, float64 b,
+			     float64 *out, intg n);
+  //! out = a * b * dtanh_fast(a * in)
+  EXPORT void simd_dtanh_fast(const float32 *in, float32 a, float32 b,
+			      float32 *out, intg n);
+  EXPORT void simd_dtanh_fast(const float64 *in, float64 a, float64 b,
+			      float64 *out, intg n);
+
+  // random kernels //////////////////////////////////////////////////////////
+
+  //! Generates blocks 'ctr' to 'ctr' + 'nblocks' - 1 of the Philox4x32-10
+  //! sequence of key (k0, k1) into 'out', 4 words per block.
+  EXPORT void simd_philox4x32(uint32 k0, uint32 k1, uint64 ctr, uint32 *out,
+			      intg nblocks);
+
+  // conversion kernels //////////////////////////////////////////////////////
+
+  //! Half precision conversions use the F16C instructions at the AVX2 level
+  //! (when the cpu has them) and the AVX-512 ones above.
+  EXPORT void simd_float16_to_float32(const float16 *in, float32 *out,
+				      intg n);
+  EXPORT void simd_float32_to_float16(const float32 *in, float16 *out,
+				      intg n);
+  EXPORT void simd_bfloat16_to_float32(const bfloat16 *in, float32 *out,
+				       intg n);
+  EXPORT void simd_float32_to_bfloat16(const float32 *in, bfloat16 *out,
+				       intg n);
+
+  // int8 kernels ////////////////////////////////////////////////////////////
+
+  //! out[t] = sum_i a[i] . b[t * ldb + i] for t = 0..3 and i < k,
+  //! accumulated exactly in int32.
+  EXPORT void simd_dot4_s8(const byte *a, const byte *b, intg ldb, intg k,
+			   int32 *out);
+
+  // idx specializations /////////////////////////////////////////////////////
+  // Contiguous idx use the simd kernels, others fall back to strided loops.
+  // Types already specialized by the IPP or TH backends are left to them.
+
+#if !defined(__IPP__) && !defined(__TH__)
+  //! add two idx's, specialized float32 version
+  template<> void idx_add(idx<float32> &i1, idx<float32> &i2,
+			  idx<float32> &out);
+#endif
+#ifndef __TH__
+  //! add two idx's, specialized float64 version
+  template<> void idx_add(idx<float64> &i1, idx<float64> &i2,
+			  idx<float64> &out);
+  //! Add two idx's as follow: out = out + in, specialized float32 version
+  template<> void idx_add(idx<float32> &in, idx<float32> &out);
+  //! Add two idx's as follow: out = out + in, specialized float64 version
+  template<> void idx_add(idx<float64> &in, idx<float64> &out);
+#endif
+#ifndef __IPP__
+  //! add two idx's, specialized ubyte version
+  template<> void idx_add(idx<ubyte> &i1, idx<ubyte> &i2, idx<ubyte> &out);
+  //! Add two idx's as follow: out = out + in, specialized ubyte version
+  template<> void idx_add(idx<ubyte> &in, idx<ubyte> &out);
+#endif
+
+#ifndef __IPP__
+  //! subtract two idx's, specialized float32 version
+  template<> void idx_sub(idx<float32> &i1, idx<float32> &i2,
+			  idx<float32> &out);
+  //! subtract two idx's, specialized ubyte version
+  template<> void idx_sub(idx<ubyte> &i1, idx<ubyte> &i2, idx<ubyte> &out);
+#endif
+  //! subtract two idx's, specialized float64 version
+  template<> void idx_sub(idx<float64> &i1, idx<float64> &i2,
+			  idx<float64> &out);
+  //! i1 -= i2, specialized float32 version
+  template<> void idx_sub(idx<float32> &i1, idx<float32> &i2);
+  //! i1 -= i2, specialized float64 version
+  template<> void idx_sub(idx<float64> &i1, idx<float64> &i2);
+  //! i1 -= i2, specialized ubyte version
+  template<> void idx_sub(idx<ubyte> &i1, idx<ubyte> &i2);
+
+#ifndef __IPP__
+  //! multiply two idx's element-wise, specialized float32 version
+  template<> void idx_mul(idx<float32> &i1, idx<float32> &i2,
+			  idx<float32> &out);
+  //! multiply two idx's element-wise, specialized ubyte version
+  template<> void idx_mul(idx<ubyte> &i1, idx<ubyte> &i2, idx<ubyte> &out);
+#endif
+  //! multiply two idx's element-wise, specialized float64 version
+  template<> void idx_mul(idx<float64> &i1, idx<float64> &i2,
+			  idx<float64> &out);
+
+#ifndef __IPP__
+  //! add a constant to each element:  o1 <- i1+c, specialized float32 version
+  template<> void idx_addc(idx<float32> &inp, float32 c, idx<float32> &out);
+  //! add a constant to each element:  o1 <- i1+c, specialized ubyte version
+  template<> void idx_addc(idx<ubyte> &inp, ubyte c, idx<ubyte> &out);
+#endif
+  //! add a constant to each element:  o1 <- i1+c, specialized float64 version
+  template<> void idx_addc(idx<float64> &inp, float64 c, idx<float64> &out);
+  //! in <- in + c, specialized float32 version
+  template<> void idx_addc(idx<float32> &in, float32 c);
+  //! in <- in + c, specialized float64 version
+  template<> void idx_addc(idx<float64> &in, float64 c);
+  //! in <- in + c, specialized ubyte version
+  template<> void idx_addc(idx<ubyte> &in, ubyte c);
+
+#ifndef __IPP__
+  //! multiply all elements by a constant, specialized float32 version
+  template<> void idx_dotc(idx<float32> &inp, float32 c, idx<float32> &out);
+  //! multiply all elements by a constant, specialized ubyte version
+  template<> void idx_dotc(idx<ubyte> &inp, ubyte c, idx<ubyte> &out);
+#endif
+  //! multiply all elements by a constant, specialized float64 version
+  template<> void idx_dotc(idx<float64> &inp, float64 c, idx<float64> &out);
+
+  //! linear combination of two idx, specialized float32 version
+  template<> void idx_lincomb(idx<float32> &i1, float32 k1, idx<float32> &i2,
+			      float32 k2, idx<float32> &out);
+  //! linear combination of two idx, specialized float64 version
+  template<> void idx_lincomb(idx<float64> &i1, float64 k1, idx<float64> &i2,
+			      float64 k2, idx<float64> &out);
+  //! linear combination of two idx, specialized ubyte version
+  template<> void idx_lincomb(idx<ubyte> &i1, ubyte k1, idx<ubyte> &i2,
+			      ubyte k2, idx<ubyte> &out);
+
+  //! fast tanh approximation, specialized float32 version
+  template<> void idx_tanh_fast(idx<float32> &inp, idx<float32> &out,
+				float32 a, float32 b);
+  //! fast tanh approximation, specialized float64 version
+  template<> void idx_tanh_fast(idx<float64> &inp, idx<float64> &out,
+				float64 a, float64 b);
+  //! fast tanh approximation derivative, specialized float32 version
+  template<> void idx_dtanh_fast(idx<float32> &inp, idx<float32> &out,
+				 float32 a, float32 b);
+  //! fast tanh approximation derivative, specialized float64 version
+  template<> void idx_dtanh_fast(idx<float64> &inp, idx<float64> &out,
+				 float64 a, float64 b);
+
+} // end namespace ebl
+
+#endif /* __SIMD__ */
+
+#endif /* SIMD_H_ */
@@ -36,6 +36,7 @@
 #include <stdio.h>
 #include "defines.h"
 #include "stl.h"
+#include "atomic.h"
 
 namespace ebl {
 
@@ -43,6 +44,10 @@ namespace ebl {
 
 //! An object that knows how many other objects are refering to it and
 //! destroys itself once nobody does anymore.
+//! By default, reference counting is not thread-safe, i.e. an object (e.g.
+//! the srg of an idx) can only be referenced from several threads if
+//! atomic reference counting is turned on, either at runtime with
+//! set_atomic_refcount(true) or at compile time with __ATOMIC_REFCOUNT__.
 class EXPORT smart_pointer {
 public:
   // basic constructors/destructor ///////////////////////////////////////////
@@ -54,21 +59,37 @@ public:
   // reference counting //////////////////////////////////////////////////////
 
   //! Decrements reference counter and deallocates this if it reaches zero.
-  virtual int unlock();
+  inline int unlock();
   //! Increments reference counter.
-  virtual int lock();
+  inline int lock();
   //! Returns the number of references to this object.
-  virtual int get_count();
+  inline int get_count();
 
   //! Sets the number of references to this object(careful)
   virtual void set_count(int count);
 
+  //! Turns atomic reference counting on or off for all smart pointers.
+  //! When on, lock() is a relaxed atomic increment and unlock() an
+  //! acquire-release atomic decrement, so that objects can be shared
+  //! (e.g. read-only tensors) between threads. This must be set before
+  //! any object gets shared between threads.
+  static void set_atomic_refcount(bool atomic);
+  //! Returns true if reference counting is atomic.
+  static bool atomic_refcount();
+
   // friends /////////////////////////////////////////////////////////////////
   template <class T> friend class svector;
 
+  // internal methods ////////////////////////////////////////////////////////
+protected:
+  //! Called by unlock() when the counter reaches zero or below: deletes
+  //! this or reports a negative counter.
+  int unlock_last(int count);
+
   // members variables ///////////////////////////////////////////////////////
 protected:
   int refcount; //!< Reference counters of objects pointing to this idx.
+  static bool atomic_refs; //!< Reference counting is atomic if true.
 
   // debug only //////////////////////////////////////////////////////////////
 #ifdef __DEBUGMEM__
@@ -35,6 +35,39 @@
 
 namespace ebl {
 
+// smart pointer /////////////////////////////////////////////////////////////
+
+inline int smart_pointer::lock() {
+#ifdef __DEBUGMEM__
+  atomic_add_relaxed(&locks, (intg) 1);
+#endif
+#ifndef __ATOMIC_REFCOUNT__
+  if (!atomic_refs) return ++refcount;
+#endif
+  return atomic_add_relaxed(&refcount, 1);
+}
+
+inline int smart_pointer::unlock() {
+#ifdef __DEBUGMEM__
+  atomic_add_relaxed(&locks, (intg) -1);
+#endif
+  int count;
+#ifndef __ATOMIC_REFCOUNT__
+  if (!atomic_refs) count = --refcount;
+  else
+#endif
+    count = atomic_add_acq_rel(&refcount, -1);
+  if (count > 0) return count;
+  return unlock_last(count);
+}
+
+inline int smart_pointer::get_count() {
+#ifndef __ATOMIC_REFCOUNT__
+  if (!atomic_refs) return refcount;
+#endif
+  return atomic_load_relaxed(&refcount);
+}
+
 // smart vector //////////////////////////////////////////////////////////////
 
 template <class T>
@@ -41,6 +41,107 @@
 
 namespace ebl {
 
+  ////////////////////////////////////////////////////////////////
+  // srg_allocator: allocation backend for srg data.
+
+  //! Alignment (in bytes) of blocks returned by the pooled allocator.
+#define SRG_ALIGNMENT 64
+
+  //! Allocation modes for srg data.
+  enum srg_alloc_mode {
+    SRG_ALLOC_SYSTEM = 0, //!< Plain realloc/free (default).
+    SRG_ALLOC_POOLED = 1  //!< Aligned size classes with per-thread caches.
+  };
+
+  //! The allocator from which all srg obtain their data segments.
+  //! In SRG_ALLOC_SYSTEM mode, data is (re)allocated with realloc() as
+  //! before. In SRG_ALLOC_POOLED mode, requests are rounded up to a size
+  //! class (4 classes per power of 2, starting at SRG_ALIGNMENT bytes),
+  //! blocks are aligned on SRG_ALIGNMENT bytes and released blocks are kept
+  //! in a cache local to the releasing thread, which spills into a shared
+  //! mutex-protected depot. Code resizing the same buffers over and over
+  //! (e.g. states and buffers at each scale of a detector) thus stops
+  //! reaching the system allocator once in steady state.
+  //! The mode can be changed at any time: each srg remembers where its
+  //! data comes from and releases it accordingly.
+  class IDXEXPORT srg_allocator {
+  public:
+    //! Sets the allocation mode used for all subsequent allocations.
+    static void set_mode(srg_alloc_mode mode);
+    //! Returns current allocation mode.
+    static srg_alloc_mode get_mode();
+    //! Sets the maximum number of bytes kept in each thread's cache
+    //! and in the shared depot. Blocks released beyond these limits are
+    //! returned to the system.
+    static void set_cache_limits(intg thread_bytes, intg shared_bytes);
+
+    // pooled allocation ///////////////////////////////////////////////////
+
+    //! Returns a block of at least 'bytes' bytes, aligned on SRG_ALIGNMENT.
+    //! 'capacity' is set to the actual size of the block, which must be
+    //! passed back to deallocate(). Returns NULL on failure.
+    static void* allocate(intg bytes, intg &capacity);
+    //! Gives back block 'ptr' obtained from allocate() with 'capacity'.
+    static void deallocate(void *ptr, intg capacity);
+    //! Returns the capacity of the block allocate() would return for 'bytes'.
+    static intg capacity(intg bytes);
+    //! Returns all blocks cached by the calling thread and the shared depot
+    //! to the system.
+    static void release();
+
+    // system allocation ///////////////////////////////////////////////////
+
+    //! Counted equivalent of realloc(), used in SRG_ALLOC_SYSTEM mode.
+    static void* system_realloc(void *ptr, intg bytes);
+    //! Counted equivalent of free(), used in SRG_ALLOC_SYSTEM mode.
+    static void system_free(void *ptr);
+
+    // counters ////////////////////////////////////////////////////////////
+
+    //! Returns the number of blocks obtained from the system so far
+    //! (in both modes). This should not move in a steady-state loop.
+    static intg system_allocations();
+    //! Returns the number of blocks returned to the system so far.
+    static intg system_frees();
+    //! Returns the number of pooled allocations served from a cache.
+    static intg cache_hits();
+    //! Returns the number of bytes currently kept in caches.
+    static intg cached_bytes();
+    //! Resets all counters (except cached_bytes) to zero.
+    static void reset_counters();
+    //! Returns a string describing counters.
+    static std::string str();
+  };
+
+  ////////////////////////////////////////////////////////////////
+  // file_mapping: memory mapping of a file for srg data.
+
+  //! A copy-on-write memory mapping of a whole file, which srg objects can
+  //! alias instead of owning their data (see srg::set_mapped()). Pages are
+  //! read lazily by the system and shared by all processes mapping the same
+  //! file until they are written to: writes go to private copies and never
+  //! reach the file. The file is unmapped when the last object referring
+  //! to the mapping unlocks it.
+  class IDXEXPORT file_mapping : public smart_pointer {
+  public:
+    //! Returns a new mapping of the whole file opened as 'fp', or NULL if
+    //! it cannot be mapped (e.g. empty file or system without mmap).
+    static file_mapping* map(FILE *fp);
+    //! Unmaps the file.
+    virtual ~file_mapping();
+    //! Returns the address of the first byte of the file.
+    char* data();
+    //! Returns the size of the file in bytes.
+    intg size();
+
+  private:
+    file_mapping(char *addr, intg bytes);
+
+  private:
+    char *addr;  //!< Address of the mapping.
+    intg  bytes; //!< Size of the mapping in bytes.
+  };
+
   ////////////////////////////////////////////////////////////////
   // srg: storage area for idx data.
 
@@ -97,7 +198,15 @@ namespace ebl {
     //! Returns a pointer to the beginning of the data segment.
     T* get_data();
     //! Sets a pointer to the beginning of the data segment.
+    //! 'ptr' is expected to come from malloc() and is released with free().
+    //! A file mapping aliased by this srg is released first.
     void set_data(T* ptr);
+    //! Makes this srg alias 'n' elements starting at byte 'offset' of
+    //! 'map' instead of owning its data, releasing current data.
+    //! Growing this srg later copies the elements into owned memory.
+    void set_mapped(file_mapping *map, intg offset, intg n);
+    //! Returns true if data aliases a file_mapping.
+    bool mapped();
     //! sets i-th element to val.
     void set(intg i, T val);
     //! fill data with zeros.
@@ -113,9 +222,18 @@ namespace ebl {
     template <typename T2> friend class idxlooper;
     
     // member variables ////////////////////////////////////////////////////////
+  private:
+    //! Returns data segment to the allocator it was obtained from.
+    void free_data();
+
   private:
     T *data; //!< pointer to data segment
     intg size_; //!< Number of allocated items.    
+    //! Size in bytes of the data block if it comes from the pooled
+    //! srg_allocator, 0 if it comes from the system.
+    intg capacity_;
+    //! Mapping aliased by data if data comes from a file, NULL otherwise.
+    file_mapping *mapping_;
 
     //    int refcount; //!< Reference counter: tells us how many idx point here.
 
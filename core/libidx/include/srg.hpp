@@ -51,6 +51,8 @@ namespace ebl {
     //    refcount = 0;
     data = (T *)NULL;
     size_ = 0;
+    capacity_ = 0;
+    mapping_ = NULL;
 #ifdef __DEBUG__
     smart_pointer::debug_name << "srg<" << typeid(T).name() << ">";
 #endif
@@ -61,6 +63,9 @@ namespace ebl {
     intg r;
     //    refcount = 0;
     data = (T *)NULL;
+    size_ = 0;
+    capacity_ = 0;
+    mapping_ = NULL;
     if ( ( r=this->changesize(s) ) > 0 ) this->clear();
     if (r < 0) { eblerror("can't allocate srg"); }
   }
@@ -75,8 +80,7 @@ namespace ebl {
 
     if (data != NULL) {
       DEBUG_LOW("srg: freeing data " << (void*) data);
-      free((void *) data);
-      data = NULL;
+      free_data();
 #ifdef __DEBUGMEM__
       this->memsize -= size_ * sizeof (T);
 #endif    
@@ -84,6 +88,19 @@ namespace ebl {
     }
   }
 
+  // give data back to the allocator it comes from
+  template <typename T> void srg<T>::free_data() {
+    if (mapping_) {
+      mapping_->unlock();
+      mapping_ = NULL;
+    } else if (capacity_ > 0)
+      srg_allocator::deallocate((void*) data, capacity_);
+    else
+      srg_allocator::system_free((void*) data);
+    data = (T*) NULL;
+    capacity_ = 0;
+  }
+
   // return size
   template <typename T> intg srg<T>::size() { return size_; }
 
@@ -97,14 +114,35 @@ namespace ebl {
     this->memsize -= size_ * sizeof (T);
 #endif    
     if (s == 0) {
-      free((void*) data);
-      data = (T*) NULL;
+      free_data();
       size_ = 0;
     } else {
-      // TODO: malloc/realloc not thread safe
-      // use google's tcalloc? (supposedly much faster:
-      // http://google-perftools.googlecode.com/svn/trunk/doc/tcmalloc.html    
-      data = (T*) realloc((void*) data, s * sizeof (T));
+      intg bytes = s * sizeof (T);
+      if (capacity_ > 0 && bytes <= capacity_ && bytes * 2 > capacity_) {
+	// pooled block is big enough and not too wasteful, keep it
+	size_ = s;
+#ifdef __DEBUGMEM__
+	this->memsize += size_ * sizeof (T);
+#endif
+	return size_;
+      }
+      if (srg_allocator::get_mode() == SRG_ALLOC_POOLED) {
+	intg cap = 0;
+	T *ndata = (T*) srg_allocator::allocate(bytes, cap);
+	if (ndata != NULL && data != NULL)
+	  memcpy(ndata, data, MIN(size_, s) * sizeof (T));
+	free_data();
+	data = ndata;
+	if (data != NULL) capacity_ = cap;
+      } else if (capacity_ > 0 || mapping_) {
+	// moving a pooled or mapped block to the system
+	T *ndata = (T*) srg_allocator::system_realloc(NULL, bytes);
+	if (ndata != NULL)
+	  memcpy(ndata, data, MIN(size_, s) * sizeof (T));
+	free_data();
+	data = ndata;
+      } else
+	data = (T*) srg_allocator::system_realloc((void*) data, bytes);
       if (data != NULL) {
 	size_ = s;
 #ifdef __DEBUGMEM__
@@ -168,7 +206,32 @@ namespace ebl {
   // get i-th item
   template <typename T> T* srg<T>::get_data() { return data; }
   // set data pointer
-  template <typename T> void srg<T>::set_data(T* ptr) { data=ptr; }
+  template <typename T> void srg<T>::set_data(T* ptr) {
+    if (mapping_) { // stop aliasing the mapping, ptr is owned from now on
+      mapping_->unlock();
+      mapping_ = NULL;
+    }
+    data = ptr;
+    capacity_ = 0;
+  }
+
+  // alias mapped data
+  template <typename T>
+  void srg<T>::set_mapped(file_mapping *map, intg offset, intg n) {
+#ifdef __DEBUGMEM__
+    this->memsize -= size_ * sizeof (T);
+#endif
+    map->lock(); // before releasing data, which may be the same mapping
+    free_data();
+    mapping_ = map;
+    data = (T*) (map->data() + offset);
+    size_ = n;
+#ifdef __DEBUGMEM__
+    this->memsize += size_ * sizeof (T);
+#endif
+  }
+
+  template <typename T> bool srg<T>::mapped() { return mapping_ != NULL; }
 
   // set i-th item
   template <typename T> void srg<T>::set(intg i, T val) { data[i] = val; }
@@ -183,6 +246,7 @@ namespace ebl {
     fprintf(f,"srg at address %ld; ",(long)this);
     fprintf(f,"size=%ld; ",size_);
     fprintf(f,"data=%ld; ",(long)data);
+    fprintf(f,"capacity=%ld; ",capacity_);
     //    fprintf(f,"refcount=%d\n",refcount);
   }
   
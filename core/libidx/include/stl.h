@@ -53,6 +53,7 @@ namespace ebl {
 //! Pre-declaration of classes.
 template <typename T> class idx;
 class eblexception;
+class file_mapping;
 
 }
 
@@ -279,6 +280,8 @@ public:
   virtual ~file();
   //! Returns the file pointer.
   FILE *get_fp();
+  //! Returns the name of the file.
+  const char *name();
   //! Increase reference counter.
   void incr_ref();
   //! Decrease reference counter.
@@ -287,10 +290,16 @@ public:
   bool no_references();
   //! Returns the number of references to this file pointer.
   uint references();
+  //! Returns a memory mapping of the whole file, created on first call,
+  //! or NULL if the file cannot be mapped.
+  ebl::file_mapping* mapping();
 
 protected:
   FILE *fp;
+  std::string filename; //!< Name of the file.
   uint refcounter; //!< Count how many objects refer to this instance.
+  ebl::file_mapping *map; //!< Mapping of the file, NULL if not mapped yet.
+  bool map_failed; //!< True if the file could not be mapped.
 };
 
 } // end namespace std
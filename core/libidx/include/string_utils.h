@@ -75,6 +75,13 @@ EXPORT double string_to_double(const std::string &s);
 //! Convert a string to an double. Throws a const char * exception
 //! upon failure.
 EXPORT double string_to_double(const char *s);
+//! Parses a double from the characters between 's' and 'end', which do not
+//! need to be null-terminated, into 'd'. Leading whitespace is skipped and
+//! characters following the number are ignored. Returns false if no number
+//! is found. Values are rounded exactly as strtod() but most are parsed
+//! without calling it, which is much faster. Tokens without digits such as
+//! "inf" or "nan" are left to strtod().
+EXPORT bool parse_double(const char *s, const char *end, double &d);
 
 //! Convert a string containing a list of uint separated by commas, e.g.
 //! "1,2,3,4" into a list of uints.
@@ -38,6 +38,7 @@
 
 #include "color_spaces.h"
 #include "idxops.h"
+#include "simd.h"
 
 namespace ebl {
 
@@ -54,6 +55,13 @@ namespace ebl {
 				    {  1,      2.03211,  0 }};
   idx<double> yuv_rgb((const double*)yuv_rgb_mat, 3, 3);
 
+  // yuv = (rgb_yuv * rgb + (0, 111, 157)) .* (1, 1.14678, 0.81300)
+  const double rgb_yuv_affine[12] = {
+    0.299, 0.587, 0.114, 0,
+    -0.147 * 1.14678, -0.289 * 1.14678, 0.437 * 1.14678, 111 * 1.14678,
+    0.615 * 0.81300, -0.515 * 0.81300, -0.100 * 0.81300, 157 * 0.81300 };
+  const double rgb_y_affine[4] = { 0.299, 0.587, 0.114, 0 };
+
   void YUVGlobalNormalization(idx<float> &yuv) {
     idx_checkorder1(yuv, 3);
     idx<float> tmp = yuv.select(2, 0);
@@ -67,6 +75,67 @@ namespace ebl {
     idx_dotc(tmp, (float)    0.01, tmp);
   }
 
+  ////////////////////////////////////////////////////////////////
+  // Whole-image conversions
+
+  //! float32 outputs of color_affine_row, for float32 and ubyte inputs.
+  template <typename Tin>
+  static void color_affine_row_float(const Tin *c0, const Tin *c1,
+				     const Tin *c2, intg is, float32 *o0,
+				     float32 *o1, float32 *o2, intg os,
+				     int nout, intg n, const double *m) {
+    float32 mf[12];
+    for (int j = 0; j < 4 * nout; ++j)
+      mf[j] = (float32) m[j];
+    float32 *o[3] = { o0, o1, o2 };
+#ifdef __SIMD__
+    if (is == 1 && os == 1) {
+      simd_color_affine(c0, c1, c2, mf, o0, o1, o2, nout, n);
+      return ;
+    }
+    // strided pixels (e.g. interleaved): convert blocks copied into planes
+    const intg bs = 256;
+    Tin b0[bs], b1[bs], b2[bs];
+    float32 r0[bs], r1[bs], r2[bs];
+    float32 *r[3] = { r0, r1, r2 };
+    for (intg i = 0; i < n; i += bs) {
+      intg k = std::min(bs, n - i);
+      for (intg j = 0; j < k; ++j) {
+	b0[j] = c0[(i + j) * is];
+	b1[j] = c1[(i + j) * is];
+	b2[j] = c2[(i + j) * is];
+      }
+      simd_color_affine(b0, b1, b2, mf, r0, r1, r2, nout, k);
+      for (int c = 0; c < nout; ++c) {
+	float32 *oc = o[c] + i * os;
+	for (intg j = 0; j < k; ++j)
+	  oc[j * os] = r[c][j];
+      }
+    }
+#else
+    for (intg i = 0; i < n; ++i) {
+      float32 a = (float32) c0[i * is], b = (float32) c1[i * is],
+	c = (float32) c2[i * is];
+      for (int j = 0; j < nout; ++j)
+	o[j][i * os] = mf[4 * j] * a + mf[4 * j + 1] * b + mf[4 * j + 2] * c
+	  + mf[4 * j + 3];
+    }
+#endif
+  }
+
+  void color_affine_row(const float32 *c0, const float32 *c1,
+			const float32 *c2, intg is, float32 *o0, float32 *o1,
+			float32 *o2, intg os, int nout, intg n,
+			const double *m) {
+    color_affine_row_float(c0, c1, c2, is, o0, o1, o2, os, nout, n, m);
+  }
+
+  void color_affine_row(const ubyte *c0, const ubyte *c1, const ubyte *c2,
+			intg is, float32 *o0, float32 *o1, float32 *o2,
+			intg os, int nout, intg n, const double *m) {
+    color_affine_row_float(c0, c1, c2, is, o0, o1, o2, os, nout, n, m);
+  }
+
   // ######################################################################
   // T. Nathan Mundhenk
   // mundhenk@usc.edu
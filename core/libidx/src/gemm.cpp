@@ -0,0 +1,497 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+// tell header that we are in the libidx scope
+#define LIBIDX
+
+#include "config.h"
+#include "idx.h"
+#include "idxops.h"
+#include "gemm.h"
+#include "simd.h"
+
+namespace ebl {
+
+  // blocking parameters ///////////////////////////////////////////////////////
+
+  // Micro-kernels compute (GEMM_MR x NR) blocks of c held in registers, from
+  // packed panels of a (GEMM_MR rows) and b (nr columns). a is packed by
+  // (GEMM_MC x GEMM_KC) blocks that stay in L2, b by (GEMM_KC x GEMM_NC) blocks
+  // that stay in L3.
+#define GEMM_MR 6
+#define GEMM_MC 120
+#define GEMM_KC 256
+#define GEMM_NC 2048
+  // below this number of multiply-adds, packing is not worth it
+#define GEMM_SMALL 32768
+
+  //! Number of columns NR computed by the micro-kernels for type T, i.e. two
+  //! 256-bit vectors.
+  template <typename T> struct gemm_nr { enum { value = 64 / sizeof (T) }; };
+
+  // micro-kernels /////////////////////////////////////////////////////////////
+
+  // Computes the (GEMM_MR x NR) block r <- pa . pb where pa is a packed
+  // (GEMM_MR x kc) panel of a and pb a packed (kc x NR) panel of b.
+  template <typename T, int NR>
+  static void gemm_kernel_generic(intg kc, const T *pa, const T *pb, T *r) {
+    T acc[GEMM_MR][NR];
+    for (int i = 0; i < GEMM_MR; ++i)
+      for (int j = 0; j < NR; ++j)
+	acc[i][j] = 0;
+    for (intg p = 0; p < kc; ++p, pa += GEMM_MR, pb += NR)
+      for (int i = 0; i < GEMM_MR; ++i) {
+	T ai = pa[i];
+	for (int j = 0; j < NR; ++j)
+	  acc[i][j] += ai * pb[j];
+      }
+    for (int i = 0; i < GEMM_MR; ++i)
+      for (int j = 0; j < NR; ++j)
+	r[i * NR + j] = acc[i][j];
+  }
+
+#ifdef __SIMD__
+  //! 256-bit vector of T.
+  template <typename T> struct gemm_vec;
+  template <> struct gemm_vec<float32> {
+    typedef float32 type __attribute__((vector_size(32))); };
+  template <> struct gemm_vec<float64> {
+    typedef float64 type __attribute__((vector_size(32))); };
+
+  // Same as gemm_kernel_generic with avx2 and fma, keeping the
+  // (GEMM_MR x 2) accumulator vectors in registers.
+  template <typename T, int NR> __attribute__((target("avx2,fma")))
+  static void gemm_kernel_avx2(intg kc, const T *pa, const T *pb, T *r) {
+    typedef typename gemm_vec<T>::type V;
+    const int W = sizeof (V) / sizeof (T);
+    V c00 = {0}, c01 = {0}, c10 = {0}, c11 = {0}, c20 = {0}, c21 = {0},
+      c30 = {0}, c31 = {0}, c40 = {0}, c41 = {0}, c50 = {0}, c51 = {0};
+    V b0, b1;
+    for (intg p = 0; p < kc; ++p, pa += GEMM_MR, pb += NR) {
+      __builtin_memcpy(&b0, pb, sizeof (V));
+      __builtin_memcpy(&b1, pb + W, sizeof (V));
+      c00 += pa[0] * b0; c01 += pa[0] * b1;
+      c10 += pa[1] * b0; c11 += pa[1] * b1;
+      c20 += pa[2] * b0; c21 += pa[2] * b1;
+      c30 += pa[3] * b0; c31 += pa[3] * b1;
+      c40 += pa[4] * b0; c41 += pa[4] * b1;
+      c50 += pa[5] * b0; c51 += pa[5] * b1;
+    }
+    __builtin_memcpy(r + 0 * NR, &c00, sizeof (V));
+    __builtin_memcpy(r + 0 * NR + W, &c01, sizeof (V));
+    __builtin_memcpy(r + 1 * NR, &c10, sizeof (V));
+    __builtin_memcpy(r + 1 * NR + W, &c11, sizeof (V));
+    __builtin_memcpy(r + 2 * NR, &c20, sizeof (V));
+    __builtin_memcpy(r + 2 * NR + W, &c21, sizeof (V));
+    __builtin_memcpy(r + 3 * NR, &c30, sizeof (V));
+    __builtin_memcpy(r + 3 * NR + W, &c31, sizeof (V));
+    __builtin_memcpy(r + 4 * NR, &c40, sizeof (V));
+    __builtin_memcpy(r + 4 * NR + W, &c41, sizeof (V));
+    __builtin_memcpy(r + 5 * NR, &c50, sizeof (V));
+    __builtin_memcpy(r + 5 * NR + W, &c51, sizeof (V));
+  }
+
+  // Returns true if the cpu has the FMA instructions, which some cpus and
+  // virtual machines do not expose along with avx2.
+  static bool gemm_detect_fma() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("fma");
+  }
+
+  static bool gemm_has_fma = gemm_detect_fma();
+#endif
+
+  // packing ///////////////////////////////////////////////////////////////////
+
+  // Packs the (mc x kc) block of a starting at 'a' into panels of GEMM_MR rows,
+  // scaled by alpha and zero-padded to a multiple of GEMM_MR rows.
+  template <typename T>
+  static void gemm_pack_a(intg mc, intg kc, const T *a, intg am0, intg am1,
+			  T alpha, T *pa) {
+    for (intg ir = 0; ir < mc; ir += GEMM_MR) {
+      intg mr = std::min((intg) GEMM_MR, mc - ir);
+      const T *a0 = a + ir * am0;
+      for (intg p = 0; p < kc; ++p, pa += GEMM_MR) {
+	const T *ap = a0 + p * am1;
+	intg i = 0;
+	for (; i < mr; ++i) pa[i] = alpha * ap[i * am0];
+	for (; i < GEMM_MR; ++i) pa[i] = 0;
+      }
+    }
+  }
+
+  // Packs the (kc x nc) block of b starting at 'b' into panels of NR columns,
+  // zero-padded to a multiple of NR columns.
+  template <typename T, int NR>
+  static void gemm_pack_b(intg kc, intg nc, const T *b, intg bm0, intg bm1,
+			  T *pb) {
+    intg npanels = (nc + NR - 1) / NR;
+#ifdef __OPENMP__
+#pragma omp parallel for
+#endif
+    for (intg jp = 0; jp < npanels; ++jp) {
+      intg jr = jp * NR, nr = std::min((intg) NR, nc - jr);
+      const T *b0 = b + jr * bm1;
+      T *pbp = pb + jp * NR * kc;
+      for (intg p = 0; p < kc; ++p, pbp += NR) {
+	const T *bp = b0 + p * bm0;
+	intg j = 0;
+	if (bm1 == 1) for (; j < nr; ++j) pbp[j] = bp[j];
+	else for (; j < nr; ++j) pbp[j] = bp[j * bm1];
+	for (; j < NR; ++j) pbp[j] = 0;
+      }
+    }
+  }
+
+  // blocked gemm //////////////////////////////////////////////////////////////
+
+  // c <- c + alpha . a . b with raw pointers and strides, where a is (m x k),
+  // b is (k x n) and c is (m x n).
+  template <typename T>
+  static void gemm_blocked(intg m, intg n, intg k, T alpha,
+			   const T *a, intg am0, intg am1,
+			   const T *b, intg bm0, intg bm1,
+			   T *c, intg cm0, intg cm1) {
+    const int NR = gemm_nr<T>::value;
+#ifdef __SIMD__
+    bool avx2 = simd_get_level() >= SIMD_AVX2 && gemm_has_fma;
+#endif
+    intg ncmax = std::min((intg) GEMM_NC, n), kcmax = std::min((intg) GEMM_KC, k);
+    intg mcmax = std::min((intg) GEMM_MC, m);
+    // packed panels come from the pooled allocator, whose thread caches
+    // serve them again at the next call
+    intg pbcap, pacap;
+    T *pb = (T*) srg_allocator::allocate
+      (((ncmax + NR - 1) / NR) * NR * kcmax * sizeof (T), pbcap);
+    T *pa = (T*) srg_allocator::allocate
+      (((mcmax + GEMM_MR - 1) / GEMM_MR) * GEMM_MR * kcmax * sizeof (T), pacap);
+    if (!pb || !pa) {
+      srg_allocator::deallocate(pa, pacap);
+      srg_allocator::deallocate(pb, pbcap);
+      eblerror("not enough memory to pack gemm operands");
+    }
+    for (intg jc = 0; jc < n; jc += GEMM_NC) {
+      intg nc = std::min((intg) GEMM_NC, n - jc);
+      intg npanels = (nc + NR - 1) / NR;
+      for (intg pc = 0; pc < k; pc += GEMM_KC) {
+	intg kc = std::min((intg) GEMM_KC, k - pc);
+	gemm_pack_b<T,NR>(kc, nc, b + pc * bm0 + jc * bm1, bm0, bm1, pb);
+	for (intg ic = 0; ic < m; ic += GEMM_MC) {
+	  intg mc = std::min((intg) GEMM_MC, m - ic);
+	  gemm_pack_a(mc, kc, a + ic * am0 + pc * am1, am0, am1, alpha, pa);
+	  // each thread computes whole columns of micro-blocks
+#ifdef __OPENMP__
+#pragma omp parallel for
+#endif
+	  for (intg jp = 0; jp < npanels; ++jp) {
+	    T r[GEMM_MR * NR];
+	    intg jr = jp * NR, nr = std::min((intg) NR, nc - jr);
+	    for (intg ir = 0; ir < mc; ir += GEMM_MR) {
+	      intg mr = std::min((intg) GEMM_MR, mc - ir);
+	      const T *pap = pa + ir * kc, *pbp = pb + jp * NR * kc;
+#ifdef __SIMD__
+	      if (avx2) gemm_kernel_avx2<T,NR>(kc, pap, pbp, r);
+	      else
+#endif
+		gemm_kernel_generic<T,NR>(kc, pap, pbp, r);
+	      // accumulate micro-block into c
+	      T *c0 = c + (ic + ir) * cm0 + (jc + jr) * cm1;
+	      for (intg i = 0; i < mr; ++i) {
+		T *ci = c0 + i * cm0, *ri = r + i * NR;
+		if (cm1 == 1) for (intg j = 0; j < nr; ++j) ci[j] += ri[j];
+		else for (intg j = 0; j < nr; ++j) ci[j * cm1] += ri[j];
+	      }
+	    }
+	  }
+	}
+      }
+    }
+    srg_allocator::deallocate(pa, pacap);
+    srg_allocator::deallocate(pb, pbcap);
+  }
+
+  // Same as gemm_blocked, with simple loops for small products.
+  template <typename T>
+  static void gemm_small(intg m, intg n, intg k, T alpha,
+			 const T *a, intg am0, intg am1,
+			 const T *b, intg bm0, intg bm1,
+			 T *c, intg cm0, intg cm1) {
+    for (intg i = 0; i < m; ++i) {
+      T *ci = c + i * cm0;
+      for (intg p = 0; p < k; ++p) {
+	T ap = alpha * a[i * am0 + p * am1];
+	const T *bp = b + p * bm0;
+	for (intg j = 0; j < n; ++j)
+	  ci[j * cm1] += ap * bp[j * bm1];
+      }
+    }
+  }
+
+  // cblas /////////////////////////////////////////////////////////////////////
+
+#ifdef __CBLAS__
+  // Returns true if matrix m can be passed to cblas (i.e. it has one unit
+  // stride), with its transposition flag 't' and leading dimension 'ld'.
+  template <typename T>
+  static bool gemm_blas_layout(idx<T> &m, CBLAS_TRANSPOSE &t, int &ld) {
+    intg d0 = m.dim(0), d1 = m.dim(1);
+    if (m.mod(1) == 1 || d1 == 1) {
+      t = CblasNoTrans;
+      ld = (int) (d0 == 1 ? d1 : m.mod(0));
+      return ld >= d1;
+    }
+    if (m.mod(0) == 1 || d0 == 1) {
+      t = CblasTrans;
+      ld = (int) (d1 == 1 ? d0 : m.mod(1));
+      return ld >= d0;
+    }
+    return false;
+  }
+
+  // Calls cblas 'f' on a, b and c if their layouts allow it, returns false
+  // otherwise.
+#define GEMM_BLAS(f)							\
+  CBLAS_TRANSPOSE ta, tb, tc;						\
+  int lda, ldb, ldc;							\
+  if (!gemm_blas_layout(a, ta, lda) || !gemm_blas_layout(b, tb, ldb) ||	\
+      !gemm_blas_layout(c, tc, ldc) || tc != CblasNoTrans)		\
+    return false;							\
+  f(CblasRowMajor, ta, tb, (int) c.dim(0), (int) c.dim(1), (int) a.dim(1), \
+    alpha, a.idx_ptr(), lda, b.idx_ptr(), ldb, beta, c.idx_ptr(), ldc);	\
+  return true;
+
+  static bool gemm_blas(idx<float32> &a, idx<float32> &b, idx<float32> &c,
+			float32 alpha, float32 beta) {
+    GEMM_BLAS(cblas_sgemm)
+  }
+
+  static bool gemm_blas(idx<float64> &a, idx<float64> &b, idx<float64> &c,
+			float64 alpha, float64 beta) {
+    GEMM_BLAS(cblas_dgemm)
+  }
+#endif
+
+  // idx_gemm //////////////////////////////////////////////////////////////////
+
+  template <typename T>
+  static void gemm2(idx<T> &a, idx<T> &b, idx<T> &c, T alpha, T beta) {
+    intg m = c.dim(0), n = c.dim(1), k = a.dim(1);
+    if (m == 0 || n == 0) return ;
+#ifdef __CBLAS__
+    if (gemm_blas(a, b, c, alpha, beta)) return ;
+#endif
+    // c <- beta . c
+    if (beta == 0) idx_clear(c);
+    else if (beta != 1) idx_dotc(c, beta, c);
+    if (k == 0 || alpha == 0) return ;
+    if (m * n * k < GEMM_SMALL)
+      gemm_small(m, n, k, alpha, a.idx_ptr(), a.mod(0), a.mod(1),
+		 b.idx_ptr(), b.mod(0), b.mod(1), c.idx_ptr(), c.mod(0), c.mod(1));
+    else
+      gemm_blocked(m, n, k, alpha, a.idx_ptr(), a.mod(0), a.mod(1),
+		   b.idx_ptr(), b.mod(0), b.mod(1),
+		   c.idx_ptr(), c.mod(0), c.mod(1));
+  }
+
+  template <typename T>
+  static void gemm(idx<T> &a, idx<T> &b, idx<T> &c, T alpha, T beta) {
+    if (a.order() == 3 && b.order() == 3 && c.order() == 3) { // batch
+      if (a.dim(0) != b.dim(0) || a.dim(0) != c.dim(0))
+	eblerror("incompatible batch dimensions for matrix-matrix "
+		 << "multiplication of " << a << " . " << b << " -> " << c);
+      for (intg i = 0; i < a.dim(0); ++i) {
+	idx<T> ai = a.select(0, i), bi = b.select(0, i), ci = c.select(0, i);
+	gemm(ai, bi, ci, alpha, beta);
+      }
+      return ;
+    }
+    idx_checkorder3(a, 2, b, 2, c, 2);
+    if (a.dim(1) != b.dim(0) || a.dim(0) != c.dim(0) || c.dim(1) != b.dim(1))
+      eblerror("incompatible dimensions for matrix-matrix multiplication of "
+	       << a << " . " << b << " -> " << c);
+    gemm2(a, b, c, alpha, beta);
+  }
+
+  void idx_gemm(idx<float32> &a, idx<float32> &b, idx<float32> &c,
+		float32 alpha, float32 beta) {
+    gemm(a, b, c, alpha, beta);
+  }
+
+  void idx_gemm(idx<float64> &a, idx<float64> &b, idx<float64> &c,
+		float64 alpha, float64 beta) {
+    gemm(a, b, c, alpha, beta);
+  }
+
+  // int8 products /////////////////////////////////////////////////////////////
+
+  template <typename T>
+  static void quantize_s8(idx<T> &in, idx<byte> &out, T scale) {
+    idx_checknelems2_all(in, out);
+    if (scale <= 0)
+      eblerror("expected a positive quantization scale but got " << scale);
+    T inv = 1 / scale;
+    idx_aloop2(i, in, T, o, out, byte) {
+      T v = *i * inv;
+      v = v > 127 ? 127 : (v < -127 ? -127 : v);
+      *o = (byte) (v >= 0 ? (int) (v + (T) .5) : (int) (v - (T) .5));
+    }
+  }
+
+  void idx_quantize_s8(idx<float32> &in, idx<byte> &out, float32 scale) {
+    quantize_s8(in, out, scale);
+  }
+
+  void idx_quantize_s8(idx<float64> &in, idx<byte> &out, float64 scale) {
+    quantize_s8(in, out, scale);
+  }
+
+  template <typename T>
+  static void quantize_rows_s8(idx<T> &w, idx<byte> &q, idx<float32> &scale) {
+    idx_checkorder1(w, 2);
+    if (q.get_idxdim() != w.get_idxdim())
+      q = idx<byte>(w.dim(0), w.dim(1));
+    if (scale.order() != 1 || scale.dim(0) != w.dim(0))
+      scale = idx<float32>(w.dim(0));
+    for (intg i = 0; i < w.dim(0); ++i) {
+      idx<T> wi = w.select(0, i);
+      idx<byte> qi = q.select(0, i);
+      T m = 0;
+      { idx_aloop1(v, wi, T) { m = std::max(m, (T) fabs(*v)); }}
+      T s = m > 0 ? m / 127 : 1;
+      quantize_s8(wi, qi, s);
+      scale.set((float32) s, i);
+    }
+  }
+
+  void idx_quantize_rows_s8(idx<float32> &w, idx<byte> &q,
+			    idx<float32> &scale) {
+    quantize_rows_s8(w, q, scale);
+  }
+
+  void idx_quantize_rows_s8(idx<float64> &w, idx<byte> &q,
+			    idx<float32> &scale) {
+    quantize_rows_s8(w, q, scale);
+  }
+
+  template <typename T>
+  static void gemm_s8(idx<byte> &a, idx<byte> &bt, idx<T> &c,
+		      idx<float32> &scale) {
+    idx_checkorder3(a, 2, bt, 2, c, 2);
+    idx_checkorder1(scale, 1);
+    intg m = a.dim(0), n = bt.dim(0), k = a.dim(1);
+    if (bt.dim(1) != k || c.dim(0) != m || c.dim(1) != n || scale.dim(0) != m)
+      eblerror("incompatible dimensions for int8 matrix multiplication of "
+	       << a << " . " << bt << "' -> " << c << " with scales " << scale);
+    if ((k > 1 && (a.mod(1) != 1 || bt.mod(1) != 1)) || scale.mod(0) != 1)
+      eblerror("int8 matrix multiplication expects contiguous rows but got "
+	       << a << " and " << bt);
+    const byte *pa = a.idx_ptr(), *pb = bt.idx_ptr();
+    const float32 *ps = scale.idx_ptr();
+    T *pc = c.idx_ptr();
+    intg am = a.mod(0), bm = bt.mod(0), cm0 = c.mod(0), cm1 = c.mod(1);
+    // blocks of 4 rows of bt stay in L1 while all rows of a go through them
+    intg j, nblocks = (n + 3) / 4;
+#ifdef __OPENMP__
+#pragma omp parallel for private(j)
+#endif
+    for (j = 0; j < nblocks; ++j) {
+      intg j0 = j * 4, nb = std::min((intg) 4, n - j0);
+      const byte *b = pb + j0 * bm;
+      int32 acc[4];
+      for (intg i = 0; i < m; ++i) {
+	const byte *ai = pa + i * am;
+	if (nb == 4) {
+#ifdef __SIMD__
+	  simd_dot4_s8(ai, b, bm, k, acc);
+#else
+	  for (intg t = 0; t < 4; ++t) {
+	    int32 sum = 0;
+	    const byte *bj = b + t * bm;
+	    for (intg p = 0; p < k; ++p) sum += (int32) ai[p] * bj[p];
+	    acc[t] = sum;
+	  }
+#endif
+	} else
+	  for (intg t = 0; t < nb; ++t) {
+	    int32 sum = 0;
+	    const byte *bj = b + t * bm;
+	    for (intg p = 0; p < k; ++p) sum += (int32) ai[p] * bj[p];
+	    acc[t] = sum;
+	  }
+	// fused dequantization
+	T *ci = pc + i * cm0 + j0 * cm1;
+	float32 s = ps[i];
+	for (intg t = 0; t < nb; ++t)
+	  ci[t * cm1] += (T) (s * acc[t]);
+      }
+    }
+  }
+
+  void idx_gemm_s8(idx<byte> &a, idx<byte> &bt, idx<float32> &c,
+		   idx<float32> &scale) {
+    gemm_s8(a, bt, c, scale);
+  }
+
+  void idx_gemm_s8(idx<byte> &a, idx<byte> &bt, idx<float64> &c,
+		   idx<float32> &scale) {
+    gemm_s8(a, bt, c, scale);
+  }
+
+  // m2dotm2 ///////////////////////////////////////////////////////////////////
+
+#ifndef __IPP__
+  template <>
+  void idx_m2dotm2(idx<float32> &a, idx<float32> &x, idx<float32> &y) {
+    idx_checkorder3(a, 2, x, 2, y, 2);
+    idx_gemm(a, x, y, (float32) 1, (float32) 0);
+  }
+
+  template <>
+  void idx_m2dotm2(idx<float64> &a, idx<float64> &x, idx<float64> &y) {
+    idx_checkorder3(a, 2, x, 2, y, 2);
+    idx_gemm(a, x, y, (float64) 1, (float64) 0);
+  }
+#endif
+
+  template <>
+  void idx_m2dotm2acc(idx<float32> &a, idx<float32> &x, idx<float32> &y) {
+    idx_checkorder3(a, 2, x, 2, y, 2);
+    idx_gemm(a, x, y, (float32) 1, (float32) 1);
+  }
+
+  template <>
+  void idx_m2dotm2acc(idx<float64> &a, idx<float64> &x, idx<float64> &y) {
+    idx_checkorder3(a, 2, x, 2, y, 2);
+    idx_gemm(a, x, y, (float64) 1, (float64) 1);
+  }
+
+} // end namespace ebl
@@ -0,0 +1,77 @@
+/***************************************************************************
+ *   Copyright (C) 2012 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#define LIBIDX
+
+#include "config.h"
+#include "idxops.h"
+#include "half.h"
+
+namespace ebl {
+
+  // bulk conversions //////////////////////////////////////////////////////////
+
+#ifdef __SIMD__
+#define half_convert_macro(name, Tin, Tout)				\
+  void name(const Tin *in, Tout *out, intg n) {				\
+    simd_##name(in, out, n);						\
+  }
+#else
+#define half_convert_macro(name, Tin, Tout)				\
+  void name(const Tin *in, Tout *out, intg n) {				\
+    for (intg i = 0; i < n; ++i) out[i] = in[i];			\
+  }
+#endif
+
+  half_convert_macro(float16_to_float32, float16, float32)
+  half_convert_macro(float32_to_float16, float32, float16)
+  half_convert_macro(bfloat16_to_float32, bfloat16, float32)
+  half_convert_macro(float32_to_bfloat16, float32, bfloat16)
+
+  // idx_copy specializations //////////////////////////////////////////////////
+
+#define idx_copy_half_macro(name, Tin, Tout)				\
+  template <> void idx_copy(const idx<Tin> &src, idx<Tout> &dst) {	\
+    idx_checknelems2_all(src, dst);					\
+    if (src.contiguousp() && dst.contiguousp())				\
+      name(src.idx_ptr(), dst.idx_ptr(), src.nelements());		\
+    else {								\
+      idx_aloop2(isrc, src, Tin, idst, dst, Tout) { *idst = *isrc; }	\
+    }									\
+  }
+
+  idx_copy_half_macro(float16_to_float32, float16, float32)
+  idx_copy_half_macro(float32_to_float16, float32, float16)
+  idx_copy_half_macro(bfloat16_to_float32, bfloat16, float32)
+  idx_copy_half_macro(float32_to_bfloat16, float32, bfloat16)
+
+} // end namespace ebl
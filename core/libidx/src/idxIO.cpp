@@ -34,7 +34,13 @@
 #define LIBIDX
 
 #include <stdio.h>
+#include <string.h>
+#include <vector>
 #include "idxIO.h"
+#include "lzcodec.h"
+
+// size in bytes of independently compressed chunks
+#define COMPRESSED_CHUNK (1 << 20)
 
 namespace ebl {
 
@@ -94,7 +100,9 @@ bool is_magic(int magic) {
       || magic == MAGIC_ASCII_MATRIX
       || magic == MAGIC_UINT_MATRIX
       || magic == MAGIC_UINT64_MATRIX
-      || magic == MAGIC_INT64_MATRIX)
+      || magic == MAGIC_INT64_MATRIX
+      || magic == MAGIC_FLOAT16_MATRIX
+      || magic == MAGIC_BFLOAT16_MATRIX)
     return true;
   return false;
 }
@@ -107,6 +115,7 @@ bool is_matrix(const char *filename) {
       eblthrow("failed to open " << filename);
     int magic = 0;
     read_matrix_header(fp, magic);
+    fclose(fp);
   } catch (eblexception &e) { return false; }
   return true;
 }
@@ -123,16 +132,38 @@ idxdim get_matrix_dims(const char *filename) {
   return d;
 }
 
-idxdim read_matrix_header(FILE *fp, int &magic) {
+idxdim read_matrix_header(FILE *fp, int &magic, bool *compressed) {
   int ndim, v, magic_vincent;
   int ndim_min = 3; // std header requires at least 3 dims even empty ones.
   idxdim dims;
 
+  if (compressed) *compressed = false;
   // read magic number
   if (fread(&magic, sizeof (int), 1, fp) != 1) {
     fclose(fp);
     eblthrow("cannot read magic number");
   }
+  // compressed matrix: read regular header, compressed data follows
+  if (magic == MAGIC_COMPRESSED_MATRIX) {
+    dims = read_matrix_header(fp, magic);
+    if (compressed) *compressed = true;
+    return dims;
+  }
+  // aligned matrix: read data offset, regular header and skip padding
+  if (magic == MAGIC_ALIGNED_MATRIX) {
+    long start = ftell(fp) - sizeof (int);
+    int offset;
+    if (fread(&offset, sizeof (int), 1, fp) != 1) {
+      fclose(fp);
+      eblthrow("cannot read data offset");
+    }
+    dims = read_matrix_header(fp, magic);
+    if (fseek(fp, start + offset, SEEK_SET)) {
+      fclose(fp);
+      eblthrow("failed to seek to data offset " << offset);
+    }
+    return dims;
+  }
   magic_vincent = endian(magic);
   magic_vincent &= ~0xF; // magic contained in higher bits
 
@@ -185,8 +216,9 @@ bool has_multiple_matrices(const char *filename) {
     return false;
   // read header
   int magic;
+  bool compressed;
   idxdim d;
-  try { d = read_matrix_header(fp, magic); }
+  try { d = read_matrix_header(fp, magic, &compressed); }
   catch(ebl::eblexception &e) { return false; }
   int magic_vincent = endian(magic);
   magic_vincent &= ~0xF; // magic contained in higher bits
@@ -221,12 +253,25 @@ bool has_multiple_matrices(const char *filename) {
     case MAGIC_INT64_MATRIX:
       size *= sizeof (int64);
       break ;
+    case MAGIC_FLOAT16_MATRIX:
+      size *= sizeof (float16);
+      break ;
+    case MAGIC_BFLOAT16_MATRIX:
+      size *= sizeof (bfloat16);
+      break ;
     default:
       eblerror("unknown magic number: " << reinterpret_cast<void*>(magic)
              << " or " << magic << " vincent: " << magic_vincent);
   }
   // go to end of data
-  fseek(fp, size, SEEK_CUR);
+  if (compressed) {
+    try { skip_compressed_data(fp); }
+    catch(ebl::eblexception &e) {
+      fclose(fp);
+      return false;
+    }
+  } else
+    fseek(fp, size, SEEK_CUR);
   fpos_t pos;
   fgetpos(fp, &pos);
   // now go to end of file
@@ -244,4 +289,164 @@ bool has_multiple_matrices(const char *filename) {
   return false;
 }
 
+std::string csv_cache_name(const char *filename, int magic,
+                           bool ignore_first_line,
+                           bool ignore_missing_value_lines,
+                           bool ignore_empty_cols) {
+  std::string name = filename;
+  name += ignore_first_line ? ".1" : ".0";
+  name += ignore_missing_value_lines ? "1" : "0";
+  name += ignore_empty_cols ? "1" : "0";
+  name += ".";
+  name += get_magic_str(magic);
+  name += ".mat";
+  return name;
+}
+
+// mapped loading //////////////////////////////////////////////////////////////
+
+static bool mapped_loading_enabled = false;
+
+void set_mapped_loading(bool enable) {
+  mapped_loading_enabled = enable;
+}
+
+bool mapped_loading() {
+  return mapped_loading_enabled;
+}
+
+// csv caching /////////////////////////////////////////////////////////////////
+
+static bool csv_caching_enabled = false;
+
+void set_csv_caching(bool enable) {
+  csv_caching_enabled = enable;
+}
+
+bool csv_caching() {
+  return csv_caching_enabled;
+}
+
+// compressed data /////////////////////////////////////////////////////////////
+
+static bool compressed_saving_enabled = false;
+
+void set_compressed_saving(bool enable) {
+  compressed_saving_enabled = enable;
+}
+
+bool compressed_saving() {
+  return compressed_saving_enabled;
+}
+
+bool write_compressed_data(FILE *fp, const char *data, intg n, int size) {
+  intg total = n * size;
+  int header[3];
+  header[0] = size > 1 ? 1 : 0; // byte-shuffle filter
+  header[1] = COMPRESSED_CHUNK;
+  header[2] = (int) ((total + COMPRESSED_CHUNK - 1) / COMPRESSED_CHUNK);
+  int nchunks = header[2], filter = header[0];
+  if (fwrite(header, sizeof (int), 3, fp) != 3) return false;
+  if (nchunks == 0) return true;
+  // compress all chunks, a chunk is never stored larger than raw
+  std::vector<int> csizes(nchunks);
+  std::vector<char> out(total);
+  int i;
+#ifdef __OPENMP__
+#pragma omp parallel for
+#endif
+  for (i = 0; i < nchunks; ++i) {
+    intg off = (intg) i * COMPRESSED_CHUNK;
+    intg len = std::min((intg) COMPRESSED_CHUNK, total - off);
+    const char *src = data + off;
+    std::vector<char> shuffled;
+    if (filter) {
+      shuffled.resize(len);
+      byte_shuffle(src, len / size, size, &shuffled[0]);
+      src = &shuffled[0];
+    }
+    intg c = lz_compress(src, len, &out[off], len - 1);
+    if (c == 0) { // incompressible, store raw
+      memcpy(&out[off], data + off, len);
+      c = len;
+    }
+    csizes[i] = (int) c;
+  }
+  // write chunk sizes and chunks
+  if (fwrite(&csizes[0], sizeof (int), nchunks, fp) != (size_t) nchunks)
+    return false;
+  for (i = 0; i < nchunks; ++i)
+    if (fwrite(&out[(intg) i * COMPRESSED_CHUNK], 1, csizes[i], fp)
+        != (size_t) csizes[i])
+      return false;
+  return true;
+}
+
+//! Reads the header and chunk sizes of compressed data into 'header' and
+//! 'csizes' and returns the total size of the chunks.
+static intg read_compressed_index(FILE *fp, int header[3],
+                                  std::vector<int> &csizes) {
+  if (fread(header, sizeof (int), 3, fp) != 3)
+    eblthrow("failed to read compressed data header");
+  if (header[1] <= 0 || header[2] < 0)
+    eblthrow("invalid compressed data header");
+  csizes.resize(header[2]);
+  if (header[2] > 0 && fread(&csizes[0], sizeof (int), header[2], fp)
+      != (size_t) header[2])
+    eblthrow("failed to read compressed chunk sizes");
+  intg total = 0;
+  for (int i = 0; i < header[2]; ++i) {
+    if (csizes[i] <= 0 || csizes[i] > header[1])
+      eblthrow("invalid compressed chunk size " << csizes[i]);
+    total += csizes[i];
+  }
+  return total;
+}
+
+void read_compressed_data(FILE *fp, char *data, intg n, int size) {
+  int header[3];
+  std::vector<int> csizes;
+  intg csize = read_compressed_index(fp, header, csizes);
+  int filter = header[0], chunk = header[1], nchunks = header[2];
+  intg total = n * size;
+  if (chunk % size != 0 || nchunks != (total + chunk - 1) / chunk)
+    eblthrow("compressed data does not match " << n << " elements of "
+             << size << " bytes");
+  if (nchunks == 0) return ;
+  // read all chunks at once then decompress them independently
+  std::vector<char> in(csize);
+  if (fread(&in[0], 1, csize, fp) != (size_t) csize)
+    eblthrow("failed to read " << csize << " bytes of compressed data");
+  std::vector<intg> offsets(nchunks, 0);
+  for (int i = 1; i < nchunks; ++i)
+    offsets[i] = offsets[i - 1] + csizes[i - 1];
+  int failed = 0, i;
+#ifdef __OPENMP__
+#pragma omp parallel for
+#endif
+  for (i = 0; i < nchunks; ++i) {
+    intg off = (intg) i * chunk;
+    intg len = std::min((intg) chunk, total - off);
+    const char *src = &in[offsets[i]];
+    if (csizes[i] == len) // raw chunk
+      memcpy(data + off, src, len);
+    else if (!filter) {
+      if (!lz_decompress(src, csizes[i], data + off, len)) failed = 1;
+    } else {
+      std::vector<char> shuffled(len);
+      if (!lz_decompress(src, csizes[i], &shuffled[0], len)) failed = 1;
+      else byte_unshuffle(&shuffled[0], len / size, size, data + off);
+    }
+  }
+  if (failed) eblthrow("corrupted compressed data");
+}
+
+void skip_compressed_data(FILE *fp) {
+  int header[3];
+  std::vector<int> csizes;
+  intg csize = read_compressed_index(fp, header, csizes);
+  if (fseek(fp, csize, SEEK_CUR))
+    eblthrow("failed to skip " << csize << " bytes of compressed data");
+}
+
 } // end namespace ebl
@@ -34,11 +34,24 @@
 #define LIBIDX
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #ifndef __WINDOWS__
 #include <inttypes.h>
 #endif
 
+#ifdef __PNG__
+#include <png.h>
+#endif
+
+#ifdef __JPEG__
+#include <setjmp.h>
+extern "C" {
+#include <jpeglib.h>
+}
+#endif
+
 #include "imageIO.h"
 #include "idxops.h"
 #include "idx.h"
@@ -103,14 +116,19 @@ namespace ebl {
     expected_size = dims.nelements();
 
     switch (type) {
-    // case 3: // PPM ASCII
-    //   uint val;
-    //   { idx_aloop1(o, *pout, ubyte) {
-    // 	in >> val;
-    // 	// downcasting automatically scales values if vmax > 255
-    // 	*o = (unsigned char) val;
-    // 	}}
-    //   break ;
+    case 2: // PGM ASCII, replicated into 3 channels
+    case 3: // PPM ASCII
+      { idx_bloop1(ou, *pout, ubyte) {
+	  { idx_bloop1(o, ou, ubyte) {
+	      if (type == 3) {
+		{ idx_bloop1(c, o, ubyte) {
+		    c.set((ubyte) (fscan_int(fp) * 255 / vmax));
+		  }}
+	      } else
+		idx_fill(o, (ubyte) (fscan_int(fp) * 255 / vmax));
+	    }}
+	}}
+      break ;
     case 6: // PPM binary
       if (pout->contiguousp()) {
 	if (sz == 2) { // 16 bits per pixel
@@ -132,6 +150,22 @@ namespace ebl {
 	      }}}}
       }
       break ;
+    case 5: { // PGM binary, replicated into 3 channels
+      if (sz == 2)
+	eblthrow("16-bit PGM images not supported");
+      idx<ubyte> gray(dims.dim(0), dims.dim(1));
+      expected_size = gray.nelements();
+      read_size = fread((char *) gray.idx_ptr(), 1, expected_size, fp);
+      if (expected_size != read_size) {
+	eblthrow("image read: not enough items read. expected "
+		 << (int) expected_size << " but found " << (int) read_size);
+      }
+      for (int c = 0; c < 3; ++c) {
+	idx<ubyte> channel = pout->select(2, c);
+	idx_copy(gray, channel);
+      }
+      break ;
+    }
       // TODO: implement pnm formats
       /*  case 4: // PBM image
 	  ((= head "P4")
@@ -169,4 +203,141 @@ namespace ebl {
     return *pout;
   }
 
+  ////////////////////////////////////////////////////////////////
+  // in-process decoding
+
+  //! Decodes 8-bit ASCII or binary PGM/PPM file 'fp' into 'out'.
+  static bool pnm_decode(FILE *fp, idx<ubyte> &out) {
+    try {
+      int type, vmax;
+      read_pnm_header(fp, type, vmax);
+      if (type < 2 || type == 4 || vmax <= 0 || vmax > 255)
+	return false; // leave other variants to ImageMagick
+      rewind(fp);
+      out = pnm_read(fp);
+    } catch (eblexception &e) {
+      return false;
+    }
+    return true;
+  }
+
+#ifdef __PNG__
+  //! Decodes PNG file 'fp' into 'out'.
+  static bool png_decode(FILE *fp, idx<ubyte> &out) {
+#if PNG_LIBPNG_VER >= 10600
+    png_image im;
+    memset(&im, 0, sizeof (im));
+    im.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_stdio(&im, fp))
+      return false;
+    // convert any bit depth, palette or gray level to 8-bit RGB. alpha is
+    // read then dropped as ImageMagick did, without a background the
+    // decoder would composite transparent pixels onto black.
+    bool alpha = (im.format & PNG_FORMAT_FLAG_ALPHA) != 0;
+    im.format = alpha ? PNG_FORMAT_RGBA : PNG_FORMAT_RGB;
+    idx<ubyte> buf(im.height, im.width, alpha ? 4 : 3);
+    if (!png_image_finish_read(&im, NULL, buf.idx_ptr(), 0, NULL)) {
+      png_image_free(&im);
+      return false;
+    }
+    if (alpha) {
+      out = idx<ubyte>(im.height, im.width, 3);
+      idx<ubyte> rgb = buf.narrow(2, 3, 0);
+      idx_copy(rgb, out);
+    } else
+      out = buf;
+    return true;
+#else
+    return false; // simplified api not available
+#endif
+  }
+#endif /* __PNG__ */
+
+#ifdef __JPEG__
+  //! A libjpeg error manager jumping back to the decoder on errors
+  //! instead of exiting.
+  struct jpeg_error_jump {
+    struct jpeg_error_mgr mgr;
+    jmp_buf jump;
+  };
+
+  static void jpeg_error_exit(j_common_ptr cinfo) {
+    longjmp(((jpeg_error_jump*) cinfo->err)->jump, 1);
+  }
+
+  //! Decodes JPEG file 'fp' into 'out', downscaled by the largest factor
+  //! (up to 8) keeping it at least 'minh' x 'minw' if one of them is > 0.
+  static bool jpeg_decode(FILE *fp, idx<ubyte> &out, intg minh, intg minw) {
+    struct jpeg_decompress_struct cinfo;
+    jpeg_error_jump jerr;
+    ubyte * volatile gray = NULL;
+    cinfo.err = jpeg_std_error(&jerr.mgr);
+    jerr.mgr.error_exit = jpeg_error_exit;
+    if (setjmp(jerr.jump)) { // decoding error
+      jpeg_destroy_decompress(&cinfo);
+      if (gray) free(gray);
+      return false;
+    }
+    jpeg_create_decompress(&cinfo);
+    jpeg_stdio_src(&cinfo, fp);
+    jpeg_read_header(&cinfo, TRUE);
+    bool grayscale = cinfo.num_components == 1;
+    cinfo.out_color_space = grayscale ? JCS_GRAYSCALE : JCS_RGB;
+    // let the idct downscale if the image is larger than needed
+    if (minh > 0 || minw > 0) {
+      for (uint d = 8; d > 1; d /= 2) {
+	if ((intg) ((cinfo.image_height + d - 1) / d) >= minh
+	    && (intg) ((cinfo.image_width + d - 1) / d) >= minw) {
+	  cinfo.scale_num = 1;
+	  cinfo.scale_denom = d;
+	  break ;
+	}
+      }
+    }
+    jpeg_start_decompress(&cinfo);
+    intg h = cinfo.output_height, w = cinfo.output_width;
+    out = idx<ubyte>(h, w, 3);
+    if (grayscale)
+      gray = (ubyte*) malloc(w);
+    JSAMPROW row;
+    while (cinfo.output_scanline < cinfo.output_height) {
+      ubyte *dst = out.idx_ptr() + (intg) cinfo.output_scanline * w * 3;
+      row = grayscale ? gray : dst;
+      jpeg_read_scanlines(&cinfo, &row, 1);
+      if (grayscale) // replicate gray level into 3 channels
+	for (intg i = 0; i < w; ++i, dst += 3)
+	  dst[0] = dst[1] = dst[2] = gray[i];
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    if (gray) free(gray);
+    return true;
+  }
+#endif /* __JPEG__ */
+
+  bool image_decode(const char *fname, idx<ubyte> &out, intg minh,
+		    intg minw) {
+    FILE *fp = fopen(fname, "rb");
+    if (!fp)
+      return false;
+    ubyte magic[4] = { 0, 0, 0, 0 };
+    size_t n = fread(magic, 1, 4, fp);
+    rewind(fp);
+    bool decoded = false;
+    if (n == 4 && magic[0] == 0x89 && magic[1] == 'P' && magic[2] == 'N'
+	&& magic[3] == 'G') {
+#ifdef __PNG__
+      decoded = png_decode(fp, out);
+#endif
+    } else if (n >= 3 && magic[0] == 0xff && magic[1] == 0xd8
+	       && magic[2] == 0xff) {
+#ifdef __JPEG__
+      decoded = jpeg_decode(fp, out, minh, minw);
+#endif
+    } else if (n >= 2 && magic[0] == 'P' && magic[1] >= '2' && magic[1] <= '6')
+      decoded = pnm_decode(fp, out);
+    fclose(fp);
+    return decoded;
+  }
+
 } // end namespace ebl
@@ -0,0 +1,206 @@
+/***************************************************************************
+ *   Copyright (C) 2012 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+// tell header that we are in the libidx scope
+#define LIBIDX
+
+#include <string.h>
+#include <algorithm>
+#include "lzcodec.h"
+
+#define LZ_MINMATCH 4
+#define LZ_LASTLITERALS 5 // last bytes of a block are always literals
+#define LZ_MFLIMIT 12 // no match can start within the last bytes
+#define LZ_MAXDIST 65535
+#define LZ_HASHLOG 14
+
+namespace ebl {
+
+  // lz codec //////////////////////////////////////////////////////////////////
+
+  static inline uint32 lz_read32(const ubyte *p) {
+    uint32 v;
+    memcpy(&v, p, sizeof (uint32));
+    return v;
+  }
+
+  static inline uint32 lz_hash(uint32 v) {
+    return (v * 2654435761U) >> (32 - LZ_HASHLOG);
+  }
+
+  //! Writes length 'l' in excess of 15 as a sequence of 255-terminated bytes.
+  static inline ubyte* lz_write_length(ubyte *op, intg l) {
+    for (; l >= 255; l -= 255) *op++ = 255;
+    *op++ = (ubyte) l;
+    return op;
+  }
+
+  //! Reads a length extension into 'l', returns false if out of bounds.
+  static inline bool lz_read_length(const ubyte *&ip, const ubyte *iend,
+                                    intg &l) {
+    uint s;
+    do {
+      if (ip >= iend) return false;
+      s = *ip++;
+      l += s;
+    } while (s == 255);
+    return true;
+  }
+
+  intg lz_bound(intg n) {
+    return n + n / 255 + 16;
+  }
+
+  intg lz_compress(const char *src_, intg n, char *dst_, intg cap) {
+    const ubyte *src = (const ubyte*) src_;
+    const ubyte *ip = src, *anchor = src, *iend = src + n;
+    ubyte *op = (ubyte*) dst_, *oend = op + cap;
+    intg lit;
+    if (n > LZ_MFLIMIT) {
+      const ubyte *mflimit = iend - LZ_MFLIMIT;
+      const ubyte *matchlimit = iend - LZ_LASTLITERALS;
+      int32 table[1 << LZ_HASHLOG];
+      for (int i = 0; i < (1 << LZ_HASHLOG); ++i) table[i] = -1;
+      intg misses = 0;
+      while (ip < mflimit) {
+        uint32 seq = lz_read32(ip);
+        uint32 h = lz_hash(seq);
+        int32 ref = table[h];
+        table[h] = (int32) (ip - src);
+        if (ref < 0 || (ip - src) - ref > LZ_MAXDIST
+            || lz_read32(src + ref) != seq) {
+          // skip faster through incompressible regions
+          ip += 1 + (misses++ >> 6);
+          continue;
+        }
+        misses = 0;
+        const ubyte *match = src + ref;
+        // extend match backwards then forwards
+        while (ip > anchor && match > src && ip[-1] == match[-1]) {
+          ip--;
+          match--;
+        }
+        const ubyte *p = ip + LZ_MINMATCH, *m = match + LZ_MINMATCH;
+        while (p < matchlimit && *p == *m) {
+          p++;
+          m++;
+        }
+        lit = ip - anchor;
+        intg ml = p - ip - LZ_MINMATCH;
+        if (op + 1 + lit + lit / 255 + 1 + 2 + ml / 255 + 1 > oend) return 0;
+        // sequence: token, literals, offset, match length
+        ubyte *token = op++;
+        if (lit >= 15) {
+          *token = 15 << 4;
+          op = lz_write_length(op, lit - 15);
+        } else
+          *token = (ubyte) (lit << 4);
+        memcpy(op, anchor, lit);
+        op += lit;
+        uint off = (uint) (ip - match);
+        *op++ = (ubyte) (off & 0xff);
+        *op++ = (ubyte) (off >> 8);
+        if (ml >= 15) {
+          *token |= 15;
+          op = lz_write_length(op, ml - 15);
+        } else
+          *token |= (ubyte) ml;
+        ip = p;
+        anchor = ip;
+        if (ip < mflimit) // help next match
+          table[lz_hash(lz_read32(ip - 2))] = (int32) (ip - 2 - src);
+      }
+    }
+    // last literals
+    lit = iend - anchor;
+    if (op + 1 + lit + lit / 255 + 1 > oend) return 0;
+    if (lit >= 15) {
+      *op++ = 15 << 4;
+      op = lz_write_length(op, lit - 15);
+    } else
+      *op++ = (ubyte) (lit << 4);
+    memcpy(op, anchor, lit);
+    op += lit;
+    return op - (ubyte*) dst_;
+  }
+
+  bool lz_decompress(const char *src, intg csize, char *dst_, intg n) {
+    const ubyte *ip = (const ubyte*) src, *iend = ip + csize;
+    ubyte *dst = (ubyte*) dst_, *op = dst, *oend = dst + n;
+    while (ip < iend) {
+      uint token = *ip++;
+      // literals
+      intg lit = token >> 4;
+      if (lit == 15 && !lz_read_length(ip, iend, lit)) return false;
+      if (lit > iend - ip || lit > oend - op) return false;
+      memcpy(op, ip, lit);
+      op += lit;
+      ip += lit;
+      if (ip == iend) break; // last sequence has no match
+      // match
+      if (iend - ip < 2) return false;
+      intg off = ip[0] | (ip[1] << 8);
+      ip += 2;
+      if (off == 0 || off > op - dst) return false;
+      intg ml = token & 15;
+      if (ml == 15 && !lz_read_length(ip, iend, ml)) return false;
+      ml += LZ_MINMATCH;
+      if (ml > oend - op) return false;
+      const ubyte *m = op - off;
+      // overlapping copies repeat the pattern, doubling the copied span
+      while (ml > 0) {
+        intg c = std::min(ml, (intg) (op - m));
+        memcpy(op, m, c);
+        op += c;
+        ml -= c;
+      }
+    }
+    return op == oend;
+  }
+
+  void byte_shuffle(const char *src, intg n, int size, char *dst) {
+    for (int b = 0; b < size; ++b, dst += n) {
+      const char *s = src + b;
+      for (intg i = 0; i < n; ++i, s += size)
+        dst[i] = *s;
+    }
+  }
+
+  void byte_unshuffle(const char *src, intg n, int size, char *dst) {
+    for (int b = 0; b < size; ++b, src += n) {
+      char *d = dst + b;
+      for (intg i = 0; i < n; ++i, d += size)
+        *d = src[i];
+    }
+  }
+
+} // end namespace ebl
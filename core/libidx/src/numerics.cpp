@@ -35,6 +35,7 @@
 #include "numerics.h"
 #include "defines.h"
 #include "utils.h"
+#include "random.h"
 
 int isinf_local(double x){
 #ifdef __MAC__
@@ -198,6 +199,7 @@ void init_drand(int x) {
 	drand_ini = true;
 	dseed(x);
 	srand(x);
+	thread_random_seed(x);
 }
 
 int dynamic_init_drand(int argc, char **argv) {
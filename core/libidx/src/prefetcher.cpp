@@ -0,0 +1,208 @@
+/***************************************************************************
+ *   Copyright (C) 2012 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+// tell header that we are in the libidx scope
+#define LIBIDX
+
+#include <set>
+#include "prefetcher.h"
+
+namespace ebl {
+
+  ////////////////////////////////////////////////////////////////
+  // prefetcher
+
+  prefetcher::prefetcher(intg budget)
+    : budget_(budget), bytes_(0), maxsize(0), hits_(0), misses_(0),
+      loading(-1), waiting(-1), started(false), stopping(false) {
+#ifndef __WINDOWS__
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&cond, NULL);
+#endif
+  }
+
+  prefetcher::~prefetcher() {
+    stop();
+#ifndef __WINDOWS__
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&mutex);
+#endif
+  }
+
+  void prefetcher::schedule(const std::vector<intg> &order_) {
+#ifndef __WINDOWS__
+    pthread_mutex_lock(&mutex);
+    order = order_;
+    // release loaded samples that are not scheduled anymore
+    std::set<intg> scheduled(order.begin(), order.end());
+    std::map<intg, entry>::iterator i = loaded.begin();
+    while (i != loaded.end()) {
+      if (scheduled.find(i->first) == scheduled.end()) {
+	bytes_ -= i->second.size;
+	i->second.sample->unlock();
+	loaded.erase(i++);
+      } else ++i;
+    }
+    if (!started && !stopping) {
+      if (pthread_create(&thread, NULL, prefetcher::entrypoint, this) == 0)
+	started = true;
+      else
+	eblwarn("failed to start prefetching thread" << std::endl);
+    }
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&mutex);
+#endif
+  }
+
+  void prefetcher::wait() {
+#ifndef __WINDOWS__
+    pthread_mutex_lock(&mutex);
+    while (started && (loading >= 0 ||
+		       (next() >= 0 && bytes_ + maxsize <= budget_)))
+      pthread_cond_wait(&cond, &mutex);
+    pthread_mutex_unlock(&mutex);
+#endif
+  }
+
+  intg prefetcher::hits() { return hits_; }
+
+  intg prefetcher::misses() { return misses_; }
+
+  intg prefetcher::bytes() { return bytes_; }
+
+  void prefetcher::reset_counters() {
+    hits_ = 0;
+    misses_ = 0;
+  }
+
+  smart_pointer* prefetcher::take(intg i) {
+    smart_pointer *sample = NULL;
+#ifndef __WINDOWS__
+    pthread_mutex_lock(&mutex);
+    bool waited = false;
+    while (loading == i) { // being loaded, wait for it
+      waited = true;
+      waiting = i;
+      pthread_cond_wait(&cond, &mutex);
+    }
+    waiting = -1;
+    // do not load it again
+    std::vector<intg>::iterator o = std::find(order.begin(), order.end(), i);
+    if (o != order.end()) order.erase(o);
+    std::map<intg, entry>::iterator e = loaded.find(i);
+    if (e != loaded.end()) {
+      sample = e->second.sample;
+      bytes_ -= e->second.size;
+      loaded.erase(e);
+      pthread_cond_broadcast(&cond); // budget was freed
+    }
+    if (sample && !waited) hits_++;
+    else misses_++;
+    pthread_mutex_unlock(&mutex);
+#else
+    misses_++;
+#endif
+    return sample;
+  }
+
+  void prefetcher::stop() {
+#ifndef __WINDOWS__
+    pthread_mutex_lock(&mutex);
+    stopping = true;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&mutex);
+    if (started) {
+      pthread_join(thread, NULL);
+      started = false;
+    }
+    for (std::map<intg, entry>::iterator i = loaded.begin();
+	 i != loaded.end(); ++i)
+      i->second.sample->unlock();
+    loaded.clear();
+    order.clear();
+    bytes_ = 0;
+#endif
+  }
+
+  void prefetcher::run() {
+#ifndef __WINDOWS__
+    pthread_mutex_lock(&mutex);
+    while (!stopping) {
+      intg i = next();
+      // wait for something to load and room to load it
+      if (i < 0 || bytes_ + maxsize > budget_) {
+	pthread_cond_wait(&cond, &mutex);
+	continue ;
+      }
+      loading = i;
+      pthread_mutex_unlock(&mutex);
+      intg size = 0;
+      smart_pointer *sample = NULL;
+      try {
+	sample = load(i, size);
+      } catch (eblexception &e) {
+	eblwarn("failed to prefetch sample " << i << ": " << e << std::endl);
+      }
+      pthread_mutex_lock(&mutex);
+      loading = -1;
+      std::vector<intg>::iterator o = std::find(order.begin(), order.end(), i);
+      if (sample) {
+	sample->lock();
+	maxsize = std::max(maxsize, size);
+	// keep it if still scheduled or being taken
+	if (o != order.end() || waiting == i) {
+	  entry e = { sample, size };
+	  loaded[i] = e;
+	  bytes_ += size;
+	} else
+	  sample->unlock();
+      } else if (o != order.end()) // do not retry this one
+	order.erase(o);
+      pthread_cond_broadcast(&cond);
+    }
+    pthread_mutex_unlock(&mutex);
+#endif
+  }
+
+  void* prefetcher::entrypoint(void *pthis) {
+    ((prefetcher*) pthis)->run();
+    return NULL;
+  }
+
+  intg prefetcher::next() {
+    for (std::vector<intg>::iterator i = order.begin(); i != order.end(); ++i)
+      if (loaded.find(*i) == loaded.end())
+	return *i;
+    return -1;
+  }
+
+} // end namespace ebl
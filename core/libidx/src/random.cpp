@@ -32,21 +32,141 @@
 // tell header that we are in the libidx scope
 #define LIBIDX
 
+#include <math.h>
 #include "random.h"
 #include "utils.h"
 #include "numerics.h"
+#include "atomic.h"
+#include "simd.h"
+
+#ifdef __OPENMP__
+#include <omp.h>
+#endif
+
+#ifndef __WINDOWS__
+#include <pthread.h>
+#endif
 
 namespace ebl {
 
-// random number generator /////////////////////////////////////////////////////
+// philox //////////////////////////////////////////////////////////////////////
+
+void philox4x32(const uint32 ctr[4], const uint32 key[2], uint32 out[4]) {
+	uint32 c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+	uint32 k0 = key[0], k1 = key[1];
+	for (int r = 0; r < 10; ++r) {
+		if (r > 0) { k0 += PHILOX_W0; k1 += PHILOX_W1; }
+		uint64 p0 = (uint64) PHILOX_M0 * c0, p1 = (uint64) PHILOX_M1 * c2;
+		c0 = (uint32) (p1 >> 32) ^ c1 ^ k0;
+		c1 = (uint32) p1;
+		c2 = (uint32) (p0 >> 32) ^ c3 ^ k1;
+		c3 = (uint32) p0;
+	}
+	out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+//! Generates blocks 'ctr' to 'ctr' + 'nblocks' - 1 of the sequence of 'key'
+//! into 'out'.
+static void philox_blocks(const uint32 key[2], uint64 ctr, uint32 *out,
+													intg nblocks) {
+#ifdef __SIMD__
+	simd_philox4x32(key[0], key[1], ctr, out, nblocks);
+#else
+	uint32 c[4] = { 0, 0, 0, 0 };
+	for (intg b = 0; b < nblocks; ++b, ++ctr, out += 4) {
+		c[0] = (uint32) ctr;
+		c[1] = (uint32) (ctr >> 32);
+		philox4x32(c, key, out);
+	}
+#endif
+}
+
+// conversions /////////////////////////////////////////////////////////////////
 
-#define MMASK  0x7fffffffL
-#define MSEED  161803398L
-#define FAC    ((float)(1.0/(1.0+MMASK)))
-#define FAC2   ((float)(1.0/0x01000000L))
+#define RANDOM_FAC24 (1.0 / 16777216.0) // 2^-24
+#define RANDOM_FAC32 (1.0 / 4294967296.0) // 2^-32
+#define RANDOM_FAC53 (1.0 / 9007199254740992.0) // 2^-53
+#define RANDOM_2PI 6.283185307179586
+
+//! Returns a uniform double in [0,1) made of 53 bits of 'a' and 'b'.
+static inline double uniform53(uint32 a, uint32 b) {
+	return ((a >> 5) * 67108864.0 + (b >> 6)) * RANDOM_FAC53;
+}
+
+//! Sets 'z0' and 'z1' to 2 independent normal numbers, using the
+//! Box-Muller transform of uniform numbers 'u1' in (0,1] and 'u2' in [0,1).
+static inline void box_muller(double u1, double u2, double &z0, double &z1) {
+	double r = sqrt(-2.0 * log(u1)), t = RANDOM_2PI * u2;
+	z0 = r * cos(t);
+	z1 = r * sin(t);
+}
+
+// bulk generation /////////////////////////////////////////////////////////////
+
+#define RANDOM_CHUNK 1024 // blocks generated at a time
+
+enum bulk_kind { BULK_UNIFORM, BULK_GAUSS };
+
+//! Number of random words used by each value of type T.
+template <typename T>
+static inline intg bulk_words(bulk_kind kind) {
+	return kind == BULK_UNIFORM && sizeof (T) == sizeof (float64) ? 2 : 1;
+}
+
+//! Converts the 'n' values of 'out' from random words 'w'. Uniform values
+//! are in [a,b), normal values have mean 'a' and standard deviation 'b'.
+template <typename T>
+static void bulk_convert(const uint32 *w, T *out, intg n, bulk_kind kind,
+												 double a, double b) {
+	intg i;
+	double z0, z1;
+	if (kind == BULK_GAUSS) {
+		for (i = 0; i + 1 < n; i += 2) {
+			box_muller((w[i] + 1.0) * RANDOM_FAC32, w[i + 1] * RANDOM_FAC32, z0, z1);
+			out[i] = (T) (a + b * z0);
+			out[i + 1] = (T) (a + b * z1);
+		}
+		if (i < n) {
+			box_muller((w[i] + 1.0) * RANDOM_FAC32, w[i + 1] * RANDOM_FAC32, z0, z1);
+			out[i] = (T) (a + b * z0);
+		}
+	} else if (bulk_words<T>(kind) == 2) {
+		for (i = 0; i < n; ++i)
+			out[i] = (T) (a + (b - a) * uniform53(w[2 * i], w[2 * i + 1]));
+	} else {
+		for (i = 0; i < n; ++i)
+			out[i] = (T) (a + (b - a) * ((w[i] >> 8) * RANDOM_FAC24));
+	}
+}
+
+//! Fills 'out' with 'n' values starting at block 'ctr' of the sequence of
+//! 'key', and returns the number of blocks used. Blocks are generated by
+//! chunks, in parallel if OpenMP is enabled.
+template <typename T>
+static intg bulk(const uint32 key[2], uint64 ctr, T *out, intg n,
+								 bulk_kind kind, double a, double b) {
+	intg vpb = 4 / bulk_words<T>(kind); // values per block
+	intg nblocks = (n + vpb - 1) / vpb;
+	intg nchunks = (nblocks + RANDOM_CHUNK - 1) / RANDOM_CHUNK;
+	intg c;
+#ifdef __OPENMP__
+#pragma omp parallel for private(c)
+#endif
+	for (c = 0; c < nchunks; ++c) {
+		uint32 w[4 * RANDOM_CHUNK];
+		intg b0 = c * RANDOM_CHUNK;
+		intg nb = std::min((intg) RANDOM_CHUNK, nblocks - b0);
+		philox_blocks(key, ctr + b0, w, nb);
+		intg i0 = b0 * vpb;
+		bulk_convert(w, out + i0, std::min(nb * vpb, n - i0), kind, a, b);
+	}
+	return nblocks;
+}
+
+// random number generator /////////////////////////////////////////////////////
 
 random::random() {
-	// no seeding, assumes already seeded
+	seed(0);
 }
 
 random::random(int x, bool silent) {
@@ -99,13 +219,33 @@ void random::time_args_seed(int argc, char **argv) {
 	init((int) seed);
 }
 
+void random::seed(int x, uint32 stream) {
+	key[0] = (uint32) x;
+	key[1] = stream;
+	set_counter(0);
+}
+
+void random::set_counter(uint64 ctr) {
+	counter = ctr;
+	bufpos = 4;
+	has_spare = false;
+}
+
+uint64 random::get_counter() {
+	return counter;
+}
+
+uint32 random::next32() {
+	if (bufpos == 4) {
+		philox_blocks(key, counter++, buf, 1);
+		bufpos = 0;
+	}
+	return buf[bufpos++];
+}
+
 double random::drand(void) {
-	register int mj;
-	if (++inext == 56) inext = 1;
-	if (++inextp == 56) inextp = 1;
-	mj = ((ma[inext] - ma[inextp]) * 84589 + 45989) & MMASK;
-	ma[inext] = mj;
-	return (double)(mj * FAC);
+	uint32 a = next32();
+	return uniform53(a, next32());
 }
 
 double random::drand(double v) {
@@ -116,6 +256,58 @@ double random::drand(double v0, double v1) {
 	return (v1-v0)*drand()+v0;
 }
 
+double random::dgauss(void) {
+	if (has_spare) {
+		has_spare = false;
+		return spare;
+	}
+	double z0, u1 = 1.0 - drand(); // in (0,1]
+	box_muller(u1, drand(), z0, spare);
+	has_spare = true;
+	return z0;
+}
+
+double random::dgauss(double sigma) {
+	return sigma * dgauss();
+}
+
+double random::dgauss(double m, double sigma) {
+	return sigma * dgauss() + m;
+}
+
+// bulk generation /////////////////////////////////////////////////////////////
+
+void random::uniform(float32 *out, intg n, double v0, double v1) {
+	set_counter(counter + bulk(key, counter, out, n, BULK_UNIFORM, v0, v1));
+}
+
+void random::uniform(float64 *out, intg n, double v0, double v1) {
+	set_counter(counter + bulk(key, counter, out, n, BULK_UNIFORM, v0, v1));
+}
+
+void random::gauss(float32 *out, intg n, double m, double sigma) {
+	set_counter(counter + bulk(key, counter, out, n, BULK_GAUSS, m, sigma));
+}
+
+void random::gauss(float64 *out, intg n, double m, double sigma) {
+	set_counter(counter + bulk(key, counter, out, n, BULK_GAUSS, m, sigma));
+}
+
+#define random_fill_macro(T, name, fn)					\
+template <> void random::name(idx<T> &x, double a, double b) {	\
+	if (!x.contiguousp()) {						\
+		idx<T> tmp(x.get_idxdim());					\
+		fn(tmp.idx_ptr(), tmp.nelements(), a, b);			\
+		idx_copy(tmp, x);						\
+	} else								\
+		fn(x.idx_ptr(), x.nelements(), a, b);			\
+}
+
+random_fill_macro(float32, fill_uniform, uniform)
+random_fill_macro(float64, fill_uniform, uniform)
+random_fill_macro(float32, fill_gauss, gauss)
+random_fill_macro(float64, fill_gauss, gauss)
+
 // internal methods //////////////////////////////////////////////////////////
 
 void random::init(int x) {
@@ -124,26 +316,77 @@ void random::init(int x) {
 }
 
 void random::dseed(int x) {
-	int mj, mk;
-	int i, ii;
-
-	mj = MSEED - (x < 0 ? -x : x);
-	mj &= MMASK;
-	ma[55] = mj;
-	mk = 1;
-	for (i = 1; i <= 54; i++) {
-		ii = (21 * i) % 55;
-		ma[ii] = mk;
-		mk = (mj - mk) & MMASK;
-		mj = ma[ii];
+	seed(x, 0);
+}
+
+// per-thread generators ///////////////////////////////////////////////////////
+
+//! A generator and the seeding generation it was seeded with.
+struct thread_generator {
+	random r;
+	uint32 stream;
+	int generation;
+};
+
+static int thread_random_value = 0; // seed of all threads
+static int thread_random_generation = 0; // incremented by each seeding
+static int thread_random_streams = 0; // streams given to non-OpenMP threads
+
+//! Streams of threads outside of OpenMP regions start after OpenMP ones.
+#define THREAD_RANDOM_STREAM0 65536
+
+static thread_generator* thread_random_new() {
+	thread_generator *t = new thread_generator;
+#ifdef __OPENMP__
+	if (omp_in_parallel())
+		t->stream = (uint32) omp_get_thread_num();
+	else
+#endif
+		t->stream = THREAD_RANDOM_STREAM0 - 1 +
+			(uint32) atomic_add_relaxed(&thread_random_streams, 1);
+	t->generation = -1;
+	return t;
+}
+
+#ifndef __WINDOWS__
+static pthread_key_t thread_random_key;
+static pthread_once_t thread_random_once = PTHREAD_ONCE_INIT;
+
+static void thread_random_delete(void *t) {
+	delete (thread_generator*) t;
+}
+
+static void thread_random_key_init() {
+	pthread_key_create(&thread_random_key, thread_random_delete);
+}
+#else
+static thread_generator *thread_random_shared = NULL;
+#endif
+
+void thread_random_seed(int x) {
+	thread_random_value = x;
+	atomic_add_acq_rel(&thread_random_generation, 1);
+}
+
+random& thread_random() {
+#ifndef __WINDOWS__
+	pthread_once(&thread_random_once, thread_random_key_init);
+	thread_generator *t =
+		(thread_generator*) pthread_getspecific(thread_random_key);
+	if (!t) {
+		t = thread_random_new();
+		pthread_setspecific(thread_random_key, t);
 	}
-	for (ii = 1; ii <= 4; ii++)
-		for (i = 1; i < 55; i++) {
-			ma[i] -= ma[1 + (i + 30) % 55];
-			ma[i] &= MMASK;
-		}
-	inext = 0;
-	inextp = 31;			/* Special constant */
+#else
+	if (!thread_random_shared) thread_random_shared = thread_random_new();
+	thread_generator *t = thread_random_shared;
+#endif
+	int g = atomic_load_relaxed(&thread_random_generation);
+	if (t->generation != g) {
+		t->r.seed(atomic_load_relaxed(&thread_random_value), t->stream);
+		t->generation = g;
+	}
+	return t->r;
 }
 
 } // end namespace ebl
@@ -0,0 +1,180 @@
+/***************************************************************************
+ *   Copyright (C) 2012 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+// tell header that we are in the libidx scope
+#define LIBIDX
+
+#include <map>
+
+#include "resampler.h"
+#include "image.h"
+
+namespace ebl {
+
+// resample_table //////////////////////////////////////////////////////////////
+
+resample_table::resample_table() : nin(0), nout(0), ntaps(0) {
+}
+
+resample_table::~resample_table() {
+}
+
+void resample_table::set(intg nin_,
+			 std::vector<std::vector<std::pair<intg,double> > >
+			 &taps) {
+  nin = nin_;
+  nout = (intg) taps.size();
+  if (nin <= 0 || nout <= 0)
+    eblerror("cannot resample " << nin << " pixels into " << nout);
+  // span of the valid taps of each output
+  std::vector<intg> first(nout, nin), last(nout, -1);
+  ntaps = 1;
+  for (intg o = 0; o < nout; ++o) {
+    for (uint t = 0; t < taps[o].size(); ++t) {
+      intg i = taps[o][t].first;
+      if (i < 0 || i >= nin || taps[o][t].second == 0) continue ;
+      first[o] = std::min(first[o], i);
+      last[o] = std::max(last[o], i);
+    }
+    if (last[o] >= first[o])
+      ntaps = std::max(ntaps, last[o] - first[o] + 1);
+  }
+  // windows of all outputs have the same size and stay within the input
+  start = idx<intg>(nout);
+  weights = idx<double>(nout, ntaps);
+  idx_clear(weights);
+  for (intg o = 0; o < nout; ++o) {
+    intg s = last[o] >= first[o] ? std::min(first[o], nin - ntaps) : 0;
+    start.set(s, o);
+    for (uint t = 0; t < taps[o].size(); ++t) {
+      intg i = taps[o][t].first;
+      if (i < 0 || i >= nin || taps[o][t].second == 0) continue ;
+      weights.set(weights.get(o, i - s) + taps[o][t].second, o, i - s);
+    }
+  }
+}
+
+std::vector<std::pair<intg,double> > resample_table::taps(intg o) {
+  std::vector<std::pair<intg,double> > v;
+  for (intg t = 0; t < ntaps; ++t)
+    if (weights.get(o, t) != 0)
+      v.push_back(std::pair<intg,double>(start.get(o) + t,
+					 weights.get(o, t)));
+  return v;
+}
+
+// resampling tables ///////////////////////////////////////////////////////////
+
+// Sets 'table' to the bilinear taps of the 16.16 fixed-point input
+// coordinates 'pos' of 'nin' inputs, as interpreted by
+// image_interpolate_bilin().
+static void resample_fixed_point(intg nin, idx<int> &pos,
+				 resample_table &table) {
+  std::vector<std::vector<std::pair<intg,double> > > taps(pos.nelements());
+  intg o = 0;
+  { idx_aloop1(p, pos, int) {
+      int i0 = *p >> 16, frac = *p & 0x0000ffff;
+      taps[o].push_back(std::pair<intg,double>
+			(i0, (0x00010000 - frac) / 65536.0));
+      taps[o].push_back(std::pair<intg,double>(i0 + 1, frac / 65536.0));
+      o++;
+    }}
+  table.set(nin, taps);
+}
+
+void resample_bilinear(intg ih, intg iw, intg oh, intg ow,
+		       resample_table &rows, resample_table &cols) {
+  // same quadrilaterals as image_resize(). coordinates of rows only depend
+  // on output rows and those of columns on output columns.
+  float x1 = (float) -0.5, y1 = (float) -0.5;
+  float x3 = (float) iw - (float) 0.5, y3 = (float) ih - (float) 0.5;
+  float p1 = (float) -0.5, q1 = (float) -0.5;
+  float p3 = (float) ow - (float) 0.5, q3 = (float) oh - (float) 0.5;
+  idx<int> ri(oh, 1), rj(oh, 1), ci(1, ow), cj(1, ow);
+  compute_bilin_transform<float>(ri, rj, x1, y1, x3, y1, x3, y3, x1, y3,
+				 p1, q1, p3, q3);
+  compute_bilin_transform<float>(ci, cj, x1, y1, x3, y1, x3, y3, x1, y3,
+				 p1, q1, p3, q3);
+  resample_fixed_point(ih, ri, rows);
+  resample_fixed_point(iw, cj, cols);
+}
+
+resample_table resample_mean(intg nin, uint fact) {
+  intg nout = nin / (intg) fact;
+  std::vector<std::vector<std::pair<intg,double> > > taps(nout);
+  for (intg o = 0; o < nout; ++o)
+    for (uint t = 0; t < fact; ++t)
+      taps[o].push_back(std::pair<intg,double>(o * fact + t, 1.0 / fact));
+  resample_table table;
+  table.set(nin, taps);
+  return table;
+}
+
+resample_table resample_gaussian_reduce(intg nin, double a) {
+  // gaussian_pyramid::reduce() keeps an odd number of inputs and applies
+  // create_burt_adelson_kernel() with a stride of 2, without padding.
+  intg ni = 1 + 2 * ((nin - 1) / 2), nout = 1 + (ni - 5) / 2;
+  if (ni < 5)
+    eblerror("cannot reduce " << nin << " pixels with a 5-tap filter");
+  double f[5] = { .25 - a / 2.0, .25, a, .25, .25 - a / 2.0 };
+  std::vector<std::vector<std::pair<intg,double> > > taps(nout);
+  for (intg o = 0; o < nout; ++o)
+    for (intg t = 0; t < 5; ++t)
+      taps[o].push_back(std::pair<intg,double>(2 * o + t, f[t]));
+  resample_table table;
+  table.set(nin, taps);
+  return table;
+}
+
+resample_table resample_compose(resample_table &first,
+				resample_table &second) {
+  if (first.nout != second.nin)
+    eblerror("cannot compose resampling of " << first.nin << " into "
+	     << first.nout << " pixels with resampling of " << second.nin
+	     << " pixels");
+  std::vector<std::vector<std::pair<intg,double> > > taps(second.nout);
+  for (intg o = 0; o < second.nout; ++o) {
+    std::map<intg,double> acc;
+    std::vector<std::pair<intg,double> > t2 = second.taps(o);
+    for (uint m = 0; m < t2.size(); ++m) {
+      std::vector<std::pair<intg,double> > t1 = first.taps(t2[m].first);
+      for (uint i = 0; i < t1.size(); ++i)
+	acc[t1[i].first] += t1[i].second * t2[m].second;
+    }
+    taps[o].assign(acc.begin(), acc.end());
+  }
+  resample_table table;
+  table.set(first.nin, taps);
+  return table;
+}
+
+} // end namespace ebl
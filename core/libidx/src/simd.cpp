@@ -0,0 +1,608 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+// tell header that we are in the libidx scope
+#define LIBIDX
+
+#include "config.h"
+#include "idx.h"
+#include "idxops.h"
+#include "simd.h"
+#include "random.h"
+
+#ifdef __SIMD__
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+#if defined(__clang__) || __GNUC__ >= 5
+#define SIMD_HAVE_AVX512 // avx512 targets and cpu checks need gcc >= 5
+#endif
+
+namespace ebl {
+
+  // scalar kernels ////////////////////////////////////////////////////////////
+
+  namespace simd_scalar {
+
+    template <typename T>
+    void add(const T *i1, const T *i2, T *out, intg n) {
+      for (intg i = 0; i < n; ++i) out[i] = i1[i] + i2[i];
+    }
+    template <typename T>
+    void sub(const T *i1, const T *i2, T *out, intg n) {
+      for (intg i = 0; i < n; ++i) out[i] = i1[i] - i2[i];
+    }
+    template <typename T>
+    void mul(const T *i1, const T *i2, T *out, intg n) {
+      for (intg i = 0; i < n; ++i) out[i] = i1[i] * i2[i];
+    }
+    template <typename T>
+    void addc(const T *in, T c, T *out, intg n) {
+      for (intg i = 0; i < n; ++i) out[i] = in[i] + c;
+    }
+    template <typename T>
+    void dotc(const T *in, T c, T *out, intg n) {
+      for (intg i = 0; i < n; ++i) out[i] = (T) (in[i] * c);
+    }
+    template <typename T>
+    void lincomb(const T *i1, T k1, const T *i2, T k2, T *out, intg n) {
+      for (intg i = 0; i < n; ++i) out[i] = k1 * i1[i] + k2 * i2[i];
+    }
+
+    template <typename T>
+    void color_affine(const T *c0, const T *c1, const T *c2, const float32 *m,
+		      float32 *o0, float32 *o1, float32 *o2, int nout,
+		      intg n) {
+      float32 *o[3] = { o0, o1, o2 };
+      for (intg i = 0; i < n; ++i)
+	for (int j = 0; j < nout; ++j)
+	  o[j][i] = m[4 * j] * (float32) c0[i]
+	    + m[4 * j + 1] * (float32) c1[i]
+	    + m[4 * j + 2] * (float32) c2[i] + m[4 * j + 3];
+    }
+
+    template <typename T>
+    void tanh_fast(const T *in, T a, T b, T *out, intg n) {
+      for (intg i = 0; i < n; ++i) out[i] = b * ebl::tanh_fast(a * in[i]);
+    }
+    template <typename T>
+    void dtanh_fast(const T *in, T a, T b, T *out, intg n) {
+      T ab = a * b;
+      for (intg i = 0; i < n; ++i) out[i] = ab * ebl::dtanh_fast(a * in[i]);
+    }
+
+    template <typename T>
+    void philox(uint32 k0, uint32 k1, uint64 ctr, T *out, intg nblocks) {
+      uint32 key[2] = { k0, k1 }, c[4] = { 0, 0, 0, 0 };
+      for (intg b = 0; b < nblocks; ++b, ++ctr) {
+	c[0] = (uint32) ctr;
+	c[1] = (uint32) (ctr >> 32);
+	philox4x32(c, key, out + 4 * b);
+      }
+    }
+
+    inline void dot4_s8(const byte *a, const byte *b, intg ldb, intg k,
+			int32 *out) {
+      for (intg t = 0; t < 4; ++t, b += ldb) {
+	int32 sum = 0;
+	for (intg i = 0; i < k; ++i) sum += (int32) a[i] * b[i];
+	out[t] = sum;
+      }
+    }
+
+    template <typename T>
+    void float16_to_float32(const T *in, float32 *out, intg n) {
+      for (intg i = 0; i < n; ++i) out[i] = in[i];
+    }
+    template <typename T>
+    void float32_to_float16(const float32 *in, T *out, intg n) {
+      for (intg i = 0; i < n; ++i) out[i] = in[i];
+    }
+    template <typename T>
+    void bfloat16_to_float32(const T *in, float32 *out, intg n) {
+      for (intg i = 0; i < n; ++i) out[i] = in[i];
+    }
+    template <typename T>
+    void float32_to_bfloat16(const float32 *in, T *out, intg n) {
+      for (intg i = 0; i < n; ++i) out[i] = in[i];
+    }
+
+  } // end namespace simd_scalar
+
+  // vectorized kernels ////////////////////////////////////////////////////////
+
+#define SIMD_NS simd_sse4
+#define SIMD_TARGET "sse4.1"
+#define SIMD_BYTES 16
+#include "simd_kernels.hpp"
+#undef SIMD_NS
+#undef SIMD_TARGET
+#undef SIMD_BYTES
+
+#define SIMD_NS simd_avx2
+#define SIMD_TARGET "avx2"
+#define SIMD_BYTES 32
+#include "simd_kernels.hpp"
+#undef SIMD_NS
+#undef SIMD_TARGET
+#undef SIMD_BYTES
+
+#ifdef SIMD_HAVE_AVX512
+#define SIMD_NS simd_avx512
+#define SIMD_TARGET "avx512f,avx512bw"
+#define SIMD_BYTES 64
+#include "simd_kernels.hpp"
+#undef SIMD_NS
+#undef SIMD_TARGET
+#undef SIMD_BYTES
+#endif
+
+  // half precision conversions need dedicated instructions, which the
+  // vector extensions above cannot express.
+
+  namespace simd_f16c {
+
+    __attribute__((target("avx,f16c")))
+    void float16_to_float32(const float16 *in, float32 *out, intg n) {
+      intg i = 0;
+      for ( ; i + 8 <= n; i += 8)
+	_mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128
+						  ((const __m128i*) (in + i))));
+      simd_scalar::float16_to_float32(in + i, out + i, n - i);
+    }
+
+    __attribute__((target("avx,f16c")))
+    void float32_to_float16(const float32 *in, float16 *out, intg n) {
+      intg i = 0;
+      for ( ; i + 8 <= n; i += 8)
+	_mm_storeu_si128((__m128i*) (out + i),
+			 _mm256_cvtps_ph(_mm256_loadu_ps(in + i),
+					 _MM_FROUND_TO_NEAREST_INT));
+      simd_scalar::float32_to_float16(in + i, out + i, n - i);
+    }
+
+    //! Returns true if the cpu has the F16C instructions.
+    static bool detect() {
+      unsigned int a, b, c, d;
+      return __get_cpuid(1, &a, &b, &c, &d) && (c & bit_F16C);
+    }
+
+  } // end namespace simd_f16c
+
+#ifdef SIMD_HAVE_AVX512
+  namespace simd_avx512 {
+
+    __attribute__((target("avx512f")))
+    void float16_to_float32(const float16 *in, float32 *out, intg n) {
+      intg i = 0;
+      for ( ; i + 16 <= n; i += 16)
+	_mm512_storeu_ps(out + i, _mm512_maskz_cvtph_ps
+			 ((__mmask16) 0xffff,
+			  _mm256_loadu_si256((const __m256i*) (in + i))));
+      simd_scalar::float16_to_float32(in + i, out + i, n - i);
+    }
+
+    __attribute__((target("avx512f")))
+    void float32_to_float16(const float32 *in, float16 *out, intg n) {
+      intg i = 0;
+      for ( ; i + 16 <= n; i += 16)
+	_mm256_storeu_si256((__m256i*) (out + i),
+			    _mm512_maskz_cvtps_ph((__mmask16) 0xffff,
+						  _mm512_loadu_ps(in + i),
+						  _MM_FROUND_TO_NEAREST_INT));
+      simd_scalar::float32_to_float16(in + i, out + i, n - i);
+    }
+
+  } // end namespace simd_avx512
+#endif
+
+  // int8 products sign-extend 16 bytes at a time to 16-bit lanes, whose pairs
+  // are multiplied and summed into 32-bit lanes (exact for int8 inputs).
+
+#define SIMD_DOT4_S8(w, vi, load, cvt, madd, add, zero)			\
+    vi s0 = zero, s1 = zero, s2 = zero, s3 = zero, va;			\
+    intg i = 0;								\
+    for ( ; i + w <= k; i += w) {					\
+      va = cvt(load(a + i));						\
+      s0 = add(s0, madd(va, cvt(load(b + i))));				\
+      s1 = add(s1, madd(va, cvt(load(b + ldb + i))));			\
+      s2 = add(s2, madd(va, cvt(load(b + 2 * ldb + i))));		\
+      s3 = add(s3, madd(va, cvt(load(b + 3 * ldb + i))));		\
+    }									\
+    int32 r[4][sizeof (vi) / sizeof (int32)];				\
+    __builtin_memcpy(r[0], &s0, sizeof (vi));				\
+    __builtin_memcpy(r[1], &s1, sizeof (vi));				\
+    __builtin_memcpy(r[2], &s2, sizeof (vi));				\
+    __builtin_memcpy(r[3], &s3, sizeof (vi));				\
+    for (intg t = 0; t < 4; ++t) {					\
+      int32 sum = 0;							\
+      for (uint l = 0; l < sizeof (vi) / sizeof (int32); ++l)		\
+	sum += r[t][l];							\
+      const byte *bt = b + t * ldb;					\
+      for (intg j = i; j < k; ++j) sum += (int32) a[j] * bt[j];		\
+      out[t] = sum;							\
+    }
+
+  namespace simd_sse4 {
+    static inline __attribute__((target("sse4.1")))
+    __m128i load8(const byte *p) {
+      return _mm_loadl_epi64((const __m128i*) p);
+    }
+
+    __attribute__((target("sse4.1")))
+    void dot4_s8(const byte *a, const byte *b, intg ldb, intg k,
+		 int32 *out) {
+      SIMD_DOT4_S8(8, __m128i, load8, _mm_cvtepi8_epi16, _mm_madd_epi16,
+		   _mm_add_epi32, _mm_setzero_si128());
+    }
+  } // end namespace simd_sse4
+
+  namespace simd_avx2 {
+    static inline __attribute__((target("avx2")))
+    __m128i load16(const byte *p) {
+      return _mm_loadu_si128((const __m128i*) p);
+    }
+
+    __attribute__((target("avx2")))
+    void dot4_s8(const byte *a, const byte *b, intg ldb, intg k,
+		 int32 *out) {
+      SIMD_DOT4_S8(16, __m256i, load16, _mm256_cvtepi8_epi16,
+		   _mm256_madd_epi16, _mm256_add_epi32, _mm256_setzero_si256());
+    }
+  } // end namespace simd_avx2
+
+#ifdef SIMD_HAVE_AVX512
+  namespace simd_avx512 {
+    static inline __attribute__((target("avx512f,avx512bw")))
+    __m256i load32(const byte *p) {
+      return _mm256_loadu_si256((const __m256i*) p);
+    }
+
+    __attribute__((target("avx512f,avx512bw")))
+    void dot4_s8(const byte *a, const byte *b, intg ldb, intg k,
+		 int32 *out) {
+      SIMD_DOT4_S8(32, __m512i, load32, _mm512_cvtepi8_epi16,
+		   _mm512_madd_epi16, _mm512_add_epi32, _mm512_setzero_si512());
+    }
+  } // end namespace simd_avx512
+#endif
+
+  // levels ////////////////////////////////////////////////////////////////////
+
+  static simd_level simd_detect() {
+    __builtin_cpu_init();
+#ifdef SIMD_HAVE_AVX512
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+      return SIMD_AVX512;
+#endif
+    if (__builtin_cpu_supports("avx2"))
+      return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+      return SIMD_SSE4;
+    return SIMD_NONE;
+  }
+
+  // Before static initialization, this is zero and scalar kernels are used.
+  static simd_level simd_max = simd_detect();
+  static simd_level simd_current = simd_max;
+  static bool simd_has_f16c = simd_f16c::detect();
+
+  simd_level simd_get_level() {
+    return simd_current;
+  }
+
+  simd_level simd_max_level() {
+    return simd_max;
+  }
+
+  void simd_set_level(simd_level l) {
+    simd_current = l > simd_max ? simd_max : l;
+  }
+
+  const char* simd_level_name(simd_level l) {
+    switch (l) {
+    case SIMD_SSE4: return "SSE4";
+    case SIMD_AVX2: return "AVX2";
+    case SIMD_AVX512: return "AVX-512";
+    default: return "none";
+    }
+  }
+
+  // dispatch //////////////////////////////////////////////////////////////////
+
+#ifdef SIMD_HAVE_AVX512
+#define SIMD_CASE_AVX512(kernel, T, V, args)				\
+  case SIMD_AVX512: simd_avx512::kernel<T, simd_avx512::V> args; break;
+#else
+#define SIMD_CASE_AVX512(kernel, T, V, args)
+#endif
+
+  //! Calls 'kernel' of type T with vector type V for the current level.
+#define SIMD_DISPATCH(kernel, T, V, args)			\
+  switch (simd_current) {					\
+    SIMD_CASE_AVX512(kernel, T, V, args)			\
+  case SIMD_AVX2: simd_avx2::kernel<T, simd_avx2::V> args; break;	\
+  case SIMD_SSE4: simd_sse4::kernel<T, simd_sse4::V> args; break;	\
+  default: simd_scalar::kernel<T> args;				\
+  }
+
+#define SIMD_BINARY(name, T, V)						\
+  void simd_##name(const T *i1, const T *i2, T *out, intg n) {		\
+    SIMD_DISPATCH(name, T, V, (i1, i2, out, n));			\
+  }
+
+#define SIMD_CONST(name, T, V)						\
+  void simd_##name(const T *in, T c, T *out, intg n) {			\
+    SIMD_DISPATCH(name, T, V, (in, c, out, n));				\
+  }
+
+#define SIMD_LINCOMB(T, V)						\
+  void simd_lincomb(const T *i1, T k1, const T *i2, T k2, T *out,	\
+		    intg n) {						\
+    SIMD_DISPATCH(lincomb, T, V, (i1, k1, i2, k2, out, n));		\
+  }
+
+  SIMD_BINARY(add, float32, vf32)
+  SIMD_BINARY(add, float64, vf64)
+  SIMD_BINARY(add, ubyte, vu8)
+  SIMD_BINARY(sub, float32, vf32)
+  SIMD_BINARY(sub, float64, vf64)
+  SIMD_BINARY(sub, ubyte, vu8)
+  SIMD_BINARY(mul, float32, vf32)
+  SIMD_BINARY(mul, float64, vf64)
+  SIMD_BINARY(mul, ubyte, vu8)
+  SIMD_CONST(addc, float32, vf32)
+  SIMD_CONST(addc, float64, vf64)
+  SIMD_CONST(addc, ubyte, vu8)
+  SIMD_CONST(dotc, float32, vf32)
+  SIMD_CONST(dotc, float64, vf64)
+  SIMD_CONST(dotc, ubyte, vu8)
+  SIMD_LINCOMB(float32, vf32)
+  SIMD_LINCOMB(float64, vf64)
+  SIMD_LINCOMB(ubyte, vu8)
+
+#define SIMD_COLOR_AFFINE(T)						\
+  void simd_color_affine(const T *c0, const T *c1, const T *c2,		\
+			 const float32 *m, float32 *o0, float32 *o1,	\
+			 float32 *o2, int nout, intg n) {		\
+    SIMD_DISPATCH(color_affine, T, vf32,				\
+		  (c0, c1, c2, m, o0, o1, o2, nout, n));		\
+  }
+
+  SIMD_COLOR_AFFINE(float32)
+  SIMD_COLOR_AFFINE(ubyte)
+
+#define SIMD_TANH(name, T, V)						\
+  void simd_##name(const T *in, T a, T b, T *out, intg n) {		\
+    SIMD_DISPATCH(name, T, V, (in, a, b, out, n));			\
+  }
+
+  SIMD_TANH(tanh_fast, float32, vf32)
+  SIMD_TANH(tanh_fast, float64, vf64)
+  SIMD_TANH(dtanh_fast, float32, vf32)
+  SIMD_TANH(dtanh_fast, float64, vf64)
+
+  void simd_philox4x32(uint32 k0, uint32 k1, uint64 ctr, uint32 *out,
+		       intg nblocks) {
+    // with only 2 lanes, sse4 is slower than the scalar code
+    if (simd_current == SIMD_SSE4)
+      simd_scalar::philox(k0, k1, ctr, out, nblocks);
+    else
+      SIMD_DISPATCH(philox, uint32, vu64, (k0, k1, ctr, out, nblocks));
+  }
+
+#ifdef SIMD_HAVE_AVX512
+#define SIMD_CASE_AVX512_F16(name)					\
+  case SIMD_AVX512: simd_avx512::name(in, out, n); break;
+#else
+#define SIMD_CASE_AVX512_F16(name)
+#endif
+
+#define SIMD_FLOAT16(name)						\
+  switch (simd_current) {						\
+    SIMD_CASE_AVX512_F16(name)						\
+  case SIMD_AVX2:							\
+    if (simd_has_f16c) { simd_f16c::name(in, out, n); break; }		\
+  default: simd_scalar::name(in, out, n);				\
+  }
+
+  void simd_float16_to_float32(const float16 *in, float32 *out, intg n) {
+    SIMD_FLOAT16(float16_to_float32);
+  }
+
+  void simd_float32_to_float16(const float32 *in, float16 *out, intg n) {
+    SIMD_FLOAT16(float32_to_float16);
+  }
+
+  // with sse4, widening and narrowing lanes is slower than the scalar code
+  void simd_bfloat16_to_float32(const bfloat16 *in, float32 *out, intg n) {
+    if (simd_current == SIMD_SSE4)
+      simd_scalar::bfloat16_to_float32(in, out, n);
+    else
+      SIMD_DISPATCH(bfloat16_to_float32, bfloat16, vu32, (in, out, n));
+  }
+
+  void simd_float32_to_bfloat16(const float32 *in, bfloat16 *out, intg n) {
+    if (simd_current == SIMD_SSE4)
+      simd_scalar::float32_to_bfloat16(in, out, n);
+    else
+      SIMD_DISPATCH(float32_to_bfloat16, bfloat16, vu32, (in, out, n));
+  }
+
+  void simd_dot4_s8(const byte *a, const byte *b, intg ldb, intg k,
+		    int32 *out) {
+    switch (simd_current) {
+#ifdef SIMD_HAVE_AVX512
+    case SIMD_AVX512: simd_avx512::dot4_s8(a, b, ldb, k, out); break;
+#endif
+    case SIMD_AVX2: simd_avx2::dot4_s8(a, b, ldb, k, out); break;
+    case SIMD_SSE4: simd_sse4::dot4_s8(a, b, ldb, k, out); break;
+    default: simd_scalar::dot4_s8(a, b, ldb, k, out);
+    }
+  }
+
+  // idx specializations ///////////////////////////////////////////////////////
+
+#define idx_simd_binary_macro(name, T, op)				\
+  template<> void idx_##name(idx<T> &i1, idx<T> &i2, idx<T> &out) {	\
+    if (i1.contiguousp() && i2.contiguousp() && out.contiguousp()) {	\
+      idx_checknelems3_all(i1, i2, out);				\
+      simd_##name(i1.idx_ptr(), i2.idx_ptr(), out.idx_ptr(),		\
+		  out.nelements());					\
+    } else {								\
+      idx_aloopf3(pi1, i1, T, pi2, i2, T, pout, out, T, {		\
+	  *pout = *pi1 op *pi2; });					\
+    }									\
+  }
+
+#define idx_simd_const_macro(name, T, op)				\
+  template<> void idx_##name(idx<T> &inp, T c, idx<T> &out) {		\
+    if (inp.contiguousp() && out.contiguousp()) {			\
+      idx_checknelems2_all(inp, out);					\
+      simd_##name(inp.idx_ptr(), c, out.idx_ptr(), out.nelements());	\
+    } else {								\
+      idx_aloopf2(pinp, inp, T, pout, out, T, {				\
+	  *pout = (T) (*pinp op c); });					\
+    }									\
+  }
+
+#define idx_add_in_place_macro(T)				\
+  template<> void idx_add(idx<T> &in, idx<T> &out) {		\
+    idx_add(out, in, out);					\
+  }
+
+#define idx_sub_in_place_macro(T)				\
+  template<> void idx_sub(idx<T> &i1, idx<T> &i2) {		\
+    idx_sub(i1, i2, i1);					\
+  }
+
+#define idx_addc_in_place_macro(T)				\
+  template<> void idx_addc(idx<T> &in, T c) {			\
+    idx_addc(in, c, in);					\
+  }
+
+#define idx_lincomb_macro(T)						\
+  template<> void idx_lincomb(idx<T> &i1, T k1, idx<T> &i2, T k2,	\
+			      idx<T> &out) {				\
+    if (i1.contiguousp() && i2.contiguousp() && out.contiguousp()) {	\
+      idx_checknelems3_all(i1, i2, out);				\
+      simd_lincomb(i1.idx_ptr(), k1, i2.idx_ptr(), k2, out.idx_ptr(),	\
+		   out.nelements());					\
+    } else {								\
+      idx_aloopf3(pi1, i1, T, pi2, i2, T, pout, out, T, {		\
+	  *pout = k1 * (*pi1) + k2 * (*pi2); });			\
+    }									\
+  }
+
+  // idx_add ///////////////////////////////////////////////////////////////////
+
+#if !defined(__IPP__) && !defined(__TH__)
+  idx_simd_binary_macro(add, float32, +)
+#endif
+#ifndef __TH__
+  idx_simd_binary_macro(add, float64, +)
+  idx_add_in_place_macro(float32)
+  idx_add_in_place_macro(float64)
+#endif
+#ifndef __IPP__
+  idx_simd_binary_macro(add, ubyte, +)
+  idx_add_in_place_macro(ubyte)
+#endif
+
+  // idx_sub ///////////////////////////////////////////////////////////////////
+
+#ifndef __IPP__
+  idx_simd_binary_macro(sub, float32, -)
+  idx_simd_binary_macro(sub, ubyte, -)
+#endif
+  idx_simd_binary_macro(sub, float64, -)
+  idx_sub_in_place_macro(float32)
+  idx_sub_in_place_macro(float64)
+  idx_sub_in_place_macro(ubyte)
+
+  // idx_mul ///////////////////////////////////////////////////////////////////
+
+#ifndef __IPP__
+  idx_simd_binary_macro(mul, float32, *)
+  idx_simd_binary_macro(mul, ubyte, *)
+#endif
+  idx_simd_binary_macro(mul, float64, *)
+
+  // idx_addc //////////////////////////////////////////////////////////////////
+
+#ifndef __IPP__
+  idx_simd_const_macro(addc, float32, +)
+  idx_simd_const_macro(addc, ubyte, +)
+#endif
+  idx_simd_const_macro(addc, float64, +)
+  idx_addc_in_place_macro(float32)
+  idx_addc_in_place_macro(float64)
+  idx_addc_in_place_macro(ubyte)
+
+  // idx_dotc //////////////////////////////////////////////////////////////////
+
+#ifndef __IPP__
+  idx_simd_const_macro(dotc, float32, *)
+  idx_simd_const_macro(dotc, ubyte, *)
+#endif
+  idx_simd_const_macro(dotc, float64, *)
+
+  // idx_lincomb ///////////////////////////////////////////////////////////////
+
+  idx_lincomb_macro(float32)
+  idx_lincomb_macro(float64)
+  idx_lincomb_macro(ubyte)
+
+  // idx_tanh_fast /////////////////////////////////////////////////////////////
+
+#define idx_tanh_fast_macro(name, T)					\
+  template<> void idx_##name(idx<T> &inp, idx<T> &out, T a, T b) {	\
+    if (inp.contiguousp() && out.contiguousp()) {			\
+      idx_checknelems2_all(inp, out);					\
+      simd_##name(inp.idx_ptr(), a, b, out.idx_ptr(), out.nelements());	\
+    } else {								\
+      idx<T> tmp(inp.get_idxdim());					\
+      idx_copy(inp, tmp);						\
+      simd_##name(tmp.idx_ptr(), a, b, tmp.idx_ptr(), tmp.nelements()); \
+      idx_copy(tmp, out);						\
+    }									\
+  }
+
+  idx_tanh_fast_macro(tanh_fast, float32)
+  idx_tanh_fast_macro(tanh_fast, float64)
+  idx_tanh_fast_macro(dtanh_fast, float32)
+  idx_tanh_fast_macro(dtanh_fast, float64)
+
+} // end namespace ebl
+
+#endif /* __SIMD__ */
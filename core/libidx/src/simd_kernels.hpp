@@ -0,0 +1,315 @@
+/***************************************************************************
+ *   Copyright (C) 2011 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+// Elementwise kernels for one instruction set. This file is included by
+// simd.cpp once per instruction set, with SIMD_NS (namespace of the kernels),
+// SIMD_TARGET (gcc target attribute) and SIMD_BYTES (vector width) defined.
+// Vectors are loaded and stored with memcpy, which compiles to unaligned
+// vector moves, since idx data is not necessarily aligned.
+
+namespace SIMD_NS {
+
+  typedef float32 vf32 __attribute__((vector_size(SIMD_BYTES)));
+  typedef float64 vf64 __attribute__((vector_size(SIMD_BYTES)));
+  typedef ubyte vu8 __attribute__((vector_size(SIMD_BYTES)));
+  typedef uint32 vu32 __attribute__((vector_size(SIMD_BYTES)));
+  typedef uint64 vu64 __attribute__((vector_size(SIMD_BYTES)));
+
+#define SIMD_ATTR __attribute__((target(SIMD_TARGET)))
+#define SIMD_LOAD(v, p) __builtin_memcpy(&v, p, sizeof (V))
+#define SIMD_STORE(p, v) __builtin_memcpy(p, &v, sizeof (V))
+
+  template <typename T, typename V> SIMD_ATTR
+  inline V splat(T c) {
+    V v;
+    for (uint k = 0; k < sizeof (V) / sizeof (T); ++k)
+      v[k] = c;
+    return v;
+  }
+
+  template <typename T, typename V> SIMD_ATTR
+  void add(const T *i1, const T *i2, T *out, intg n) {
+    const intg w = sizeof (V) / sizeof (T);
+    intg i = 0;
+    V a, b;
+    for ( ; i + w <= n; i += w) {
+      SIMD_LOAD(a, i1 + i);
+      SIMD_LOAD(b, i2 + i);
+      a = a + b;
+      SIMD_STORE(out + i, a);
+    }
+    for ( ; i < n; ++i)
+      out[i] = i1[i] + i2[i];
+  }
+
+  template <typename T, typename V> SIMD_ATTR
+  void sub(const T *i1, const T *i2, T *out, intg n) {
+    const intg w = sizeof (V) / sizeof (T);
+    intg i = 0;
+    V a, b;
+    for ( ; i + w <= n; i += w) {
+      SIMD_LOAD(a, i1 + i);
+      SIMD_LOAD(b, i2 + i);
+      a = a - b;
+      SIMD_STORE(out + i, a);
+    }
+    for ( ; i < n; ++i)
+      out[i] = i1[i] - i2[i];
+  }
+
+  template <typename T, typename V> SIMD_ATTR
+  void mul(const T *i1, const T *i2, T *out, intg n) {
+    const intg w = sizeof (V) / sizeof (T);
+    intg i = 0;
+    V a, b;
+    for ( ; i + w <= n; i += w) {
+      SIMD_LOAD(a, i1 + i);
+      SIMD_LOAD(b, i2 + i);
+      a = a * b;
+      SIMD_STORE(out + i, a);
+    }
+    for ( ; i < n; ++i)
+      out[i] = i1[i] * i2[i];
+  }
+
+  template <typename T, typename V> SIMD_ATTR
+  void addc(const T *in, T c, T *out, intg n) {
+    const intg w = sizeof (V) / sizeof (T);
+    intg i = 0;
+    V a, vc = splat<T,V>(c);
+    for ( ; i + w <= n; i += w) {
+      SIMD_LOAD(a, in + i);
+      a = a + vc;
+      SIMD_STORE(out + i, a);
+    }
+    for ( ; i < n; ++i)
+      out[i] = in[i] + c;
+  }
+
+  template <typename T, typename V> SIMD_ATTR
+  void dotc(const T *in, T c, T *out, intg n) {
+    const intg w = sizeof (V) / sizeof (T);
+    intg i = 0;
+    V a, vc = splat<T,V>(c);
+    for ( ; i + w <= n; i += w) {
+      SIMD_LOAD(a, in + i);
+      a = a * vc;
+      SIMD_STORE(out + i, a);
+    }
+    for ( ; i < n; ++i)
+      out[i] = (T) (in[i] * c);
+  }
+
+  template <typename T, typename V> SIMD_ATTR
+  void lincomb(const T *i1, T k1, const T *i2, T k2, T *out, intg n) {
+    const intg w = sizeof (V) / sizeof (T);
+    intg i = 0;
+    V a, b, vk1 = splat<T,V>(k1), vk2 = splat<T,V>(k2);
+    for ( ; i + w <= n; i += w) {
+      SIMD_LOAD(a, i1 + i);
+      SIMD_LOAD(b, i2 + i);
+      a = vk1 * a + vk2 * b;
+      SIMD_STORE(out + i, a);
+    }
+    for ( ; i < n; ++i)
+      out[i] = k1 * i1[i] + k2 * i2[i];
+  }
+
+  template <typename V> SIMD_ATTR
+  inline V load_float(const float32 *p) {
+    V v;
+    __builtin_memcpy(&v, p, sizeof (V));
+    return v;
+  }
+
+  template <typename V> SIMD_ATTR
+  inline V load_float(const ubyte *p) {
+    V v;
+    for (uint k = 0; k < sizeof (V) / sizeof (float32); ++k)
+      v[k] = (float32) p[k];
+    return v;
+  }
+
+  template <typename T, typename V> SIMD_ATTR
+  void color_affine(const T *c0, const T *c1, const T *c2, const float32 *m,
+		    float32 *o0, float32 *o1, float32 *o2, int nout, intg n) {
+    const intg w = sizeof (V) / sizeof (float32);
+    float32 *o[3] = { o0, o1, o2 };
+    V k[12], a, b, c, r;
+    for (int j = 0; j < 4 * nout; ++j)
+      k[j] = splat<float32,V>(m[j]);
+    intg i = 0;
+    for ( ; i + w <= n; i += w) {
+      a = load_float<V>(c0 + i);
+      b = load_float<V>(c1 + i);
+      c = load_float<V>(c2 + i);
+      for (int j = 0; j < nout; ++j) {
+	const V *kj = k + 4 * j;
+	r = kj[0] * a + kj[1] * b + kj[2] * c + kj[3];
+	SIMD_STORE(o[j] + i, r);
+      }
+    }
+    for ( ; i < n; ++i)
+      for (int j = 0; j < nout; ++j)
+	o[j][i] = m[4 * j] * (float32) c0[i] + m[4 * j + 1] * (float32) c1[i]
+	  + m[4 * j + 2] * (float32) c2[i] + m[4 * j + 3];
+  }
+
+  // tanh_fast() of 'w' elements at a time, see numerics.hpp.
+  template <typename T, typename V> SIMD_ATTR
+  void tanh_fast(const T *in, T a, T b, T *out, intg n) {
+    const intg w = sizeof (V) / sizeof (T);
+    const V va = splat<T,V>(a), vb = splat<T,V>(b);
+    const V c = splat<T,V>((T) TANH_FAST_CLAMP), mc = -c;
+    const V n0 = splat<T,V>(135135), n1 = splat<T,V>(17325);
+    const V n2 = splat<T,V>(378), d1 = splat<T,V>(62370);
+    const V d2 = splat<T,V>(3150), d3 = splat<T,V>(28);
+    V x, s;
+    intg i = 0;
+    for ( ; i + w <= n; i += w) {
+      SIMD_LOAD(x, in + i);
+      x = va * x;
+      x = x < c ? x : c;
+      x = x > mc ? x : mc;
+      s = x * x;
+      x = vb * x * (n0 + s * (n1 + s * (n2 + s)))
+	/ (n0 + s * (d1 + s * (d2 + s * d3)));
+      SIMD_STORE(out + i, x);
+    }
+    for ( ; i < n; ++i)
+      out[i] = b * ebl::tanh_fast(a * in[i]);
+  }
+
+  // dtanh_fast() of 'w' elements at a time, see numerics.hpp.
+  template <typename T, typename V> SIMD_ATTR
+  void dtanh_fast(const T *in, T a, T b, T *out, intg n) {
+    const intg w = sizeof (V) / sizeof (T);
+    const V va = splat<T,V>(a), vab = splat<T,V>(a * b), zero = splat<T,V>(0);
+    const V c2 = splat<T,V>((T) (TANH_FAST_CLAMP * TANH_FAST_CLAMP));
+    const V p0 = splat<T,V>((T) 18261468225.0), p1 = splat<T,V>(-1404728325.0);
+    const V p2 = splat<T,V>(58939650), p3 = splat<T,V>(-1819125);
+    const V p4 = splat<T,V>(47250), p5 = splat<T,V>(-1134);
+    const V p6 = splat<T,V>(28), d0 = splat<T,V>(135135);
+    const V d1 = splat<T,V>(62370), d2 = splat<T,V>(3150);
+    V x, s, d;
+    intg i = 0;
+    for ( ; i + w <= n; i += w) {
+      SIMD_LOAD(x, in + i);
+      x = va * x;
+      s = x * x;
+      d = d0 + s * (d1 + s * (d2 + s * p6));
+      x = vab * (p0 + s * (p1 + s * (p2 + s * (p3 + s * (p4 + s * (p5
+	+ s * p6)))))) / (d * d);
+      x = s < c2 ? x : zero;
+      SIMD_STORE(out + i, x);
+    }
+    for ( ; i < n; ++i)
+      out[i] = a * b * ebl::dtanh_fast(a * in[i]);
+  }
+
+  // Philox4x32-10 on one block per 64-bit lane: the 32-bit words of the
+  // blocks are kept in the low half of the lanes so that the round
+  // multiplications produce the 64-bit products directly.
+  template <typename T, typename V> SIMD_ATTR
+  void philox(uint32 k0, uint32 k1, uint64 ctr, T *out, intg nblocks) {
+    const intg w = sizeof (V) / sizeof (uint64);
+    const V lo = splat<uint64,V>(0xffffffffULL);
+    const V m0 = splat<uint64,V>(PHILOX_M0), m1 = splat<uint64,V>(PHILOX_M1);
+    V c0 = splat<uint64,V>(0), c1 = c0, c2, c3, p0, p1;
+    intg b = 0;
+    for ( ; b + w <= nblocks; b += w) {
+      for (intg k = 0; k < w; ++k) {
+	c0[k] = (ctr + b + k) & 0xffffffffULL;
+	c1[k] = (ctr + b + k) >> 32;
+      }
+      c2 = splat<uint64,V>(0);
+      c3 = c2;
+      uint32 kk0 = k0, kk1 = k1;
+      for (int r = 0; r < 10; ++r) {
+	if (r > 0) { kk0 += PHILOX_W0; kk1 += PHILOX_W1; }
+	p0 = m0 * (c0 & lo);
+	p1 = m1 * (c2 & lo);
+	c0 = (p1 >> 32) ^ c1 ^ splat<uint64,V>(kk0);
+	c1 = p1 & lo;
+	c2 = (p0 >> 32) ^ c3 ^ splat<uint64,V>(kk1);
+	c3 = p0 & lo;
+      }
+      for (intg k = 0; k < w; ++k) {
+	T *o = out + 4 * (b + k);
+	o[0] = (T) c0[k];
+	o[1] = (T) c1[k];
+	o[2] = (T) c2[k];
+	o[3] = (T) c3[k];
+      }
+    }
+    simd_scalar::philox(k0, k1, ctr + b, out + 4 * b, nblocks - b);
+  }
+
+  // bfloat16 is the upper half of a float32, V holds float32 bit patterns.
+  template <typename T, typename V> SIMD_ATTR
+  void bfloat16_to_float32(const T *in, float32 *out, intg n) {
+    const intg w = sizeof (V) / sizeof (uint32);
+    intg i = 0;
+    V a = splat<uint32,V>(0);
+    for ( ; i + w <= n; i += w) {
+      for (intg k = 0; k < w; ++k)
+	a[k] = (uint32) in[i + k].bits << 16;
+      SIMD_STORE(out + i, a);
+    }
+    simd_scalar::bfloat16_to_float32(in + i, out + i, n - i);
+  }
+
+  template <typename T, typename V> SIMD_ATTR
+  void float32_to_bfloat16(const float32 *in, T *out, intg n) {
+    const intg w = sizeof (V) / sizeof (uint32);
+    const V one = splat<uint32,V>(1), bias = splat<uint32,V>(0x7fff);
+    const V abs = splat<uint32,V>(0x7fffffffu);
+    const V inf = splat<uint32,V>(0x7f800000u);
+    const V quiet = splat<uint32,V>(0x00400000u);
+    intg i = 0;
+    V a, r;
+    for ( ; i + w <= n; i += w) {
+      SIMD_LOAD(a, in + i);
+      r = a + bias + ((a >> 16) & one);
+      r = (a & abs) > inf ? (a | quiet) : r;
+      r = r >> 16;
+      for (intg k = 0; k < w; ++k)
+	out[i + k].bits = (uint16) r[k];
+    }
+    simd_scalar::float32_to_bfloat16(in + i, out + i, n - i);
+  }
+
+#undef SIMD_ATTR
+#undef SIMD_LOAD
+#undef SIMD_STORE
+
+} // end namespace SIMD_NS
@@ -67,47 +67,32 @@ smart_pointer::~smart_pointer() {
 
 // reference counting ////////////////////////////////////////////////////////
 
-int smart_pointer::unlock() {
-  refcount--;
-#ifdef __DEBUGMEM__
-  locks--;
-#endif
-  // #ifdef __DEBUG__
-  //     std::cerr << debug_name << " " << this
-  // 	      << " smart_pointer::unlock: refcount = " << refcount;
-  //     if (refcount == 0) std::cerr << " (deleting)";
-  //     std::cerr << std::endl;
-  // #endif
-  if (refcount < 0) {
-    eblerror("idx negative reference counter: " << refcount);
-    return refcount;
-  } else {
-    if (refcount == 0) {
-      DEBUG_LOW("------------ deleting " << this);// << " (" << *this << ")");
-      delete this;
-      return 0;
-    } else {
-      return refcount;
-    }
+bool smart_pointer::atomic_refs = false;
+
+int smart_pointer::unlock_last(int count) {
+  if (count < 0) {
+    eblerror("idx negative reference counter: " << count);
+    return count;
   }
+  DEBUG_LOW("------------ deleting " << this);// << " (" << *this << ")");
+  delete this;
+  return 0;
 }
 
-int smart_pointer::lock() {
-#ifdef __DEBUGMEM__
-  locks++;
-#endif
-  // #ifdef __DEBUG__
-  //     std::cerr << debug_name << " " << this << " smart_pointer::lock: refcount="
-  //    << refcount + 1 << std::endl;
-  // #endif
-      return ++refcount;
+void smart_pointer::set_count(int count) {
+  refcount=count;
 }
 
-int smart_pointer::get_count() {
-  return refcount;
+void smart_pointer::set_atomic_refcount(bool atomic) {
+  atomic_refs = atomic;
 }
-void smart_pointer::set_count(int count) {
-  refcount=count;
+
+bool smart_pointer::atomic_refcount() {
+#ifdef __ATOMIC_REFCOUNT__
+  return true;
+#else
+  return atomic_refs;
+#endif
 }
 
 } // namespace ebl
@@ -35,6 +35,301 @@
 
 #include "srg.h"
 
+#ifndef __WINDOWS__
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 namespace ebl {
 
+  ////////////////////////////////////////////////////////////////
+  // srg_allocator internals
+
+  // Size classes: 4 classes per power of 2 from 2^6 to 2^30 bytes,
+  // i.e. class c = 4 * (k - 6) + j has size 2^k + j * 2^(k - 2).
+  // Larger blocks are not cached.
+#define SRG_MIN_CLASS_BITS 6
+#define SRG_MAX_CLASS_BITS 30
+#define SRG_NCLASSES (4 * (SRG_MAX_CLASS_BITS - SRG_MIN_CLASS_BITS + 1))
+
+  // Returns the size class index that fits 'bytes', or SRG_NCLASSES if
+  // 'bytes' is too large to be cached.
+  static int srg_class_index(intg bytes) {
+    if (bytes <= (1 << SRG_MIN_CLASS_BITS)) return 0;
+    int k = 0;
+    for (intg b = bytes - 1; b > 1; b >>= 1) k++;
+    intg step = ((intg) 1) << (k - 2);
+    intg j = (bytes - (((intg) 1) << k) + step - 1) / step;
+    if (j == 4) { k++; j = 0; }
+    int c = 4 * (k - SRG_MIN_CLASS_BITS) + (int) j;
+    return c < SRG_NCLASSES ? c : SRG_NCLASSES;
+  }
+
+  // Returns the size in bytes of class 'c'.
+  static intg srg_class_size(int c) {
+    int k = c / 4 + SRG_MIN_CLASS_BITS;
+    return (((intg) 1) << k) + (c % 4) * (((intg) 1) << (k - 2));
+  }
+
+  // Counters are updated from any thread.
+  static inline void srg_counter_add(intg *counter, intg n) {
+    atomic_add_relaxed(counter, n);
+  }
+
+  static intg srg_nsystem_allocs = 0;
+  static intg srg_nsystem_frees = 0;
+  static intg srg_ncache_hits = 0;
+  static intg srg_cached_bytes = 0;
+  static srg_alloc_mode srg_mode = SRG_ALLOC_SYSTEM;
+  static intg srg_thread_limit = 64 * 1048576;
+  static intg srg_shared_limit = 256 * 1048576;
+
+  // Raw aligned blocks from the system.
+  static void* srg_aligned_alloc(intg bytes) {
+    void *ptr = NULL;
+#ifdef __WINDOWS__
+    ptr = _aligned_malloc(bytes, SRG_ALIGNMENT);
+#else
+    if (posix_memalign(&ptr, SRG_ALIGNMENT, bytes) != 0) ptr = NULL;
+#endif
+    if (ptr) srg_counter_add(&srg_nsystem_allocs, 1);
+    return ptr;
+  }
+
+  static void srg_aligned_free(void *ptr) {
+    srg_counter_add(&srg_nsystem_frees, 1);
+#ifdef __WINDOWS__
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+  }
+
+#ifndef __WINDOWS__
+
+  //! A set of free lists, one per size class. Free blocks are chained
+  //! through their first word.
+  struct srg_cache {
+    void *heads[SRG_NCLASSES];
+    intg bytes;
+  };
+
+  static srg_cache srg_shared = { { NULL }, 0 };
+  static pthread_mutex_t srg_shared_mutex = PTHREAD_MUTEX_INITIALIZER;
+  static pthread_key_t srg_cache_key;
+  static pthread_once_t srg_cache_once = PTHREAD_ONCE_INIT;
+
+  // Pushes block 'ptr' of class 'c' into cache 'cache'.
+  static inline void srg_cache_push(srg_cache *cache, int c, void *ptr) {
+    *((void**) ptr) = cache->heads[c];
+    cache->heads[c] = ptr;
+    cache->bytes += srg_class_size(c);
+  }
+
+  // Pops a block of class 'c' from 'cache', or returns NULL if none.
+  static inline void* srg_cache_pop(srg_cache *cache, int c) {
+    void *ptr = cache->heads[c];
+    if (ptr) {
+      cache->heads[c] = *((void**) ptr);
+      cache->bytes -= srg_class_size(c);
+    }
+    return ptr;
+  }
+
+  // Moves all blocks of 'cache' to the shared depot, or to the system
+  // once the depot is full.
+  static void srg_cache_flush(srg_cache *cache) {
+    pthread_mutex_lock(&srg_shared_mutex);
+    for (int c = 0; c < SRG_NCLASSES; ++c) {
+      void *ptr;
+      while ((ptr = srg_cache_pop(cache, c)) != NULL) {
+	if (srg_shared.bytes + srg_class_size(c) <= srg_shared_limit)
+	  srg_cache_push(&srg_shared, c, ptr);
+	else {
+	  srg_counter_add(&srg_cached_bytes, -srg_class_size(c));
+	  srg_aligned_free(ptr);
+	}
+      }
+    }
+    pthread_mutex_unlock(&srg_shared_mutex);
+  }
+
+  // Called when a thread exits: hand its cache over to the depot.
+  static void srg_cache_destroy(void *ptr) {
+    srg_cache *cache = (srg_cache*) ptr;
+    srg_cache_flush(cache);
+    free(cache);
+  }
+
+  static void srg_cache_key_init() {
+    pthread_key_create(&srg_cache_key, srg_cache_destroy);
+  }
+
+  // Returns the calling thread's cache, allocating it if needed.
+  static srg_cache* srg_thread_cache() {
+    pthread_once(&srg_cache_once, srg_cache_key_init);
+    srg_cache *cache = (srg_cache*) pthread_getspecific(srg_cache_key);
+    if (!cache) {
+      cache = (srg_cache*) calloc(1, sizeof (srg_cache));
+      if (!cache) eblerror("failed to allocate srg thread cache");
+      pthread_setspecific(srg_cache_key, cache);
+    }
+    return cache;
+  }
+
+#endif /* __WINDOWS__ */
+
+  ////////////////////////////////////////////////////////////////
+  // srg_allocator
+
+  void srg_allocator::set_mode(srg_alloc_mode mode) { srg_mode = mode; }
+
+  srg_alloc_mode srg_allocator::get_mode() { return srg_mode; }
+
+  void srg_allocator::set_cache_limits(intg thread_bytes, intg shared_bytes) {
+    srg_thread_limit = thread_bytes;
+    srg_shared_limit = shared_bytes;
+  }
+
+  intg srg_allocator::capacity(intg bytes) {
+    int c = srg_class_index(bytes);
+    if (c == SRG_NCLASSES) // not cached, just round up to alignment
+      return ((bytes + SRG_ALIGNMENT - 1) / SRG_ALIGNMENT) * SRG_ALIGNMENT;
+    return srg_class_size(c);
+  }
+
+  void* srg_allocator::allocate(intg bytes, intg &cap) {
+    int c = srg_class_index(bytes);
+    cap = capacity(bytes);
+#ifndef __WINDOWS__
+    if (c < SRG_NCLASSES) {
+      void *ptr = srg_cache_pop(srg_thread_cache(), c);
+      if (!ptr && srg_shared.heads[c]) { // try the shared depot
+	pthread_mutex_lock(&srg_shared_mutex);
+	ptr = srg_cache_pop(&srg_shared, c);
+	pthread_mutex_unlock(&srg_shared_mutex);
+      }
+      if (ptr) {
+	srg_counter_add(&srg_ncache_hits, 1);
+	srg_counter_add(&srg_cached_bytes, -cap);
+	return ptr;
+      }
+    }
+#endif
+    return srg_aligned_alloc(cap);
+  }
+
+  void srg_allocator::deallocate(void *ptr, intg cap) {
+    if (!ptr) return ;
+#ifndef __WINDOWS__
+    int c = srg_class_index(cap);
+    if (c < SRG_NCLASSES) {
+      srg_cache *cache = srg_thread_cache();
+      srg_counter_add(&srg_cached_bytes, cap);
+      srg_cache_push(cache, c, ptr);
+      if (cache->bytes > srg_thread_limit)
+	srg_cache_flush(cache);
+      return ;
+    }
+#endif
+    srg_aligned_free(ptr);
+  }
+
+  void srg_allocator::release() {
+#ifndef __WINDOWS__
+    srg_cache *cache = srg_thread_cache();
+    pthread_mutex_lock(&srg_shared_mutex);
+    srg_cache *caches[2] = { cache, &srg_shared };
+    for (uint i = 0; i < 2; ++i)
+      for (int c = 0; c < SRG_NCLASSES; ++c) {
+	void *ptr;
+	while ((ptr = srg_cache_pop(caches[i], c)) != NULL) {
+	  srg_counter_add(&srg_cached_bytes, -srg_class_size(c));
+	  srg_aligned_free(ptr);
+	}
+      }
+    pthread_mutex_unlock(&srg_shared_mutex);
+#endif
+  }
+
+  void* srg_allocator::system_realloc(void *ptr, intg bytes) {
+    void *res = realloc(ptr, bytes);
+    if (res) {
+      srg_counter_add(&srg_nsystem_allocs, 1);
+      if (ptr) srg_counter_add(&srg_nsystem_frees, 1);
+    }
+    return res;
+  }
+
+  void srg_allocator::system_free(void *ptr) {
+    if (!ptr) return ;
+    srg_counter_add(&srg_nsystem_frees, 1);
+    free(ptr);
+  }
+
+  intg srg_allocator::system_allocations() {
+    return atomic_load_relaxed(&srg_nsystem_allocs);
+  }
+
+  intg srg_allocator::system_frees() {
+    return atomic_load_relaxed(&srg_nsystem_frees);
+  }
+
+  intg srg_allocator::cache_hits() {
+    return atomic_load_relaxed(&srg_ncache_hits);
+  }
+
+  intg srg_allocator::cached_bytes() {
+    return atomic_load_relaxed(&srg_cached_bytes);
+  }
+
+  void srg_allocator::reset_counters() {
+    srg_nsystem_allocs = 0;
+    srg_nsystem_frees = 0;
+    srg_ncache_hits = 0;
+  }
+
+  std::string srg_allocator::str() {
+    std::ostringstream s;
+    s << "srg allocator ("
+      << (srg_mode == SRG_ALLOC_POOLED ? "pooled" : "system")
+      << "): system allocations " << srg_nsystem_allocs
+      << " frees " << srg_nsystem_frees
+      << " cache hits " << srg_ncache_hits
+      << " cached " << srg_cached_bytes / (float) 1048576 << " Mb";
+    return s.str();
+  }
+
+  ////////////////////////////////////////////////////////////////
+  // file_mapping
+
+  file_mapping* file_mapping::map(FILE *fp) {
+#ifdef __WINDOWS__
+    return NULL;
+#else
+    struct stat st;
+    int fd = fileno(fp);
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size <= 0) return NULL;
+    void *addr = mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE,
+		      MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) return NULL;
+    return new file_mapping((char*) addr, (intg) st.st_size);
+#endif
+  }
+
+  file_mapping::file_mapping(char *addr_, intg bytes_)
+    : addr(addr_), bytes(bytes_) {
+  }
+
+  file_mapping::~file_mapping() {
+#ifndef __WINDOWS__
+    munmap(addr, (size_t) bytes);
+#endif
+  }
+
+  char* file_mapping::data() { return addr; }
+
+  intg file_mapping::size() { return bytes; }
+
 } // end namespace ebl
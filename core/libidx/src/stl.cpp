@@ -34,6 +34,7 @@
 #define LIBIDX
 
 #include "stl.h"
+#include "srg.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
@@ -370,13 +371,15 @@ CONCAT_FPRINTF(size_t, "%u", uint)
 //////////////////////////////////////////////////////////////////////////////
 // file
 
-file::file(const char *filename, const char *mode) : refcounter(0) {
-  fp = fopen(filename, mode);
+file::file(const char *filename_, const char *mode)
+  : filename(filename_), refcounter(0), map(NULL), map_failed(false) {
+  fp = fopen(filename_, mode);
   if (!fp)
-    eblthrow("failed to open " << filename);
+    eblthrow("failed to open " << filename_);
 }
 
 file::~file() {
+  if (map) map->unlock(); // matrices aliasing the mapping keep it alive
   fclose(fp);
 }
 
@@ -384,6 +387,10 @@ FILE *file::get_fp() {
   return fp;
 }
 
+const char *file::name() {
+  return filename.c_str();
+}
+
 void file::incr_ref() {
   refcounter++;
 }
@@ -401,6 +408,16 @@ uint file::references() {
   return refcounter;
 }
 
+ebl::file_mapping* file::mapping() {
+  if (!map && !map_failed) {
+    fflush(fp);
+    map = ebl::file_mapping::map(fp);
+    if (map) map->lock();
+    else map_failed = true;
+  }
+  return map;
+}
+
 } // namespace std
 
 namespace ebl {
@@ -37,6 +37,8 @@
 #include <istream>
 #include <ostream>
 #include <errno.h>
+#include <stdlib.h>
+#include <ctype.h>
 
 using namespace std;
 
@@ -106,6 +108,68 @@ double string_to_double(const char *s) {
   return d;
 }
 
+bool parse_double(const char *s, const char *end, double &d) {
+  // powers of 10 exactly representable as doubles
+  static const double pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+  while (s < end && isspace((unsigned char) *s)) s++;
+  const char *start = s;
+  bool neg = false, found = false, exact = true;
+  if (s < end && (*s == '-' || *s == '+')) neg = (*s++ == '-');
+  // accumulate up to 19 significant digits in an integer mantissa
+  uint64 mant = 0;
+  int ndigits = 0, exp10 = 0;
+  for (; s < end && isdigit((unsigned char) *s); ++s, found = true) {
+    if (ndigits < 19) {
+      mant = mant * 10 + (*s - '0');
+      if (mant) ndigits++;
+    } else {
+      exp10++;
+      exact = false;
+    }
+  }
+  if (s < end && *s == '.') {
+    for (++s; s < end && isdigit((unsigned char) *s); ++s, found = true) {
+      if (ndigits < 19) {
+        mant = mant * 10 + (*s - '0');
+        if (mant) ndigits++;
+        exp10--;
+      } else
+        exact = false;
+    }
+  }
+  if (!found) { // no digits, e.g. "inf" or "nan": let strtod decide
+    std::string tmp(start, end - start);
+    char *e;
+    d = strtod(tmp.c_str(), &e);
+    return e != tmp.c_str();
+  }
+  if (s < end && (*s == 'e' || *s == 'E')) {
+    const char *e = s + 1;
+    bool eneg = false;
+    if (e < end && (*e == '-' || *e == '+')) eneg = (*e++ == '-');
+    if (e < end && isdigit((unsigned char) *e)) {
+      int x = 0;
+      for (; e < end && isdigit((unsigned char) *e); ++e)
+        if (x < 100000) x = x * 10 + (*e - '0');
+      exp10 += eneg ? -x : x;
+      s = e;
+    }
+  }
+  // exact when both mantissa and power of 10 are exact doubles
+  if (exact && mant < ((uint64) 1 << 53) && exp10 >= -22 && exp10 <= 22) {
+    d = (double) mant;
+    if (exp10 < 0) d /= pow10[-exp10];
+    else d *= pow10[exp10];
+    if (neg) d = -d;
+    return true;
+  }
+  std::string tmp(start, s - start);
+  d = strtod(tmp.c_str(), NULL);
+  return true;
+}
+
 std::list<uint> string_to_uintlist(const std::string &s_) {
   return string_to_uintlist(s_.c_str());
 }
@@ -136,6 +136,36 @@ ELSE ($ENV{NOMAGICKPP})
   ENDIF (Magick++_FOUND)
 ENDIF ($ENV{NOMAGICKPP})
 
+# find libpng and libjpeg (in-process image decoding)
+################################################################################
+IF ($ENV{NOPNG})
+  MESSAGE(STATUS "libpng DISABLED by env variable $NOPNG=1.")
+ELSE ($ENV{NOPNG})
+  FIND_PACKAGE(PNG)
+  IF (PNG_FOUND)
+    INCLUDE_DIRECTORIES(${PNG_INCLUDE_DIRS})
+    MESSAGE(STATUS "libpng library: ${PNG_LIBRARIES}")
+    MESSAGE(STATUS "libpng Found.")
+    SET (CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -D__PNG__")
+  ELSE (PNG_FOUND)
+    MESSAGE("__ WARNING: libpng not found (optional).")
+  ENDIF (PNG_FOUND)
+ENDIF ($ENV{NOPNG})
+
+IF ($ENV{NOJPEG})
+  MESSAGE(STATUS "libjpeg DISABLED by env variable $NOJPEG=1.")
+ELSE ($ENV{NOJPEG})
+  FIND_PACKAGE(JPEG)
+  IF (JPEG_FOUND)
+    INCLUDE_DIRECTORIES(${JPEG_INCLUDE_DIR})
+    MESSAGE(STATUS "libjpeg library: ${JPEG_LIBRARIES}")
+    MESSAGE(STATUS "libjpeg Found.")
+    SET (CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -D__JPEG__")
+  ELSE (JPEG_FOUND)
+    MESSAGE("__ WARNING: libjpeg not found (optional).")
+  ENDIF (JPEG_FOUND)
+ENDIF ($ENV{NOJPEG})
+
 # find MPI
 ################################################################################
 IF ($ENV{NOMPI})
@@ -123,6 +123,12 @@ template <typename Tdata> class camera {
   //! target height and width (if specified).
   //! This also increments frame counter.
   virtual idx<Tdata> postprocess();
+  //! Return 'f' narrowed and resized as postprocess() does, without touching
+  //! the frame buffer nor the fps counters. This can be called from other
+  //! threads than the grabbing one.
+  idx<Tdata> transform(idx<Tdata> &f);
+  //! Update fps counters with a newly grabbed frame.
+  void update_fps();
 
   // members /////////////////////////////////////////////////////////////////
  protected:
@@ -220,23 +220,33 @@ void camera<Tdata>::set_silent() {
 
 template <typename Tdata>
 inline idx<Tdata> camera<Tdata>::postprocess() {
+  update_fps();
+  return transform(frame);
+}
+
+template <typename Tdata>
+idx<Tdata> camera<Tdata>::transform(idx<Tdata> &f) {
+  if (narrow_dim >= 0)
+    f = f.narrow(narrow_dim, narrow_size, narrow_off);
+  if (!bresize)
+    return f; // return original frame
+  else { // or return a resized frame
+    if (mresize)
+      return image_mean_resize(f, height, width, resize_mode);
+    else
+      return image_resize(f, height, width, resize_mode);
+  }
+}
+
+template <typename Tdata>
+void camera<Tdata>::update_fps() {
   fps_ms_elapsed = tfps.elapsed_milliseconds();
   cntfps++;
-  if (narrow_dim >= 0)
-    frame = frame.narrow(narrow_dim, narrow_size, narrow_off);
   if (fps_ms_elapsed > 1000) {
     fps_grab = cntfps * 1000 / (float) fps_ms_elapsed;
     tfps.restart(); // restart timer
     cntfps = 0; // reset counter
   }
-  if (!bresize)
-    return frame; // return original frame
-  else { // or return a resized frame
-    if (mresize)
-      return image_mean_resize(frame, height, width, resize_mode);
-    else
-      return image_resize(frame, height, width, resize_mode);
-  }
 }
 
 } // end namespace ebl
@@ -33,9 +33,15 @@
 #ifndef CAMERA_DIRECTORY_H_
 #define CAMERA_DIRECTORY_H_
 
+#include <map>
+
 #include "camera.h"
 #include "tools_utils.h"
 
+#ifdef __PTHREAD__
+#include <pthread.h>
+#endif
+
 #ifdef __BOOST__
 #ifndef BOOST_FILESYSTEM_VERSION
 #define BOOST_FILESYSTEM_VERSION 3
@@ -122,6 +128,39 @@ namespace ebl {
     //! of the camera, -1 if unknown.
     virtual int size();
 
+    // background decoding /////////////////////////////////////////////////////
+
+    //! Decode and resize the next 'ahead' frames with 'nthreads' background
+    //! threads, so that grab() only waits when decoding is slower than the
+    //! caller. Frames are returned in the same order as without threads,
+    //! including randomized lists and multiple passes. If 'ahead' is 0, it
+    //! defaults to twice the number of threads. 0 threads turns background
+    //! decoding off. This requires pthread support.
+    virtual void set_decoding_threads(uint nthreads, uint ahead = 0);
+
+    // internal methods ////////////////////////////////////////////////////////
+  protected:
+    //! Load image 'fname', letting the decoder downscale it when the frame
+    //! is resized anyway. This throws a string upon failure.
+    idx<Tdata> load(const std::string &fname);
+    //! Return the full path of the file at position 'pos' of all passes.
+    std::string path(uint pos);
+    //! Return the next frame decoded by the background threads.
+    idx<Tdata> grab_decoded();
+    //! Stop background threads and release frames they decoded.
+    void stop_decoding();
+    //! Main loop of decoding threads.
+    void decode_loop();
+    //! Entry point of decoding threads.
+    static void* decode_entry(void *pthis);
+
+    //! A frame decoded in the background, or the reason it failed.
+    struct decoded_frame {
+      idx<Tdata> *raw;		//!< Frame as loaded (and narrowed).
+      idx<Tdata> *res;		//!< Frame as returned by grab().
+      std::string error;	//!< Error message if loading failed.
+    };
+
     // members /////////////////////////////////////////////////////////////////
   protected:
     using camera<Tdata>::frame;	//!< frame buffer
@@ -140,6 +179,18 @@ namespace ebl {
     bool                 randomize; //!< Randomize order of images or not.
     uint                 npasses; //!< Number of passes on the list.
     const char          *file_pattern; //!< File search regex.
+    uint                 pos;	//!< Position of next file in all passes.
+    std::vector<std::string> paths; //!< Files of a pass, when decoding.
+    std::map<uint, decoded_frame> decoded; //!< Frames decoded ahead.
+    uint                 dfirst;	//!< First position to decode ahead.
+    uint                 dnext;	//!< Next position to decode.
+    uint                 dahead;	//!< Number of positions to decode ahead.
+    bool                 dstop;	//!< Decoding threads were asked to stop.
+#ifdef __PTHREAD__
+    std::vector<pthread_t> decoders; //!< Decoding threads.
+    pthread_mutex_t      dmutex;
+    pthread_cond_t       dcond;	//!< Signals any change of decoding state.
+#endif
   };
 
 } // end namespace ebl
@@ -47,10 +47,15 @@ namespace ebl {
 					    std::ostream &o, std::ostream &e,
 					    const char *pattern,
 					    const std::list<std::string> *files)
-    : camera<Tdata>(height_, width_, o, e), indir(dir),
-      randomize(randomize_), npasses(npasses_), file_pattern(pattern) {
+    : camera<Tdata>(height_, width_, o, e), fl(NULL), indir(dir),
+      randomize(randomize_), npasses(npasses_), file_pattern(pattern), pos(0),
+      dfirst(0), dnext(0), dahead(0), dstop(false) {
     if (npasses == 0)
       eblerror("number of passes must be >= 1");
+#ifdef __PTHREAD__
+    pthread_mutex_init(&dmutex, NULL);
+    pthread_cond_init(&dcond, NULL);
+#endif
     out << "Initializing directory camera from: " << dir << std::endl;
     if (files && files->size() > 0) { // file names specified by hand
       // build list and check each file exists
@@ -87,10 +92,15 @@ namespace ebl {
 					    bool randomize_, uint npasses_,
 					    std::ostream &o, std::ostream &e,
 					    const char *pattern)
-    : camera<Tdata>(height_, width_, o, e),
-      randomize(randomize_), npasses(npasses_), file_pattern(pattern) {
+    : camera<Tdata>(height_, width_, o, e), fl(NULL),
+      randomize(randomize_), npasses(npasses_), file_pattern(pattern), pos(0),
+      dfirst(0), dnext(0), dahead(0), dstop(false) {
     if (npasses == 0)
       eblerror("number of passes must be >= 1");
+#ifdef __PTHREAD__
+    pthread_mutex_init(&dmutex, NULL);
+    pthread_cond_init(&dcond, NULL);
+#endif
   }
 
   template <typename Tdata>
@@ -119,6 +129,11 @@ namespace ebl {
 
   template <typename Tdata>
   camera_directory<Tdata>::~camera_directory() {
+    stop_decoding();
+#ifdef __PTHREAD__
+    pthread_cond_destroy(&dcond);
+    pthread_mutex_destroy(&dmutex);
+#endif
     if (fl)
       delete fl;
   }
@@ -156,6 +171,7 @@ namespace ebl {
 // 	frame_name_[i] = '_';
     fli++; // move to next element
     frame_id_++;
+    pos++;
   }
 
   template <typename Tdata>
@@ -165,6 +181,7 @@ namespace ebl {
     // move to previous element
     fli--;
     frame_id_--;
+    pos--;
     // set names
     fdir = fli->first; // directory
     fname = fli->second; // file name
@@ -193,8 +210,10 @@ namespace ebl {
     out << frame_id_ << "/" << flsize << ": grabbing ";
     out << fdir << fname << std::endl;
     oss.str(""); oss << fdir << "/" << fname;
+    if (dahead > 0)
+      return grab_decoded();
     try {
-      frame = load_image<Tdata>(oss.str());
+      frame = load(oss.str());
     } catch (const std::string &e) {
       err << "failed to load image " << oss.str();
 #ifndef __NOEXCEPTIONS__
@@ -207,6 +226,14 @@ namespace ebl {
     return this->postprocess();
   }
 
+  template <typename Tdata>
+  idx<Tdata> camera_directory<Tdata>::load(const std::string &fname) {
+    if (this->bresize && this->narrow_dim < 0 && this->resize_mode != 2)
+      // frame is resized anyway, let decoder downscale it if much bigger
+      return load_image<Tdata>(fname, this->height, this->width);
+    return load_image<Tdata>(fname);
+  }
+
   template <typename Tdata>
   void camera_directory<Tdata>::skip(uint n) {
     if (n == 0) return ;
@@ -218,6 +245,7 @@ namespace ebl {
       }
       fli++;
       frame_id_++;
+      pos++;
     }
     std::cout << "Skipped " << i << " frames." << std::endl;
   }
@@ -265,6 +293,186 @@ namespace ebl {
     return (int) flsize;
   }
 
+  ////////////////////////////////////////////////////////////////
+  // background decoding
+
+  template <typename Tdata>
+  void camera_directory<Tdata>::set_decoding_threads(uint nthreads,
+						     uint ahead) {
+    stop_decoding();
+    if (nthreads == 0)
+      return ;
+#ifdef __PTHREAD__
+    if (!fl)
+      eblerror("directory not initialized");
+    // positions of all passes map to the same list of files
+    paths.clear();
+    for (files_list::iterator i = fl->begin(); i != fl->end(); ++i) {
+      std::string p = i->first;
+      if (p.size() > 0 && p[p.length() - 1] != '/')
+	p += "/";
+      p += i->second;
+      paths.push_back(p);
+    }
+    dahead = ahead > 0 ? ahead : 2 * nthreads;
+    dfirst = pos;
+    dnext = pos;
+    dstop = false;
+    decoders.resize(nthreads);
+    for (uint i = 0; i < nthreads; ++i)
+      if (pthread_create(&decoders[i], NULL, decode_entry, this) != 0) {
+	decoders.resize(i);
+	break ;
+      }
+    if (decoders.size() == 0) {
+      dahead = 0;
+      eblwarn("failed to start decoding threads, decoding synchronously");
+      return ;
+    }
+    out << "Decoding " << dahead << " frames ahead with " << decoders.size()
+	<< " threads." << std::endl;
+#else
+    eblwarn("no pthread support, decoding synchronously");
+#endif
+  }
+
+  template <typename Tdata>
+  std::string camera_directory<Tdata>::path(uint p) {
+    return paths[p % paths.size()];
+  }
+
+  template <typename Tdata>
+  idx<Tdata> camera_directory<Tdata>::grab_decoded() {
+    decoded_frame d;
+    d.raw = NULL;
+    d.res = NULL;
+#ifdef __PTHREAD__
+    uint p = pos - 1; // next() moved past current frame
+    typename std::map<uint, decoded_frame>::iterator i;
+    pthread_mutex_lock(&dmutex);
+    if (p != dfirst) { // moved without grab(), restart decoding from here
+      dfirst = p;
+      dnext = p;
+      for (i = decoded.begin(); i != decoded.end(); ) {
+	if (i->first < p || i->first >= p + dahead) { // outside new window
+	  if (i->second.raw) delete i->second.raw;
+	  if (i->second.res) delete i->second.res;
+	  decoded.erase(i++);
+	} else
+	  ++i;
+      }
+      pthread_cond_broadcast(&dcond);
+    }
+    while ((i = decoded.find(p)) == decoded.end())
+      pthread_cond_wait(&dcond, &dmutex);
+    d = i->second;
+    decoded.erase(i);
+    dfirst = p + 1;
+    pthread_cond_broadcast(&dcond); // make room for next frame
+    pthread_mutex_unlock(&dmutex);
+#endif
+    if (!d.raw) {
+      err << "failed to load image " << oss.str();
+#ifndef __NOEXCEPTIONS__
+      err << " (" << d.error << "). ";
+#endif
+      err << "Trying next image..." << std::endl;
+      frame_id_++;
+      return grab();
+    }
+    frame = *d.raw;
+    idx<Tdata> res = *d.res;
+    delete d.raw;
+    delete d.res;
+    this->update_fps();
+    return res;
+  }
+
+  template <typename Tdata>
+  void camera_directory<Tdata>::stop_decoding() {
+#ifdef __PTHREAD__
+    if (decoders.size() == 0)
+      return ;
+    pthread_mutex_lock(&dmutex);
+    dstop = true;
+    pthread_cond_broadcast(&dcond);
+    pthread_mutex_unlock(&dmutex);
+    for (uint i = 0; i < decoders.size(); ++i)
+      pthread_join(decoders[i], NULL);
+    decoders.clear();
+    for (typename std::map<uint, decoded_frame>::iterator i = decoded.begin();
+	 i != decoded.end(); ++i) {
+      if (i->second.raw) delete i->second.raw;
+      if (i->second.res) delete i->second.res;
+    }
+    decoded.clear();
+#endif
+    dahead = 0;
+  }
+
+  template <typename Tdata>
+  void camera_directory<Tdata>::decode_loop() {
+#ifdef __PTHREAD__
+    pthread_mutex_lock(&dmutex);
+    while (true) {
+      if (dnext < dfirst)
+	dnext = dfirst;
+      if (dstop)
+	break ;
+      if (dnext >= dfirst + dahead || dnext >= flsize) {
+	pthread_cond_wait(&dcond, &dmutex);
+	continue ;
+      }
+      uint p = dnext++;
+      std::string fname = path(p);
+      pthread_mutex_unlock(&dmutex);
+      // decode without holding the lock. frames are only handed over once
+      // this thread holds no more reference to them.
+      decoded_frame d;
+      d.raw = NULL;
+      d.res = NULL;
+      {
+	try {
+	  idx<Tdata> raw = load(fname);
+	  idx<Tdata> res = this->transform(raw);
+	  d.raw = new idx<Tdata>(raw);
+	  d.res = new idx<Tdata>(res);
+	} catch (const std::string &e) {
+	  d.error = e;
+	} catch (std::exception &e) {
+	  d.error = e.what();
+	} catch (...) {
+	  d.error = "unknown error while decoding ";
+	  d.error += fname;
+	}
+	// a frame is only valid if both raw and transformed frames exist
+	if (!d.res && d.raw) {
+	  delete d.raw;
+	  d.raw = NULL;
+	}
+      }
+      pthread_mutex_lock(&dmutex);
+      // keep frame only if still expected and not decoded twice after a
+      // restart of the window
+      if (p >= dfirst && p < dfirst + dahead
+	  && decoded.find(p) == decoded.end()) {
+	decoded[p] = d;
+	pthread_cond_broadcast(&dcond);
+      } else {
+	if (d.raw) delete d.raw;
+	if (d.res) delete d.res;
+      }
+    }
+    pthread_mutex_unlock(&dmutex);
+#endif
+  }
+
+  template <typename Tdata>
+  void* camera_directory<Tdata>::decode_entry(void *pthis) {
+    ((camera_directory<Tdata>*) pthis)->decode_loop();
+    return NULL;
+  }
+
 } // end namespace ebl
 
 #endif /* CAMERA_DIRECTORY_HPP_ */
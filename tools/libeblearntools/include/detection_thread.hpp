@@ -88,6 +88,8 @@ void detection_thread<T>::execute() {
     uint       wid_states     = 0;	// window id
 #endif
     uint	display_sleep  = conf.try_get_uint("display_sleep", 0);
+    // report system allocations made by each detection (process-wide)
+    bool count_allocations = conf.exists_true("count_allocations");
     //      if (!display && save_video) {
     //        // we still want to output images but not show them
     //        display = true;
@@ -260,7 +262,12 @@ void detection_thread<T>::execute() {
         } else {
           try {
             mout << "starting processing of frame " << frame_name << std::endl;
+            intg nallocs = srg_allocator::system_allocations();
             bboxes &bb = detect.fprop(frame, frame_name.c_str(), frame_id);
+            if (count_allocations)
+              mout << "system allocations during detection: "
+                   << srg_allocator::system_allocations() - nallocs
+                   << " (" << srg_allocator::str() << ")" << std::endl;
             copy_bboxes(bb); // make a copy of bounding boxes
           } catch(ebl::eblexception &e) { // detection failed
 #ifdef __NOEXCEPTIONS__
@@ -490,6 +497,8 @@ void detection_thread<T>::init_detector(detector<T> &detect,
     detect.set_corners_inference(conf.get_uint("corners_inference"));
   if (conf.exists("input_gain"))
     detect.set_input_gain(conf.get_double("input_gain"));
+  if (conf.exists_true("scales_pyramid"))
+    detect.set_pyramid(true);
   if (conf.exists_true("dump_outputs")) {
     std::string fname;
     fname << odir << "/dump/detect_out";
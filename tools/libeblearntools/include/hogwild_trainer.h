@@ -0,0 +1,141 @@
+/***************************************************************************
+ *   Copyright (C) 2012 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef HOGWILD_TRAINER_H_
+#define HOGWILD_TRAINER_H_
+
+#include <vector>
+
+#include "defines_tools.h"
+#include "thread.h"
+#include "ebl_trainer.h"
+
+namespace ebl {
+
+// hogwild_trainer /////////////////////////////////////////////////////////////
+
+//! A supervised trainer updating the same weights from several threads
+//! without locking them (Hogwild). Each worker thread trains its own copy of
+//! the machine, i.e. with its own buffers and gradients, allocated on a
+//! parameter sharing the weights of this trainer's parameter
+//! (see ddparameter(parameter<T>&)). Only picking samples from the datasource
+//! and recording results are serialized between threads.
+template <typename T, typename Tdata, typename Tlabel>
+class hogwild_trainer : public supervised_trainer<T,Tdata,Tlabel> {
+ public:
+  //! \param m The machine of this trainer, used for testing and for
+  //!   estimating 2nd order derivatives, training is done by the workers.
+  //! \param p The parameter of 'm', whose weights are shared by the workers.
+  hogwild_trainer(trainable_module<T,Tdata,Tlabel> &m, ddparameter<T> &p,
+                  bool silent = false);
+  //! Destructor, deletes the workers.
+  virtual ~hogwild_trainer();
+
+  //! Adds a worker thread training machine 'm' of network 'net', which is
+  //! allocated on parameter 'p'. 'p' must share its weights with the
+  //! parameter of this trainer. This trainer takes ownership of 'p', 'net'
+  //! and 'm'.
+  void add_worker(ddparameter<T> *p, module_1_1<T> *net,
+                  trainable_module<T,Tdata,Tlabel> *m);
+  //! Returns the number of worker threads.
+  uint get_nthreads();
+  //! Returns the number of samples processed by worker 'thread' during the
+  //! last epoch.
+  intg get_nsamples(uint thread);
+  //! Trains for 'niter' sweeps over 'ds' with all workers in parallel.
+  //! See supervised_trainer::train() for the arguments, except that
+  //! 2nd order derivatives are only estimated at the beginning of each
+  //! sweep and 'hessian_period' is ignored.
+  virtual void train(labeled_datasource<T, Tdata, Tlabel> &ds,
+                     classifier_meter &log, gd_param &args, int niter,
+                     infer_param &infp,
+                     intg hessian_period = 0, intg nhessian = 0,
+                     double mu = .02);
+
+  // friends ///////////////////////////////////////////////////////////////////
+  template <class T1, class T2, class T3> friend class hogwild_thread;
+
+  // members ///////////////////////////////////////////////////////////////////
+ protected:
+  std::vector<ddparameter<T>*>                     wparams;   //!< Parameters.
+  std::vector<module_1_1<T>*>                      wnets;     //!< Networks.
+  std::vector<trainable_module<T,Tdata,Tlabel>*>   wmachines; //!< Machines.
+  std::vector<supervised_trainer<T,Tdata,Tlabel>*> wtrainers; //!< Trainers.
+  std::vector<intg>                                wsamples;  //!< Samples.
+  mutex  dsmutex;       //!< Serializes accesses to datasource, log and age.
+  mutex  outmutex;      //!< Synchronizes outputs of the workers.
+  bool   selected;      //!< Current sample of datasource is to be trained.
+  using supervised_trainer<T,Tdata,Tlabel>::param;
+  using supervised_trainer<T,Tdata,Tlabel>::age;
+  using supervised_trainer<T,Tdata,Tlabel>::batch_size;
+};
+
+// hogwild_thread //////////////////////////////////////////////////////////////
+
+//! A worker thread of a hogwild_trainer. It trains with 'trainer' on the
+//! samples of the datasource shared by all workers until the end of the
+//! current epoch, without locking the weights it updates.
+template <typename T, typename Tdata, typename Tlabel>
+class hogwild_thread : public thread {
+ public:
+  //! \param master The trainer owning this worker.
+  //! \param trainer The trainer of this worker.
+  //! \param om A mutex used to synchronize threads outputs.
+  hogwild_thread(hogwild_trainer<T,Tdata,Tlabel> &master,
+                 supervised_trainer<T,Tdata,Tlabel> &trainer,
+                 labeled_datasource<T,Tdata,Tlabel> &ds, classifier_meter &log,
+                 gd_param &gdp, mutex *om = NULL, const char *name = "");
+  virtual ~hogwild_thread();
+  //! Trains until the end of the epoch.
+  virtual void execute();
+  //! Returns the number of samples processed by this thread.
+  intg get_nsamples();
+  //! Returns the number of milliseconds spent by this thread.
+  long get_milliseconds();
+
+  // members ///////////////////////////////////////////////////////////////////
+ protected:
+  hogwild_trainer<T,Tdata,Tlabel>    &master;
+  supervised_trainer<T,Tdata,Tlabel> &trainer;
+  labeled_datasource<T,Tdata,Tlabel> &ds;
+  classifier_meter                   &log;
+  gd_param                           &gdp;         //!< Shared by all workers.
+  intg                                nsamples;    //!< Samples processed.
+  long                                millis;      //!< Time spent.
+  using                               thread::mout;
+};
+
+} // end namespace ebl
+
+#include "hogwild_trainer.hpp"
+
+#endif /* HOGWILD_TRAINER_H_ */
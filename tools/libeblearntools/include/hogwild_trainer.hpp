@@ -0,0 +1,206 @@
+/***************************************************************************
+ *   Copyright (C) 2012 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#ifndef HOGWILD_TRAINER_HPP_
+#define HOGWILD_TRAINER_HPP_
+
+namespace ebl {
+
+// hogwild_trainer /////////////////////////////////////////////////////////////
+
+template <typename T, typename Tdata, typename Tlabel>
+hogwild_trainer<T,Tdata,Tlabel>::
+hogwild_trainer(trainable_module<T,Tdata,Tlabel> &m, ddparameter<T> &p,
+                bool silent_)
+    : supervised_trainer<T,Tdata,Tlabel>(m, p, silent_), selected(true) {
+}
+
+template <typename T, typename Tdata, typename Tlabel>
+hogwild_trainer<T,Tdata,Tlabel>::~hogwild_trainer() {
+  for (uint i = 0; i < wtrainers.size(); ++i) {
+    delete wtrainers[i];
+    delete wmachines[i];
+    delete wnets[i];
+    delete wparams[i];
+  }
+}
+
+template <typename T, typename Tdata, typename Tlabel>
+void hogwild_trainer<T,Tdata,Tlabel>::
+add_worker(ddparameter<T> *p, module_1_1<T> *net,
+           trainable_module<T,Tdata,Tlabel> *m) {
+  if (p->getstorage() != param.getstorage()
+      || p->nelements() != param.nelements())
+    eblerror("worker parameter " << *p << " does not share the weights of "
+             << param);
+  wparams.push_back(p);
+  wnets.push_back(net);
+  wmachines.push_back(m);
+  wtrainers.push_back(new supervised_trainer<T,Tdata,Tlabel>(*m, *p, true));
+}
+
+template <typename T, typename Tdata, typename Tlabel>
+uint hogwild_trainer<T,Tdata,Tlabel>::get_nthreads() {
+  return (uint) wtrainers.size();
+}
+
+template <typename T, typename Tdata, typename Tlabel>
+intg hogwild_trainer<T,Tdata,Tlabel>::get_nsamples(uint thread) {
+  if (thread >= wsamples.size()) return 0;
+  return wsamples[thread];
+}
+
+template <typename T, typename Tdata, typename Tlabel>
+void hogwild_trainer<T,Tdata,Tlabel>::
+train(labeled_datasource<T, Tdata, Tlabel> &ds, classifier_meter &log,
+      gd_param &gdp, int niter, infer_param &infp,
+      intg hessian_period, intg nhessian, double mu) {
+  if (wtrainers.empty()) eblerror("no worker threads to train with");
+  eblprint( "training on " << niter * ds.get_epoch_size() << " samples with "
+            << wtrainers.size() << " threads");
+  if (nhessian == 0) {
+    eblprint( " and disabling 2nd order derivative calculation" << std::endl);
+    param.set_epsilon(1.0);
+  } else {
+    eblprint( " and recomputing 2nd order derivatives on " << nhessian
+              << " samples at the beginning of each epoch..." << std::endl);
+  }
+  // tensors are now referenced from several threads, restored at the end
+  bool atomic = smart_pointer::atomic_refcount();
+  smart_pointer::set_atomic_refcount(true);
+  timer t;
+  this->init(ds, &log);
+  for (uint j = 0; j < wtrainers.size(); ++j) {
+    wtrainers[j]->init(ds);
+    wtrainers[j]->batch_size = batch_size;
+  }
+  for (int i = 0; i < niter; ++i) { // niter iterations
+    t.start();
+    ds.init_epoch();
+    if (nhessian > 0) this->compute_diaghessian(ds, nhessian, mu);
+    for (uint j = 0; j < wparams.size(); ++j)
+      idx_copy(param.epsilons, wparams[j]->epsilons);
+    // train with all workers until the end of the epoch
+    std::vector<hogwild_thread<T,Tdata,Tlabel>*> threads;
+    for (uint j = 0; j < wtrainers.size(); ++j) {
+      std::string name; name << "Hogwild " << j;
+      threads.push_back(new hogwild_thread<T,Tdata,Tlabel>
+                        (*this, *wtrainers[j], ds, log, gdp, &outmutex,
+                         name.c_str()));
+      threads[j]->start();
+    }
+    bool finished = false;
+    while (!finished) {
+      millisleep(10);
+      this->update_progress(); // tell the outside world we're still running
+      finished = true;
+      for (uint j = 0; j < threads.size(); ++j)
+        finished = finished && threads[j]->finished();
+    }
+    // report speed of each thread
+    double total = 0;
+    wsamples.resize(threads.size());
+    for (uint j = 0; j < threads.size(); ++j) {
+      wsamples[j] = threads[j]->get_nsamples();
+      double s = std::max((long) 1, threads[j]->get_milliseconds()) / 1000.0;
+      double speed = threads[j]->get_nsamples() / s;
+      eblprint( threads[j]->name() << ": " << threads[j]->get_nsamples()
+                << " samples in " << s << "s (" << speed << " samples/s)"
+                << std::endl);
+      total += speed;
+      delete threads[j];
+    }
+    eblprint( "samples_per_second=" << total << std::endl);
+    this->end_epoch(ds, log, t);
+  }
+  smart_pointer::set_atomic_refcount(atomic);
+}
+
+// hogwild_thread //////////////////////////////////////////////////////////////
+
+template <typename T, typename Tdata, typename Tlabel>
+hogwild_thread<T,Tdata,Tlabel>::
+hogwild_thread(hogwild_trainer<T,Tdata,Tlabel> &master_,
+               supervised_trainer<T,Tdata,Tlabel> &trainer_,
+               labeled_datasource<T,Tdata,Tlabel> &ds_, classifier_meter &log_,
+               gd_param &gdp_, mutex *om, const char *name_)
+    : thread(om, name_), master(master_), trainer(trainer_), ds(ds_),
+      log(log_), gdp(gdp_), nsamples(0), millis(0) {
+}
+
+template <typename T, typename Tdata, typename Tlabel>
+hogwild_thread<T,Tdata,Tlabel>::~hogwild_thread() {
+}
+
+template <typename T, typename Tdata, typename Tlabel>
+void hogwild_thread<T,Tdata,Tlabel>::execute() {
+#ifdef __PTHREAD__
+  pthread_detach(pthread_self()); // nobody joins, release resources on exit
+#endif
+  timer t;
+  t.start();
+  while (!_stop) {
+    // pick the next samples
+    master.dsmutex.lock();
+    if (ds.epoch_done()) {
+      master.dsmutex.unlock();
+      break ;
+    }
+    uint n = trainer.gather_batch(ds, master.selected);
+    gd_param args = gdp;
+    master.dsmutex.unlock();
+    // learn and update the shared weights without locking
+    trainer.learn_batch(n, args);
+    // record results, age is global so that annealing happens once
+    master.dsmutex.lock();
+    trainer.age = master.age;
+    trainer.record_batch(ds, log, n, gdp);
+    master.age = trainer.age;
+    master.dsmutex.unlock();
+    nsamples += n;
+  }
+  millis = t.elapsed_milliseconds();
+}
+
+template <typename T, typename Tdata, typename Tlabel>
+intg hogwild_thread<T,Tdata,Tlabel>::get_nsamples() {
+  return nsamples;
+}
+
+template <typename T, typename Tdata, typename Tlabel>
+long hogwild_thread<T,Tdata,Tlabel>::get_milliseconds() {
+  return millis;
+}
+
+} // end namespace ebl
+
+#endif /* HOGWILD_TRAINER_HPP_ */
@@ -50,6 +50,7 @@
 #include "detection_thread.h"
 #include "fprop_thread.h"
 #include "gdb.h"
+#include "hogwild_trainer.h"
 #include "job.h"
 #include "metaparser.h"
 #include "mpijob.h"
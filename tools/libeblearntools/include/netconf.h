@@ -33,6 +33,8 @@
 #ifndef NETCONF_H_
 #define NETCONF_H_
 
+#include <limits>
+
 #include "libeblearn.h"
 #include "configuration.h"
 #include "tools_utils.h"
@@ -222,6 +224,31 @@ template <class Tmodule, typename T>
 bool load_module(configuration &conf, module_1_1<T> &m,
                  const std::string &module_name, const std::string &type);
 
+//! Creates the int8 modules of ebl_quantization.h, which only exist for
+//! floating point types. 'integer' is true for integer types, for which
+//! creating an int8 module is an error.
+template <typename T, bool integer = std::numeric_limits<T>::is_integer>
+class int8_factory {
+ public:
+  //! Returns a new linear_int8_module, see its constructor.
+  static module_1_1<T>* linear(parameter<T> *p, intg in, intg out,
+                               float range, const char *name);
+  //! Returns a new convolution_int8_module, see its constructor.
+  static module_1_1<T>* convolution(parameter<T> *p, idxdim &ker,
+                                    idxdim &stride, idx<intg> &table,
+                                    float range, const char *name, bool crop);
+};
+
+//! Integer types version of int8_factory, raising errors.
+template <typename T> class int8_factory<T, true> {
+ public:
+  static module_1_1<T>* linear(parameter<T> *p, intg in, intg out,
+                               float range, const char *name);
+  static module_1_1<T>* convolution(parameter<T> *p, idxdim &ker,
+                                    idxdim &stride, idx<intg> &table,
+                                    float range, const char *name, bool crop);
+};
+
 //! Load network's modules individually based on configuration and return
 //! the number of weights loaded.
 template <typename T>
@@ -568,6 +568,11 @@ create_module(const std::string &name, parameter<T> &theparam,
     idx<intg> tblmax = table.select(1, 1);
     thick = 1 + idx_max(tblmax);
     bool crop = true;
+    // int8 products (inference only)
+    bool int8 = conf.exists_true("quantize_int8");
+    float int8_range = 0;
+    get_param(conf, name, "int8", int8, true);
+    get_param(conf, name, "int8_range", int8_range, true);
     // create module
     if (!type.compare("conv")) { // conv module
 #ifdef __CUDA__
@@ -582,6 +587,11 @@ create_module(const std::string &name, parameter<T> &theparam,
 					 name.c_str(), crop, gpu_id_m);
       else
 #endif
+      if (int8)
+        module = int8_factory<T>::convolution
+					(bshared_exists? NULL : &theparam, kernel, stride, table,
+					 int8_range, name.c_str(), crop);
+      else
         module = (module_1_1<T>*)
 					//		new convolution_module_replicable<T>
 					new convolution_module<T>
@@ -593,6 +603,15 @@ create_module(const std::string &name, parameter<T> &theparam,
 				new convolution_layer<T>
 				(bshared_exists? NULL : &theparam, kernel, stride, table,
 				 true /* tanh */, name.c_str());
+    // convolution algorithm
+    std::string salgo;
+    if (get_param(conf, name, "algorithm", salgo, true)) {
+      convolution_module<T> *cm =
+	dynamic_cast<convolution_module<T>*>(module);
+      convolution_layer<T> *cl = dynamic_cast<convolution_layer<T>*>(module);
+      if (cl) cm = &cl->convol;
+      if (cm) cm->set_algorithm(string_to_conv_algorithm(salgo));
+    }
   }
   // subsampling ///////////////////////////////////////////////////////
   else if (!type.compare("subs") || !type.compare("subsl")
@@ -802,8 +821,17 @@ create_module(const std::string &name, parameter<T> &theparam,
     intg lin, lout;
     if (!get_param2(conf, name, "in", lin, thick, nout)) return NULL;
     if (!get_param2(conf, name, "out", lout, thick, nout)) return NULL;
+    // int8 products (inference only)
+    bool int8 = conf.exists_true("quantize_int8");
+    float int8_range = 0;
+    get_param(conf, name, "int8", int8, true);
+    get_param(conf, name, "int8_range", int8_range, true);
     // create module
-    if (!type.compare("linear"))
+    if (!type.compare("linear") && int8)
+      module = int8_factory<T>::linear
+				(bshared_exists? NULL : &theparam, lin, lout, int8_range,
+				 name.c_str());
+    else if (!type.compare("linear"))
       module = (module_1_1<T>*) new linear_module<T>
 				(bshared_exists? NULL : &theparam, lin, lout, name.c_str());
     else
@@ -958,7 +986,9 @@ create_module(const std::string &name, parameter<T> &theparam,
     // tanh ///////////////////////////////////////////////////////////////
   } else if (!type.compare("tanh")) {
     double linear = 0;
+    bool fast = false;
     get_param(conf, name, "linear", linear, true);
+    get_param(conf, name, "fast", fast, true);
 #ifdef __CUDA__
     bool use_gpu_m = use_gpu;
     int gpu_id_m = gpu_id;
@@ -969,13 +999,16 @@ create_module(const std::string &name, parameter<T> &theparam,
                                                         gpu_id_m);
     else
 #endif
-      module = (module_1_1<T>*) new tanh_module<T>(linear, name.c_str());
+      module = (module_1_1<T>*) new tanh_module<T>(linear, name.c_str(), fast);
   }
   // stdsig //////////////////////////////////////////////////////////////
   else if (!type.compare("stdsig")) {
     double linear = 0;
+    bool fast = false;
     get_param(conf, name, "linear", linear, true);
-    module = (module_1_1<T>*) new stdsigmoid_module<T>(linear, name.c_str());
+    get_param(conf, name, "fast", fast, true);
+    module = (module_1_1<T>*)
+			new stdsigmoid_module<T>(linear, name.c_str(), fast);
   }
   // rectified linear ///////////////////////////////////////////////////////////
   else if (!type.compare("relu")) {
@@ -1033,6 +1066,37 @@ create_module(const std::string &name, parameter<T> &theparam,
   return module;
 }
 
+// int8_factory ////////////////////////////////////////////////////////////////
+
+template <typename T, bool integer>
+module_1_1<T>* int8_factory<T,integer>::
+linear(parameter<T> *p, intg in, intg out, float range, const char *name) {
+  return new linear_int8_module<T>(p, in, out, range, name);
+}
+
+template <typename T, bool integer>
+module_1_1<T>* int8_factory<T,integer>::
+convolution(parameter<T> *p, idxdim &ker, idxdim &stride, idx<intg> &table,
+            float range, const char *name, bool crop) {
+  return new convolution_int8_module<T>(p, ker, stride, table, range, name,
+                                        crop);
+}
+
+template <typename T>
+module_1_1<T>* int8_factory<T,true>::
+linear(parameter<T> *p, intg in, intg out, float range, const char *name) {
+  eblerror("int8 module " << name << " requires a floating point type");
+  return NULL;
+}
+
+template <typename T>
+module_1_1<T>* int8_factory<T,true>::
+convolution(parameter<T> *p, idxdim &ker, idxdim &stride, idx<intg> &table,
+            float range, const char *name, bool crop) {
+  eblerror("int8 module " << name << " requires a floating point type");
+  return NULL;
+}
+
 // select network based on configuration
 template <typename T>
 ebm_1<T>* create_ebm1(const std::string &name, configuration &conf) {
@@ -44,6 +44,7 @@
 #include "idx.h"
 #include "job.h"
 #include "ebl_trainer.h"
+#include "hogwild_trainer.h"
 
 #ifdef __GUI__
 #include "ebl_trainer_gui.h"
@@ -60,6 +61,8 @@ create_trainable_module(ddparameter<T> &theparam, configuration &conf,
 												uint noutputs, module_1_1<T> **net,
 												bool silent = false, bool expect_loading = false);
 //! This creates a trainable network and returns it.
+//! If variable 'nthreads' is greater than 1, the network is trained by as
+//! many threads updating the same weights (see hogwild_trainer).
 template <typename T, typename Tdata, typename Tlabel>
 supervised_trainer<T,Tdata,Tlabel>*
 create_trainable_network(ddparameter<T> &theparam, configuration &conf,
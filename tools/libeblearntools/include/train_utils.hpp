@@ -78,6 +78,9 @@ create_trainable_module(ddparameter<T> &theparam, configuration &conf,
   }
   if (!conf.exists_true("retrain") && conf.exists_true("manual_load"))
     manually_load_network(*((layers<T>*)net), conf);
+  // keep hidden states in float16 between fprop and bprop
+  if (conf.exists_true("half_states"))
+    ((layers<T>*)net)->set_half_states(true);
 	return machine;
 }
 
@@ -90,8 +93,30 @@ create_trainable_network(ddparameter<T> &theparam, configuration &conf,
   trainable_module<T,Tdata,Tlabel> *train =
 		create_trainable_module<T,Tdata,Tlabel>(theparam, conf, noutputs, network,
 																						silent);
-  supervised_trainer<T,Tdata,Tlabel> *thetrainer =
-		new supervised_trainer<T,Tdata,Tlabel>(*train, theparam, silent);
+  supervised_trainer<T,Tdata,Tlabel> *thetrainer = NULL;
+  uint nthreads = conf.try_get_uint("nthreads", 1);
+  if (nthreads > 1) {
+    hogwild_trainer<T,Tdata,Tlabel> *hogwild =
+      new hogwild_trainer<T,Tdata,Tlabel>(*train, theparam, silent);
+    // each thread trains its own machine, built from the same configuration
+    // on a parameter sharing the weights of 'theparam'. building machines
+    // initializes the shared weights, save them and restore them after.
+    idx<T> w(theparam.x[0].get_idxdim());
+    idx_copy(theparam.x[0], w);
+    for (uint i = 0; i < nthreads; ++i) {
+      ddparameter<T> *p = new ddparameter<T>(theparam, true);
+      module_1_1<T> *net = NULL;
+      trainable_module<T,Tdata,Tlabel> *m =
+        create_trainable_module<T,Tdata,Tlabel>(*p, conf, noutputs, &net, true);
+      hogwild->add_worker(p, net, m);
+    }
+    idx_copy(w, theparam.x[0]);
+    if (!silent)
+      std::cout << "Training with " << nthreads << " threads." << std::endl;
+    thetrainer = hogwild;
+  } else
+    thetrainer =
+      new supervised_trainer<T,Tdata,Tlabel>(*train, theparam, silent);
   thetrainer->set_progress_file(job::get_progress_filename());
   iter = 0;
   if (conf.exists_true("retrain") && conf.exists("retrain_iteration")) {
@@ -137,7 +162,9 @@ void test_and_save(uint iter, configuration &conf, std::string &conffname,
 	int save_weights = conf.get_int("save_weights");
 	if (save_weights > 0 && (save_weights == 1 || iter >= save_weights)) {
     std::cout << "saving net to " << wfname.str() << std::endl;
-    theparam.save_x(wfname.str().c_str()); // save trained network
+    // save trained network, optionally in half precision
+    theparam.save_x(wfname.str().c_str(),
+                    conf.exists_true("save_weights_half"));
     std::cout << "saved=" << wfname.str() << std::endl;
 	} else {
     std::cout << "Not saving weights (save_weights set to "
@@ -353,6 +380,11 @@ create_validation_set(configuration &conf, uint &noutputs,
   if (conf.exists("epoch_show_modulo"))
     val_ds->set_epoch_show(conf.get_uint("epoch_show_modulo"));
   val_ds->keep_outputs(conf.exists_true("keep_outputs"));
+  if (conf.exists("prefetch_mb")) { // read on-demand data ahead
+    intg budget = (intg) conf.get_int("prefetch_mb") * 1024 * 1024;
+    val_ds->set_prefetching(budget, conf.exists("prefetch_depth") ?
+                            conf.get_int("prefetch_depth") : 256);
+  }
   if (conf.exists_true("save_answers")) {
 		if (!silent)
 			eblprint("Forcing datasource to keep outputs in order to save answers.");
@@ -425,6 +457,11 @@ create_training_set(configuration &conf, uint &noutputs, std::string &traindata)
   if (conf.exists("label_coeff"))
     train_ds->set_label_coeff((T)conf.get_double("label_coeff"));
   train_ds->keep_outputs(conf.exists_true("keep_outputs"));
+  if (conf.exists("prefetch_mb")) { // read on-demand data ahead
+    intg budget = (intg) conf.get_int("prefetch_mb") * 1024 * 1024;
+    train_ds->set_prefetching(budget, conf.exists("prefetch_depth") ?
+                              conf.get_int("prefetch_depth") : 256);
+  }
   if (conf.exists_true("save_answers")) {
     eblprint("Forcing datasource to keep outputs in order to save answers.");
     train_ds->keep_outputs(true);    
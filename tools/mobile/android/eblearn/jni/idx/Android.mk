@@ -18,6 +18,7 @@ LOCAL_SRC_FILES  := $(SRC)/color_spaces.cpp \
 		    $(SRC)/ippops.cpp \
 		    $(SRC)/numerics.cpp \
 		    $(SRC)/random.cpp \
+		    $(SRC)/resampler.cpp \
 		    $(SRC)/smart.cpp \
 		    $(SRC)/srg.cpp \
 		    $(SRC)/stl.cpp \
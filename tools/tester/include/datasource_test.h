@@ -8,6 +8,7 @@
 class datasource_test : public CppUnit::TestFixture  {
   CPPUNIT_TEST_SUITE(datasource_test);
   //  CPPUNIT_TEST(test_mnist_LabeledDataSource); // TODO: fix test
+  CPPUNIT_TEST(test_prefetching);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -21,6 +22,7 @@ public:
 
   // Test functions
   void test_mnist_LabeledDataSource();
+  void test_prefetching();
 };
 
 #endif /* DATASOURCE_TEST_H_ */
@@ -6,6 +6,8 @@
 #include "ebl_layers.h"
 #include "ebl_tester.h"
 #include "ebl_pooling.h"
+#include "ebl_quantization.h"
+#include "ebl_answer.h"
 
 //! Test class for Ebm class
 class ebl_basic_test : public CppUnit::TestFixture  {
@@ -45,6 +47,11 @@ class ebl_basic_test : public CppUnit::TestFixture  {
   // double tests
   // CPPUNIT_TEST(test_addc_module_double); //not working
   CPPUNIT_TEST(test_convolution_module_double);
+  CPPUNIT_TEST(test_convolution_algorithms);
+  CPPUNIT_TEST(test_convolution_plans);
+  CPPUNIT_TEST(test_int8_modules);
+  CPPUNIT_TEST(test_batches);
+  CPPUNIT_TEST(test_half_states);
   // CPPUNIT_TEST(test_subsampling_module_double); //not working
 
   //CPPUNIT_TEST(test_wavg_pooling_module_double); //segfaults
@@ -61,6 +68,7 @@ class ebl_basic_test : public CppUnit::TestFixture  {
   //CPPUNIT_TEST(test_mirrorpad_module_double); //not working
   CPPUNIT_TEST(test_thres_module_double);
   CPPUNIT_TEST(test_tanh_shrink_module_double);
+  CPPUNIT_TEST(test_tanh_fast_module_double);
 
   //  CPPUNIT_TEST(test_softmax); // TODO: fix test
   CPPUNIT_TEST(test_state_copy);
@@ -91,6 +99,11 @@ public:
   void test_convolution_module_float();
   void test_convolution_module_cuda();
   void test_convolution_module_double();
+  void test_convolution_algorithms();
+  void test_convolution_plans();
+  void test_int8_modules();
+  void test_batches();
+  void test_half_states();
   void test_subsampling_module_float();
   void test_subsampling_module_double();
   void test_wavg_pooling_module_float();
@@ -125,6 +138,7 @@ public:
   void test_thres_module_double();
   void test_tanh_shrink_module_float();
   void test_tanh_shrink_module_double();
+  void test_tanh_fast_module_double();
 };
 
 #endif /* EBL_BASIC_TEST_H_ */
@@ -43,6 +43,7 @@ class ebl_machines_test : public CppUnit::TestFixture  {
   CPPUNIT_TEST(test_full_table);
   //CPPUNIT_TEST(test_lenet5_mnist_float);
   CPPUNIT_TEST(test_lenet5_mnist_double);
+  CPPUNIT_TEST(test_hogwild);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -58,6 +59,7 @@ public:
   void test_lenet5_mnist_float();
   void test_lenet5_mnist_double();
   void test_full_table();
+  void test_hogwild();
 };
 
 template <typename Tnet>
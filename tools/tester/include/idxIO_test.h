@@ -12,8 +12,13 @@ class idxIO_test : public CppUnit::TestFixture  {
   CPPUNIT_TEST(test_save_load_matrix_float);
   CPPUNIT_TEST(test_save_load_matrix_double);
   CPPUNIT_TEST(test_save_load_matrix_long);
+  CPPUNIT_TEST(test_save_load_matrix_half);
   CPPUNIT_TEST(test_save_load_matrix_matrix);
   CPPUNIT_TEST(test_save_load_matrices);
+  CPPUNIT_TEST(test_mapped_loading);
+  CPPUNIT_TEST(test_compressed_matrices);
+  CPPUNIT_TEST(test_csv_loading);
+  CPPUNIT_TEST(test_prefetching);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -31,8 +36,13 @@ public:
   void test_save_load_matrix_float();
   void test_save_load_matrix_double();
   void test_save_load_matrix_long();
+  void test_save_load_matrix_half();
   void test_save_load_matrix_matrix();
   void test_save_load_matrices();
+  void test_mapped_loading();
+  void test_compressed_matrices();
+  void test_csv_loading();
+  void test_prefetching();
 };
 
 #endif /* IDXIOTEST_H_ */
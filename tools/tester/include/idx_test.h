@@ -9,6 +9,7 @@ class idx_test : public CppUnit::TestFixture  {
   CPPUNIT_TEST_SUITE(idx_test);
   CPPUNIT_TEST(test_Idx_get);
   CPPUNIT_TEST(test_Srg);
+  CPPUNIT_TEST(test_Srg_pooled);
   CPPUNIT_TEST(test_IdxSpec);
   CPPUNIT_TEST(test_Idx_operations);
   CPPUNIT_TEST(test_Idx_resize);
@@ -16,6 +17,7 @@ class idx_test : public CppUnit::TestFixture  {
   CPPUNIT_TEST(test_IdxIter2);
   CPPUNIT_TEST(test_Idx_macros);
   CPPUNIT_TEST(test_view_as_order);
+  CPPUNIT_TEST(test_idx_view);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -30,6 +32,7 @@ public:
   // Test functions
   void test_Idx_get();
   void test_Srg();
+  void test_Srg_pooled();
   void test_IdxSpec();
   void test_Idx_operations();
   void test_Idx_resize();
@@ -37,5 +40,6 @@ public:
   void test_IdxIter2();
   void test_Idx_macros();
   void test_view_as_order();
+  void test_idx_view();
 };
 #endif /*IDXTEST_*/
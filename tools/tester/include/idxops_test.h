@@ -3,6 +3,8 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include "idxops.h"
+#include "idxexpr.h"
+#include "random.h"
 
 //! Test class for Blas class
 class idxops_test : public CppUnit::TestFixture  {
@@ -16,10 +18,17 @@ class idxops_test : public CppUnit::TestFixture  {
   CPPUNIT_TEST(test_idx_m2squdotm1);
   CPPUNIT_TEST(test_idx_m2extm2acc);
   CPPUNIT_TEST(test_idx_m2dotm1);
+  CPPUNIT_TEST(test_idx_m2dotm2);
   CPPUNIT_TEST(test_idx_copy);
   CPPUNIT_TEST(test_idx_copy2);
   CPPUNIT_TEST(test_idx_abs);
   CPPUNIT_TEST(test_huge_vec);
+  CPPUNIT_TEST(test_simd_ops);
+  CPPUNIT_TEST(test_idx_eval);
+  CPPUNIT_TEST(test_idx_2dconvol);
+  CPPUNIT_TEST(test_random);
+  CPPUNIT_TEST(test_half);
+  CPPUNIT_TEST(test_gemm_s8);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -41,10 +50,17 @@ public:
   void test_idx_m2squdotm1();
   void test_idx_m2extm2acc();
   void test_idx_m2dotm1();
+  void test_idx_m2dotm2();
   void test_idx_copy();
   void test_idx_copy2();
   void test_idx_abs();
   void test_huge_vec();
+  void test_simd_ops();
+  void test_idx_eval();
+  void test_idx_2dconvol();
+  void test_random();
+  void test_half();
+  void test_gemm_s8();
 };
 
 #endif /* IDXOPSTEST_H_ */
@@ -29,6 +29,7 @@ class idxops_test2 : public CppUnit::TestFixture  {
   CPPUNIT_TEST(idx_dtanh2);
   CPPUNIT_TEST(idx_stdsigmoid2);
   CPPUNIT_TEST(idx_dstdsigmoid2);
+  CPPUNIT_TEST(idx_tanh_fast2);
   CPPUNIT_TEST(idx_abs2);
   CPPUNIT_TEST(idx_thresdotc_acc2);
   CPPUNIT_TEST(idx_threshold2);
@@ -69,6 +70,7 @@ public:
   void idx_dtanh2();
   void idx_stdsigmoid2();
   void idx_dstdsigmoid2();
+  void idx_tanh_fast2();
   void idx_abs2();
   void idx_thresdotc_acc2();
   void idx_threshold2();
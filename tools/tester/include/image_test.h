@@ -11,7 +11,12 @@ class image_test : public CppUnit::TestFixture  {
   CPPUNIT_TEST(test_resize);
   CPPUNIT_TEST(test_pnm_P3);
   CPPUNIT_TEST(test_pnm_P6);
+  CPPUNIT_TEST(test_image_decode);
+  CPPUNIT_TEST(test_color_conversions);
+  CPPUNIT_TEST(test_resampler);
+  CPPUNIT_TEST(test_resampler_pyramid);
   CPPUNIT_TEST(test_gaussian_pyramid);
+  CPPUNIT_TEST(test_camera_directory);
   //  CPPUNIT_TEST(test_colorspaces);
   CPPUNIT_TEST_SUITE_END();
 
@@ -28,7 +33,12 @@ public:
   void test_resize();
   void test_pnm_P3();
   void test_pnm_P6();
+  void test_image_decode();
+  void test_color_conversions();
+  void test_resampler();
+  void test_resampler_pyramid();
   void test_gaussian_pyramid();
+  void test_camera_directory();
   void test_deformations();
   void test_colorspaces();
 };
@@ -0,0 +1,29 @@
+#ifndef SMART_TEST_H_
+#define SMART_TEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "idx.h"
+#include "smart.h"
+
+//! Test class for smart_pointer class
+class smart_test : public CppUnit::TestFixture  {
+  CPPUNIT_TEST_SUITE(smart_test);
+  CPPUNIT_TEST(test_refcount);
+  CPPUNIT_TEST(test_atomic_refcount_threads);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  // member variables
+  
+public:
+  //! This function is called before each test function is called.
+  void setUp();
+  //! This function is called after each test function is called.
+  void tearDown();
+
+  // Test functions
+  void test_refcount();
+  void test_atomic_refcount_threads();
+};
+
+#endif /* SMART_TEST_H_ */
@@ -53,3 +53,49 @@ void datasource_test::test_mnist_LabeledDataSource() {
     CPPUNIT_ASSERT(false); // error
   }
 }
+
+// check that samples read ahead are the ones returned by next_train()
+// and next(), in balanced and unbalanced orders.
+void datasource_test::test_prefetching() {
+  string fname = "./eblearn_tester_prefetch.mat";
+  midx<float> all(30);
+  idx<int> labels(30);
+  for (int i = 0; i < 30; ++i) {
+    idx<float> m(3, 4 + i % 3);
+    idx_fill(m, (float) i);
+    all.mset(m, i);
+    labels.set(i % 3, i);
+  }
+  CPPUNIT_ASSERT(save_matrices(all, fname));
+  midx<float> data = load_matrices<float>(fname, true);
+  class_datasource<float,float,int> ds(data, labels, NULL, "prefetch");
+  ds.set_prefetching(1024 * 1024, 8);
+  idx<float> sample;
+  for (int balanced = 0; balanced < 2; ++balanced) {
+    ds.set_balanced(balanced == 1);
+    for (int i = 0; i < 100; ++i) {
+      ds.next_train();
+      ds.fprop1_data(sample);
+      int id = (int) sample.get(0, 0);
+      CPPUNIT_ASSERT_EQUAL(id % 3, ds.get_label());
+      CPPUNIT_ASSERT_EQUAL((intg) (4 + id % 3), sample.dim(1));
+    }
+  }
+  ds.seek_begin();
+  for (int i = 0; i < 30; ++i, ds.next()) {
+    ds.fprop1_data(sample);
+    CPPUNIT_ASSERT_EQUAL((float) i, sample.get(2, 3));
+  }
+  // copies do not share the read-ahead and read their samples directly
+  {
+    class_datasource<float,float,int> copy(ds);
+    copy.seek_begin();
+    for (int i = 0; i < 30; ++i, copy.next()) {
+      copy.fprop1_data(sample);
+      CPPUNIT_ASSERT_EQUAL((float) i, sample.get(2, 3));
+    }
+  }
+  ds.seek_begin();
+  ds.fprop1_data(sample);
+  CPPUNIT_ASSERT_EQUAL((float) 0, sample.get(2, 3));
+}
@@ -339,6 +339,344 @@ void ebl_basic_test::test_convolution_module_double() {
   TEST_DERIVATIVES(c, in, out, T, FLOAT_THRESHOLD)
       }
 
+// Checks that algorithm 'a' gives the same fprop, bprop and bbprop results
+// as the unfold algorithm.
+template <typename T>
+static void check_conv_algorithm(conv_algorithm a, intg nin, intg h, intg w,
+				 idx<intg> &table, idxdim &ker, idxdim &stride,
+				 double thresh) {
+  ddparameter<T> p1(100000), p2(100000);
+  convolution_module<T> c1(&p1, ker, stride, table), c2(&p2, ker, stride, table);
+  c1.set_algorithm(CONV_UNFOLD);
+  c2.set_algorithm(a);
+  CPPUNIT_ASSERT_EQUAL((int) a, (int) c2.get_algorithm());
+  dseed(1);
+  state<T> in1(nin, h, w), in2(nin, h, w), out1, out2;
+  idx_random(in1, -1.0, 1.0);
+  idx_copy(in1, in2);
+  idx_random(c1.kernel, -1.0, 1.0);
+  idx_copy(c1.kernel, c2.kernel);
+  // fprop
+  c1.fprop1(in1, out1);
+  c2.fprop1(in2, out2);
+  CPPUNIT_ASSERT(out1.get_idxdim() == out2.get_idxdim());
+  idx<T> d(out1.get_idxdim());
+  idx_sub(out1, out2, d);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0, idx_sumabs(d), thresh);
+  // bprop and bbprop
+  in1.resize_dx(); in1.resize_ddx(); in2.resize_dx(); in2.resize_ddx();
+  out1.resize_dx(); out1.resize_ddx(); out2.resize_dx(); out2.resize_ddx();
+  idx_random(out1.dx[0], -1.0, 1.0);
+  idx_copy(out1.dx[0], out2.dx[0]);
+  idx_random(out1.ddx[0], 0.0, 1.0);
+  idx_copy(out1.ddx[0], out2.ddx[0]);
+  in1.zero_dx(); in1.zero_ddx(); in2.zero_dx(); in2.zero_ddx();
+  c1.kernel.zero_dx(); c1.kernel.zero_ddx();
+  c2.kernel.zero_dx(); c2.kernel.zero_ddx();
+  c1.bprop1(in1, out1);
+  c2.bprop1(in2, out2);
+  c1.bbprop1(in1, out1);
+  c2.bbprop1(in2, out2);
+  idx<T> di(in1.get_idxdim()), dk(c1.kernel.get_idxdim());
+  idx_sub(in1.dx[0], in2.dx[0], di);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0, idx_sumabs(di), thresh);
+  idx_sub(in1.ddx[0], in2.ddx[0], di);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0, idx_sumabs(di), thresh);
+  idx_sub(c1.kernel.dx[0], c2.kernel.dx[0], dk);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0, idx_sumabs(dk), thresh);
+  idx_sub(c1.kernel.ddx[0], c2.kernel.ddx[0], dk);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0, idx_sumabs(dk), thresh);
+  // fprop again with new kernels
+  idx_random(c1.kernel, -1.0, 1.0);
+  idx_copy(c1.kernel, c2.kernel);
+  c1.fprop1(in1, out1);
+  c2.fprop1(in2, out2);
+  idx_sub(out1, out2, d);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0, idx_sumabs(d), thresh);
+}
+
+// Checks CONV_SEPARABLE against the unfold algorithm with box, separable and
+// other kernels, and after kernels changed from one kind to another.
+static void check_conv_separable() {
+  typedef double T;
+  idxdim ker(5, 5), s1(1, 1);
+  idx<intg> table = full_table(2, 2);
+  ddparameter<T> p1(10000), p2(10000);
+  convolution_module<T> c1(&p1, ker, s1, table), c2(&p2, ker, s1, table);
+  c1.set_algorithm(CONV_UNFOLD);
+  c2.set_algorithm(CONV_SEPARABLE);
+  dseed(1);
+  state<T> in(2, 16, 13), out1, out2;
+  idx_random(in, -1.0, 1.0);
+  idx<T> g = create_gaussian_kernel<T>(5);
+  for (intg pass = 0; pass < 2; ++pass) {
+    idx_random(c1.kernel, -1.0, 1.0);
+    idx<T> kbox = c1.kernel.select(0, pass), kg = c1.kernel.select(0, 2 - pass);
+    idx_fill(kbox, (T) .1);
+    idx_copy(g, kg);
+    idx_copy(c1.kernel, c2.kernel);
+    c1.fprop1(in, out1);
+    c2.fprop1(in, out2);
+    idx<T> d(out1.get_idxdim());
+    idx_sub(out1, out2, d);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0, idx_sumabs(d), 1e-9);
+  }
+}
+
+void ebl_basic_test::test_convolution_algorithms() {
+  idxdim ker(5, 5), ker2(3, 4), s1(1, 1), s2(2, 2);
+  idx<intg> full = full_table(3, 4), one = one2one_table(3);
+  std::vector<intg> fanin(1, 2);
+  idx<intg> rnd = random_table(4, 6, fanin);
+  check_conv_algorithm<double>(CONV_GEMM, 3, 16, 13, full, ker, s1, 1e-9);
+  check_conv_algorithm<double>(CONV_GEMM, 3, 15, 12, one, ker2, s1, 1e-9);
+  check_conv_algorithm<double>(CONV_GEMM, 4, 17, 19, rnd, ker, s2, 1e-9);
+  check_conv_algorithm<float>(CONV_GEMM, 4, 20, 21, rnd, ker2, s2, 1e-2);
+  idxdim ker3(3, 3), ker9(9, 9);
+  check_conv_algorithm<double>(CONV_WINOGRAD, 3, 16, 13, full, ker3, s1, 1e-9);
+  check_conv_algorithm<double>(CONV_WINOGRAD, 4, 7, 9, rnd, ker3, s1, 1e-9);
+  check_conv_algorithm<double>(CONV_WINOGRAD, 4, 17, 19, rnd, ker3, s2, 1e-9);
+  check_conv_algorithm<float>(CONV_WINOGRAD, 3, 22, 20, full, ker3, s1, 1e-2);
+  check_conv_algorithm<double>(CONV_FFT, 3, 16, 13, full, ker, s1, 1e-9);
+  check_conv_algorithm<double>(CONV_FFT, 4, 40, 70, rnd, ker9, s1, 1e-9);
+  check_conv_algorithm<double>(CONV_FFT, 3, 15, 12, one, ker2, s2, 1e-9);
+  check_conv_algorithm<float>(CONV_FFT, 3, 30, 25, full, ker, s1, 1e-2);
+  check_conv_algorithm<double>(CONV_DEFAULT, 3, 16, 13, full, ker3, s1, 1e-9);
+  check_conv_separable();
+  // repeated (input, output) entries are summed
+  idx<intg> dup(full.dim(0) + 2, 2);
+  idx<intg> dup0 = dup.narrow(0, full.dim(0), 0);
+  idx_copy(full, dup0);
+  dup.set(1, full.dim(0), 0); dup.set(2, full.dim(0), 1);
+  dup.set(1, full.dim(0) + 1, 0); dup.set(2, full.dim(0) + 1, 1);
+  check_conv_algorithm<double>(CONV_GEMM, 3, 16, 13, dup, ker, s2, 1e-9);
+  check_conv_algorithm<double>(CONV_WINOGRAD, 3, 16, 13, dup, ker3, s1, 1e-9);
+  check_conv_algorithm<double>(CONV_FFT, 3, 16, 13, dup, ker, s1, 1e-9);
+  // derivatives of the gemm algorithm
+  typedef double T;
+  state<T> in(2, 9, 8), out;
+  idx<intg> table = full_table(2, 3);
+  ddparameter<T> prm(10000);
+  convolution_module<T> c(&prm, ker2, s1, table);
+  c.set_algorithm(CONV_GEMM);
+  TEST_DERIVATIVES(c, in, out, T, DOUBLE_THRESHOLD)
+}
+
+// Checks that plans cached for alternating input sizes and new input
+// buffers give the same results as the unfold algorithm.
+void ebl_basic_test::test_convolution_plans() {
+  typedef double T;
+  idxdim ker(3, 3), s1(1, 1);
+  idx<intg> table = full_table(8, 16);
+  ddparameter<T> p1(100000), p2(100000);
+  convolution_module<T> c1(&p1, ker, s1, table), c2(&p2, ker, s1, table);
+  c1.set_algorithm(CONV_UNFOLD);
+  dseed(1);
+  idx_random(c1.kernel, -1.0, 1.0);
+  idx_copy(c1.kernel, c2.kernel);
+  intg sizes[5][2] = { {20, 24}, {11, 9}, {20, 24}, {37, 30}, {11, 9} };
+  state<T> out1, out2;
+  for (int i = 0; i < 5; ++i) {
+    state<T> in(8, sizes[i][0], sizes[i][1]);
+    idx_random(in, -1.0, 1.0);
+    c1.fprop1(in, out1);
+    c2.fprop1(in, out2);
+    CPPUNIT_ASSERT(out1.get_idxdim() == out2.get_idxdim());
+    idx<T> d(out1.get_idxdim());
+    idx_sub(out1, out2, d);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0, idx_sumabs(d), 1e-9);
+  }
+}
+
+// Returns the max absolute difference between 'a' and 'b' relative to the
+// max absolute value of 'a'.
+template <typename T> static double relative_maxdiff(idx<T> &a, idx<T> &b) {
+  double d = 0, m = 0;
+  { idx_aloop2(i, a, T, j, b, T) {
+      d = std::max(d, (double) fabs(*i - *j));
+      m = std::max(m, (double) fabs(*i));
+    }}
+  return d / m;
+}
+
+// Checks that int8 modules give results close to floating point ones, with
+// given, calibrated and dynamic input ranges.
+void ebl_basic_test::test_int8_modules() {
+  typedef float T;
+  idxdim ker(5, 5), ker2(3, 4), s1(1, 1), s2(2, 2);
+  std::vector<intg> fanin(1, 2);
+  idx<intg> full = full_table(3, 8), rnd = random_table(4, 6, fanin);
+  idx<intg> *tables[3] = { &full, &rnd, &rnd };
+  idxdim *kers[3] = { &ker, &ker2, &ker };
+  idxdim *strides[3] = { &s1, &s1, &s2 };
+  intg sizes[3][3] = { {3, 20, 23}, {4, 16, 17}, {4, 21, 20} };
+  dseed(1);
+  for (int t = 0; t < 3; ++t) {
+    ddparameter<T> p1(100000), p2(100000);
+    convolution_module<T> c1(&p1, *kers[t], *strides[t], *tables[t]);
+    convolution_int8_module<T> c2(&p2, *kers[t], *strides[t], *tables[t]);
+    idx_random(c1.kernel, -1.0, 1.0);
+    idx_copy(c1.kernel, c2.kernel);
+    state<T> in(sizes[t][0], sizes[t][1], sizes[t][2]), out1, out2;
+    idx_random(in, -1.0, 1.0);
+    c1.fprop1(in, out1);
+    c2.fprop1(in, out2); // dynamic range
+    CPPUNIT_ASSERT(out1.get_idxdim() == out2.get_idxdim());
+    CPPUNIT_ASSERT(relative_maxdiff(out1, out2) < .02);
+    c2.start_calibration();
+    c2.fprop1(in, out2);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0, relative_maxdiff(out1, out2), 1e-9);
+    c2.stop_calibration();
+    CPPUNIT_ASSERT(c2.get_range() > .99 && c2.get_range() <= 1);
+    c2.fprop1(in, out2);
+    CPPUNIT_ASSERT(relative_maxdiff(out1, out2) < .02);
+  }
+  // linear, with 1 and several input columns
+  ddparameter<T> p1(10000), p2(10000);
+  linear_module<T> l1(&p1, 50, 10);
+  linear_int8_module<T> l2(&p2, 50, 10, 2.0);
+  idx_random(l1.w, -1.0, 1.0);
+  idx_copy(l1.w, l2.w);
+  for (intg n = 1; n <= 7; n += 6) {
+    state<T> in(50, n), out1, out2;
+    idx_random(in, -2.0, 2.0);
+    l1.fprop1(in, out1);
+    l2.fprop1(in, out2);
+    CPPUNIT_ASSERT(out1.get_idxdim() == out2.get_idxdim());
+    CPPUNIT_ASSERT(relative_maxdiff(out1, out2) < .02);
+  }
+  // weights are quantized again when loaded
+  idx_dotc(l1.w, 2.0, l1.w);
+  l2.load_x(l1.w);
+  state<T> in(50), out1, out2;
+  idx_random(in, -1.0, 1.0);
+  l1.fprop1(in, out1);
+  l2.fprop1(in, out2);
+  CPPUNIT_ASSERT(relative_maxdiff(out1, out2) < .02);
+}
+
+void ebl_basic_test::test_batches() {
+  typedef double T;
+  ddparameter<T> p(10000);
+  idxdim ker2(2, 2), ker3(3, 3), ker4(4, 4), s1(1, 1);
+  idx<intg> t1 = full_table(2, 4), t2 = full_table(4, 6);
+  layers<T> net(true);
+  net.add_module(new convolution_module<T>(&p, ker3, s1, t1));
+  net.add_module(new addc_module<T>(&p, 4));
+  net.add_module(new tanh_module<T>());
+  // modules keeping intermediate buffers between fprop and bprop
+  net.add_module(new contrast_norm_module<T>(ker3, 4));
+  net.add_module(new subsampling_module<T>(&p, 4, ker2, ker2));
+  net.add_module(new lppooling_module<T>(4, ker2, s1));
+  net.add_module(new convolution_module<T>(&p, ker4, s1, t2));
+  net.add_module(new tanh_module<T>());
+  net.add_module(new linear_module<T>(&p, 6, 3));
+  l2_energy<T> cost;
+  trainable_module<T> machine(cost, net);
+  forget_param_linear fp(2, .5, false, true);
+  machine.forget(fp);
+  // a batch of samples and their targets
+  uint nb = 5;
+  state<T> in(2, 12, 12), tgt(3, 1, 1);
+  for (uint i = 1; i < nb; ++i) { // distinct storages for each sample
+    in.add_x_new(idx<T>(in.get_idxdim()));
+    tgt.add_x_new(idx<T>(tgt.get_idxdim()));
+  }
+  dseed(3);
+  for (uint i = 0; i < nb; ++i) {
+    idx_random(in.x[i], -1.0, 1.0);
+    idx_random(tgt.x[i], -1.0, 1.0);
+  }
+  // gradients accumulated over each sample propagated separately
+  idx<T> dsum(p.dx[0].get_idxdim()), esum(nb);
+  idx_clear(dsum);
+  state<T> e;
+  e.resize_dx();
+  e.dx[0].set(1.0);
+  for (uint i = 0; i < nb; ++i) {
+    state<T> x = in.get_x(i), y = tgt.get_x(i);
+    x.resize_dx();
+    machine.fprop(x, y, e);
+    p.zero_dx();
+    machine.bprop(x, y, e);
+    idx_add(p.dx[0], dsum);
+    esum.set(e.get(), i);
+  }
+  // the whole batch at once
+  state<T> eb;
+  in.resize_dx();
+  machine.fprop(in, tgt, eb);
+  CPPUNIT_ASSERT_EQUAL((size_t) nb, (size_t) eb.x.size());
+  eb.resize_dx();
+  for (uint i = 0; i < nb; ++i) {
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(esum.get(i), eb.x[i].get(), 1e-12);
+    eb.dx[i].set(1.0);
+  }
+  p.zero_dx();
+  machine.bprop(in, tgt, eb);
+  CPPUNIT_ASSERT(idx_max(dsum) != 0);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0, relative_maxdiff(dsum, p.dx[0]), 1e-10);
+}
+
+// Checks that hidden states and weights stored in float16 between uses give
+// the same outputs and close gradients.
+void ebl_basic_test::test_half_states() {
+  typedef float T;
+  ddparameter<T> p(10000);
+  idxdim ker2(2, 2), ker3(3, 3), ker5(5, 5), s1(1, 1);
+  idx<intg> t1 = full_table(2, 4), t2 = full_table(4, 3);
+  layers<T> net(true);
+  net.add_module(new convolution_module<T>(&p, ker3, s1, t1));
+  net.add_module(new tanh_module<T>());
+  net.add_module(new subsampling_module<T>(&p, 4, ker2, ker2));
+  net.add_module(new tanh_module<T>());
+  net.add_module(new convolution_module<T>(&p, ker5, s1, t2));
+  forget_param_linear fp(2, .5, false, true);
+  net.forget(fp);
+  state<T> in(2, 12, 12), out1, out2;
+  dseed(1);
+  idx_random(in, -1.0, 1.0);
+  // forward-only hidden states are never packed
+  net.set_half_states(true);
+  net.fprop(in, out1);
+  for (uint i = 0; i < net.hiddens.size() - 1; ++i)
+    CPPUNIT_ASSERT(!net.hiddens[i]->packed_half());
+  net.set_half_states(false);
+  in.resize_dx();
+  // reference propagation
+  net.fprop(in, out1);
+  out1.resize_dx();
+  idx_fill(out1.dx[0], (T) 1);
+  p.zero_dx();
+  net.bprop(in, out1);
+  idx<T> d1(p.dx[0].get_idxdim());
+  idx_copy(p.dx[0], d1);
+  // hidden states kept for bprop are packed once used, outputs are
+  // computed in T
+  net.set_half_states(true);
+  net.fprop(in, out2);
+  for (uint i = 0; i < net.hiddens.size() - 1; ++i)
+    CPPUNIT_ASSERT(net.hiddens[i]->packed_half());
+  CPPUNIT_ASSERT_EQUAL((double) 0, (double) idx_sqrdist(out1, out2));
+  out2.resize_dx();
+  idx_fill(out2.dx[0], (T) 1);
+  p.zero_dx();
+  net.bprop(in, out2);
+  CPPUNIT_ASSERT(!net.hiddens[0]->packed_half());
+  CPPUNIT_ASSERT(relative_maxdiff(d1, p.dx[0]) < .01);
+  // weights released while packed and restored with float16 precision
+  idx<T> w(p.x[0].get_idxdim());
+  idx_copy(p.x[0], w);
+  p.pack_half();
+  CPPUNIT_ASSERT(p.packed_half());
+  CPPUNIT_ASSERT_EQUAL((intg) 0, p.getstorage()->size());
+  p.unpack_half();
+  CPPUNIT_ASSERT(relative_maxdiff(w, p.x[0]) < 1e-3);
+  net.set_half_states(false);
+  net.fprop(in, out2);
+  CPPUNIT_ASSERT(relative_maxdiff(out1, out2) < .01);
+}
+
 void ebl_basic_test::test_subsampling_module_float() {
   typedef float T;
   ddparameter<T> p(10000);
@@ -547,7 +885,44 @@ void ebl_basic_test::test_linear_module_double() {
   linear_module<T> m(&p, 10, 100);
   state<T> in(10, 1, 1), out;
   TEST_DERIVATIVES(m, in, out, T, DOUBLE_THRESHOLD)
-      }
+  // 2nd derivatives at several positions sum those of each position
+  ddparameter<T> p2(10000);
+  linear_module<T> m2(&p2, 10, 4);
+  state<T> in2(10, 3, 4), out2;
+  dseed(2);
+  forget_param_linear fp(2, .5, false, true);
+  m2.forget(fp);
+  idx_random(in2, -1.0, 1.0);
+  m2.fprop1(in2, out2);
+  in2.resize_ddx();
+  idx_clear(in2.ddx[0]);
+  out2.resize_ddx();
+  idx_random(out2.ddx[0], 0.0, 1.0);
+  idx_clear(m2.w.ddx[0]);
+  m2.bbprop1(in2, out2);
+  idx<T> wddx(m2.w.ddx[0].get_idxdim()), inddx(in2.get_idxdim());
+  idx_copy(m2.w.ddx[0], wddx);
+  idx_clear(m2.w.ddx[0]);
+  idx_clear(inddx);
+  for (intg i = 0; i < 3; ++i)
+    for (intg j = 0; j < 4; ++j) {
+      state<T> a(10, 1, 1), b(4, 1, 1);
+      a.resize_ddx();
+      idx_clear(a.ddx[0]);
+      b.resize_ddx();
+      idx<T> ax = a.select(2, 0).select(1, 0), ix = in2.select(2, j).select(1, i);
+      idx_copy(ix, ax);
+      idx<T> bd = b.ddx[0].select(2, 0).select(1, 0);
+      idx<T> od = out2.ddx[0].select(2, j).select(1, i);
+      idx_copy(od, bd);
+      m2.bbprop1(a, b);
+      idx<T> ad = a.ddx[0].select(2, 0).select(1, 0);
+      idx<T> id = inddx.select(2, j).select(1, i);
+      idx_add(ad, id);
+    }
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0, relative_maxdiff(wddx, m2.w.ddx[0]), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0, relative_maxdiff(inddx, in2.ddx[0]), 1e-12);
+}
 
 void ebl_basic_test::test_subtractive_norm_module_double() {
   typedef double T;
@@ -663,3 +1038,12 @@ void ebl_basic_test::test_tanh_shrink_module_double() {
   state<T> in(5, 10, 10), out;
   TEST_DERIVATIVES(m, in, out, T, DOUBLE_THRESHOLD)
       }
+
+void ebl_basic_test::test_tanh_fast_module_double() {
+  typedef double T;
+  tanh_module<T> m(0, "tanh", true);
+  state<T> in(5, 10, 10), out;
+  TEST_DERIVATIVES(m, in, out, T, DOUBLE_THRESHOLD)
+  stdsigmoid_module<T> m2(0, "stdsigmoid", true);
+  TEST_DERIVATIVES(m2, in, out, T, DOUBLE_THRESHOLD)
+}
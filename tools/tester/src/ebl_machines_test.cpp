@@ -31,6 +31,7 @@
  ***************************************************************************/
 
 #include "ebl_machines_test.h"
+#include "hogwild_trainer.h"
 
 using namespace std;
 using namespace ebl;
@@ -68,3 +69,75 @@ void ebl_machines_test::test_full_table() {
   CPPUNIT_ASSERT_EQUAL((intg) 1, m.get(5, 0));
   CPPUNIT_ASSERT_EQUAL((intg) 2, m.get(5, 1));
 }
+
+// Returns a small 2-layer classifier allocated on 'p'.
+static trainable_module<double,double,int>*
+hogwild_machine(ddparameter<double> &p, layers<double> *&net, intg dim) {
+  net = new layers<double>(true);
+  net->add_module(new linear_module<double>(&p, dim, 8));
+  net->add_module(new addc_module<double>(&p, 8));
+  net->add_module(new tanh_module<double>());
+  net->add_module(new linear_module<double>(&p, 8, 2));
+  return new trainable_module<double,double,int>
+    (*new l2_energy<double>, *net, NULL, new class_answer<double,double,int>(2));
+}
+
+void ebl_machines_test::test_hogwild() {
+  intg n = 2000, dim = 10;
+  uint nthreads = 2;
+  // linearly separable samples
+  dseed(1);
+  idx<double> data(n, dim), w(dim);
+  idx<int> labels(n);
+  idx_random(w, -1.0, 1.0);
+  for (intg i = 0; i < n; ++i) {
+    idx<double> s = data.select(0, i);
+    idx_random(s, -1.0, 1.0);
+    labels.set(idx_dot(s, w) > 0 ? 1 : 0, i);
+  }
+  class_datasource<double,double,int> train_ds(data, labels, NULL, "train");
+  class_datasource<double,double,int> test_ds(data, labels, NULL, "test");
+  train_ds.set_balanced(false); // every sample is trained once per epoch
+  test_ds.set_test();
+  // master machine and one machine per worker, sharing the weights
+  ddparameter<double> p;
+  layers<double> *net;
+  trainable_module<double,double,int> *machine = hogwild_machine(p, net, dim);
+  forget_param_linear fp(1, .5, (int) 0 /* fixed seed */);
+  machine->forget(fp);
+  idx<double> weights(p.get_idxdim());
+  idx_copy(p, weights);
+  hogwild_trainer<double,double,int> trainer(*machine, p, true);
+  for (uint i = 0; i < nthreads; ++i) {
+    ddparameter<double> *wp = new ddparameter<double>(p, true);
+    layers<double> *wnet;
+    trainable_module<double,double,int> *m = hogwild_machine(*wp, wnet, dim);
+    trainer.add_worker(wp, wnet, m);
+  }
+  idx_copy(weights, p); // workers allocation may have reset shared weights
+  CPPUNIT_ASSERT_EQUAL(nthreads, trainer.get_nthreads());
+  gd_param gdp(0.05, 0, 0, 0, 0, 0, 0, 0, 0);
+  infer_param infp;
+  classifier_meter trainmeter, testmeter;
+  bool atomic = smart_pointer::atomic_refcount();
+  trainer.test(test_ds, testmeter, infp);
+  // updates of concurrent workers interleave differently at each run, so
+  // energy may not decrease at every epoch, but each epoch must bring it
+  // well below the energy before training.
+  double energy = testmeter.total_energy / testmeter.size;
+  for (int i = 0; i < 3; ++i) {
+    trainer.train(train_ds, trainmeter, gdp, 1, infp);
+    // all samples of the epoch were trained, each by a single thread
+    intg total = 0;
+    for (uint j = 0; j < nthreads; ++j)
+      total += trainer.get_nsamples(j);
+    CPPUNIT_ASSERT_EQUAL(train_ds.get_epoch_size(), total);
+    CPPUNIT_ASSERT_EQUAL(train_ds.get_epoch_count(), total);
+    CPPUNIT_ASSERT_EQUAL(atomic, smart_pointer::atomic_refcount());
+    trainer.test(test_ds, testmeter, infp);
+    double e = testmeter.total_energy / testmeter.size;
+    CPPUNIT_ASSERT(e < energy / 2);
+  }
+  delete machine;
+  delete net;
+}
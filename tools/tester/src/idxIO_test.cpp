@@ -1,3 +1,4 @@
+#include <utime.h>
 #include "idxIO_test.h"
 #include "libidx.h"
 #include "tools_utils.h"
@@ -92,6 +93,43 @@ void idxIO_test::test_save_load_matrix_long() {
   }
 }
 
+void idxIO_test::test_save_load_matrix_half() {
+  idx<float> m(9, 9);
+  float v = -40.1;
+  { idx_aloop1(i, m, float) { *i = v; v += 1; }}
+  idx<float16> h(m.get_idxdim());
+  idx<bfloat16> b(m.get_idxdim());
+  idx_copy(m, h);
+  idx_copy(m, b);
+  try {
+    // same type loading keeps exact bits
+    save_matrix(h, TEST_FILE);
+    idx<float16> lh = load_matrix<float16>(TEST_FILE);
+    { idx_aloop2(i, h, float16, j, lh, float16) {
+	CPPUNIT_ASSERT_EQUAL((*i).bits, (*j).bits);
+      }}
+    // loading into float converts
+    idx<float> lf = load_matrix<float>(TEST_FILE);
+    { idx_aloop2(i, m, float, j, lf, float) {
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(*i, *j, fabs(*i) / 1024);
+      }}
+    save_matrix(b, TEST_FILE);
+    lf = load_matrix<float>(TEST_FILE);
+    { idx_aloop2(i, m, float, j, lf, float) {
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(*i, *j, fabs(*i) / 128);
+      }}
+    // float matrices can be loaded as half
+    save_matrix(m, TEST_FILE);
+    lh = load_matrix<float16>(TEST_FILE);
+    { idx_aloop2(i, h, float16, j, lh, float16) {
+	CPPUNIT_ASSERT_EQUAL((*i).bits, (*j).bits);
+      }}
+  } catch(std::string &err) {
+    std::cerr << err << std::endl;
+    CPPUNIT_ASSERT(false); // err
+  }
+}
+
 void idxIO_test::test_save_load_matrix_matrix() {
   try {
     CPPUNIT_ASSERT_MESSAGE(*gl_data_errmsg, gl_data_dir != NULL);
@@ -180,3 +218,230 @@ void idxIO_test::test_save_load_matrices() {
     CPPUNIT_ASSERT(false); // err
   }
 }
+
+void idxIO_test::test_mapped_loading() {
+  std::string fname = TEST_FILE;
+  idx<double> m(9, 9);
+  double v = 0.1;
+  { idx_aloop1(i, m, double) {
+      *i = v;
+      v++;
+    }
+  }
+  try {
+    // aligned file is readable without mapping
+    rm_file(fname.c_str());
+    CPPUNIT_ASSERT(save_matrix(m, fname.c_str(), 4096));
+    CPPUNIT_ASSERT(has_multiple_matrices(fname.c_str()) == false);
+    check_loading_equal(m, fname);
+    // mapped loading aliases the file
+    set_mapped_loading(true);
+    idx<double> l = load_matrix<double>(fname);
+    CPPUNIT_ASSERT(l.getstorage()->mapped());
+    CPPUNIT_ASSERT_EQUAL((intg) 0, (intg) ((intptr_t) l.idx_ptr() % 4096));
+    check_loading_equal(m, fname);
+    // modifications are not written back to the file
+    idx_clear(l);
+    check_loading_equal(m, fname);
+    // replacing mapped data releases the mapping and owns the new data
+    idx<double> l2 = load_matrix<double>(fname);
+    double *d = (double*) malloc(l2.nelements() * sizeof (double));
+    l2.getstorage()->set_data(d);
+    CPPUNIT_ASSERT(!l2.getstorage()->mapped());
+    CPPUNIT_ASSERT(l2.idx_ptr() == d);
+    // type conversion falls back to regular loading
+    idx<float> f = load_matrix<float>(fname);
+    CPPUNIT_ASSERT(!f.getstorage()->mapped());
+    CPPUNIT_ASSERT_EQUAL((float) m.get(8, 8), f.get(8, 8));
+    // data unaligned for the type falls back to regular loading
+    rm_file(fname.c_str());
+    save_matrix(m, fname);
+    idx<double> u = load_matrix<double>(fname);
+    CPPUNIT_ASSERT(!u.getstorage()->mapped());
+    check_loading_equal(m, fname);
+    set_mapped_loading(false);
+  } catch(eblexception &e) {
+    set_mapped_loading(false);
+    std::cerr << e << std::endl;
+    CPPUNIT_ASSERT(false); // err
+  }
+}
+
+void idxIO_test::test_compressed_matrices() {
+  std::string fname = TEST_FILE;
+  // image-like data spanning several chunks
+  idx<ubyte> im(3, 700, 700);
+  for (intg c = 0; c < im.dim(0); ++c)
+    for (intg h = 0; h < im.dim(1); ++h)
+      for (intg w = 0; w < im.dim(2); ++w)
+        im.set((ubyte) (w / 5 + (drand() > .9 ? 1 : 0)), c, h, w);
+  idx<float> f(50, 50);
+  for (intg h = 0; h < f.dim(0); ++h)
+    for (intg w = 0; w < f.dim(1); ++w)
+      f.set(w / (float) 4, h, w);
+  try {
+    set_compressed_saving(true);
+    rm_file(fname.c_str());
+    CPPUNIT_ASSERT(save_matrix(im, fname));
+    CPPUNIT_ASSERT(has_multiple_matrices(fname.c_str()) == false);
+    CPPUNIT_ASSERT(get_matrix_dims(fname.c_str()) == im.get_idxdim());
+    CPPUNIT_ASSERT(file_size(fname) * 3 < (uint) im.nelements());
+    check_loading_equal(im, fname);
+    // mapped loading falls back to decompression
+    set_mapped_loading(true);
+    check_loading_equal(im, fname);
+    set_mapped_loading(false);
+    // non-contiguous matrices and multi-byte types
+    idx<ubyte> n = im.narrow(2, 300, 100);
+    rm_file(fname.c_str());
+    CPPUNIT_ASSERT(save_matrix(n, fname));
+    check_loading_equal(n, fname);
+    rm_file(fname.c_str());
+    CPPUNIT_ASSERT(save_matrix(f, fname));
+    check_loading_equal(f, fname);
+    // casting while loading
+    idx<double> d = load_matrix<double>(fname);
+    CPPUNIT_ASSERT_EQUAL((double) f.get(7, 9), d.get(7, 9));
+    // collections, with an empty element, loaded on demand or not
+    midx<float> all(3);
+    idx<float> part = f.narrow(0, 10, 5);
+    all.mset(f, 0);
+    all.mset(part, 2);
+    rm_file(fname.c_str());
+    CPPUNIT_ASSERT(save_matrices(all, fname));
+    set_compressed_saving(false);
+    CPPUNIT_ASSERT(has_multiple_matrices(fname.c_str()));
+    for (int ondemand = 0; ondemand < 2; ++ondemand) {
+      midx<float> l = load_matrices<float>(fname, ondemand == 1);
+      CPPUNIT_ASSERT(!l.exists(1));
+      idx<float> e = l.mget(2);
+      CPPUNIT_ASSERT(e.get_idxdim() == idxdim(10, 50));
+      CPPUNIT_ASSERT_EQUAL(f.get(14, 7), e.get(9, 7));
+      e = l.mget(0);
+      CPPUNIT_ASSERT_EQUAL(f.get(49, 49), e.get(49, 49));
+    }
+  } catch(eblexception &e) {
+    set_compressed_saving(false);
+    set_mapped_loading(false);
+    std::cerr << e << std::endl;
+    CPPUNIT_ASSERT(false); // err
+  }
+}
+
+void idxIO_test::test_csv_loading() {
+  std::string fname = TEST_FILE;
+  fname += ".csv";
+  std::string cname = csv_cache_name(fname.c_str(), get_magic<double>(),
+                                     true, false, true);
+  std::string fcname = csv_cache_name(fname.c_str(), get_magic<float>(),
+                                      true, false, true);
+  CPPUNIT_ASSERT(cname != fcname);
+  FILE *fp = fopen(fname.c_str(), "wb");
+  CPPUNIT_ASSERT(fp != NULL);
+  fprintf(fp, "a,b,c,d\n1.5,-2e3,,0.1\r\n3,x,,4\n 7,8,,.25e-2\n");
+  fclose(fp);
+  try {
+    // remove empty column, keep lines with missing values
+    rm_file(cname.c_str());
+    rm_file(fcname.c_str());
+    idx<double> m = load_csv_matrix<double>(fname.c_str(), true, false, true,
+                                            true, true);
+    CPPUNIT_ASSERT(m.get_idxdim() == idxdim(3, 3));
+    CPPUNIT_ASSERT_EQUAL(-2000.0, m.get(0, 1));
+    CPPUNIT_ASSERT_EQUAL(0.1, m.get(0, 2));
+    CPPUNIT_ASSERT_EQUAL(0.0, m.get(1, 1));
+    CPPUNIT_ASSERT_EQUAL(7.0, m.get(2, 0));
+    CPPUNIT_ASSERT_EQUAL(0.0025, m.get(2, 2));
+    CPPUNIT_ASSERT(file_exists(cname));
+    // date the csv file back so that caches are more recent, then replace
+    // the double cache by another matrix: it is loaded instead of the csv
+    struct utimbuf past;
+    past.actime = past.modtime = file_modified(fname) - 10;
+    CPPUNIT_ASSERT(utime(fname.c_str(), &past) == 0);
+    idx<double> other(2, 2);
+    idx_fill(other, 42.0);
+    CPPUNIT_ASSERT(save_matrix(other, cname));
+    idx<double> c = load_csv_matrix<double>(fname.c_str(), true, false, true,
+                                            true, true);
+    CPPUNIT_ASSERT(c.get_idxdim() == idxdim(2, 2));
+    CPPUNIT_ASSERT_EQUAL(42.0, c.get(1, 1));
+    // the float cache is separate from the double cache
+    idx<float> f = load_csv_matrix<float>(fname.c_str(), true, false, true,
+                                          true, true);
+    CPPUNIT_ASSERT(f.get_idxdim() == m.get_idxdim());
+    CPPUNIT_ASSERT_EQUAL(0.1f, f.get(0, 2));
+    CPPUNIT_ASSERT(file_exists(fcname));
+    // a csv file modified in the same second as (or after) its cache is
+    // parsed again
+    CPPUNIT_ASSERT(utime(fname.c_str(), NULL) == 0);
+    c = load_csv_matrix<double>(fname.c_str(), true, false, true, true, true);
+    CPPUNIT_ASSERT(c.get_idxdim() == m.get_idxdim());
+    CPPUNIT_ASSERT_EQUAL(0.1, c.get(0, 2));
+    rm_file(cname.c_str());
+    rm_file(fcname.c_str());
+    // keep all columns
+    m = load_csv_matrix<double>(fname.c_str(), true, false, false, true);
+    CPPUNIT_ASSERT(m.get_idxdim() == idxdim(3, 4));
+    CPPUNIT_ASSERT_EQUAL(4.0, m.get(1, 3));
+    // ignore lines with missing values
+    std::string text = "1,2\n3,\n5,6\n";
+    m = parse_csv_matrix<double>(text.c_str(), text.size(), false, true,
+                                 false, true);
+    CPPUNIT_ASSERT(m.get_idxdim() == idxdim(2, 2));
+    CPPUNIT_ASSERT_EQUAL(5.0, m.get(1, 0));
+    // infinities and nans are values, words are missing values
+    text = "1,inf,-Infinity\nnan,x,2\n";
+    m = parse_csv_matrix<double>(text.c_str(), text.size(), false, false,
+                                 false, true);
+    CPPUNIT_ASSERT(m.get_idxdim() == idxdim(2, 3));
+    CPPUNIT_ASSERT(m.get(0, 1) > 0 && isinf(m.get(0, 1)));
+    CPPUNIT_ASSERT(m.get(0, 2) < 0 && isinf(m.get(0, 2)));
+    CPPUNIT_ASSERT(isnan(m.get(1, 0)));
+    CPPUNIT_ASSERT_EQUAL(0.0, m.get(1, 1));
+    // parse in several chunks
+    text = "";
+    for (int i = 0; i < 600000; ++i)
+      text += "1,2.5,3\n";
+    m = parse_csv_matrix<double>(text.c_str(), text.size());
+    CPPUNIT_ASSERT(m.get_idxdim() == idxdim(600000, 3));
+    CPPUNIT_ASSERT_EQUAL(2.5, m.get(599999, 1));
+    CPPUNIT_ASSERT_EQUAL(6.5 * 600000, idx_sum(m));
+  } catch(eblexception &e) {
+    std::cerr << e << std::endl;
+    CPPUNIT_ASSERT(false); // err
+  }
+  rm_file(fname.c_str());
+}
+
+void idxIO_test::test_prefetching() {
+  std::string fname = TEST_FILE;
+  midx<float> all(10);
+  for (int i = 0; i < 10; ++i) {
+    idx<float> m(5, 5);
+    idx_fill(m, (float) i);
+    all.mset(m, i);
+  }
+  rm_file(fname.c_str());
+  CPPUNIT_ASSERT(save_matrices(all, fname));
+  midx<float> data = load_matrices<float>(fname, true);
+  // budget of 3 samples
+  midx_prefetcher<float> p(data, 3 * 25 * sizeof (float));
+  std::vector<intg> order;
+  for (int i = 9; i >= 0; --i) order.push_back(i);
+  p.schedule(order);
+  p.wait();
+  CPPUNIT_ASSERT_EQUAL((intg) (3 * 25 * sizeof (float)), p.bytes());
+  // loaded samples are hits, others are misses
+  for (int i = 9; i >= 0; --i) {
+    if (i == 6) { // let 6, 5 and 4 be loaded, and nothing after
+      p.wait();
+      order.clear();
+      order.push_back(6); order.push_back(5); order.push_back(4);
+      p.schedule(order);
+    }
+    midx<float> s = p.get(i);
+    CPPUNIT_ASSERT_EQUAL((float) i, s.mget(0).get(4, 4));
+  }
+  CPPUNIT_ASSERT_EQUAL((intg) 6, p.hits());
+  CPPUNIT_ASSERT_EQUAL((intg) 4, p.misses());
+}
@@ -62,6 +62,41 @@ void idx_test::test_Srg() {
   CPPUNIT_ASSERT_EQUAL(30, (int) s->size());
 }
 
+// Testing srg with the pooled allocator: alignment, content preservation
+// and no system allocations when resizing buffers in steady state.
+void idx_test::test_Srg_pooled() {
+  srg_alloc_mode mode = srg_allocator::get_mode();
+  srg_allocator::set_mode(SRG_ALLOC_POOLED);
+  srg<double> *s = new srg<double>(10);
+  CPPUNIT_ASSERT_EQUAL(0, (int) (((intg) s->get_data()) % SRG_ALIGNMENT));
+  s->set(3, 42);
+  s->changesize(1000);
+  CPPUNIT_ASSERT_EQUAL(1000, (int) s->size());
+  CPPUNIT_ASSERT_EQUAL(42.0, (double)s->get(3));
+  CPPUNIT_ASSERT_EQUAL(0, (int) (((intg) s->get_data()) % SRG_ALIGNMENT));
+  delete s;
+  // resizing the same buffers twice should only hit the caches
+  intg nallocs = 0;
+  for (uint pass = 0; pass < 2; ++pass) {
+    intg before = srg_allocator::system_allocations();
+    idx<float> a(1, 1), b(1, 1, 1);
+    for (intg i = 10; i < 200; i += 17) {
+      a.resize(i, i);
+      b.resize(3, i / 2 + 1, i);
+    }
+    nallocs = srg_allocator::system_allocations() - before;
+  }
+  CPPUNIT_ASSERT_EQUAL(0, (int) nallocs);
+  // switching modes with live pooled blocks
+  idx<float> c(100);
+  idx_fill(c, (float) 1);
+  srg_allocator::set_mode(SRG_ALLOC_SYSTEM);
+  c.resize(200);
+  CPPUNIT_ASSERT_EQUAL((float) 1, c.get(99));
+  srg_allocator::release();
+  srg_allocator::set_mode(mode);
+}
+
 // Testing idxspec constructors, select, transpose, unfold
 void idx_test::test_IdxSpec() {
   idxspec *sp = new idxspec(5, 4, 3);
@@ -548,3 +583,54 @@ void idx_test::test_view_as_order() {
 		}}}}}}}}}
   CPPUNIT_ASSERT_EQUAL(42, cnt);
 }
+
+void idx_test::test_idx_view() {
+  idx<double> m(3, 4, 5);
+  intg i = 0;
+  { idx_aloop1(it, m, double) { *it = (double) i++; } }
+  // views see the same elements as the idx
+  idx_view<double,3> v(m);
+  CPPUNIT_ASSERT_EQUAL((intg) 60, v.nelements());
+  CPPUNIT_ASSERT_EQUAL(true, v.contiguousp());
+  CPPUNIT_ASSERT_EQUAL(m.get(2, 1, 3), v(2, 1, 3));
+  idx<double> s = m.select(1, 2);
+  idx_view<double,2> vs = v.select(1, 2);
+  CPPUNIT_ASSERT_EQUAL(false, vs.contiguousp());
+  CPPUNIT_ASSERT_EQUAL(s.get(1, 4), vs(1, 4));
+  CPPUNIT_ASSERT_EQUAL(m.get(1, 3, 2), v[1][3](2));
+  idx_view<double,3> vn = v.narrow(2, 2, 3);
+  CPPUNIT_ASSERT_EQUAL(m.get(0, 0, 4), vn(0, 0, 1));
+  // bloop and eloop over views visit elements like their idx counterparts
+  idx<double> m2(3, 4, 5);
+  idx_view<double,3> v2(m2);
+  { view_bloop2(lv, v, lv2, v2) {
+      view_bloop2(llv, lv, llv2, lv2) {
+	view_bloop2(lllv, llv, lllv2, llv2) {
+	  *lllv2 = *lllv;
+	}
+      }
+    }
+  }
+  { idx_aloop2(it, m, double, it2, m2, double) {
+      CPPUNIT_ASSERT_EQUAL(*it, *it2); } }
+  idx_clear(m2);
+  { view_eloop1(lv, v2) {
+      lv(0, 0) = 1;
+    }
+  }
+  double sum = 0;
+  { view_eloop1(lv, v2) {
+      view_eloop1(llv, lv) {
+	view_eloop1(lllv, llv) {
+	  sum += *lllv;
+	}
+      }
+    }
+  }
+  CPPUNIT_ASSERT_EQUAL(5.0, sum);
+  // views keep no reference on the storage
+  int count = m.getstorage()->get_count();
+  { idx_view<double,3> v3 = v;
+    CPPUNIT_ASSERT_EQUAL(m.idx_ptr(), v3.data); }
+  CPPUNIT_ASSERT_EQUAL(count, m.getstorage()->get_count());
+}
@@ -1,4 +1,5 @@
 #include "idxops_test.h"
+#include "filters.h"
 
 using namespace ebl;
 
@@ -367,6 +368,75 @@ void idxops_test::test_idx_m2dotm1() {
     CPPUNIT_ASSERT_EQUAL((T)10.0, o.get());
 }
 
+// Checks o <- alpha . a . b + beta . o computed with idx_gemm against a
+// naive product, for float32 or float64 operands with any strides.
+template <typename T2>
+static void check_gemm(idx<T2> &a, idx<T2> &b, idx<T2> &o, T2 alpha, T2 beta) {
+  intg i = 0;
+  { idx_aloop1(pa, a, T2) { *pa = (T2) ((i++ * 7) % 23) / 11 - 1; }}
+  { idx_aloop1(pb, b, T2) { *pb = (T2) ((i++ * 13) % 19) / 9 - 1; }}
+  { idx_aloop1(po, o, T2) { *po = (T2) ((i++ * 5) % 17) / 8 - 1; }}
+  idx<T2> r(o.dim(0), o.dim(1));
+  for (intg y = 0; y < o.dim(0); ++y)
+    for (intg x = 0; x < o.dim(1); ++x) {
+      double f = 0;
+      for (intg k = 0; k < a.dim(1); ++k)
+	f += (double) a.get(y, k) * (double) b.get(k, x);
+      r.set((T2) (alpha * f + beta * o.get(y, x)), y, x);
+    }
+  idx_gemm(a, b, o, alpha, beta);
+  double tolerance = sizeof (T2) == 4 ? 1e-3 : 1e-9;
+  { idx_aloop2(po, o, T2, pr, r, T2) {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL((double) *pr, (double) *po, tolerance);
+    }}
+}
+
+template <typename T2> static void check_gemm() {
+  // small products, blocked products with edges, transposed operands
+  intg sizes[][3] = { {2, 3, 5}, {7, 33, 19}, {131, 70, 300}, {13, 2100, 9} };
+  for (uint s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s) {
+    intg m = sizes[s][0], n = sizes[s][1], k = sizes[s][2];
+    idx<T2> a(m, k), b(k, n), o(m, n), ta(k, m), tb(n, k), to(n, m);
+    idx<T2> tta = ta.transpose(0, 1), ttb = tb.transpose(0, 1);
+    idx<T2> tto = to.transpose(0, 1);
+    check_gemm(a, b, o, (T2) 1, (T2) 0);
+    check_gemm(tta, b, o, (T2) 1, (T2) 1);
+    check_gemm(a, ttb, tto, (T2) .5, (T2) 2);
+    check_gemm(tta, ttb, o, (T2) -1, (T2) 0);
+  }
+  // matrix-matrix product and accumulation
+  idx<T2> a(4, 3), b(3, 5), o(4, 5);
+  idx_fill(a, (T2) 2);
+  idx_fill(b, (T2) 1);
+  idx_m2dotm2(a, b, o);
+  { idx_bloop1(o0, o, T2) { idx_bloop1(o1, o0, T2) {
+	CPPUNIT_ASSERT_EQUAL((T2) 6, o1.get()); }}}
+  idx_m2dotm2acc(a, b, o);
+  { idx_bloop1(o0, o, T2) { idx_bloop1(o1, o0, T2) {
+	CPPUNIT_ASSERT_EQUAL((T2) 12, o1.get()); }}}
+}
+
+void idxops_test::test_idx_m2dotm2() {
+  check_gemm<float32>();
+  check_gemm<float64>();
+  // packing buffers of repeated blocked products are served by the caches
+  idx<float32> pa(131, 300), pb(300, 70), po(131, 70);
+  idx_fill(pa, (float32) 1);
+  idx_fill(pb, (float32) 1);
+  idx_m2dotm2(pa, pb, po);
+  intg before = srg_allocator::system_allocations();
+  idx_m2dotm2(pa, pb, po);
+  CPPUNIT_ASSERT_EQUAL(0, (int) (srg_allocator::system_allocations() - before));
+  CPPUNIT_ASSERT_EQUAL((float32) 300, po.get(130, 69));
+  // generic version with non-contiguous output
+  idx<int> a(2, 3), b(3, 4), o(4, 2);
+  idx<int> to = o.transpose(0, 1);
+  idx_fill(a, 2);
+  idx_fill(b, 3);
+  idx_m2dotm2(a, b, to);
+  { idx_aloop1(po, o, int) { CPPUNIT_ASSERT_EQUAL(18, *po); }}
+}
+
 void idxops_test::test_huge_vec() {
 
   // this would not run on many systems
@@ -473,3 +543,356 @@ void idxops_test::test_huge_vec() {
 // 	}
 // 	return 0;
 // }
+
+// Checks elementwise ops of type T2 against scalar results, on 'a', 'b' and
+// 'out' which are either all contiguous or all strided.
+template <typename T2>
+static void check_elementwise(idx<T2> &a, idx<T2> &b, idx<T2> &out,
+			      double tolerance) {
+  T2 k1 = (T2) 3, k2 = (T2) 5;
+  idx<T2> r(out.get_idxdim());
+  intg i = 0;
+  { idx_aloop2(pa, a, T2, pb, b, T2) {
+      *pa = (T2) ((i * 7) % 23 + 1);
+      *pb = (T2) ((i * 13) % 19 + 2);
+      i++;
+    }}
+#define CHECK_OP(call, expr) {						\
+    call;								\
+    idx_aloop4(pa, a, T2, pb, b, T2, po, out, T2, pr, r, T2) {		\
+      *pr = (T2) (expr);						\
+      CPPUNIT_ASSERT_DOUBLES_EQUAL((double) *pr, (double) *po, tolerance); \
+    }}
+  CHECK_OP(idx_add(a, b, out), *pa + *pb);
+  CHECK_OP(idx_sub(a, b, out), *pa - *pb);
+  CHECK_OP(idx_mul(a, b, out), *pa * *pb);
+  CHECK_OP(idx_addc(a, k1, out), *pa + k1);
+  CHECK_OP(idx_dotc(a, k2, out), *pa * k2);
+  CHECK_OP(idx_lincomb(a, k1, b, k2, out), k1 * *pa + k2 * *pb);
+  CHECK_OP(idx_copy(b, out); idx_add(a, out), *pa + *pb);
+  CHECK_OP(idx_copy(a, out); idx_sub(out, b), *pa - *pb);
+#undef CHECK_OP
+}
+
+template <typename T2> static void check_elementwise(double tolerance) {
+  // odd size to exercise the scalar tail of vector loops
+  idx<T2> a(1037), b(1037), out(1037);
+  check_elementwise(a, b, out, tolerance);
+  idx<T2> sa(23, 41), sb(41, 23), sout(41, 23);
+  idx<T2> ta = sa.transpose(0, 1);
+  idx<T2> nb = sb.narrow(1, 20, 3), nout = sout.narrow(1, 20, 3);
+  idx<T2> na = ta.narrow(1, 20, 1);
+  check_elementwise(na, nb, nout, tolerance);
+}
+
+void idxops_test::test_simd_ops() {
+#ifdef __SIMD__
+  simd_level max = simd_max_level();
+  for (int l = SIMD_NONE; l <= max; ++l) {
+    simd_set_level((simd_level) l);
+    CPPUNIT_ASSERT_EQUAL(l, (int) simd_get_level());
+    check_elementwise<float32>(1e-5);
+    check_elementwise<float64>(1e-12);
+    check_elementwise<ubyte>(0);
+  }
+  simd_set_level(max);
+#endif
+}
+
+// Checks lazy expressions of 'a' and 'b' against the eager ops, evaluated
+// into 'out' and 'out2'.
+static void check_eval(idx<float> &a, idx<float> &b, idx<float> &out,
+		       idx<float> &out2) {
+  idx<float> r(out.get_idxdim()), r2(out.get_idxdim());
+  intg i = 0;
+  { idx_aloop2(pa, a, float, pb, b, float) {
+      *pa = (float) ((i * 7) % 23) - 11;
+      *pb = (float) ((i * 13) % 19 + 2);
+      i++;
+    }}
+  // single output: out = (a + b) * a - 2 * b / 4
+  idx_eval(out, (idx_lazy(a) + idx_lazy(b)) * idx_lazy(a)
+	   - (float) 2 * idx_lazy(b) / (float) 4);
+  idx_add(a, b, r);
+  idx_mul(r, a, r);
+  idx_dotc(b, (float) .5, r2);
+  idx_sub(r, r2, r);
+  { idx_aloop2(po, out, float, pr, r, float) {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(*pr, *po, 1e-5);
+    }}
+  // two outputs, the second reading the first: out = sqrt(b) + sign(a),
+  // out2 = -a / out
+  idx_eval(out, lazy_sqrt(idx_lazy(b)) + lazy_sign(idx_lazy(a)),
+	   out2, -idx_lazy(a) / idx_lazy(out));
+  { idx_aloop4(pa, a, float, pb, b, float, po, out, float, po2, out2, float) {
+      float e = sqrt(*pb) + (*pa < 0 ? -1 : 1);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(e, *po, 1e-5);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(-*pa / e, *po2, 1e-5);
+    }}
+  // in-place update
+  idx_copy(a, r);
+  idx_eval(a, idx_lazy(a) * idx_lazy(a) + (float) 1);
+  { idx_aloop2(pa, a, float, pr, r, float) {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(*pr * *pr + 1, *pa, 1e-5);
+    }}
+}
+
+void idxops_test::test_idx_eval() {
+  idx<float> a(1037), b(1037), out(1037), out2(1037);
+  check_eval(a, b, out, out2);
+  idx<float> sa(23, 41), sb(41, 23), sout(41, 23), sout2(41, 23);
+  idx<float> ta = sa.transpose(0, 1);
+  idx<float> na = ta.narrow(1, 20, 1), nb = sb.narrow(1, 20, 3);
+  idx<float> nout = sout.narrow(1, 20, 3), nout2 = sout2.narrow(1, 20, 2);
+  check_eval(na, nb, nout, nout2);
+}
+
+// Checks idx_2dconvol() of 'in' with 'kernel' against a direct convolution.
+static void check_2dconvol(idx<double> &in, idx<double> &kernel) {
+  intg ki = kernel.dim(0), kj = kernel.dim(1);
+  idx<double> out(in.dim(0) - ki + 1, in.dim(1) - kj + 1);
+  idx_2dconvol(in, kernel, out);
+  for (intg i = 0; i < out.dim(0); ++i)
+    for (intg j = 0; j < out.dim(1); ++j) {
+      double s = 0;
+      for (intg a = 0; a < ki; ++a)
+	for (intg b = 0; b < kj; ++b)
+	  s += in.get(i + a, j + b) * kernel.get(a, b);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(s, out.get(i, j), 1e-9);
+    }
+}
+
+void idxops_test::test_idx_2dconvol() {
+  idx<double> in(37, 29);
+  intg n = 0;
+  { idx_aloop1(p, in, double) {
+      *p = (double) ((n * 7) % 23) - 11;
+      n++;
+    }}
+  // separable kernels
+  idx<double> g = create_gaussian_kernel<double>(5), col, row;
+  CPPUNIT_ASSERT(idx_separable(g, col, row));
+  check_2dconvol(in, g);
+  idx<double> ba = create_burt_adelson_kernel<double>();
+  CPPUNIT_ASSERT(idx_separable(ba, col, row));
+  check_2dconvol(in, ba);
+  idx<double> g2 = create_gaussian_kernel<double>((uint) 3, (uint) 7);
+  check_2dconvol(in, g2);
+  // box kernel
+  idx<double> box(4, 6);
+  idx_fill(box, .25);
+  check_2dconvol(in, box);
+  // non-separable kernel, on a transposed input
+  idx<double> m = create_mexican_hat<double>(1, 5);
+  CPPUNIT_ASSERT(!idx_separable(m, col, row));
+  idx<double> tin = in.transpose(0, 1);
+  check_2dconvol(tin, m);
+  check_2dconvol(tin, g);
+}
+
+void idxops_test::test_random() {
+  // philox known-answer vectors
+  uint32 c0[4] = { 0, 0, 0, 0 }, k0[2] = { 0, 0 }, out[4];
+  uint32 e0[4] = { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 };
+  philox4x32(c0, k0, out);
+  for (int i = 0; i < 4; ++i) CPPUNIT_ASSERT_EQUAL(e0[i], out[i]);
+  uint32 c1[4] = { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff };
+  uint32 k1[2] = { 0xffffffff, 0xffffffff };
+  uint32 e1[4] = { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd };
+  philox4x32(c1, k1, out);
+  for (int i = 0; i < 4; ++i) CPPUNIT_ASSERT_EQUAL(e1[i], out[i]);
+  // same seed and stream give the same sequence, other streams differ
+  ebl::random r1, r2, r3;
+  r1.seed(42, 3);
+  r2.seed(42, 3);
+  r3.seed(42, 4);
+  idx<double> d(1001);
+  intg same = 0;
+  { idx_aloop1(p, d, double) {
+      *p = r1.drand();
+      CPPUNIT_ASSERT_EQUAL(*p, r2.drand());
+      if (*p == r3.drand()) same++;
+      CPPUNIT_ASSERT(*p >= 0 && *p < 1);
+    }}
+  CPPUNIT_ASSERT(same < 2);
+  // bulk fills continue the sequence at the next block, with all simd levels
+  uint64 ctr = r1.get_counter();
+  idx<double> fd(1001);
+  idx<float> ff(37, 29);
+  idx<float> nf = ff.transpose(0, 1).narrow(0, 20, 3);
+  r2.set_counter(ctr);
+#ifdef __SIMD__
+  simd_level max = simd_max_level();
+  for (int l = SIMD_NONE; l <= max; ++l) {
+    simd_set_level((simd_level) l);
+#endif
+    r1.set_counter(ctr);
+    r1.fill_uniform(fd, -2, 3);
+    { idx_aloop1(p, fd, double) {
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(-2 + 5 * r2.drand(), *p, 1e-12);
+      }}
+    r1.set_counter(ctr);
+    r1.fill_uniform(ff);
+    double mean = idx_sum(ff) / ff.nelements();
+    CPPUNIT_ASSERT(idx_min(ff) >= 0 && idx_max(ff) <= 1);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(.5, mean, .02);
+    r1.fill_gauss(d, 1, 2);
+    mean = idx_sum(d) / d.nelements();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1, mean, .2);
+    double var = 0;
+    { idx_aloop1(p, d, double) { var += (*p - mean) * (*p - mean); }}
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(4, var / d.nelements(), .5);
+    // non-contiguous and integer fills
+    idx_clear(ff);
+    r1.fill_uniform(nf, 1, 2);
+    CPPUNIT_ASSERT(idx_min(nf) >= 1);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(20 * 37 * 1.5, idx_sum(ff), 20 * 37 * .1);
+    idx<ubyte> u(100);
+    r1.fill_uniform(u, 10, 20);
+    CPPUNIT_ASSERT(idx_min(u) >= 10 && idx_max(u) <= 20);
+    r2.set_counter(ctr);
+#ifdef __SIMD__
+  }
+  simd_set_level(max);
+#endif
+  // per-thread generators are reseeded deterministically
+  thread_random_seed(7);
+  double t = thread_random().drand();
+  thread_random_seed(7);
+  CPPUNIT_ASSERT_EQUAL(t, thread_random().drand());
+}
+
+void idxops_test::test_half() {
+  // exact values, rounding to nearest even, overflow and subnormals
+  CPPUNIT_ASSERT_EQUAL((uint16) 0x3c00, float16(1.0).bits);
+  CPPUNIT_ASSERT_EQUAL((uint16) 0xc000, float16(-2.0).bits);
+  CPPUNIT_ASSERT_EQUAL((uint16) 0x7bff, float16(65504.0).bits);
+  CPPUNIT_ASSERT_EQUAL((uint16) 0x7c00, float16(65520.0).bits);
+  CPPUNIT_ASSERT_EQUAL((uint16) 0x3c00, float16(1 + ldexp(1.0, -11)).bits);
+  CPPUNIT_ASSERT_EQUAL((uint16) 0x3c02, float16(1 + 3 * ldexp(1.0, -11)).bits);
+  CPPUNIT_ASSERT_EQUAL((uint16) 0x0001, float16(ldexp(1.0, -24)).bits);
+  CPPUNIT_ASSERT_EQUAL((uint16) 0x0000, float16(ldexp(1.0, -25)).bits);
+  CPPUNIT_ASSERT_EQUAL((uint16) 0x3f80, bfloat16(1.0).bits);
+  CPPUNIT_ASSERT_EQUAL((uint16) 0x3f80, bfloat16(1 + ldexp(1.0, -8)).bits);
+  CPPUNIT_ASSERT_EQUAL((uint16) 0x3f82, bfloat16(1 + 3 * ldexp(1.0, -8)).bits);
+  CPPUNIT_ASSERT((float) float16(1e10) == INFINITY);
+  CPPUNIT_ASSERT(isnan((float) float16(NAN)));
+  CPPUNIT_ASSERT(isnan((float) bfloat16(NAN)));
+  // all half values convert to float and back exactly, bulk conversions
+  // of random floats match the scalar ones, with all simd levels
+  idx<float16> h(65536), h2(65536);
+  idx<bfloat16> b(65536), b2(65536);
+  idx<float> f(65536), r(1001), r2(1001);
+  for (intg i = 0; i < 65536; ++i) {
+    h.ptr(i)->bits = (uint16) i;
+    b.ptr(i)->bits = (uint16) i;
+  }
+  ebl::random g;
+  g.seed(3);
+  g.fill_gauss(r, 0, 1e3);
+  r.set(65519.99, 0);
+  r.set(-1e-6, 1);
+  idx<float> r3(500, 2), nr = r3.select(1, 0);
+  idx<float16> h3(500, 2), nh = h3.select(1, 1);
+  idx<float16> hr = h2.narrow(0, 1001, 0);
+  idx<bfloat16> br = b2.narrow(0, 1001, 0);
+  g.fill_uniform(nr, -1, 1);
+#ifdef __SIMD__
+  simd_level max = simd_max_level();
+  for (int l = SIMD_NONE; l <= max; ++l) {
+    simd_set_level((simd_level) l);
+#endif
+    idx_copy(h, f);
+    idx_copy(f, h2);
+    for (intg i = 0; i < 65536; ++i) {
+      if (isnan(f.get(i)))
+	CPPUNIT_ASSERT(isnan((float) h2.get(i)));
+      else {
+	CPPUNIT_ASSERT_EQUAL(float16_bits_to_float32((uint16) i), f.get(i));
+	CPPUNIT_ASSERT_EQUAL((uint16) i, h2.ptr(i)->bits);
+      }
+    }
+    idx_copy(b, f);
+    idx_copy(f, b2);
+    for (intg i = 0; i < 65536; ++i)
+      if (!isnan(f.get(i)))
+	CPPUNIT_ASSERT_EQUAL((uint16) i, b2.ptr(i)->bits);
+    idx_copy(r, hr);
+    idx_copy(r, br);
+    for (intg i = 0; i < 1001; ++i) {
+      CPPUNIT_ASSERT_EQUAL(float32_to_float16_bits(r.get(i)), h2.ptr(i)->bits);
+      CPPUNIT_ASSERT_EQUAL(float32_to_bfloat16_bits(r.get(i)),
+			   b2.ptr(i)->bits);
+    }
+    idx_copy(hr, r2);
+    { idx_aloop2(i, r, float, j, r2, float) {
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(*i, *j, fabs(*i) / 2048 + 1e-7);
+      }}
+    // non-contiguous copies
+    idx_copy(nr, nh);
+    for (intg i = 0; i < 500; ++i)
+      CPPUNIT_ASSERT_EQUAL(float32_to_float16_bits(nr.get(i)),
+			   nh.ptr(i)->bits);
+#ifdef __SIMD__
+  }
+  simd_set_level(max);
+#endif
+}
+
+void idxops_test::test_gemm_s8() {
+  // symmetric rounding and saturation
+  float vals[6] = { 0.5, -1.26, 1.24, 0.004, 200, -200 };
+  byte expected[6] = { 50, -126, 124, 0, 127, -127 };
+  idx<float> x(6);
+  idx<byte> qx(6);
+  for (intg i = 0; i < 6; ++i) x.set(vals[i], i);
+  idx_quantize_s8(x, qx, (float) .01);
+  for (intg i = 0; i < 6; ++i)
+    CPPUNIT_ASSERT_EQUAL((int) expected[i], (int) qx.get(i));
+  // per-row scales
+  idx<float> w(2, 3), ws;
+  idx<byte> qw;
+  idx_clear(w);
+  w.set(-2.54, 0, 0);
+  w.set(1.0, 0, 1);
+  idx_quantize_rows_s8(w, qw, ws);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(.02, ws.get(0), 1e-7);
+  CPPUNIT_ASSERT_EQUAL(1.0f, ws.get(1));
+  CPPUNIT_ASSERT_EQUAL(-127, (int) qw.get(0, 0));
+  CPPUNIT_ASSERT_EQUAL(50, (int) qw.get(0, 1));
+  CPPUNIT_ASSERT_EQUAL(0, (int) qw.get(1, 2));
+  // products against exact integer products, with odd sizes so that all
+  // simd tails are used, and with extreme values over a long dimension
+  ebl::random g;
+  g.seed(5);
+  intg sizes[3][3] = { {9, 14, 45}, {3, 4, 1}, {5, 8, 1000} };
+  for (int t = 0; t < 3; ++t) {
+    intg m = sizes[t][0], n = sizes[t][1], k = sizes[t][2];
+    idx<byte> a(m, k), bt(n, k);
+    idx<float> r(m * k + n * k), c(m, n), s(m);
+    g.fill_uniform(r, -127.49, 127.49);
+    float *pr = r.idx_ptr();
+    { idx_aloop1(i, a, byte) { *i = (byte) (t == 2 ? -127 : *pr++); }}
+    { idx_aloop1(i, bt, byte) { *i = (byte) (t == 2 ? -127 : *pr++); }}
+    g.fill_uniform(s, .5, 2);
+#ifdef __SIMD__
+    simd_level max = simd_max_level();
+    for (int l = SIMD_NONE; l <= max; ++l) {
+      simd_set_level((simd_level) l);
+#endif
+      idx_fill(c, 1);
+      idx_gemm_s8(a, bt, c, s);
+      for (intg i = 0; i < m; ++i)
+	for (intg j = 0; j < n; ++j) {
+	  double sum = 0;
+	  for (intg p = 0; p < k; ++p)
+	    sum += (double) a.get(i, p) * bt.get(j, p);
+	  double e = 1 + s.get(i) * sum;
+	  CPPUNIT_ASSERT_DOUBLES_EQUAL(e, c.get(i, j), fabs(e) * 1e-6);
+	}
+#ifdef __SIMD__
+    }
+    simd_set_level(max);
+#endif
+  }
+}
@@ -1057,6 +1057,51 @@ void idxops_test2::idx_dstdsigmoid2() {
 }
 
 
+// Checks idx_tanh_fast() and idx_dtanh_fast() of 'm1' against b * tanh(a x)
+// and its derivative, and the derivative against finite differences.
+template <typename T> void test_tanh_fast(idx<T> m1, T a, T b, double tol) {
+  idx<T> mt(m1.get_idxdim()), md(m1.get_idxdim());
+  idx_tanh_fast(m1, mt, a, b);
+  idx_dtanh_fast(m1, md, a, b);
+  double h = 1e-4;
+  { idx_aloop3(x, m1, T, y, mt, T, d, md, T) {
+      double e = b * tanh(a * (double) *x);
+      double de = a * b * dtanh(a * (double) *x);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(e, (double) *y, tol * b);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(de, (double) *d, 2 * tol * a * b);
+      double fd = b * (tanh_fast(a * (*x + h)) - tanh_fast(a * (*x - h)))
+	/ (2 * h);
+      if (std::abs(a * *x) < TANH_FAST_CLAMP - a * h)
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(fd, (double) *d, 20 * tol * a * b);
+    }}
+}
+
+template <typename T> void test_tanh_fast(intg n) {
+  // values spanning [-8, 8], contiguous and not
+  idx<T> m(n, 3), t(3, n);
+  intg i = 0;
+  { idx_aloop1(x, m, T) { *x = (T) (16.0 * i++ / m.nelements() - 8); }}
+  idx<T> tt = t.transpose(0, 1);
+  idx_copy(m, tt);
+  test_tanh_fast<T>(m, 1, 1, 1e-4);
+  test_tanh_fast<T>(tt, 1, 1, 1e-4);
+  test_tanh_fast<T>(m, (T) STDSIGMOID_A, (T) STDSIGMOID_B, 1e-4);
+}
+
+void idxops_test2::idx_tanh_fast2() {
+#ifdef __SIMD__
+  simd_level max = simd_max_level();
+  for (int l = SIMD_NONE; l <= max; ++l) {
+    simd_set_level((simd_level) l);
+#endif
+    test_tanh_fast<float32>(1037);
+    test_tanh_fast<float64>(1037);
+#ifdef __SIMD__
+  }
+  simd_set_level(max);
+#endif
+}
+
 template <typename T> void test_abs(intg i1, intg i2, intg i3, intg i4,
 				     idx<T> m1) {
   idx<T> mt(i1, i2, i3, i4);
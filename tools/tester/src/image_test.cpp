@@ -3,6 +3,7 @@
 #define __SHOW__
 
 #include "ebl_preprocessing.h"
+#include "camera_directory.h"
 #ifdef __GUI__
 #include "libidxgui.h"
 #endif
@@ -197,7 +198,232 @@ void image_test::test_pnm_P6() {
 	}
 }
 
+void image_test::test_image_decode() {
+	try {
+		CPPUNIT_ASSERT_MESSAGE(*gl_data_errmsg, gl_data_dir != NULL);
+		string imgfile = *gl_data_dir;
+		imgfile += "/pnm/rgb_P6.ppm";
+		idx<ubyte> im;
+		CPPUNIT_ASSERT(image_decode(imgfile.c_str(), im));
+		CPPUNIT_ASSERT(im.get(0, 0, 0) == 255);
+		CPPUNIT_ASSERT(im.get(0, 1, 1) == 255);
+		CPPUNIT_ASSERT(im.get(0, 2, 2) == 255);
+		CPPUNIT_ASSERT(im.get(0, 2, 0) == 0);
+#ifdef __PNG__
+		imgfile = *gl_data_dir;
+		imgfile += "/barn.png";
+		CPPUNIT_ASSERT(image_decode(imgfile.c_str(), im));
+		CPPUNIT_ASSERT(im.order() == 3 && im.dim(2) == 3);
+		// alpha is dropped, (semi-)transparent pixels keep their color
+		imgfile = *gl_data_dir;
+		imgfile += "/rgba.png";
+		CPPUNIT_ASSERT(image_decode(imgfile.c_str(), im));
+		CPPUNIT_ASSERT(im.get_idxdim() == idxdim(2, 3, 3));
+		CPPUNIT_ASSERT(im.get(0, 0, 0) == 255 && im.get(0, 0, 1) == 0);
+		CPPUNIT_ASSERT(im.get(0, 1, 1) == 255 && im.get(0, 1, 2) == 0);
+		CPPUNIT_ASSERT(im.get(0, 2, 2) == 255 && im.get(0, 2, 0) == 0);
+		CPPUNIT_ASSERT(im.get(1, 0, 2) == 30);
+		CPPUNIT_ASSERT(im.get(1, 1, 0) == 200 && im.get(1, 1, 1) == 100
+									 && im.get(1, 1, 2) == 50);
+		CPPUNIT_ASSERT(im.get(1, 2, 0) == 255 && im.get(1, 2, 1) == 255);
+#endif
+#ifdef __JPEG__
+		imgfile = *gl_data_dir;
+		imgfile += "/reagan.jpg";
+		idx<ubyte> full, small;
+		CPPUNIT_ASSERT(image_decode(imgfile.c_str(), full));
+		// decoder may only downscale while staying above requested size
+		CPPUNIT_ASSERT(image_decode(imgfile.c_str(), small, 30, 30));
+		CPPUNIT_ASSERT(small.dim(0) >= 30 && small.dim(1) >= 30);
+		CPPUNIT_ASSERT(small.dim(0) <= full.dim(0) / 2);
+		CPPUNIT_ASSERT(small.dim(2) == 3);
+#endif
+		// unknown formats are left to the external fallback
+		imgfile = *gl_data_dir;
+		imgfile += "/tables/table_6_16_connect_60.mat";
+		CPPUNIT_ASSERT(!image_decode(imgfile.c_str(), im));
+	} catch(string &err) {
+		cerr << err << endl;
+		CPPUNIT_ASSERT(false);
+	}
+}
+
+void image_test::test_color_conversions() {
+	// whole-image conversions against the per-pixel ones, on an odd width
+	// to exercise vector remainders and on interleaved (strided) pixels
+	intg h = 7, w = 37;
+	idx<ubyte> rgb8(h, w, 3);
+	idx<float> rgb(h, w, 3);
+	dseed(1);
+	{ idx_aloop2(i8, rgb8, ubyte, i, rgb, float) {
+			*i8 = (ubyte) drand(0, 255);
+			*i = (float) *i8;
+		}}
+	idx<float> ref(h, w, 3), refy(h, w, 1), refbgr(h, w, 3), refh(h, w);
+	{ idx_bloop4(r, rgb, float, y, ref, float, yy, refy, float,
+							 b, refbgr, float) {
+			{ idx_bloop4(rr, r, float, yr, y, float, yyr, yy, float,
+									 br, b, float) {
+					rgb_to_yuv_1D(rr, yr);
+					rgb_to_y_1D(rr, yyr);
+					idx<float> bgr(3);
+					bgr.set(rr.get(2), 0); bgr.set(rr.get(1), 1); bgr.set(rr.get(0), 2);
+					bgr_to_yuv_1D(bgr, br);
+				}}
+		}}
+	{ idx_bloop2(r, rgb, float, hh, refh, float) {
+			{ idx_bloop2(rr, r, float, hr, hh, float) {
+					double hv, sv, vv;
+					PIX_RGB_TO_HSV_COMMON(rr.get(0), rr.get(1), rr.get(2), hv, sv, vv,
+																false);
+					hr.set((float) hv);
+				}}
+		}}
+	// interleaved float and ubyte inputs
+	idx<float> yuv(h, w, 3), yuv8(h, w, 3), y(h, w, 1);
+	rgb_to_yuv_interleaved(rgb, yuv);
+	rgb_to_yuv_interleaved(rgb8, yuv8);
+	rgb_to_y_interleaved(rgb8, y);
+	CPPUNIT_ASSERT(idx_sqrdist(yuv, ref) < 1e-3);
+	CPPUNIT_ASSERT(idx_sqrdist(yuv8, ref) < 1e-3);
+	CPPUNIT_ASSERT(idx_sqrdist(y, refy) < 1e-3);
+	// planar, as used by the preprocessing modules
+	idx<float> prgb = rgb.shift_dim(2, 0), pref = ref.shift_dim(2, 0);
+	idx<float> pyuv(3, h, w), py(1, h, w), crgb(3, h, w), ph(h, w);
+	idx_copy(prgb, crgb); // contiguous planar input
+	rgb_to_yuv_planar(crgb, pyuv);
+	CPPUNIT_ASSERT(idx_sqrdist(pyuv, pref) < 1e-3);
+	rgb_to_y_planar(prgb, py);
+	idx<float> pyy = py.select(0, 0), ry = refy.select(2, 0);
+	CPPUNIT_ASSERT(idx_sqrdist(pyy, ry) < 1e-3);
+	idx<float> bgrp(3, h, w);
+	for (int c = 0; c < 3; ++c) {
+		idx<float> dst = bgrp.select(0, c), src = prgb.select(0, 2 - c);
+		idx_copy(src, dst);
+	}
+	bgr_to_yuv_planar(bgrp, pyuv);
+	idx<float> prefbgr = refbgr.shift_dim(2, 0);
+	CPPUNIT_ASSERT(idx_sqrdist(pyuv, prefbgr) < 1e-3);
+	rgb_to_h_planar(prgb, ph);
+	CPPUNIT_ASSERT(idx_sqrdist(ph, refh) < 1e-3);
+	// double outputs are computed exactly as the per-pixel versions
+	idx<double> dyuv(h, w, 3);
+	rgb_to_yuv_interleaved(rgb8, dyuv);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(ref.get(3, 5, 1), dyuv.get(3, 5, 1), 1e-4);
+}
+
 typedef double t_gdata;
+void image_test::test_resampler() {
+	// channels-first image viewed as (h x w x c), as in resize_module
+	idx<float> planar(3, 23, 31);
+	dseed(2);
+	{ idx_aloop1(p, planar, float) {
+			*p = (float) drand(-1, 1);
+		}}
+	idx<float> in = planar.shift_dim(0, 2), cin(23, 31, 3);
+	idx_copy(in, cin);
+	resampler<float> rs;
+	// bilinear: same values as the warp used for integer images
+	intg sizes[4][2] = { { 11, 17 }, { 40, 9 }, { 23, 31 }, { 1, 2 } };
+	for (int s = 0; s < 4; ++s) {
+		intg oh = sizes[s][0], ow = sizes[s][1];
+		idx<float> warped(oh, ow, 3), bg(4);
+		idx_clear(bg);
+		image_warp_quad(cin, warped, bg, 1, -.5f, -.5f, 30.5f, -.5f, 30.5f, 22.5f,
+										-.5f, 22.5f, -.5f, -.5f, ow - .5f, oh - .5f);
+		idx<float> r = rs.bilinear(in, oh, ow);
+		idx<float> r2 = image_resize(in, (double) oh, (double) ow, 1, NULL,
+																 NULL, &rs);
+		CPPUNIT_ASSERT_EQUAL((double) 0, (double) idx_sqrdist(warped, r));
+		CPPUNIT_ASSERT_EQUAL((double) 0, (double) idx_sqrdist(warped, r2));
+	}
+	// mean: bilinear resizing to 2x the target then means of 2x2 blocks
+	idx<float> big = rs.bilinear(in, 14, 20), mref(7, 10, 3);
+	for (intg i = 0; i < 7; ++i)
+		for (intg j = 0; j < 10; ++j)
+			for (intg k = 0; k < 3; ++k)
+				mref.set((big.get(2*i, 2*j, k) + big.get(2*i+1, 2*j, k)
+									+ big.get(2*i, 2*j+1, k) + big.get(2*i+1, 2*j+1, k)) / 4,
+								 i, j, k);
+	idx<float> m = rs.mean(in, 14, 20, 2);
+	CPPUNIT_ASSERT(idx_sqrdist(m, mref) < 1e-8);
+	// gaussian: bilinear resizing then 2 pyramid reductions
+	gaussian_pyramid<float> gp;
+	idx<float> mid = rs.bilinear(in, 21, 29), gref;
+	mid = mid.shift_dim(2, 0);
+	gref = gp.reduce(mid, 2);
+	gref = gref.shift_dim(0, 2);
+	idx<float> g = rs.gaussian(in, 21, 29, 2);
+	CPPUNIT_ASSERT(g.get_idxdim() == gref.get_idxdim());
+	CPPUNIT_ASSERT(idx_sqrdist(g, gref) < 1e-8);
+	// grayscale images keep their order
+	idx<float> gray = in.select(2, 1), gr = rs.bilinear(gray, 5, 6);
+	CPPUNIT_ASSERT_EQUAL(2, gr.order());
+	idx<float> r = rs.bilinear(in, 5, 6), r1 = r.select(2, 1);
+	CPPUNIT_ASSERT_EQUAL((double) 0, (double) idx_sqrdist(gr, r1));
+}
+
+void image_test::test_resampler_pyramid() {
+	// smooth rgb image, channels first as given to resizepp_module
+	idx<float> planar(3, 60, 80);
+	for (intg k = 0; k < 3; ++k)
+		for (intg i = 0; i < 60; ++i)
+			for (intg j = 0; j < 80; ++j)
+				planar.set((float) (128 + 100 * sin(.1 * i + k) * cos(.07 * j)),
+									 k, i, j);
+	idx<float> in = planar.shift_dim(0, 2);
+	// scales derived from each other have the sizes of direct resizings
+	// and differ by less than 1% of the image's variance (2500)
+	resampler<float> direct, pyr, pyrm, pyrg;
+	pyr.set_pyramid(true);
+	pyrm.set_pyramid(true);
+	pyrg.set_pyramid(true);
+	double s = 1;
+	for (int i = 0; i < 8; ++i, s /= 1.25) {
+		intg h = (intg) (60 * s), w = (intg) (80 * s);
+		idx<float> r = direct.bilinear(in, h, w), p = pyr.bilinear(in, h, w);
+		CPPUNIT_ASSERT(r.get_idxdim() == p.get_idxdim());
+		CPPUNIT_ASSERT(idx_sqrdist(r, p) / r.nelements() < 25);
+		r = direct.mean(in, 2 * h, 2 * w, 2);
+		p = pyrm.mean(in, 2 * h, 2 * w, 2);
+		CPPUNIT_ASSERT(r.get_idxdim() == p.get_idxdim());
+		CPPUNIT_ASSERT(idx_sqrdist(r, p) / r.nelements() < 25);
+		r = direct.gaussian(in, 2 * h, 2 * w, 1);
+		p = pyrg.gaussian(in, 2 * h, 2 * w, 1);
+		CPPUNIT_ASSERT(r.get_idxdim() == p.get_idxdim());
+		CPPUNIT_ASSERT(idx_sqrdist(r, p) / r.nelements() < 25);
+	}
+	// other images are resampled directly
+	idx<float> other = in.narrow(0, 30, 0);
+	idx<float> o1 = direct.bilinear(other, 10, 20);
+	idx<float> o2 = pyr.bilinear(other, 10, 20);
+	CPPUNIT_ASSERT_EQUAL((double) 0, (double) idx_sqrdist(o1, o2));
+	// resizepp: rgb to y conversion done once, same regions
+	resizepp_module<float> rdirect(MEAN_RESIZE, new rgb_to_y_module<float>(false));
+	resizepp_module<float> rpyr(MEAN_RESIZE, new rgb_to_y_module<float>(false));
+	rpyr.set_pyramid(true);
+	s = 1;
+	for (int i = 0; i < 6; ++i, s /= 1.25) {
+		intg h = (intg) (60 * s), w = (intg) (80 * s);
+		rect<int> outr(0, 0, h, w);
+		idx<float> od(1, h, w), op(1, h, w);
+		rdirect.set_dimensions(h, w);
+		rdirect.set_output_region(outr);
+		rdirect.fprop1(planar, od);
+		rpyr.set_dimensions(h, w);
+		rpyr.set_output_region(outr);
+		rpyr.fprop1(planar, op);
+		CPPUNIT_ASSERT(od.get_idxdim() == op.get_idxdim());
+		rect<int> bd = rdirect.get_original_bbox(), bp = rpyr.get_original_bbox();
+		CPPUNIT_ASSERT(bd.h0 == bp.h0 && bd.w0 == bp.w0
+									 && bd.height == bp.height && bd.width == bp.width);
+		if (i == 0) // same image, conversion only
+			CPPUNIT_ASSERT(idx_sqrdist(od, op) / od.nelements() < 1e-6);
+		else
+			CPPUNIT_ASSERT(idx_sqrdist(od, op) / od.nelements() < 25);
+	}
+}
+
 void image_test::test_gaussian_pyramid() {
 	// TODO: fix test
 	//   CPPUNIT_ASSERT_MESSAGE(*gl_data_errmsg, gl_data_dir != NULL);
@@ -286,6 +512,72 @@ void image_test::test_gaussian_pyramid() {
 	//#endif
 }
 
+#if defined(__BOOST__) && defined(__PTHREAD__)
+// Grab all frames of 'dir' and return their names and first pixel values,
+// decoding with 'nthreads' background threads (0 for sequential grabbing).
+// If 'moves' is true, skip() and previous() are called between grabs.
+static vector<string> grab_directory(const char *dir, bool randomize,
+				     uint npasses, uint nthreads, bool moves) {
+  ostringstream out, err;
+  srand(0); // same random list for each camera
+  camera_directory<ubyte> cam(dir, -1, -1, randomize, npasses, out, err);
+  cam.set_decoding_threads(nthreads);
+  vector<string> frames;
+  for (uint k = 0; !cam.empty(); ++k) {
+    idx<ubyte> f = cam.grab();
+    string s;
+    s << cam.frame_name() << ":" << (int) f.get(0, 0, 0);
+    frames.push_back(s);
+    if (moves && k == 1)
+      cam.skip(2);
+    else if (moves && k == 3)
+      cam.previous();
+  }
+  return frames;
+}
+#endif
+
+void image_test::test_camera_directory() {
+#if defined(__BOOST__) && defined(__PTHREAD__)
+  string dir = "eblearn_tester_camera_directory";
+  uint nimages = 7;
+  vector<string> files;
+  CPPUNIT_ASSERT(mkdir_full(dir.c_str()));
+  for (uint i = 0; i < nimages; ++i) {
+    idx<ubyte> im(4, 5, 3);
+    idx_fill(im, (ubyte) (10 * i + 5));
+    string fname;
+    fname << dir << "/image_" << i << ".ppm";
+    CPPUNIT_ASSERT(save_image_ppm(fname, im));
+    files.push_back(fname);
+  }
+  try {
+    // plain, randomized, multiple passes and skip/previous runs
+    bool randomize[4] = { false, true, false, false };
+    uint npasses[4] = { 1, 1, 2, 1 };
+    bool moves[4] = { false, false, false, true };
+    uint nframes[4] = { nimages, nimages, 2 * nimages, nimages - 1 };
+    for (uint r = 0; r < 4; ++r) {
+      vector<string> ref =
+	grab_directory(dir.c_str(), randomize[r], npasses[r], 0, moves[r]);
+      CPPUNIT_ASSERT_EQUAL((size_t) nframes[r], ref.size());
+      for (uint nthreads = 1; nthreads <= 4; ++nthreads) {
+	vector<string> frames =
+	  grab_directory(dir.c_str(), randomize[r], npasses[r], nthreads,
+			 moves[r]);
+	CPPUNIT_ASSERT(frames == ref);
+      }
+    }
+  } catch(string &err) {
+    cerr << err << endl;
+    CPPUNIT_ASSERT(false);
+  }
+  for (uint i = 0; i < files.size(); ++i)
+    rm_file(files[i].c_str());
+  rm_file(dir.c_str());
+#endif
+}
+
 void image_test::test_deformations() {
 	try {
 		CPPUNIT_ASSERT_MESSAGE(*gl_data_errmsg, gl_data_dir != NULL);
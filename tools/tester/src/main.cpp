@@ -50,6 +50,7 @@
 
 #include "idxIO_test.h"
 #include "idx_test.h"
+#include "smart_test.h"
 #include "idxops_test.h"
 #include "idxops_test2.h"
 #include "ebl_basic_test.h"
@@ -265,6 +266,7 @@ MAIN_QTHREAD(int, argc, char**, argv) {
     // adding test suites
     runner.addTest(idxIO_test::suite());
     runner.addTest(idx_test::suite());
+    runner.addTest(smart_test::suite());
     runner.addTest(idxiter_test::suite());
     runner.addTest(idxops_test::suite());
     runner.addTest(idxops_test2::suite());
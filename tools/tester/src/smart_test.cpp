@@ -0,0 +1,78 @@
+#include "smart_test.h"
+#include "idxops.h"
+#include "thread.h"
+
+using namespace std;
+using namespace ebl;
+
+void smart_test::setUp() {
+}
+
+void smart_test::tearDown() {
+}
+
+// Testing reference counts of storage shared by idx views
+void smart_test::test_refcount() {
+  idx<float> m(4, 5);
+  srg<float> *s = m.getstorage();
+  CPPUNIT_ASSERT_EQUAL(1, s->get_count());
+  {
+    idx<float> r = m.select(0, 1);
+    idx<float> c(r);
+    CPPUNIT_ASSERT_EQUAL(3, s->get_count());
+    svector<idx<float> > v;
+    v.push_back_new(c);
+    CPPUNIT_ASSERT_EQUAL(4, s->get_count());
+  }
+  CPPUNIT_ASSERT_EQUAL(1, s->get_count());
+}
+
+// A thread creating and destroying views on a shared read-only tensor.
+class refcount_thread : public ebl::thread {
+public:
+  refcount_thread(idx<float> &m_, uint niters_)
+    : ebl::thread(NULL, "refcount", false), m(m_), niters(niters_), sum(0) {
+  }
+  virtual ~refcount_thread() {
+  }
+  idx<float> &m; //!< The shared tensor.
+  uint niters; //!< Number of iterations.
+  double sum; //!< Sum of all elements read.
+protected:
+  virtual void execute() {
+    for (uint i = 0; i < niters; ++i) {
+      idx<float> row = m.select(0, i % m.dim(0));
+      idx<float> e = row.narrow(0, 1, i % m.dim(1));
+      svector<idx<float> > v;
+      v.push_back_new(row);
+      v.push_back_new(e);
+      idx<float> copy(e);
+      sum += copy.get(0);
+    }
+  }
+};
+
+// Hammering shared idx views from many threads with atomic refcounts
+void smart_test::test_atomic_refcount_threads() {
+  bool atomic = smart_pointer::atomic_refcount();
+  smart_pointer::set_atomic_refcount(true);
+  uint nthreads = 8, niters = 200000;
+  idx<float> m(10, 10);
+  idx_fill(m, (float) 1);
+  srg<float> *s = m.getstorage();
+  vector<refcount_thread*> threads;
+  for (uint i = 0; i < nthreads; ++i)
+    threads.push_back(new refcount_thread(m, niters));
+  for (uint i = 0; i < nthreads; ++i)
+    CPPUNIT_ASSERT_EQUAL(0, threads[i]->start());
+  for (uint i = 0; i < nthreads; ++i)
+    while (!threads[i]->finished())
+      millisleep(5);
+  // all views are gone, only m references the storage
+  CPPUNIT_ASSERT_EQUAL(1, s->get_count());
+  for (uint i = 0; i < nthreads; ++i) {
+    CPPUNIT_ASSERT_EQUAL((double) niters, threads[i]->sum);
+    delete threads[i];
+  }
+  smart_pointer::set_atomic_refcount(atomic);
+}
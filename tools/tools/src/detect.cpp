@@ -116,6 +116,10 @@ MAIN_QTHREAD(int, argc, char **, argv) { // macro to enable multithreaded gui
       uint              ipp_cores     = 1;
       if (conf.exists("ipp_cores")) ipp_cores = conf.get_uint("ipp_cores");
       ipp_init(ipp_cores); // limit IPP (if available) to 1 core
+      if (conf.exists_true("pooled_allocator")) // cache and align tensors
+				srg_allocator::set_mode(SRG_ALLOC_POOLED);
+      if (conf.exists_true("atomic_refcount")) // share tensors between threads
+				smart_pointer::set_atomic_refcount(true);
       bool		save_video    = conf.exists_true("save_video");
       bool              save_detections = conf.exists_true("save_detections");
       int		height        = -1;
@@ -195,6 +199,11 @@ MAIN_QTHREAD(int, argc, char **, argv) { // macro to enable multithreaded gui
 					cam = new camera_directory<ubyte>(dir.c_str(), height, width,
 																						input_random, npasses, mout, merr,
 																						fpattern, &files);
+				// decode and resize next images in the background
+				if (conf.exists("input_decode_threads"))
+					((camera_directory<ubyte>*) cam)->set_decoding_threads
+						(conf.get_uint("input_decode_threads"),
+						 conf.try_get_uint("input_decode_ahead", 0));
       } else if (!strcmp(cam_type.c_str(), "opencv"))
 				cam = new camera_opencv<ubyte>(-1, height, width);
 #ifdef __LINUX__
@@ -0,0 +1,297 @@
+/***************************************************************************
+ *   Copyright (C) 2012 by Pierre Sermanet *
+ *   pierre.sermanet@gmail.com *
+ *   All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Redistribution under a license not approved by the Open Source
+ *       Initiative (http://www.opensource.org) must display the
+ *       following acknowledgement in all advertising material:
+ *        This product includes software developed at the Courant
+ *        Institute of Mathematical Sciences (http://cims.nyu.edu).
+ *     * The names of the authors may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ThE AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ***************************************************************************/
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <stdlib.h>
+#include <sstream>
+#include <iomanip>
+#include <time.h>
+#include "libidx.h"
+#include "libeblearn.h"
+#include "libeblearntools.h"
+#include "eblapp.h"
+
+#ifndef __WINDOWS__
+#include <fenv.h>
+#endif
+
+#ifdef __GUI__
+#include "libeblearngui.h"
+#endif
+
+typedef float T; // precision at which network is fprop (float is ok)
+typedef float Tdata; // data's original type
+typedef int Tlabel; // label's original type
+#define bbsds T,Tdata,int
+
+// global variables
+
+uint ncalibration = 500; // Number of samples used for calibration.
+std::string output_conf; // Output configuration of calibrated ranges.
+
+// calibration /////////////////////////////////////////////////////////////////
+
+// Records the input ranges of each int8 module of 'net' over the first
+// 'n' samples of 'ds'.
+void calibrate(module_1_1<T> &net, datasource<T,Tdata> &ds, uint n) {
+  std::vector<module_1_1<T>*> qmods;
+  find_int8_modules(net, qmods);
+  n = std::min(n, (uint) ds.size());
+  cout << "Calibrating " << qmods.size() << " int8 modules on " << n
+       << " samples from " << ds.name() << endl;
+  for (uint i = 0; i < qmods.size(); ++i)
+    dynamic_cast<int8_quantizer<T>*>(qmods[i])->start_calibration();
+  state<T> in, out;
+  ds.init_epoch();
+  ds.set_test(); // make sure we iterate straight through dataset
+  for (uint i = 0; i < n; ++i) {
+    ds.fprop_data(in);
+    net.fprop(in, out);
+    ds.next();
+  }
+  for (uint i = 0; i < qmods.size(); ++i) {
+    int8_quantizer<T> *q = dynamic_cast<int8_quantizer<T>*>(qmods[i]);
+    q->stop_calibration();
+    cout << qmods[i]->name() << ": input range " << q->get_range() << endl;
+  }
+}
+
+// Writes the calibrated ranges of each int8 module of 'net' into 'fname'.
+void write_ranges(module_1_1<T> &net, const std::string &fname) {
+  std::vector<module_1_1<T>*> qmods;
+  find_int8_modules(net, qmods);
+  std::ofstream of(fname.c_str());
+  if (!of) eblerror("failed to open " << fname);
+  of << "# int8 input ranges calibrated by dscalibrate" << endl;
+  of << "quantize_int8 = 1" << endl;
+  for (uint i = 0; i < qmods.size(); ++i)
+    of << qmods[i]->name() << "_int8_range = "
+       << dynamic_cast<int8_quantizer<T>*>(qmods[i])->get_range() << endl;
+  of.close();
+  cout << "Saved int8 ranges to " << fname << endl;
+}
+
+// evaluation //////////////////////////////////////////////////////////////////
+
+// Compares outputs of floating point network 'net' and int8 network 'qnet'
+// on all samples of 'ds'.
+void compare(module_1_1<T> &net, module_1_1<T> &qnet,
+	     labeled_datasource<T,Tdata,Tlabel> &ds) {
+  cout << "Comparing float and int8 networks on " << ds.size()
+       << " samples from " << ds.name() << endl;
+  state<T> in, out, qout;
+  state<Tlabel> label;
+  timer tfloat, tint8;
+  uint n = 0, nlabeled = 0, agree = 0, errors = 0, qerrors = 0;
+  double maxdiff = 0, sumdiff = 0, nelements = 0;
+  ds.init_epoch();
+  ds.set_test(); // make sure we iterate straight through dataset
+  for (uint i = 0; i < ds.size(); ++i, ++n) {
+    ds.fprop_data(in);
+    ds.fprop_label(label);
+    tfloat.start();
+    net.fprop(in, out);
+    tfloat.stop();
+    tint8.start();
+    qnet.fprop(in, qout);
+    tint8.stop();
+    // outputs differences
+    { idx_aloop2(o, out, T, q, qout, T) {
+	double d = fabs((double) *o - *q);
+	maxdiff = std::max(maxdiff, d);
+	sumdiff += d;
+      }}
+    nelements += out.nelements();
+    // classification
+    intg c = idx_indexmax(out), qc = idx_indexmax(qout);
+    if (c == qc) agree++;
+    if (label.nelements() == 1) {
+      intg l = (intg) *label.idx_ptr();
+      nlabeled++;
+      if (c != l) errors++;
+      if (qc != l) qerrors++;
+    }
+    ds.next();
+  }
+  if (n == 0) return ;
+  cout << "Outputs absolute difference: max " << maxdiff << " mean "
+       << sumdiff / std::max(1.0, nelements) << endl;
+  cout << "Same answer: " << agree * 100.0 / n << "%" << endl;
+  if (nlabeled > 0) {
+    double ferr = errors * 100.0 / nlabeled, qerr = qerrors * 100.0 / nlabeled;
+    cout << "Float error: " << ferr << "% int8 error: " << qerr
+	 << "% accuracy loss: " << qerr - ferr << "%" << endl;
+  }
+  cout << "Float fprop: " << tfloat.accumulated_milliseconds() / (double) n
+       << " ms/sample, int8 fprop: "
+       << tint8.accumulated_milliseconds() / (double) n << " ms/sample"
+       << endl;
+}
+
+// args ////////////////////////////////////////////////////////////////////////
+
+// parse command line input
+bool parse_args(int argc, char **argv) {
+  // Read arguments from shell input
+  if (argc <= 1) {
+    cerr << "input error: expecting arguments." << endl;
+    return false;
+  }
+  // loop over arguments
+  for (int i = 2; i < argc; ++i) {
+    try {
+      if (strcmp(argv[i], "-n") == 0) {
+	++i; if (i >= argc) throw 1;
+	ncalibration = atoi(argv[i]);
+      } else if (strcmp(argv[i], "-o") == 0) {
+	++i; if (i >= argc) throw 0;
+	output_conf = argv[i];
+      } else throw 2;
+    } catch (int err) {
+      cerr << "input error: ";
+      switch (err) {
+      case 0: cerr << "expecting string after " << argv[i-1]; break;
+      case 1: cerr << "expecting integer after " << argv[i-1]; break;
+      case 2: cerr << "unknown parameter " << argv[i-1]; break;
+      default: cerr << "undefined error";
+      }
+      cerr << endl << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// print command line usage
+void print_usage() {
+  cout << "Usage: ./dscalibrate <conf> [OPTIONS]"
+       << endl << "Options are:" << endl;
+  cout << "  -n <integer>" << endl
+       << "   Number of samples used to calibrate int8 ranges (default: "
+       << ncalibration << ")." << endl;
+  cout << "  -o <file>" << endl
+       << "   Output configuration of calibrated ranges (default: "
+       << "<conf>_int8.conf)." << endl;
+}
+
+// main ////////////////////////////////////////////////////////////////////////
+
+#ifdef __GUI__
+MAIN_QTHREAD(int, argc, char **, argv) { // macro to enable multithreaded gui
+#else
+  int main(int argc, char **argv) { // regular main without gui
+#endif
+    cout << "* Dataset int8 calibration" << endl;
+    // parse arguments
+    if (!parse_args(argc, argv)) {
+      print_usage();
+      return -1;
+    }
+#ifdef __LINUX__
+    feenableexcept(FE_DIVBYZERO | FE_INVALID); // enable float exceptions
+#endif
+    try {
+      cout << "Using random seed " << dynamic_init_drand(argc, argv) << endl;
+      timer gtimer;
+      gtimer.start(); // total running time
+      configuration conf(argv[1], true, true, false); // configuration file
+      if (!conf.exists("current_dir")) {
+	string dir;
+	dir << dirname(argv[1]) << "/";
+	cout << "setting current_dir to: " << dir << endl;
+	conf.set("current_dir", dir.c_str());
+      }
+      conf.set("run_type", "fprop"); // tell conf that we are in fprop mode
+      conf.resolve();
+      if (output_conf.empty())
+	output_conf << noext_name(argv[1]) << "_int8.conf";
+
+      //! load datasets, calibrate on training samples if available
+      uint noutputs = 0;
+      labeled_datasource<T,Tdata,Tlabel> *train_ds = NULL;
+      labeled_datasource<T,Tdata,Tlabel> *test_ds = NULL;
+      string valdata, traindata;
+      test_ds = create_validation_set<T,Tdata,Tlabel>(conf, noutputs, valdata);
+      if (!conf.exists_true("test_only"))
+        train_ds =
+	  create_training_set<T,Tdata,Tlabel>(conf, noutputs, traindata);
+
+      // create networks ///////////////////////////////////////////////////////
+      answer_module<bbsds> *answer = create_answer<bbsds>(conf, noutputs);
+      if (answer) // update number of outputs given the answer module
+        noutputs = answer->get_nfeatures();
+      parameter<T> theparam, qparam;
+      intg inthick = conf.exists("input_thickness") ?
+	conf.get_int("input_thickness") : -1, qinthick = inthick;
+      conf.set("quantize_int8", "0");
+      module_1_1<T> *net =
+	create_network<T>(theparam, conf, inthick, noutputs, "arch");
+      conf.set("quantize_int8", "1");
+      module_1_1<T> *qnet =
+	create_network<T>(qparam, conf, qinthick, noutputs, "arch");
+      //! initialize the network weights, shared by both networks
+      if (conf.exists_true("retrain"))
+        theparam.load_x(conf.get_cstring("retrain_weights"));
+      else {
+	eblwarn("calibrating a randomly initialized network, "
+		<< "retrain_weights should be set");
+	bool fixed_random = conf.try_get_bool("fixed_randomization", false);
+	forget_param_linear fgp(1, 0.5, !fixed_random);
+	if (!fixed_random) fgp.seed(conf.str());
+        net->forget(fgp);
+      }
+      qparam.load_x(theparam);
+      cout << "Float network: " << net->describe() << endl;
+      cout << "int8 network: " << qnet->describe() << endl;
+
+      // calibrate and evaluate ////////////////////////////////////////////////
+      labeled_datasource<T,Tdata,Tlabel> *cal_ds = train_ds ? train_ds : test_ds;
+      calibrate(*qnet, *cal_ds, ncalibration);
+      write_ranges(*qnet, output_conf);
+      if (test_ds) compare(*net, *qnet, *test_ds);
+
+      //free variables
+      if (net) delete net;
+      if (qnet) delete qnet;
+      if (answer) delete answer;
+      if (test_ds) delete test_ds;
+      if (train_ds) delete train_ds;
+#ifdef __GUI__
+      quit_gui(); // close all windows
+#endif
+      cout << "dscalibrate done. Running time: " << gtimer.elapsed() << endl;
+    } eblcatcherror();
+    return 0;
+  }
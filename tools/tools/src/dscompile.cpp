@@ -180,6 +180,7 @@ bool            divnorm2 = false; // 2nd divisive normalization
 bool            colornorm = false; // color normalization
 bool            colornorm_across = true; // color norm across channels
 bool            videobox = false; // read bboxes in video sequences
+bool            compress = false; // compress saved matrices
 uint            videobox_stride; // the stride for videobox
 uint            videobox_n; // number of images to read-ahead
 
@@ -286,6 +287,8 @@ bool parse_args(int argc, char **argv) {
 	individual_save = false;
       } else if (strcmp(argv[i], "-save_layers_separately") == 0) {
 	separate_layers_save = true;
+      } else if (strcmp(argv[i], "-compress") == 0) {
+	compress = true;
       } else if (strcmp(argv[i], "-load") == 0) {
 	++i; if (i >= argc) throw 0;
 	load = argv[i];
@@ -550,6 +553,8 @@ void print_usage() {
        << "     Do not save individual samples." << endl;
   cout << "  -save_layers_separately" << endl
        << "     Save each layer of each sampe in separate files." << endl;
+  cout << "  -compress" << endl
+       << "     Compress saved matrices (loaded back transparently)." << endl;
   cout << "  -dname <name>" << endl;
   cout << "  -maxperclass <integer>" << endl;
   cout << "  -maxdata <integer>" << endl;
@@ -742,6 +747,7 @@ void compile() {
   if (scale_mode) ds->set_scales(scales, outdir);
   if (minvisibility_set) ds->set_minvisibility(minvisibility);
   if (planar_loading) ds->set_planar_loading();
+  if (compress) set_compressed_saving(true);
   // execute extraction
   // switch between load and normal mode
   if (load_set) { // in load mode, do nothing but loading dataset
@@ -70,6 +70,10 @@ int train(configuration &conf, string &conffname) {
     uint              ipp_cores     = 1;
     if (conf.exists("ipp_cores")) ipp_cores = conf.get_uint("ipp_cores");
     ipp_init(ipp_cores); // limit IPP (if available) to 1 core
+    if (conf.exists_true("pooled_allocator")) // cache and align tensors
+      srg_allocator::set_mode(SRG_ALLOC_POOLED);
+    if (conf.exists_true("csv_cache")) // keep parsed csv datasets in .mat files
+      set_csv_caching(true);
     intg nhessian = conf.exists("ndiaghessian") ?
       conf.get_int("ndiaghessian") : 100;
     intg hessian_period = conf.exists("hessian_period") ?
@@ -97,6 +101,8 @@ int train(configuration &conf, string &conffname) {
                                                  &net, iter);
     thetrainer->set_test_display_modulo
         (conf.try_get_intg("test_display_modulo", 0));
+    if (conf.exists("batch_size"))
+      thetrainer->set_batch_size(conf.get_uint("batch_size"));
     // a classifier-meter measures classification errors
     classifier_meter trainmeter, testmeter;
     trainmeter.init(noutputs);